@@ -60,6 +60,8 @@ namespace companion
             public bool useParallelProjection;
             public bool useSmartSmoothing;
             public float fps;
+
+            public bool isLive;
         }
 
         [DllImport("pimax-openxr.dll", CallingConvention = CallingConvention.StdCall)]
@@ -278,6 +280,11 @@ namespace companion
                 status.valid = false;
 
                 getRuntimeStatus(new IntPtr(&status));
+                if (!status.valid)
+                {
+                    runtimeStatusLabel.Text = "Pimax runtime status is not available while an application is running.";
+                    return;
+                }
                 var label = "Resolution: " + status.resolutionWidth + "x" + status.resolutionHeight + " @ " + status.refreshRate.ToString("#") + " Hz" +
                     "   Horizontal FOV: " + status.fov.ToString("#.#") + " deg (" + fov[status.fovLevel] + ")\n";
                 if (status.useParallelProjection)
@@ -289,6 +296,10 @@ namespace companion
                     label += "Smart Smoothing, ";
                 }
                 label += "Floor height: " + status.floorHeight.ToString("#.##") + " m";
+                if (status.isLive)
+                {
+                    label += ", Running at " + status.fps.ToString("0") + " FPS";
+                }
                 runtimeStatusLabel.Text = label;
             }
             catch (Exception)
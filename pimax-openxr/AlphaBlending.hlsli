@@ -9,3 +9,21 @@ float4 processAlpha(float4 input, uint2 pos, uint2 widthHeight, bool ignoreAlpha
     }
     return output;
 }
+
+// Helpers to access R8G8B8A8 texels through a R32_UINT view, since SRGB formats cannot be used for UAVs.
+float4 unpackR8G8B8A8(uint packed) {
+    return float4(packed & 0xff, (packed >> 8) & 0xff, (packed >> 16) & 0xff, packed >> 24) / 255.0;
+}
+
+uint packR8G8B8A8(float4 color) {
+    const uint4 bytes = (uint4)round(saturate(color) * 255.0);
+    return bytes.r | (bytes.g << 8) | (bytes.b << 16) | (bytes.a << 24);
+}
+
+float3 srgbToLinear(float3 color) {
+    return color <= 0.04045 ? color / 12.92 : pow((color + 0.055) / 1.055, 2.4);
+}
+
+float3 linearToSrgb(float3 color) {
+    return color <= 0.0031308 ? color * 12.92 : 1.055 * pow(color, 1.0 / 2.4) - 0.055;
+}
@@ -0,0 +1,31 @@
+// Clear or set the alpha channel and/or premultiply each component, then encode to SRGB.
+
+#include "AlphaBlending.hlsli"
+
+cbuffer config : register(b0) {
+    bool ignoreAlpha;
+    bool isUnpremultipliedAlpha;
+    bool isInPlace;
+};
+
+Texture2D in_texture : register(t0);
+RWTexture2D<uint> out_texture : register(u0);
+
+[numthreads(32, 32, 1)]
+void main(uint2 pos : SV_DispatchThreadID) {
+    uint width, height;
+    out_texture.GetDimensions(width, height);
+
+    // When processing in-place, the texture cannot be bound as an input.
+    float4 input;
+    if (isInPlace) {
+        input = unpackR8G8B8A8(out_texture[pos]);
+        input.rgb = srgbToLinear(input.rgb);
+    } else {
+        input = in_texture[pos];
+    }
+
+    float4 output = processAlpha(input, pos, uint2(width, height), ignoreAlpha, isUnpremultipliedAlpha);
+    output.rgb = linearToSrgb(saturate(output.rgb));
+    out_texture[pos] = packR8G8B8A8(output);
+}
@@ -0,0 +1,24 @@
+// Clear or set the alpha channel and/or premultiply each component, then encode to SRGB.
+
+#include "AlphaBlending.hlsli"
+
+cbuffer config : register(b0) {
+    bool ignoreAlpha;
+    bool isUnpremultipliedAlpha;
+    bool isInPlace;
+};
+
+Texture2DArray in_texture : register(t0);
+RWTexture2D<uint> out_texture : register(u0);
+
+[numthreads(32, 32, 1)]
+void main(uint2 pos : SV_DispatchThreadID) {
+    uint width, height, size;
+    in_texture.GetDimensions(width, height, size);
+
+    // The destination is always a different texture than the source (the slice of another swapchain).
+    float4 output = processAlpha(
+        in_texture[float3(pos, 0)], pos, uint2(width, height), ignoreAlpha, isUnpremultipliedAlpha);
+    output.rgb = linearToSrgb(saturate(output.rgb));
+    out_texture[pos] = packR8G8B8A8(output);
+}
@@ -0,0 +1,29 @@
+// Resample a parallel view into a canted view. Both views share the same eye position, so each point of the canted
+// view maps to a single point of the parallel view through a rotation.
+
+#include "AlphaBlending.hlsli"
+
+cbuffer config : register(b0) {
+    // The rows of the rotation from the canted view to the parallel view.
+    float4 cantedToParallel[3];
+    // The tangents of the FOV angles: left, right, up and down.
+    float4 destinationTan;
+    float4 sourceTan;
+    // The image rectangle of the parallel view, in normalized texture coordinates.
+    float4 sourceRect;
+    bool ignoreAlpha;
+    bool isUnpremultipliedAlpha;
+};
+
+// Returns false if the point falls outside of the parallel view.
+bool getSourceTexcoord(float2 texcoord, out float2 sourceTexcoord) {
+    const float3 canted = float3(
+        lerp(destinationTan.x, destinationTan.y, texcoord.x), lerp(destinationTan.z, destinationTan.w, texcoord.y), -1);
+    const float3 parallel = float3(dot(cantedToParallel[0].xyz, canted),
+                                   dot(cantedToParallel[1].xyz, canted),
+                                   dot(cantedToParallel[2].xyz, canted));
+
+    const float2 uv = (parallel.xy / -parallel.z - sourceTan.xz) / (sourceTan.yw - sourceTan.xz);
+    sourceTexcoord = sourceRect.xy + uv * sourceRect.zw;
+    return parallel.z < 0 && all(uv >= 0) && all(uv <= 1);
+}
@@ -0,0 +1,14 @@
+// Resample a parallel view into a canted view, with alpha correction.
+
+#include "ParallelReprojection.hlsli"
+
+SamplerState sourceSampler : register(s0);
+Texture2DArray sourceTexture : register(t0);
+
+float4 main(in float4 position : SV_POSITION, in float2 texcoord : TEXCOORD0) : SV_TARGET {
+    float2 sourceTexcoord;
+    const float4 color = getSourceTexcoord(texcoord, sourceTexcoord)
+                             ? sourceTexture.Sample(sourceSampler, float3(sourceTexcoord, 0))
+                             : 0;
+    return processAlpha(color, (uint2)position.xy, 0, ignoreAlpha, isUnpremultipliedAlpha);
+}
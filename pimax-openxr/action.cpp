@@ -80,8 +80,6 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
         *path = stringToPath(pathString, true /* validate */);
         if (*path == XR_NULL_PATH) {
             return XR_ERROR_PATH_FORMAT_INVALID;
@@ -105,14 +103,12 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
-        const auto it = m_strings.find(path);
-        if (it == m_strings.cend()) {
+        const std::string* const entry = m_strings.getString(path);
+        if (!entry) {
             return XR_ERROR_PATH_INVALID;
         }
 
-        const auto& str = it->second;
+        const auto& str = *entry;
         if (bufferCapacityInput && bufferCapacityInput < str.length()) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
@@ -206,6 +202,7 @@ namespace pimax_openxr {
         delete xrActionSet;
         m_actionSets.erase(actionSet);
         m_activeActionSets.erase(actionSet);
+        std::atomic_store(&m_actionStateSnapshot, std::shared_ptr<const ActionStateSnapshot>());
 
         return XR_SUCCESS;
     }
@@ -327,6 +324,7 @@ namespace pimax_openxr {
         // We do not delete the action as it might still be used internally (eg: referenced by action spaces).
 
         m_actions.erase(action);
+        std::atomic_store(&m_actionStateSnapshot, std::shared_ptr<const ActionStateSnapshot>());
 
         return XR_SUCCESS;
     }
@@ -402,6 +400,8 @@ namespace pimax_openxr {
                 source.realPath = path;
                 xrAction.actionSources.insert_or_assign(path, source);
             }
+
+            resolveActionSpaceBindings();
         }
 
         return XR_SUCCESS;
@@ -519,77 +519,17 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_BOOLEAN_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        if (getInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(getInfo->subactionPath) == m_strings.cend()) {
-                return XR_ERROR_PATH_INVALID;
-            }
-            if (!xrAction.subactionPaths.count(getInfo->subactionPath)) {
-                return XR_ERROR_PATH_UNSUPPORTED;
-            }
+        ActionState actionState;
+        const XrResult result =
+            getActionState(getInfo->action, getInfo->subactionPath, XR_ACTION_TYPE_BOOLEAN_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        std::optional<bool> combinedState;
-        const std::string& subActionPath = getXrPath(getInfo->subactionPath);
-        const int subActionSide = std::max(0, getActionSide(subActionPath));
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.buttonMap != nullptr || value.floatValue != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateBoolean",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side]) {
-                    // Per spec, the combined state is the OR of all values.
-                    if (value.buttonMap) {
-                        combinedState = combinedState.value_or(false) || value.buttonMap[side] & value.buttonType;
-                    } else if (value.floatValue) {
-                        combinedState = combinedState.value_or(false) || value.floatValue[side] > 0.95f;
-                    }
-                }
-            }
-        }
-
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        if (combinedState) {
-            state->currentState = combinedState.value();
-            state->changedSinceLastSync = !!state->currentState != xrAction.lastBoolValue[subActionSide];
-
-            const ActionSet& xrActionSet = *(ActionSet*)xrAction.actionSet;
-            state->lastChangeTime = state->changedSinceLastSync
-                                        ? pvrTimeToXrTime(xrActionSet.cachedInputState.TimeInSeconds)
-                                        : xrAction.lastBoolValueChangedTime[subActionSide];
-        } else {
-            state->currentState = state->changedSinceLastSync = XR_FALSE;
-            state->lastChangeTime = 0;
-        }
-
-        xrAction.lastBoolValue[subActionSide] = state->currentState;
-        xrAction.lastBoolValueChangedTime[subActionSide] = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = actionState.boolValue ? XR_TRUE : XR_FALSE;
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(g_traceProvider,
                           "xrGetActionStateBoolean",
@@ -619,87 +559,17 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_FLOAT_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        if (getInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(getInfo->subactionPath) == m_strings.cend()) {
-                return XR_ERROR_PATH_INVALID;
-            }
-            if (!xrAction.subactionPaths.count(getInfo->subactionPath)) {
-                return XR_ERROR_PATH_UNSUPPORTED;
-            }
-        }
-
-        std::optional<float> combinedState;
-        const std::string& subActionPath = getXrPath(getInfo->subactionPath);
-        const int subActionSide = std::max(0, getActionSide(subActionPath));
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.floatValue != nullptr ||
-                                 (value.vector2fValue != nullptr && value.vector2fIndex >= 0) ||
-                                 value.buttonMap != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateFloat",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side]) {
-                    // Per spec, the combined state is the absolute maximum of all values.
-                    if (value.floatValue) {
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.floatValue[side]);
-                    } else if (value.buttonMap) {
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.buttonMap[side] & value.buttonType ? 1.f : 0.f);
-                    } else if (value.vector2fValue) {
-                        const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
-
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.vector2fIndex == 0 ? vector2fValue.x : vector2fValue.y);
-                    }
-                }
-            }
-        }
-
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        if (combinedState) {
-            state->currentState = combinedState.value();
-            state->changedSinceLastSync = state->currentState != xrAction.lastFloatValue[subActionSide];
-
-            const ActionSet& xrActionSet = *(ActionSet*)xrAction.actionSet;
-            state->lastChangeTime = state->changedSinceLastSync
-                                        ? pvrTimeToXrTime(xrActionSet.cachedInputState.TimeInSeconds)
-                                        : xrAction.lastFloatValueChangedTime[subActionSide];
-        } else {
-            state->currentState = 0.0f;
-            state->changedSinceLastSync = XR_FALSE;
-            state->lastChangeTime = 0;
+        ActionState actionState;
+        const XrResult result =
+            getActionState(getInfo->action, getInfo->subactionPath, XR_ACTION_TYPE_FLOAT_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        xrAction.lastFloatValue[subActionSide] = state->currentState;
-        xrAction.lastFloatValueChangedTime[subActionSide] = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = actionState.floatValue;
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(g_traceProvider,
                           "xrGetActionStateFloat",
@@ -729,84 +599,17 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
+        ActionState actionState;
+        const XrResult result =
+            getActionState(getInfo->action, getInfo->subactionPath, XR_ACTION_TYPE_VECTOR2F_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_VECTOR2F_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        if (getInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(getInfo->subactionPath) == m_strings.cend()) {
-                return XR_ERROR_PATH_INVALID;
-            }
-            if (!xrAction.subactionPaths.count(getInfo->subactionPath)) {
-                return XR_ERROR_PATH_UNSUPPORTED;
-            }
-        }
-
-        std::optional<XrVector2f> combinedState;
-        const std::string& subActionPath = getXrPath(getInfo->subactionPath);
-        const int subActionSide = std::max(0, getActionSide(subActionPath));
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.vector2fValue != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateVector2f",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side] && value.vector2fValue) {
-                    const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
-
-                    // Per spec, the combined state if the one of the vector with the longest length.
-                    const float l1 = combinedState ? sqrt(combinedState.value().x * combinedState.value().x +
-                                                          combinedState.value().y * combinedState.value().y)
-                                                   : 0.f;
-                    const float l2 = sqrt(vector2fValue.x * vector2fValue.x + vector2fValue.y * vector2fValue.y);
-                    if (l2 >= l1) {
-                        combinedState = vector2fValue;
-                    }
-                }
-            }
-        }
-
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        if (combinedState) {
-            state->currentState = combinedState.value();
-
-            state->changedSinceLastSync = state->currentState.x != xrAction.lastVector2fValue[subActionSide].x ||
-                                          state->currentState.y != xrAction.lastVector2fValue[subActionSide].y;
-
-            const ActionSet& xrActionSet = *(ActionSet*)xrAction.actionSet;
-            state->lastChangeTime = state->changedSinceLastSync
-                                        ? pvrTimeToXrTime(xrActionSet.cachedInputState.TimeInSeconds)
-                                        : xrAction.lastVector2fValueChangedTime[subActionSide];
-        } else {
-            state->currentState = {0.0f, 0.0f};
-            state->changedSinceLastSync = XR_FALSE;
-            state->lastChangeTime = 0;
-        }
-
-        xrAction.lastVector2fValue[subActionSide] = state->currentState;
-        xrAction.lastVector2fValueChangedTime[subActionSide] = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = actionState.vector2fValue;
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(
             g_traceProvider,
@@ -837,56 +640,14 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        std::unique_lock lock(m_actionsAndSpacesMutex);
-
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_POSE_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        ActionState actionState;
+        const XrResult result =
+            getActionState(getInfo->action, getInfo->subactionPath, XR_ACTION_TYPE_POSE_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        if (getInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(getInfo->subactionPath) == m_strings.cend()) {
-                return XR_ERROR_PATH_INVALID;
-            }
-            if (!xrAction.subactionPaths.count(getInfo->subactionPath)) {
-                return XR_ERROR_PATH_UNSUPPORTED;
-            }
-        }
-
-        const std::string& subActionPath = getXrPath(getInfo->subactionPath);
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            TraceLoggingWrite(g_traceProvider, "xrGetActionStatePose", TLArg(fullPath.c_str(), "ActionSourcePath"));
-
-            // We only support hands paths and eye tracker, not gamepad etc.
-            if (!isActionEyeTracker(fullPath)) {
-                const int side = getActionSide(fullPath);
-                if (side >= 0) {
-                    state->isActive = m_isControllerActive[side] ? XR_TRUE : XR_FALSE;
-
-                    // Per spec we must consistently pick one source. We pick the first one.
-                    break;
-                }
-            } else {
-                state->isActive = m_isEyeTrackingAvailable ? XR_TRUE : XR_FALSE;
-
-                // Per spec we must consistently pick one source. We pick the first one.
-                break;
-            }
-        }
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
 
         TraceLoggingWrite(g_traceProvider, "xrGetActionStatePose", TLArg(!!state->isActive, "Active"));
 
@@ -911,9 +672,11 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        // TODO: Try to reduce contention here.
+        // The xrGetActionState*() functions do not wait on this lock: they read from the last published snapshot.
         std::unique_lock lock(m_actionsAndSpacesMutex);
 
+        invalidatePoseCache();
+
         bool doSide[xr::Side::Count] = {false, false};
         for (uint32_t i = 0; i < syncInfo->countActiveActionSets; i++) {
             if (!m_activeActionSets.count(syncInfo->activeActionSets[i].actionSet)) {
@@ -941,7 +704,7 @@ namespace pimax_openxr {
         }
 
         // Latch the state of all inputs, and we will let the further calls to xrGetActionState*() do the triage.
-        CHECK_PVRCMD(pvr_getInputState(m_pvrSession, &m_cachedInputState));
+        latchInputState();
         bool wasRecenteringPressed = false;
         bool wasSystemPressed = false;
         for (uint32_t side = 0; side < xr::Side::Count; side++) {
@@ -971,31 +734,18 @@ namespace pimax_openxr {
                 TLArg(m_cachedInputState.fingerRing[side], "RingFinger"),
                 TLArg(m_cachedInputState.fingerPinky[side], "PinkyFinger"));
 
-            // Look for changes in controller/interaction profiles.
+            // Look for changes in controller/interaction profiles. The controller watcher thread does the PVR queries.
             const auto lastControllerType = m_cachedControllerType[side];
-            const int size = pvr_getTrackedDeviceStringProperty(m_pvrSession,
-                                                                side == 0 ? pvrTrackedDevice_LeftController
-                                                                          : pvrTrackedDevice_RightController,
-                                                                pvrTrackedDeviceProp_ControllerType_String,
-                                                                nullptr,
-                                                                0);
-            m_isControllerActive[side] = size > 0;
-            if (m_isControllerActive[side]) {
-                if (m_debugControllerType.empty()) {
-                    m_cachedControllerType[side].resize(size, 0);
-                    pvr_getTrackedDeviceStringProperty(m_pvrSession,
-                                                       side == 0 ? pvrTrackedDevice_LeftController
-                                                                 : pvrTrackedDevice_RightController,
-                                                       pvrTrackedDeviceProp_ControllerType_String,
-                                                       m_cachedControllerType[side].data(),
-                                                       (int)m_cachedControllerType[side].size() + 1);
-                    // Remove trailing 0.
-                    m_cachedControllerType[side].resize(size - 1, 0);
+            if (m_controllerStateChanged[side].exchange(false)) {
+                std::unique_lock lock(m_controllerWatcherMutex);
+
+                m_isControllerActive[side] = m_isWatchedControllerPresent[side];
+                if (m_isControllerActive[side]) {
+                    m_cachedControllerType[side] =
+                        m_debugControllerType.empty() ? m_watchedControllerType[side] : m_debugControllerType;
                 } else {
-                    m_cachedControllerType[side] = m_debugControllerType;
+                    m_cachedControllerType[side].clear();
                 }
-            } else {
-                m_cachedControllerType[side].clear();
             }
 
             if (lastControllerType != m_cachedControllerType[side] ||
@@ -1031,25 +781,10 @@ namespace pimax_openxr {
             ActionSet& xrActionSet = *(ActionSet*)syncInfo->activeActionSets[i].actionSet;
 
             xrActionSet.cachedInputState = m_cachedInputState;
+            std::copy_n(m_inputChangeTime, xr::Side::Count, xrActionSet.inputChangeTime);
         }
 
-        // Re-assert haptics to OVR. We do this regardless of actionsets being synced.
-        const auto now = std::chrono::high_resolution_clock::now();
-        for (uint32_t side = 0; side < xr::Side::Count; side++) {
-            if (m_currentVibration[side].duration > 0) {
-                const bool isExpired =
-                    (now - m_currentVibration[side].startTime).count() >= m_currentVibration[side].duration;
-                if (isExpired) {
-                    m_currentVibration[side].amplitude = 0.f;
-                    m_currentVibration[side].duration = 0;
-                }
-
-                CHECK_PVRCMD(pvr_triggerHapticPulse(m_pvrSession,
-                                                    side == 0 ? pvrTrackedDevice_LeftController
-                                                              : pvrTrackedDevice_RightController,
-                                                    m_currentVibration[side].amplitude));
-            }
-        }
+        publishActionStateSnapshot(*syncInfo);
 
         m_lastForcedInteractionProfile = m_forcedInteractionProfile;
 
@@ -1266,7 +1001,7 @@ namespace pimax_openxr {
         }
 
         if (hapticActionInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(hapticActionInfo->subactionPath) == m_strings.cend()) {
+            if (!m_strings.getString(hapticActionInfo->subactionPath)) {
                 return XR_ERROR_PATH_INVALID;
             }
             if (!xrAction.subactionPaths.count(hapticActionInfo->subactionPath)) {
@@ -1274,6 +1009,27 @@ namespace pimax_openxr {
             }
         }
 
+        // Validate the PCM buffer before touching any state.
+        const XrHapticPcmVibrationFB* pcm = nullptr;
+        if (has_XR_FB_haptic_pcm && hapticFeedback->type == XR_TYPE_HAPTIC_PCM_VIBRATION_FB) {
+            pcm = reinterpret_cast<const XrHapticPcmVibrationFB*>(hapticFeedback);
+            if ((pcm->bufferSize && !pcm->buffer) || pcm->bufferSize > XR_MAX_HAPTIC_PCM_BUFFER_SIZE_FB ||
+                pcm->sampleRate <= 0 || !pcm->samplesConsumed) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrApplyHapticFeedback",
+                              TLArg(pcm->bufferSize, "BufferSize"),
+                              TLArg(pcm->sampleRate, "SampleRate"),
+                              TLArg(!!pcm->append, "Append"));
+        }
+
+        std::unique_lock hapticsLock(m_hapticsMutex);
+
+        std::optional<uint32_t> samplesConsumed;
+
+        const auto now = std::chrono::high_resolution_clock::now();
         const std::string& subActionPath = getXrPath(hapticActionInfo->subactionPath);
         for (const auto& source : xrAction.actionSources) {
             if (!startsWith(source.first, subActionPath)) {
@@ -1286,43 +1042,76 @@ namespace pimax_openxr {
 
             // We only support hands paths, not gamepad etc.
             const int side = getActionSide(fullPath);
-            if (isOutput && side >= 0) {
-                const XrHapticBaseHeader* entry = reinterpret_cast<const XrHapticBaseHeader*>(hapticFeedback);
-                while (entry) {
-                    if (entry->type == XR_TYPE_HAPTIC_VIBRATION) {
-                        const XrHapticVibration* vibration = reinterpret_cast<const XrHapticVibration*>(entry);
-
-                        TraceLoggingWrite(g_traceProvider,
-                                          "xrApplyHapticFeedback",
-                                          TLArg(vibration->amplitude, "Amplitude"),
-                                          TLArg(vibration->frequency, "Frequency"),
-                                          TLArg(vibration->duration, "Duration"));
-
-                        // NOTE: PVR only supports pulses, so there is nothing we can do with the
-                        // frequency.
-                        m_currentVibration[side].startTime = std::chrono::high_resolution_clock::now();
-                        m_currentVibration[side].amplitude = vibration->amplitude;
-                        if (vibration->amplitude > 0) {
-                            // General recommendation is 20ms for short pulses.
-                            m_currentVibration[side].duration =
-                                vibration->duration == XR_MIN_HAPTIC_DURATION ? 20'000'000 : vibration->duration;
-
-                            CHECK_PVRCMD(pvr_triggerHapticPulse(m_pvrSession,
-                                                                side == 0 ? pvrTrackedDevice_LeftController
-                                                                          : pvrTrackedDevice_RightController,
-                                                                vibration->amplitude));
-                        } else {
-                            // OpenComposite seems to pass an amplitude of 0 sometimes. Assume this means stopping.
-                            m_currentVibration[side].duration = 0;
-                        }
-                        break;
-                    }
+            if (!isOutput || side < 0) {
+                continue;
+            }
 
-                    entry = reinterpret_cast<const XrHapticBaseHeader*>(entry->next);
+            Haptic& haptic = m_currentVibration[side];
+            if (pcm) {
+                // A new buffer replaces anything playing, unless it is appended to the samples still queued.
+                const bool isPlayingPcm = haptic.pcmPosition < haptic.pcmSamples.size();
+                if (!pcm->append || !isPlayingPcm || haptic.pcmSampleRate != pcm->sampleRate) {
+                    haptic.pcmSamples.clear();
+                    haptic.pcmPosition = 0;
+                    haptic.pcmSampleRate = pcm->sampleRate;
+                    haptic.pcmStartTime = now;
+                } else if (haptic.pcmPosition) {
+                    // Drop the samples already played, and shift the start time accordingly.
+                    haptic.pcmSamples.erase(haptic.pcmSamples.begin(), haptic.pcmSamples.begin() + haptic.pcmPosition);
+                    haptic.pcmStartTime += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                        std::chrono::duration<double>(haptic.pcmPosition / (double)haptic.pcmSampleRate));
+                    haptic.pcmPosition = 0;
                 }
+                const uint32_t accepted =
+                    (uint32_t)std::min<size_t>(pcm->bufferSize, k_maxHapticPcmSamples - haptic.pcmSamples.size());
+                haptic.pcmSamples.insert(haptic.pcmSamples.end(), pcm->buffer, pcm->buffer + accepted);
+                haptic.amplitude = 0.f;
+                haptic.duration = 0;
+
+                // The application resubmits what we did not consume, so report the smallest count across sides.
+                samplesConsumed = std::min(samplesConsumed.value_or(accepted), accepted);
+                continue;
+            }
+
+            const XrHapticBaseHeader* entry = reinterpret_cast<const XrHapticBaseHeader*>(hapticFeedback);
+            while (entry) {
+                if (entry->type == XR_TYPE_HAPTIC_VIBRATION) {
+                    const XrHapticVibration* vibration = reinterpret_cast<const XrHapticVibration*>(entry);
+
+                    TraceLoggingWrite(g_traceProvider,
+                                      "xrApplyHapticFeedback",
+                                      TLArg(vibration->amplitude, "Amplitude"),
+                                      TLArg(vibration->frequency, "Frequency"),
+                                      TLArg(vibration->duration, "Duration"));
+
+                    // NOTE: PVR only supports pulses, so there is nothing we can do with the
+                    // frequency.
+                    haptic.startTime = now;
+                    haptic.amplitude = vibration->amplitude;
+                    haptic.pcmSamples.clear();
+                    haptic.pcmPosition = 0;
+                    if (vibration->amplitude > 0) {
+                        // General recommendation is 20ms for short pulses.
+                        haptic.duration =
+                            vibration->duration == XR_MIN_HAPTIC_DURATION ? 20'000'000 : vibration->duration;
+                    } else {
+                        // OpenComposite seems to pass an amplitude of 0 sometimes. Assume this means stopping.
+                        haptic.duration = 0;
+                    }
+                    break;
+                }
+
+                entry = reinterpret_cast<const XrHapticBaseHeader*>(entry->next);
             }
         }
 
+        if (pcm) {
+            *pcm->samplesConsumed = samplesConsumed.value_or(0);
+        }
+
+        // The haptics thread starts playing right away.
+        SetEvent(m_hapticsWakeEvent.get());
+
         return XR_SUCCESS;
     }
 
@@ -1359,7 +1148,7 @@ namespace pimax_openxr {
         }
 
         if (hapticActionInfo->subactionPath != XR_NULL_PATH) {
-            if (m_strings.find(hapticActionInfo->subactionPath) == m_strings.cend()) {
+            if (!m_strings.getString(hapticActionInfo->subactionPath)) {
                 return XR_ERROR_PATH_INVALID;
             }
             if (!xrAction.subactionPaths.count(hapticActionInfo->subactionPath)) {
@@ -1380,10 +1169,15 @@ namespace pimax_openxr {
             // We only support hands paths, not gamepad etc.
             const int side = getActionSide(fullPath);
             if (isOutput && side >= 0) {
+                std::unique_lock hapticsLock(m_hapticsMutex);
+
                 m_currentVibration[side].amplitude = 0.f;
                 m_currentVibration[side].duration = 0;
+                m_currentVibration[side].pcmSamples.clear();
+                m_currentVibration[side].pcmPosition = 0;
             }
         }
+        SetEvent(m_hapticsWakeEvent.get());
 
         // We do this at the very end to avoid any haptics to continue infinitely.
         if (m_sessionState != XR_SESSION_STATE_FOCUSED) {
@@ -1393,6 +1187,60 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrGetDeviceSampleRateFB
+    XrResult OpenXrRuntime::xrGetDeviceSampleRateFB(XrSession session,
+                                                    const XrHapticActionInfo* hapticActionInfo,
+                                                    XrDevicePcmSampleRateGetInfoFB* deviceSampleRate) {
+        if (hapticActionInfo->type != XR_TYPE_HAPTIC_ACTION_INFO ||
+            deviceSampleRate->type != XR_TYPE_DEVICE_PCM_SAMPLE_RATE_STATE_FB) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrGetDeviceSampleRateFB",
+                          TLXArg(session, "Session"),
+                          TLXArg(hapticActionInfo->action, "Action"),
+                          TLArg(getXrPath(hapticActionInfo->subactionPath).c_str(), "SubactionPath"));
+
+        if (!has_XR_FB_haptic_pcm) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        std::unique_lock lock(m_actionsAndSpacesMutex);
+
+        if (!m_actions.count(hapticActionInfo->action)) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        Action& xrAction = *(Action*)hapticActionInfo->action;
+
+        if (xrAction.type != XR_ACTION_TYPE_VIBRATION_OUTPUT) {
+            return XR_ERROR_ACTION_TYPE_MISMATCH;
+        }
+
+        if (hapticActionInfo->subactionPath != XR_NULL_PATH) {
+            if (!m_strings.getString(hapticActionInfo->subactionPath)) {
+                return XR_ERROR_PATH_INVALID;
+            }
+            if (!xrAction.subactionPaths.count(hapticActionInfo->subactionPath)) {
+                return XR_ERROR_PATH_UNSUPPORTED;
+            }
+        }
+
+        // PVR only supports pulses of a given amplitude. We play the envelope of the samples at the rate of the
+        // haptics thread, which is therefore the rate of the device.
+        deviceSampleRate->sampleRate = 1e6f / m_hapticsPeriod.count();
+
+        TraceLoggingWrite(
+            g_traceProvider, "xrGetDeviceSampleRateFB", TLArg(deviceSampleRate->sampleRate, "SampleRate"));
+
+        return XR_SUCCESS;
+    }
+
     // Update all actions with the appropriate bindings for the controller.
     void OpenXrRuntime::rebindControllerActions(int side) {
         std::string preferredInteractionProfile;
@@ -1585,35 +1433,419 @@ namespace pimax_openxr {
         m_currentInteractionProfileDirty =
             m_currentInteractionProfileDirty ||
             (m_currentInteractionProfile[side] != prevInterationProfile && !m_activeActionSets.empty());
+
+        resolveActionSpaceBindings();
+    }
+
+    // Query the type of each controller, and flag the sides whose controller appeared, disappeared or changed.
+    void OpenXrRuntime::pollControllerTypes() {
+        for (uint32_t side = 0; side < xr::Side::Count; side++) {
+            const pvrTrackedDeviceType device =
+                side == 0 ? pvrTrackedDevice_LeftController : pvrTrackedDevice_RightController;
+
+            std::string controllerType;
+            const int size = pvr_getTrackedDeviceStringProperty(
+                m_pvrSession, device, pvrTrackedDeviceProp_ControllerType_String, nullptr, 0);
+            if (size > 0) {
+                controllerType.resize(size, 0);
+                pvr_getTrackedDeviceStringProperty(m_pvrSession,
+                                                   device,
+                                                   pvrTrackedDeviceProp_ControllerType_String,
+                                                   controllerType.data(),
+                                                   (int)controllerType.size() + 1);
+                // Remove trailing 0.
+                controllerType.resize(size - 1, 0);
+            }
+
+            std::unique_lock lock(m_controllerWatcherMutex);
+
+            if ((size > 0) != m_isWatchedControllerPresent[side] || controllerType != m_watchedControllerType[side]) {
+                TraceLoggingWrite(g_traceProvider,
+                                  "ControllerWatcher",
+                                  TLArg(side == 0 ? "Left" : "Right", "Side"),
+                                  TLArg(size > 0, "Present"),
+                                  TLArg(controllerType.c_str(), "Type"));
+
+                m_isWatchedControllerPresent[side] = size > 0;
+                m_watchedControllerType[side] = controllerType;
+                m_controllerStateChanged[side] = true;
+            }
+        }
+    }
+
+    void OpenXrRuntime::startControllerWatcher() {
+        {
+            std::unique_lock lock(m_controllerWatcherMutex);
+
+            m_terminateControllerWatcher = false;
+            m_isWatchedControllerPresent[xr::Side::Left] = m_isWatchedControllerPresent[xr::Side::Right] = false;
+            m_watchedControllerType[xr::Side::Left].clear();
+            m_watchedControllerType[xr::Side::Right].clear();
+        }
+        m_controllerStateChanged[xr::Side::Left] = m_controllerStateChanged[xr::Side::Right] = true;
+
+        // Do the first query synchronously, so that the first xrSyncActions() sees the controllers.
+        pollControllerTypes();
+
+        m_controllerWatcherThread = std::thread([&]() {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ControllerWatcherThread");
+
+            while (true) {
+                {
+                    std::unique_lock lock(m_controllerWatcherMutex);
+
+                    m_controllerWatcherCondVar.wait_for(
+                        lock, k_controllerWatcherPeriod, [&] { return m_terminateControllerWatcher; });
+                    if (m_terminateControllerWatcher) {
+                        break;
+                    }
+                }
+
+                pollControllerTypes();
+            }
+
+            TraceLoggingWriteStop(local, "ControllerWatcherThread");
+        });
+    }
+
+    void OpenXrRuntime::stopControllerWatcher() {
+        if (!m_controllerWatcherThread.joinable()) {
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_controllerWatcherMutex);
+
+            m_terminateControllerWatcher = true;
+            m_controllerWatcherCondVar.notify_all();
+        }
+        m_controllerWatcherThread.join();
+        m_controllerWatcherThread = {};
+    }
+
+    void OpenXrRuntime::startHapticsThread() {
+        const int hapticsPeriodUs = std::clamp(getSetting("haptics_period_us").value_or(4000), 500, 20000);
+        m_hapticsPeriod = std::chrono::microseconds(hapticsPeriodUs);
+        *m_hapticsWakeEvent.put() = CreateEventEx(nullptr, L"Haptics Wake", 0, EVENT_ALL_ACCESS);
+        {
+            std::unique_lock lock(m_hapticsMutex);
+
+            m_terminateHapticsThread = false;
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                m_currentVibration[side] = {};
+            }
+        }
+
+        m_hapticsThread = std::thread([&]() { hapticsThread(); });
+    }
+
+    void OpenXrRuntime::stopHapticsThread() {
+        if (!m_hapticsThread.joinable()) {
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_hapticsMutex);
+
+            m_terminateHapticsThread = true;
+        }
+        SetEvent(m_hapticsWakeEvent.get());
+        m_hapticsThread.join();
+        m_hapticsThread = {};
+        m_hapticsWakeEvent.reset();
+    }
+
+    // Drive the PVR haptics on a high-resolution timer, so that their timing does not depend on the frame rate of the
+    // application. The thread sleeps until woken up whenever no haptics are playing.
+    void OpenXrRuntime::hapticsThread() {
+        TraceLocalActivity(local);
+        TraceLoggingWriteStart(local, "HapticsThread", TLArg(m_hapticsPeriod.count(), "PeriodUs"));
+
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+        wil::unique_handle timer(
+            CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+        if (!timer) {
+            // High-resolution timers require Windows 10 version 1803.
+            timer.reset(CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS));
+        }
+
+        bool hadError[xr::Side::Count]{};
+        while (true) {
+            float amplitudes[xr::Side::Count];
+            bool needUpdate[xr::Side::Count]{};
+            bool isPlaying = false;
+            {
+                std::unique_lock lock(m_hapticsMutex);
+
+                if (m_terminateHapticsThread) {
+                    break;
+                }
+
+                const auto now = std::chrono::high_resolution_clock::now();
+                for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                    Haptic& haptic = m_currentVibration[side];
+                    amplitudes[side] = getHapticAmplitude(haptic, now);
+
+                    // Re-assert the pulse while playing, and stop it once when done.
+                    needUpdate[side] = amplitudes[side] > 0 || haptic.isActive;
+                    haptic.isActive = amplitudes[side] > 0;
+                    isPlaying = isPlaying || haptic.isActive;
+                }
+            }
+
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                if (needUpdate[side]) {
+                    // Errors cannot be propagated from this thread. Keep going, the next pulse might succeed, and
+                    // only log the first failure in a row.
+                    const auto result = pvr_triggerHapticPulse(m_pvrSession,
+                                                               side == 0 ? pvrTrackedDevice_LeftController
+                                                                         : pvrTrackedDevice_RightController,
+                                                               amplitudes[side]);
+                    if (result != pvr_success && !hadError[side]) {
+                        ErrorLog("pvr_triggerHapticPulse() failed with code: %s\n", xr::ToString(result).c_str());
+                    }
+                    hadError[side] = result != pvr_success;
+                }
+            }
+
+            if (isPlaying) {
+                // Relative due time, in 100ns units.
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -(LONGLONG)m_hapticsPeriod.count() * 10;
+                SetWaitableTimer(timer.get(), &dueTime, 0, nullptr, nullptr, FALSE);
+                const HANDLE handles[] = {m_hapticsWakeEvent.get(), timer.get()};
+                WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, INFINITE);
+            } else {
+                WaitForSingleObject(m_hapticsWakeEvent.get(), INFINITE);
+            }
+        }
+
+        TraceLoggingWriteStop(local, "HapticsThread");
+    }
+
+    void OpenXrRuntime::startInputSampler() {
+        m_newInputSamples.reserve(k_inputSamplesCount);
+        m_inputSamples.clear();
+        m_lastInputSample = {};
+        m_lastLatchedInputState = {};
+        std::fill_n(m_inputChangeTime, xr::Side::Count, InputChangeTime{});
+
+        if (!getSetting("input_sampler").value_or(false)) {
+            return;
+        }
+
+        // Without high-resolution timers (before Windows 10 version 1803), the timer cannot wait less than 1ms.
+        const bool hasHighResolutionTimer =
+            wil::unique_handle(CreateWaitableTimerExW(
+                                   nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS))
+                .is_valid();
+        const int rate =
+            std::clamp(getSetting("input_sampler_rate").value_or(500), 100, hasHighResolutionTimer ? 2000 : 1000);
+        m_inputSamplerPeriod = std::chrono::microseconds(1'000'000 / rate);
+        m_terminateInputSampler = false;
+
+        m_inputSamplerThread = std::thread([&]() { inputSamplerThread(); });
+    }
+
+    void OpenXrRuntime::stopInputSampler() {
+        if (!m_inputSamplerThread.joinable()) {
+            return;
+        }
+
+        m_terminateInputSampler = true;
+        m_inputSamplerThread.join();
+        m_inputSamplerThread = {};
     }
 
-    std::string OpenXrRuntime::getXrPath(XrPath path) const {
+    // Poll the PVR input state into the ring of samples, which xrSyncActions() reads without locking. This keeps the
+    // PVR calls off the thread of the application, and lets us observe the inputs that change between two syncs.
+    void OpenXrRuntime::inputSamplerThread() {
+        TraceLocalActivity(local);
+        TraceLoggingWriteStart(local, "InputSamplerThread", TLArg(m_inputSamplerPeriod.count(), "PeriodUs"));
+
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+
+        wil::unique_handle timer(
+            CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+        if (!timer) {
+            // High-resolution timers require Windows 10 version 1803.
+            timer.reset(CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS));
+        }
+
+        pvrInputState lastRawSample{};
+        double lastSampleTime = 0;
+        while (!m_terminateInputSampler) {
+            const auto sampleStart = std::chrono::high_resolution_clock::now();
+
+            pvrInputState sample;
+            if (pvr_getInputState(m_pvrSession, &sample) == pvr_success) {
+                // Only publish new samples, so that the ring covers as much time as possible.
+                if (memcmp(&sample, &lastRawSample, sizeof(sample))) {
+                    lastRawSample = sample;
+
+                    // The samples must be strictly ordered in time for xrSyncActions() to find the new ones.
+                    if (sample.TimeInSeconds <= lastSampleTime) {
+                        sample.TimeInSeconds = std::max(pvr_getTimeSeconds(m_pvr), lastSampleTime + 1e-6);
+                    }
+                    m_inputSamples.push(sample);
+                    lastSampleTime = sample.TimeInSeconds;
+                }
+            }
+
+            // The period of a periodic timer is in milliseconds, so re-arm a one-shot timer instead, accounting for
+            // the time spent polling. Relative due time, in 100ns units.
+            const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                m_inputSamplerPeriod - (std::chrono::high_resolution_clock::now() - sampleStart));
+            if (remaining.count() > 0) {
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -(LONGLONG)remaining.count() * 10;
+                SetWaitableTimer(timer.get(), &dueTime, 0, nullptr, nullptr, FALSE);
+                WaitForSingleObject(timer.get(), INFINITE);
+            }
+        }
+
+        TraceLoggingWriteStop(local, "InputSamplerThread");
+    }
+
+    // Latch the newest input state, either from the input sampler or directly from PVR. When the sampler is running,
+    // we also look at the samples since the last sync: the time of the first change is reported as the time of the
+    // change, and buttons that were pressed then released in between are reported as pressed for one sync.
+    void OpenXrRuntime::latchInputState() {
+        // Samples are collected from the newest to the oldest.
+        m_newInputSamples.clear();
+        if (m_inputSamplerThread.joinable()) {
+            m_inputSamples.forEachNewest([&](const pvrInputState& sample) {
+                if (sample.TimeInSeconds <= m_lastInputSample.TimeInSeconds ||
+                    m_newInputSamples.size() == k_inputSamplesCount) {
+                    return false;
+                }
+                m_newInputSamples.push_back(sample);
+                return true;
+            });
+
+            // No new sample means the inputs did not change since the last sync.
+            if (m_newInputSamples.empty() && m_lastInputSample.TimeInSeconds > 0) {
+                m_newInputSamples.push_back(m_lastInputSample);
+            }
+        }
+        if (m_newInputSamples.empty()) {
+            pvrInputState inputState;
+            CHECK_PVRCMD(pvr_getInputState(m_pvrSession, &inputState));
+            m_newInputSamples.push_back(inputState);
+        }
+
+        const pvrInputState& newest = m_newInputSamples.front();
+        const pvrInputState& previous = m_lastLatchedInputState;
+        pvrInputState latched = newest;
+        for (uint32_t side = 0; side < xr::Side::Count; side++) {
+            InputChangeTime& changeTime = m_inputChangeTime[side];
+            changeTime = {};
+
+            uint32_t pressed = 0;
+            uint32_t touched = 0;
+            uint32_t changedButtons = 0;
+            uint32_t changedTouches = 0;
+            for (auto it = m_newInputSamples.crbegin(); it != m_newInputSamples.crend(); it++) {
+                pressed |= it->HandButtons[side];
+                touched |= it->HandTouches[side];
+
+                // Record the first sample where each input differs from the last latched state.
+                const XrTime time = pvrTimeToXrTime(it->TimeInSeconds);
+                const auto latchChange = [&](XrTime& inputTime, bool changed) {
+                    if (!inputTime && changed) {
+                        inputTime = time;
+                    }
+                };
+                const uint32_t newButtons = (it->HandButtons[side] ^ previous.HandButtons[side]) & ~changedButtons;
+                const uint32_t newTouches = (it->HandTouches[side] ^ previous.HandTouches[side]) & ~changedTouches;
+                for (uint32_t bit = 0; bit < 32; bit++) {
+                    latchChange(changeTime.buttons[bit], newButtons & (1u << bit));
+                    latchChange(changeTime.touches[bit], newTouches & (1u << bit));
+                }
+                changedButtons |= newButtons;
+                changedTouches |= newTouches;
+                latchChange(changeTime.trigger, it->Trigger[side] != previous.Trigger[side]);
+                latchChange(changeTime.grip, it->Grip[side] != previous.Grip[side]);
+                latchChange(changeTime.gripForce, it->GripForce[side] != previous.GripForce[side]);
+                latchChange(changeTime.joystick,
+                            it->JoyStick[side].x != previous.JoyStick[side].x ||
+                                it->JoyStick[side].y != previous.JoyStick[side].y);
+                latchChange(changeTime.touchPad,
+                            it->TouchPad[side].x != previous.TouchPad[side].x ||
+                                it->TouchPad[side].y != previous.TouchPad[side].y);
+                latchChange(changeTime.touchPadForce, it->TouchPadForce[side] != previous.TouchPadForce[side]);
+            }
+
+            latched.HandButtons[side] |= pressed & ~m_lastLatchedInputState.HandButtons[side];
+            latched.HandTouches[side] |= touched & ~m_lastLatchedInputState.HandTouches[side];
+        }
+
+        m_lastInputSample = newest;
+        m_lastLatchedInputState = latched;
+        m_cachedInputState = latched;
+    }
+
+    // Advance the haptic of one side to the current time, and return the amplitude to play.
+    float OpenXrRuntime::getHapticAmplitude(Haptic& haptic, std::chrono::high_resolution_clock::time_point now) {
+        if (haptic.pcmPosition < haptic.pcmSamples.size()) {
+            const double elapsed = std::chrono::duration<double>(now - haptic.pcmStartTime).count();
+            const size_t end = std::min((size_t)(elapsed * haptic.pcmSampleRate) + 1, haptic.pcmSamples.size());
+
+            // PVR cannot play a waveform, so we play its envelope: the peak of the samples since the last update.
+            float amplitude = 0.f;
+            for (size_t i = haptic.pcmPosition; i < end; i++) {
+                amplitude = std::max(amplitude, std::abs(haptic.pcmSamples[i]));
+            }
+            haptic.pcmPosition = end;
+            if (haptic.pcmPosition >= haptic.pcmSamples.size()) {
+                haptic.pcmSamples.clear();
+                haptic.pcmPosition = 0;
+            }
+
+            return std::min(amplitude, 1.f);
+        }
+
+        if (haptic.duration > 0) {
+            const bool isExpired = (now - haptic.startTime).count() >= haptic.duration;
+            if (isExpired) {
+                haptic.amplitude = 0.f;
+                haptic.duration = 0;
+            }
+            return haptic.amplitude;
+        }
+
+        return 0.f;
+    }
+
+    const std::string& OpenXrRuntime::getXrPath(XrPath path) const {
+        static const std::string empty;
+        static const std::string unknown = "<unknown>";
+
         if (path == XR_NULL_PATH) {
-            return "";
+            return empty;
         }
 
-        const auto it = m_strings.find(path);
-        if (it == m_strings.cend()) {
-            return "<unknown>";
+        const std::string* const entry = m_strings.getString(path);
+        if (!entry) {
+            return unknown;
         }
 
-        return it->second;
+        return *entry;
     }
 
     XrPath OpenXrRuntime::stringToPath(const std::string& path, bool validate) {
-        for (auto entry : m_strings) {
-            if (entry.second == path) {
-                return entry.first;
-            }
+        const XrPath existing = (XrPath)m_strings.getId(path);
+        if (existing != XR_NULL_PATH) {
+            return existing;
         }
 
         if (path.length() >= XR_MAX_PATH_LENGTH || !validatePath(path)) {
             return XR_NULL_PATH;
         }
 
-        m_stringIndex++;
-        m_strings.insert_or_assign(m_stringIndex, path);
-        return (XrPath)m_stringIndex;
+        return (XrPath)m_strings.intern(path);
     }
 
     int OpenXrRuntime::getActionSide(const std::string& fullPath, bool allowExtraPaths) const {
@@ -1643,6 +1875,271 @@ namespace pimax_openxr {
         return {normalizedInput.x * scaling, normalizedInput.y * scaling};
     }
 
+    // Find the time at which the input of an action source changed, or 0 if it did not change before the newest sample.
+    XrTime OpenXrRuntime::getInputChangeTime(const ActionSet& xrActionSet, const ActionSource& source, int side) {
+        const pvrInputState& state = xrActionSet.cachedInputState;
+        const InputChangeTime& changeTime = xrActionSet.inputChangeTime[side];
+
+        XrTime time = 0;
+        if (source.buttonMap) {
+            const XrTime* bitTimes = source.buttonMap == state.HandTouches ? changeTime.touches : changeTime.buttons;
+            for (uint32_t bit = 0; bit < 32; bit++) {
+                if (source.buttonType & (1u << bit)) {
+                    time = std::max(time, bitTimes[bit]);
+                }
+            }
+        } else if (source.floatValue) {
+            time = source.floatValue == state.Trigger     ? changeTime.trigger
+                   : source.floatValue == state.Grip      ? changeTime.grip
+                   : source.floatValue == state.GripForce ? changeTime.gripForce
+                                                          : changeTime.touchPadForce;
+        } else if (source.vector2fValue) {
+            time = source.vector2fValue == state.JoyStick ? changeTime.joystick : changeTime.touchPad;
+        }
+        return time;
+    }
+
+    // Combine the values of all the action sources matching the subaction path of the state. This is only invoked from
+    // xrSyncActions() so that the xrGetActionState*() functions do not need to look at the action sources.
+    void OpenXrRuntime::computeActionState(const Action& xrAction,
+                                           ActionState& state,
+                                           const ActionState* previousState) const {
+        std::optional<bool> combinedBool;
+        std::optional<float> combinedFloat;
+        std::optional<XrVector2f> combinedVector2f;
+        bool isPoseActive = false;
+        XrTime changeTime = 0;
+
+        const ActionSet& xrActionSet = *(ActionSet*)xrAction.actionSet;
+
+        const std::string& subActionPath = getXrPath(state.subactionPath);
+        for (const auto& source : xrAction.actionSources) {
+            if (!startsWith(source.first, subActionPath)) {
+                continue;
+            }
+
+            const std::string& fullPath = source.first;
+            const auto& value = source.second;
+
+            // We only support hands paths and eye tracker, not gamepad etc.
+            const int side = getActionSide(fullPath);
+            if (xrAction.type == XR_ACTION_TYPE_POSE_INPUT) {
+                if (!isActionEyeTracker(fullPath)) {
+                    if (side >= 0) {
+                        isPoseActive = m_isControllerActive[side];
+
+                        // Per spec we must consistently pick one source. We pick the first one.
+                        break;
+                    }
+                } else {
+                    isPoseActive = m_isEyeTrackingAvailable;
+
+                    // Per spec we must consistently pick one source. We pick the first one.
+                    break;
+                }
+            }
+
+            if (side < 0 || !m_isControllerActive[side]) {
+                continue;
+            }
+
+            changeTime = std::max(changeTime, getInputChangeTime(xrActionSet, value, side));
+
+            if (xrAction.type == XR_ACTION_TYPE_BOOLEAN_INPUT) {
+                // Per spec, the combined state is the OR of all values.
+                if (value.buttonMap) {
+                    combinedBool = combinedBool.value_or(false) || value.buttonMap[side] & value.buttonType;
+                } else if (value.floatValue) {
+                    combinedBool = combinedBool.value_or(false) || value.floatValue[side] > 0.95f;
+                }
+            } else if (xrAction.type == XR_ACTION_TYPE_FLOAT_INPUT) {
+                // Per spec, the combined state is the absolute maximum of all values.
+                if (value.floatValue) {
+                    combinedFloat = std::max(combinedFloat.value_or(-std::numeric_limits<float>::infinity()),
+                                             value.floatValue[side]);
+                } else if (value.buttonMap) {
+                    combinedFloat = std::max(combinedFloat.value_or(-std::numeric_limits<float>::infinity()),
+                                             value.buttonMap[side] & value.buttonType ? 1.f : 0.f);
+                } else if (value.vector2fValue && value.vector2fIndex >= 0) {
+                    const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
+
+                    combinedFloat = std::max(combinedFloat.value_or(-std::numeric_limits<float>::infinity()),
+                                             value.vector2fIndex == 0 ? vector2fValue.x : vector2fValue.y);
+                }
+            } else if (xrAction.type == XR_ACTION_TYPE_VECTOR2F_INPUT) {
+                if (value.vector2fValue) {
+                    const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
+
+                    // Per spec, the combined state if the one of the vector with the longest length.
+                    const float l1 = combinedVector2f ? sqrt(combinedVector2f.value().x * combinedVector2f.value().x +
+                                                             combinedVector2f.value().y * combinedVector2f.value().y)
+                                                      : 0.f;
+                    const float l2 = sqrt(vector2fValue.x * vector2fValue.x + vector2fValue.y * vector2fValue.y);
+                    if (l2 >= l1) {
+                        combinedVector2f = vector2fValue;
+                    }
+                }
+            }
+        }
+
+        const XrTime syncTime = pvrTimeToXrTime(xrActionSet.cachedInputState.TimeInSeconds);
+        const ActionState previous = previousState ? *previousState : ActionState{};
+
+        switch (xrAction.type) {
+        case XR_ACTION_TYPE_BOOLEAN_INPUT:
+            state.isActive = combinedBool.has_value();
+            state.boolValue = combinedBool.value_or(false);
+            state.changedSinceLastSync = state.isActive && state.boolValue != previous.boolValue;
+            break;
+
+        case XR_ACTION_TYPE_FLOAT_INPUT:
+            state.isActive = combinedFloat.has_value();
+            state.floatValue = combinedFloat.value_or(0.f);
+            state.changedSinceLastSync = state.isActive && state.floatValue != previous.floatValue;
+            break;
+
+        case XR_ACTION_TYPE_VECTOR2F_INPUT:
+            state.isActive = combinedVector2f.has_value();
+            state.vector2fValue = combinedVector2f.value_or(XrVector2f{0.f, 0.f});
+            state.changedSinceLastSync =
+                state.isActive && (state.vector2fValue.x != previous.vector2fValue.x ||
+                                   state.vector2fValue.y != previous.vector2fValue.y);
+            break;
+
+        case XR_ACTION_TYPE_POSE_INPUT:
+            state.isActive = isPoseActive;
+            break;
+
+        default:
+            break;
+        }
+
+        if (xrAction.type != XR_ACTION_TYPE_POSE_INPUT) {
+            state.lastChangeTime = !state.isActive             ? 0
+                                   : state.changedSinceLastSync ? (changeTime ? changeTime : syncTime)
+                                                                : previous.lastChangeTime;
+        }
+    }
+
+    // Build a new snapshot of the state of all attached actions and make it visible to the xrGetActionState*()
+    // functions. Must be invoked with the actions and spaces mutex held.
+    void OpenXrRuntime::publishActionStateSnapshot(const XrActionsSyncInfo& syncInfo) {
+        const auto previousSnapshot = std::atomic_load(&m_actionStateSnapshot);
+        auto snapshot = std::make_shared<ActionStateSnapshot>();
+
+        std::set<XrActionSet> syncedActionSets;
+        for (uint32_t i = 0; i < syncInfo.countActiveActionSets; i++) {
+            syncedActionSets.insert(syncInfo.activeActionSets[i].actionSet);
+        }
+
+        for (const auto& action : m_actions) {
+            const Action& xrAction = *(Action*)action;
+            if (!m_activeActionSets.count(xrAction.actionSet)) {
+                continue;
+            }
+
+            const ActionStateSnapshot::Entry* previousEntry = nullptr;
+            if (previousSnapshot) {
+                const auto it = previousSnapshot->actions.find(action);
+                if (it != previousSnapshot->actions.cend()) {
+                    previousEntry = &it->second;
+                }
+            }
+
+            // Actions from action sets that were not synced keep their state.
+            if (previousEntry && !syncedActionSets.count(xrAction.actionSet)) {
+                snapshot->actions.emplace(action, *previousEntry);
+                continue;
+            }
+
+            ActionStateSnapshot::Entry& entry = snapshot->actions[action];
+            entry.type = xrAction.type;
+
+            const auto addState = [&](XrPath subactionPath) {
+                const ActionState* previousState = nullptr;
+                if (previousEntry) {
+                    for (const auto& state : previousEntry->states) {
+                        if (state.subactionPath == subactionPath) {
+                            previousState = &state;
+                            break;
+                        }
+                    }
+                }
+
+                ActionState& state = entry.states.emplace_back();
+                state.subactionPath = subactionPath;
+                computeActionState(xrAction, state, previousState);
+            };
+
+            addState(XR_NULL_PATH);
+            for (const auto& subactionPath : xrAction.subactionPaths) {
+                addState(subactionPath);
+            }
+        }
+
+        std::atomic_store(&m_actionStateSnapshot, std::shared_ptr<const ActionStateSnapshot>(std::move(snapshot)));
+    }
+
+    // Read the state of an action from the last snapshot, without contending with xrSyncActions() or other users of
+    // the actions and spaces mutex. Only when the action is not part of the snapshot do we take the lock, in order to
+    // report the appropriate error.
+    XrResult
+    OpenXrRuntime::getActionState(XrAction action, XrPath subactionPath, XrActionType type, ActionState& state) {
+        const auto snapshot = std::atomic_load(&m_actionStateSnapshot);
+        if (snapshot) {
+            const auto it = snapshot->actions.find(action);
+            if (it != snapshot->actions.cend()) {
+                if (it->second.type != type) {
+                    return XR_ERROR_ACTION_TYPE_MISMATCH;
+                }
+
+                if (subactionPath != XR_NULL_PATH && !m_strings.getString(subactionPath)) {
+                    return XR_ERROR_PATH_INVALID;
+                }
+
+                for (const auto& entry : it->second.states) {
+                    if (entry.subactionPath == subactionPath) {
+                        state = entry;
+                        return XR_SUCCESS;
+                    }
+                }
+
+                return XR_ERROR_PATH_UNSUPPORTED;
+            }
+        }
+
+        std::unique_lock lock(m_actionsAndSpacesMutex);
+
+        if (!m_actions.count(action)) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        const Action& xrAction = *(Action*)action;
+
+        if (xrAction.type != type) {
+            return XR_ERROR_ACTION_TYPE_MISMATCH;
+        }
+
+        if (!m_activeActionSets.count(xrAction.actionSet)) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+
+        if (subactionPath != XR_NULL_PATH) {
+            if (!m_strings.getString(subactionPath)) {
+                return XR_ERROR_PATH_INVALID;
+            }
+            if (!xrAction.subactionPaths.count(subactionPath)) {
+                return XR_ERROR_PATH_UNSUPPORTED;
+            }
+        }
+
+        // The action was never synced.
+        state = {};
+        state.subactionPath = subactionPath;
+
+        return XR_SUCCESS;
+    }
+
     void OpenXrRuntime::handleBuiltinActions(bool wasRecenteringPressed, bool wasSystemPressed) {
         const auto now = pvr_getTimeSeconds(m_pvr);
 
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "utils.h"
+
+// Counts the heap allocations made by one thread, in order to verify that the frame loop is free of them. Instead of
+// replacing the allocator, the heap allocation routine of the process is hooked. The hook forwards every call
+// unchanged. It is only available in debug builds, and once installed it is never removed: other threads of the
+// application may be running inside the hook at any time.
+
+#ifdef _DEBUG
+namespace {
+    using namespace pimax_openxr::utils;
+
+    using RtlAllocateHeap_t = PVOID(NTAPI*)(PVOID heapHandle, ULONG flags, SIZE_T size);
+    RtlAllocateHeap_t g_original_RtlAllocateHeap = nullptr;
+
+    // The hook may run on any thread, including while a thread is being created: it must not access thread-local
+    // storage, and it must not allocate.
+    std::atomic<DWORD> g_countingThreadId{0};
+    std::atomic<uint64_t> g_allocationCount{0};
+
+    PVOID NTAPI hooked_RtlAllocateHeap(PVOID heapHandle, ULONG flags, SIZE_T size) {
+        if (GetCurrentThreadId() == g_countingThreadId.load(std::memory_order_relaxed)) {
+            g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return g_original_RtlAllocateHeap(heapHandle, flags, size);
+    }
+} // namespace
+
+#endif
+
+namespace pimax_openxr::utils {
+
+#ifdef _DEBUG
+    void StartAllocationCounting() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            DetourDllAttach("ntdll.dll", "RtlAllocateHeap", hooked_RtlAllocateHeap, g_original_RtlAllocateHeap);
+        });
+    }
+
+    bool IsAllocationCountingEnabled() {
+        return g_original_RtlAllocateHeap;
+    }
+
+    ScopedAllocationCounter::ScopedAllocationCounter() {
+        g_countingThreadId.store(GetCurrentThreadId(), std::memory_order_relaxed);
+        m_start = g_allocationCount.load(std::memory_order_relaxed);
+    }
+
+    ScopedAllocationCounter::~ScopedAllocationCounter() {
+        g_countingThreadId.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t ScopedAllocationCounter::count() const {
+        return g_allocationCount.load(std::memory_order_relaxed) - m_start;
+    }
+#else
+    void StartAllocationCounting() {
+    }
+
+    bool IsAllocationCountingEnabled() {
+        return false;
+    }
+
+    ScopedAllocationCounter::ScopedAllocationCounter() {
+    }
+
+    ScopedAllocationCounter::~ScopedAllocationCounter() {
+    }
+
+    uint64_t ScopedAllocationCounter::count() const {
+        return 0;
+    }
+#endif
+
+} // namespace pimax_openxr::utils
@@ -40,62 +40,127 @@ struct RuntimeStatus {
     bool useParallelProjection;
     bool useSmartSmoothing;
     float fps;
+
+    // Whether the status was published by a running session.
+    bool isLive;
 };
 
-extern "C" __declspec(dllexport) void WINAPI getRuntimeStatus(RuntimeStatus* status) {
-    pimax_openxr::log::Log("Hello\n");
-
-    pvrEnvHandle pvr;
-    CHECK_PVRCMD(pvr_initialise(&pvr));
-
-    pvrSessionHandle pvrSession;
-    CHECK_PVRCMD(pvr_createSession(pvr, &pvrSession));
-
-    // Ensure there is no stale parallel projection settings.
-    CHECK_PVRCMD(pvr_setIntConfig(pvrSession, "view_rotation_fix", 0));
-
-    pvrDisplayInfo displayInfo{};
-    CHECK_PVRCMD(pvr_getEyeDisplayInfo(pvrSession, pvrEye_Left, &displayInfo));
-
-    pvrEyeRenderInfo eyeInfo[xr::StereoView::Count];
-    CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Left, &eyeInfo[xr::StereoView::Left]));
-    CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Right, &eyeInfo[xr::StereoView::Right]));
-    const auto cantingAngle = PVR::Quatf{eyeInfo[xr::StereoView::Left].HmdToEyePose.Orientation}.Angle(
-                                  eyeInfo[xr::StereoView::Right].HmdToEyePose.Orientation) /
-                              2.f;
-    const auto fov = PVR::RadToDegree(atan(eyeInfo[xr::StereoView::Left].Fov.LeftTan) +
-                                      atan(eyeInfo[xr::StereoView::Right].Fov.RightTan) + cantingAngle * 2.f);
-    const auto useParallelProjection =
-        cantingAngle > 0.0001f &&
-        RegGetDword(HKEY_LOCAL_MACHINE, "SOFTWARE\\PimaxXR", "force_parallel_projection_state")
-            .value_or(!pvr_getIntConfig(pvrSession, "steamvr_use_native_fov", 0));
-
-    if (useParallelProjection) {
-        // Per Pimax, we must set this value for parallel projection to work properly.
-        CHECK_PVRCMD(pvr_setIntConfig(pvrSession, "view_rotation_fix", 1));
-
-        // Update eye info to account for parallel projection.
+namespace {
+
+    // How long the result of a probe is reused for, when no session is running.
+    constexpr auto k_probeCacheDuration = std::chrono::seconds(30);
+
+    std::mutex g_probeCacheMutex;
+    std::optional<RuntimeStatus> g_probeCache;
+    std::chrono::steady_clock::time_point g_probeCacheTime;
+    std::optional<int> g_probeCacheParallelProjectionState;
+
+    // Whether a runtime instance exists in any process, even one that does not publish its status.
+    bool isRuntimeInstanceAlive() {
+        wil::unique_event_nothrow event(OpenEventW(SYNCHRONIZE, FALSE, telemetry::k_runtimeInstanceEventName));
+        return event.is_valid();
+    }
+
+    // Query the status through a temporary PVR session. This is expensive, and would disrupt a running application:
+    // it must only be used when no runtime instance exists.
+    void probeRuntimeStatus(RuntimeStatus* status) {
+        pvrEnvHandle pvr;
+        CHECK_PVRCMD(pvr_initialise(&pvr));
+        auto shutdownPvr = MakeScopeGuard([&] { pvr_shutdown(pvr); });
+
+        pvrSessionHandle pvrSession;
+        CHECK_PVRCMD(pvr_createSession(pvr, &pvrSession));
+        auto destroySession = MakeScopeGuard([&] { pvr_destroySession(pvrSession); });
+
+        // Ensure there is no stale parallel projection settings.
+        CHECK_PVRCMD(pvr_setIntConfig(pvrSession, "view_rotation_fix", 0));
+
+        pvrDisplayInfo displayInfo{};
+        CHECK_PVRCMD(pvr_getEyeDisplayInfo(pvrSession, pvrEye_Left, &displayInfo));
+
+        pvrEyeRenderInfo eyeInfo[xr::StereoView::Count];
         CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Left, &eyeInfo[xr::StereoView::Left]));
         CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Right, &eyeInfo[xr::StereoView::Right]));
+        const auto cantingAngle = PVR::Quatf{eyeInfo[xr::StereoView::Left].HmdToEyePose.Orientation}.Angle(
+                                      eyeInfo[xr::StereoView::Right].HmdToEyePose.Orientation) /
+                                  2.f;
+        const auto fov = PVR::RadToDegree(atan(eyeInfo[xr::StereoView::Left].Fov.LeftTan) +
+                                          atan(eyeInfo[xr::StereoView::Right].Fov.RightTan) + cantingAngle * 2.f);
+        const auto useParallelProjection =
+            cantingAngle > 0.0001f &&
+            RegGetDword(HKEY_LOCAL_MACHINE, "SOFTWARE\\PimaxXR", "force_parallel_projection_state")
+                .value_or(!pvr_getIntConfig(pvrSession, "steamvr_use_native_fov", 0));
+
+        if (useParallelProjection) {
+            // Per Pimax, we must set this value for parallel projection to work properly.
+            CHECK_PVRCMD(pvr_setIntConfig(pvrSession, "view_rotation_fix", 1));
+
+            // Update eye info to account for parallel projection.
+            CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Left, &eyeInfo[xr::StereoView::Left]));
+            CHECK_PVRCMD(pvr_getEyeRenderInfo(pvrSession, pvrEye_Right, &eyeInfo[xr::StereoView::Right]));
+        }
+
+        const pvrFovPort fovForResolution = eyeInfo[xr::StereoView::Left].Fov;
+
+        pvrSizei viewportSize;
+        CHECK_PVRCMD(pvr_getFovTextureSize(pvrSession, pvrEye_Left, fovForResolution, 1.f, &viewportSize));
+
+        status->refreshRate = displayInfo.refresh_rate;
+        status->resolutionWidth = viewportSize.w;
+        status->resolutionHeight = viewportSize.h;
+        status->fovLevel = pvr_getIntConfig(pvrSession, "fov_level", 1);
+        status->fov = fov;
+        status->floorHeight = pvr_getFloatConfig(pvrSession, CONFIG_KEY_EYE_HEIGHT, 0.f);
+        status->useParallelProjection = useParallelProjection;
+        status->useSmartSmoothing = pvr_getIntConfig(pvrSession, "dbg_asw_enable", 0);
+        status->fps = pvr_getFloatConfig(pvrSession, "client_fps", 0);
+
+        status->valid = true;
+        status->isLive = false;
     }
 
-    const pvrFovPort fovForResolution = eyeInfo[xr::StereoView::Left].Fov;
-
-    pvrSizei viewportSize;
-    CHECK_PVRCMD(pvr_getFovTextureSize(pvrSession, pvrEye_Left, fovForResolution, 1.f, &viewportSize));
+} // namespace
 
-    status->refreshRate = displayInfo.refresh_rate;
-    status->resolutionWidth = viewportSize.w;
-    status->resolutionHeight = viewportSize.h;
-    status->fovLevel = pvr_getIntConfig(pvrSession, "fov_level", 1);
-    status->fov = fov;
-    status->floorHeight = pvr_getFloatConfig(pvrSession, CONFIG_KEY_EYE_HEIGHT, 0.f);
-    status->useParallelProjection = useParallelProjection;
-    status->useSmartSmoothing = pvr_getIntConfig(pvrSession, "dbg_asw_enable", 0);
-    status->fps = pvr_getFloatConfig(pvrSession, "client_fps", 0);
+extern "C" __declspec(dllexport) void WINAPI getRuntimeStatus(RuntimeStatus* status) {
+    // A running session publishes its status, which we can read without disrupting it.
+    telemetry::RuntimeStatus liveStatus{};
+    if (TelemetryPublisher::readStatus(liveStatus)) {
+        status->refreshRate = liveStatus.refreshRate;
+        status->resolutionWidth = liveStatus.resolutionWidth;
+        status->resolutionHeight = liveStatus.resolutionHeight;
+        status->fovLevel = (uint8_t)liveStatus.fovLevel;
+        status->fov = liveStatus.fov;
+        status->floorHeight = liveStatus.floorHeight;
+        status->useParallelProjection = liveStatus.useParallelProjection;
+        status->useSmartSmoothing = liveStatus.useSmartSmoothing;
+        status->fps = liveStatus.fps;
+        status->isLive = true;
+        status->valid = true;
+        return;
+    }
 
-    status->valid = true;
+    // Never create a PVR session or write the PVR configuration underneath a running application. Report the status
+    // as unknown instead.
+    if (isRuntimeInstanceAlive()) {
+        status->valid = false;
+        status->isLive = true;
+        return;
+    }
 
-    pvr_destroySession(pvrSession);
-    pvr_shutdown(pvr);
+    // Otherwise, reuse the last probe unless it is stale or the parallel projection override has changed.
+    std::unique_lock lock(g_probeCacheMutex);
+    const auto now = std::chrono::steady_clock::now();
+    const auto parallelProjectionState =
+        RegGetDword(HKEY_LOCAL_MACHINE, "SOFTWARE\\PimaxXR", "force_parallel_projection_state");
+    if (!g_probeCache || now - g_probeCacheTime >= k_probeCacheDuration ||
+        g_probeCacheParallelProjectionState != parallelProjectionState) {
+        pimax_openxr::log::Log("Probing runtime status\n");
+
+        RuntimeStatus probedStatus{};
+        probeRuntimeStatus(&probedStatus);
+        g_probeCache = probedStatus;
+        g_probeCacheTime = now;
+        g_probeCacheParallelProjectionState = parallelProjectionState;
+    }
+    *status = g_probeCache.value();
 }
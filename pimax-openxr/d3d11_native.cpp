@@ -27,8 +27,12 @@
 #include "utils.h"
 
 #include "AlphaBlendingCS.h"
+#include "AlphaBlendingSRGBCS.h"
 #include "AlphaBlendingTexArrayCS.h"
+#include "AlphaBlendingTexArraySRGBCS.h"
 #include "FullScreenQuadVS.h"
+#include "ParallelReprojectionPS.h"
+#include "ParallelReprojectionTexArrayPS.h"
 #include "PassthroughPS.h"
 
 // Implements native support to submit swapchains to PVR.
@@ -43,6 +47,19 @@ namespace pimax_openxr {
     struct AlphaBlendingCSConstants {
         alignas(4) bool ignoreAlpha;
         alignas(4) bool isUnpremultipliedAlpha;
+        alignas(4) bool isInPlace;
+    };
+
+    // Constant buffer offsets must be a multiple of 16 constants (256 bytes).
+    constexpr size_t k_precompositionConstantsStride = 256;
+
+    struct ParallelReprojectionPSConstants {
+        XrVector4f cantedToParallel[3];
+        XrVector4f destinationTan;
+        XrVector4f sourceTan;
+        XrVector4f sourceRect;
+        alignas(4) bool ignoreAlpha;
+        alignas(4) bool isUnpremultipliedAlpha;
     };
 
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetD3D11GraphicsRequirementsKHR
@@ -70,6 +87,11 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
+        // The adapter LUID is not stable across reboots, so it cannot come from the cached system.
+        if (!ensureLiveSystem()) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+
         memcpy(&graphicsRequirements->adapterLuid, &m_adapterLuid, sizeof(LUID));
         graphicsRequirements->minFeatureLevel = D3D_FEATURE_LEVEL_11_0;
 
@@ -119,6 +141,9 @@ namespace pimax_openxr {
             m_pvrSubmissionDevice = m_d3d11Device;
             m_pvrSubmissionContext = m_d3d11Context;
 
+            // The priority of the application's device belongs to the application.
+            m_useHighPrioritySubmission = false;
+
             UINT creationFlags = 0;
             if (m_pvrSubmissionDevice->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED) {
                 creationFlags |= D3D11_1_CREATE_DEVICE_CONTEXT_STATE_SINGLETHREADED;
@@ -146,12 +171,11 @@ namespace pimax_openxr {
         CHECK_HRCMD(m_pvrSubmissionFence->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, fenceHandle.put()));
         CHECK_HRCMD(
             m_d3d11Device->OpenSharedFence(fenceHandle.get(), IID_PPV_ARGS(m_d3d11Fence.ReleaseAndGetAddressOf())));
-        *m_eventForSubmissionFence.put() = CreateEventEx(nullptr, L"Submission Fence", 0, EVENT_ALL_ACCESS);
 
         // Frame timers.
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i] = std::make_unique<D3D11GpuTimer>(m_d3d11Device.Get(), m_d3d11Context.Get());
-        }
+        m_gpuTimestampsApp = std::make_unique<D3D11TimestampPool>(
+            m_d3d11Device.Get(), m_d3d11Context.Get(), k_maxGpuTimersPerPool, k_gpuTimersLatency);
+        m_gpuTimerApp = std::make_unique<GpuTimer>(*m_gpuTimestampsApp);
 
         return XR_SUCCESS;
     }
@@ -204,6 +228,25 @@ namespace pimax_openxr {
         CHECK_HRCMD(device->QueryInterface(m_pvrSubmissionDevice.ReleaseAndGetAddressOf()));
         CHECK_HRCMD(deviceContext->QueryInterface(m_pvrSubmissionContext.ReleaseAndGetAddressOf()));
 
+        // Let the precomposition preempt the application's GPU work, so that the frame reaches PVR before the
+        // compositor deadline even when the application saturates the GPU.
+        m_useHighPrioritySubmission = getSetting("high_priority_submission").value_or(false);
+        if (m_useHighPrioritySubmission) {
+            ComPtr<IDXGIDevice> dxgiDevice;
+            CHECK_HRCMD(device.As(&dxgiDevice));
+            const HRESULT hr = dxgiDevice->SetGPUThreadPriority(7);
+            if (FAILED(hr)) {
+                // Raising the priority may require privileges that the application does not have.
+                ErrorLog("Failed to raise the GPU priority of the submission device: %X\n", hr);
+            }
+            INT priority = 0;
+            dxgiDevice->GetGPUThreadPriority(&priority);
+            TraceLoggingWrite(g_traceProvider,
+                              "xrCreateSession",
+                              TLArg(m_useHighPrioritySubmission, "HighPrioritySubmission"),
+                              TLArg(priority, "GPUThreadPriority"));
+        }
+
         initializeSubmissionResources();
     }
 
@@ -211,7 +254,7 @@ namespace pimax_openxr {
         // Create the synchronization fence to serialize work between the application device and submission device.
         CHECK_HRCMD(m_pvrSubmissionDevice->CreateFence(
             0, D3D11_FENCE_FLAG_SHARED, IID_PPV_ARGS(m_pvrSubmissionFence.ReleaseAndGetAddressOf())));
-        m_fenceValue = 0;
+        m_fenceValue = m_frameFenceValue = 0;
 
         // Create the resources for alpha correction.
         CHECK_HRCMD(m_pvrSubmissionDevice->CreateComputeShader(
@@ -222,6 +265,47 @@ namespace pimax_openxr {
                                                                nullptr,
                                                                m_alphaCorrectShader[1].ReleaseAndGetAddressOf()));
         setDebugName(m_alphaCorrectShader[1].Get(), "AlphaBlending CS");
+        CHECK_HRCMD(m_pvrSubmissionDevice->CreateComputeShader(g_AlphaBlendingSRGBCS,
+                                                               sizeof(g_AlphaBlendingSRGBCS),
+                                                               nullptr,
+                                                               m_alphaCorrectSRGBShader[0].ReleaseAndGetAddressOf()));
+        setDebugName(m_alphaCorrectSRGBShader[0].Get(), "AlphaBlendingSRGB CS");
+        CHECK_HRCMD(m_pvrSubmissionDevice->CreateComputeShader(g_AlphaBlendingTexArraySRGBCS,
+                                                               sizeof(g_AlphaBlendingTexArraySRGBCS),
+                                                               nullptr,
+                                                               m_alphaCorrectSRGBShader[1].ReleaseAndGetAddressOf()));
+        setDebugName(m_alphaCorrectSRGBShader[1].Get(), "AlphaBlendingSRGB CS");
+        {
+            // Binding a range of a constant buffer is an optional feature of Direct3D 11.1.
+            D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+            m_useConstantBufferOffsetting =
+                SUCCEEDED(m_pvrSubmissionDevice->CheckFeatureSupport(
+                    D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+                options.ConstantBufferOffsetting;
+            TraceLoggingWrite(
+                g_traceProvider, "xrCreateSession", TLArg(m_useConstantBufferOffsetting, "ConstantBufferOffsetting"));
+
+            D3D11_BUFFER_DESC desc{};
+            desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+            desc.Usage = D3D11_USAGE_DYNAMIC;
+            desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+            if (m_useConstantBufferOffsetting) {
+                desc.ByteWidth = (UINT)(k_maxPrecompositionWork * k_precompositionConstantsStride);
+                CHECK_HRCMD(m_pvrSubmissionDevice->CreateBuffer(
+                    &desc, nullptr, m_precompositionConstants.ReleaseAndGetAddressOf()));
+                setDebugName(m_precompositionConstants.Get(), "Precomposition Constants");
+            } else {
+                desc.ByteWidth = (UINT)((sizeof(AlphaBlendingCSConstants) + 15) & ~15);
+                m_precompositionConstantsPerWork.resize(k_maxPrecompositionWork);
+                for (size_t i = 0; i < k_maxPrecompositionWork; i++) {
+                    CHECK_HRCMD(m_pvrSubmissionDevice->CreateBuffer(
+                        &desc, nullptr, m_precompositionConstantsPerWork[i].ReleaseAndGetAddressOf()));
+                    setDebugName(m_precompositionConstantsPerWork[i].Get(),
+                                 fmt::format("Precomposition Constants[{}]", i));
+                }
+            }
+        }
         CHECK_HRCMD(m_pvrSubmissionDevice->CreateVertexShader(
             g_FullScreenQuadVS, sizeof(g_FullScreenQuadVS), nullptr, m_fullQuadVS.ReleaseAndGetAddressOf()));
         setDebugName(m_fullQuadVS.Get(), "FullQuad VS");
@@ -229,6 +313,30 @@ namespace pimax_openxr {
             g_PassthroughPS, sizeof(g_PassthroughPS), nullptr, m_colorConversionPS.ReleaseAndGetAddressOf()));
         setDebugName(m_fullQuadVS.Get(), "ColorConversion PS");
 
+        // Create the resources for parallel projection reprojection.
+        CHECK_HRCMD(m_pvrSubmissionDevice->CreatePixelShader(g_ParallelReprojectionPS,
+                                                             sizeof(g_ParallelReprojectionPS),
+                                                             nullptr,
+                                                             m_parallelReprojectionPS[0].ReleaseAndGetAddressOf()));
+        setDebugName(m_parallelReprojectionPS[0].Get(), "ParallelReprojection PS");
+        CHECK_HRCMD(m_pvrSubmissionDevice->CreatePixelShader(g_ParallelReprojectionTexArrayPS,
+                                                             sizeof(g_ParallelReprojectionTexArrayPS),
+                                                             nullptr,
+                                                             m_parallelReprojectionPS[1].ReleaseAndGetAddressOf()));
+        setDebugName(m_parallelReprojectionPS[1].Get(), "ParallelReprojection PS");
+        {
+            D3D11_BUFFER_DESC desc{};
+            // The size of a constant buffer must be a multiple of 16 bytes.
+            desc.ByteWidth = (UINT)((sizeof(ParallelReprojectionPSConstants) + 15) & ~15);
+            desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+            desc.Usage = D3D11_USAGE_DYNAMIC;
+            desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+            CHECK_HRCMD(m_pvrSubmissionDevice->CreateBuffer(
+                &desc, nullptr, m_parallelReprojectionConstants.ReleaseAndGetAddressOf()));
+            setDebugName(m_parallelReprojectionConstants.Get(), "ParallelReprojection Constants");
+        }
+
         {
             D3D11_SAMPLER_DESC desc;
             ZeroMemory(&desc, sizeof(desc));
@@ -252,10 +360,29 @@ namespace pimax_openxr {
                 m_pvrSubmissionDevice->CreateRasterizerState(&desc, m_noDepthRasterizer.ReleaseAndGetAddressOf()));
         }
 
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerPrecomposition[i] =
-                std::make_unique<D3D11GpuTimer>(m_pvrSubmissionDevice.Get(), m_pvrSubmissionContext.Get());
+        m_gpuTimestampsPrecomposition = std::make_unique<D3D11TimestampPool>(
+            m_pvrSubmissionDevice.Get(), m_pvrSubmissionContext.Get(), k_maxGpuTimersPerPool, k_gpuTimersLatency);
+        m_gpuTimerPrecomposition = std::make_unique<GpuTimer>(*m_gpuTimestampsPrecomposition);
+
+        // With many layers, the precomposition can be recorded in parallel on deferred contexts. The calling thread
+        // records one of the chunks, so there is one more context than worker threads. This is not possible when
+        // submitting on the application's device, which is not ours to create deferred contexts on.
+        m_useParallelPrecomposition =
+            !m_useApplicationDeviceForSubmission && getSetting("parallel_precomposition").value_or(false);
+        if (m_useParallelPrecomposition) {
+            const size_t workerCount =
+                (size_t)std::clamp(getSetting("parallel_precomposition_threads").value_or(2), 1, 7);
+            m_precompositionContexts.resize(workerCount + 1);
+            m_precompositionCommandLists.resize(workerCount + 1);
+            for (auto& context : m_precompositionContexts) {
+                CHECK_HRCMD(m_pvrSubmissionDevice->CreateDeferredContext1(0, context.ReleaseAndGetAddressOf()));
+            }
+            m_precompositionWorkers.start(workerCount);
         }
+        TraceLoggingWrite(g_traceProvider,
+                          "xrCreateSession",
+                          TLArg(m_useParallelPrecomposition, "ParallelPrecomposition"),
+                          TLArg(m_precompositionWorkers.workerCount(), "ParallelPrecompositionThreads"));
 
         // Create the resources for drawing text.
         CHECK_HRCMD(FW1CreateFactory(FW1_VERSION, m_fontWrapperFactory.ReleaseAndGetAddressOf()));
@@ -300,9 +427,8 @@ namespace pimax_openxr {
     void OpenXrRuntime::cleanupD3D11() {
         flushD3D11Context();
 
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i].reset();
-        }
+        m_gpuTimerApp.reset();
+        m_gpuTimestampsApp.reset();
 
         m_d3d11ContextState.Reset();
         m_d3d11Context.Reset();
@@ -312,20 +438,28 @@ namespace pimax_openxr {
     void OpenXrRuntime::cleanupSubmissionDevice() {
         flushSubmissionContext();
 
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerPrecomposition[i].reset();
-        }
+        m_gpuTimerPrecomposition.reset();
+        m_gpuTimestampsPrecomposition.reset();
 
         m_dxgiSwapchain.Reset();
         for (int i = 0; i < ARRAYSIZE(m_alphaCorrectShader); i++) {
             m_alphaCorrectShader[i].Reset();
+            m_alphaCorrectSRGBShader[i].Reset();
         }
+        m_precompositionConstants.Reset();
+        m_precompositionConstantsPerWork.clear();
+        m_precompositionWork.clear();
+        m_intermediateTexturePool.clear();
+        m_precompositionWorkers.stop();
+        m_precompositionCommandLists.clear();
+        m_precompositionContexts.clear();
+        m_useParallelPrecomposition = false;
+        cleanupParallelReprojectionResources();
 
         m_pvrSubmissionFence.Reset();
         m_pvrSubmissionContextState.Reset();
         m_pvrSubmissionContext.Reset();
         m_pvrSubmissionDevice.Reset();
-        m_eventForSubmissionFence.reset();
     }
 
     // Retrieve generic handles to the swapchain images to import into the application device.
@@ -384,6 +518,10 @@ namespace pimax_openxr {
             handles.push_back(textureHandle);
         }
 
+        if (!initialized && m_useResourceWarmUp) {
+            warmUpSwapchainResources(xrSwapchain);
+        }
+
         return handles;
     }
 
@@ -455,22 +593,51 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
-    // Prepare a PVR swapchain to be used by PVR.
-    void OpenXrRuntime::prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
-                                                       uint32_t layerIndex,
-                                                       uint32_t slice,
-                                                       XrCompositionLayerFlags compositionFlags,
-                                                       std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) {
-        // If the texture was never used or already committed, do nothing.
-        if (xrSwapchain.slices[0].empty() || committed.count(std::make_pair(xrSwapchain.pvrSwapchain[0], slice))) {
-            return;
+    // Prepare a PVR swapchain to be used by PVR, and return the PVR swapchain to submit for the slice.
+    pvrTextureSwapChain OpenXrRuntime::prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
+                                                                      uint32_t layerIndex,
+                                                                      uint32_t slice,
+                                                                      XrCompositionLayerFlags compositionFlags,
+                                                                      DXGI_FORMAT submissionFormat,
+                                                                      CommittedImageList& committed) {
+        // The decision to convert is made once per swapchain, but is reverted if the swapchain is later submitted for a
+        // layer that cannot be converted (eg: alpha-blended).
+        if (!xrSwapchain.useConversion.has_value() && !xrSwapchain.slices[0].empty()) {
+            xrSwapchain.useConversion =
+                canConvertSubmissionFormat(xrSwapchain, submissionFormat, layerIndex, compositionFlags);
+            TraceLoggingWrite(g_traceProvider,
+                              "SubmissionFormat",
+                              TLPArg(&xrSwapchain, "Swapchain"),
+                              TLArg(xrSwapchain.useConversion.value(), "UseConversion"),
+                              TLArg((int)submissionFormat, "Format"));
+        } else if (xrSwapchain.useConversion.value_or(false) &&
+                   !canConvertSubmissionFormat(xrSwapchain, submissionFormat, layerIndex, compositionFlags)) {
+            xrSwapchain.useConversion = false;
+            std::fill(xrSwapchain.lastProcessedIndex.begin(), xrSwapchain.lastProcessedIndex.end(), -1);
+            TraceLoggingWrite(g_traceProvider,
+                              "SubmissionFormat",
+                              TLPArg(&xrSwapchain, "Swapchain"),
+                              TLArg(false, "UseConversion"));
+        }
+        const bool needConvert = xrSwapchain.useConversion.value_or(false);
+        if (needConvert) {
+            ensureSwapchainConvertedResources(xrSwapchain, slice);
         }
+        const pvrTextureSwapChain submittedSwapchain =
+            needConvert ? xrSwapchain.convertedPvrSwapchain[slice] : xrSwapchain.pvrSwapchain[slice];
 
-        ensureSwapchainSliceResources(xrSwapchain, slice);
+        // If the texture was never used or already committed, do nothing.
+        if (xrSwapchain.slices[0].empty() || committed.contains(std::make_pair(xrSwapchain.pvrSwapchain[0], slice))) {
+            return submittedSwapchain;
+        }
 
-        int pvrDestIndex = -1;
-        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, xrSwapchain.pvrSwapchain[slice], &pvrDestIndex));
-        const int lastReleasedIndex = xrSwapchain.lastReleasedIndex;
+        // If the application did not release a new image since we last committed this slice, the last image committed
+        // to PVR already holds the processed content. This is always the case for a static image swapchain after its
+        // first submission. Re-reference it as-is: committing would require a copy into the next PVR image.
+        if (m_reuseStaticLayers && xrSwapchain.lastProcessedIndex[slice] == xrSwapchain.lastReleasedIndex) {
+            committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+            return submittedSwapchain;
+        }
 
         const bool needClearAlpha =
             layerIndex > 0 && !(compositionFlags & XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT);
@@ -478,16 +645,67 @@ namespace pimax_openxr {
         // 1). This avoids needing to run the premultiply alpha shader only do multiply all values by 1...
         const bool needPremultiplyAlpha = (m_honorPremultiplyFlagOnProj0 || layerIndex > 0) &&
                                           (compositionFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT);
+
+        // The conversion is done by the alpha correction pass, writing directly into the converted PVR swapchain. The
+        // application's image is processed again whenever it must be committed, so there is never a copy, and the
+        // PVR swapchains of the other slices are not needed.
+        if (needConvert) {
+            ensureSwapchainImageResourceView(xrSwapchain, slice, xrSwapchain.lastReleasedIndex);
+
+            int pvrDestIndex = -1;
+            CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, submittedSwapchain, &pvrDestIndex));
+
+            PrecompositionWork& work = m_precompositionWork.emplace_back();
+            work.swapchain = &xrSwapchain;
+            work.slice = slice;
+            work.sourceIndex = xrSwapchain.lastReleasedIndex;
+            work.destIndex = pvrDestIndex;
+            work.needClearAlpha = needClearAlpha;
+            work.needPremultiplyAlpha = needPremultiplyAlpha;
+            work.needConvert = true;
+            committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+            return submittedSwapchain;
+        }
+
+        ensureSwapchainSliceResources(xrSwapchain, slice);
+
+        int pvrDestIndex = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, xrSwapchain.pvrSwapchain[slice], &pvrDestIndex));
+        const int lastReleasedIndex = xrSwapchain.lastReleasedIndex;
+
         const bool needCopy = xrSwapchain.lastProcessedIndex[slice] == lastReleasedIndex ||
                               (slice > 0 && !(needClearAlpha || needPremultiplyAlpha));
 
+        // With native D3D12 precomposition, the work is recorded on the application queue by
+        // flushPrecompositionD3D12(), before the frame is serialized to the submission device. Nothing may touch the
+        // textures on the submission device until then, including committing them.
+        // With asynchronous commit, the copies and plain commits are left to the submission thread as well, see
+        // flushAsyncCommit().
+        const bool deferToD3D12 =
+            isD3D12Session() && m_useD3D12Precomposition &&
+            canUseD3D12Precomposition(xrSwapchain, slice, needCopy, needClearAlpha || needPremultiplyAlpha);
+        const bool deferToAsyncCommit = m_useAsyncCommit && (needCopy || !(needClearAlpha || needPremultiplyAlpha));
+        if (deferToD3D12 || deferToAsyncCommit) {
+            PrecompositionWork& work = m_precompositionWork.emplace_back();
+            work.swapchain = &xrSwapchain;
+            work.slice = slice;
+            work.sourceIndex = lastReleasedIndex;
+            work.destIndex = pvrDestIndex;
+            work.needCopy = needCopy;
+            work.needClearAlpha = !needCopy && needClearAlpha;
+            work.needPremultiplyAlpha = !needCopy && needPremultiplyAlpha;
+            committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+            return submittedSwapchain;
+        }
+
         if (needCopy) {
             // Circumvent some of PVR's limitations:
             // - For texture arrays, we must do a copy to slice 0 into another swapchain.
             // - Committing into a swapchain automatically acquires the next image. When an app renders certain
             //   swapchains (eg: quad layers) at a lower frame rate, we must perform a copy to the current PVR swapchain
-            //   image. All the processing needed (eg: alpha correction) was done during initial processing (the first
-            //   time we saw the last released image), so no need to redo it.
+            //   image (unless we re-reference the last committed image, see above). All the processing needed (eg:
+            //   alpha correction) was done during initial processing (the first time we saw the last released image),
+            //   so no need to redo it.
             m_pvrSubmissionContext->CopySubresourceRegion(xrSwapchain.slices[slice][pvrDestIndex].Get(),
                                                           0,
                                                           0,
@@ -502,132 +720,342 @@ namespace pimax_openxr {
             // For alpha-blended layers with texture arrays, we must also output into slice 0 of
             // another swapchain (see other branch above).
             //
-            // One more difficulty: because we use a compute shader, we cannot use an SRGB format as destination. We
-            // might need to do a conversion pass at the very end.
+            // The processing of all the layers is batched in flushPrecomposition(), which also commits the textures.
+            const bool useSinglePass = canUseSinglePassPrecomposition(xrSwapchain, slice);
+            const bool isInPlace = useSinglePass && slice == 0 && pvrDestIndex == lastReleasedIndex;
 
-            ensureSwapchainIntermediateResources(xrSwapchain);
+            if (!useSinglePass) {
+                ensureSwapchainIntermediateResources(xrSwapchain);
+            }
 
-            // Lazily create SRV.
-            if (!xrSwapchain.imagesResourceView[slice][lastReleasedIndex]) {
-                D3D11_SHADER_RESOURCE_VIEW_DESC desc{};
+            if (!isInPlace) {
+                ensureSwapchainImageResourceView(xrSwapchain, slice, lastReleasedIndex);
+            }
+            if (useSinglePass) {
+                ensureSwapchainEncodeAccessView(xrSwapchain, slice, pvrDestIndex);
+            }
 
-                desc.ViewDimension = xrSwapchain.xrDesc.arraySize == 1 ? D3D11_SRV_DIMENSION_TEXTURE2D
-                                                                       : D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-                desc.Format = xrSwapchain.dxgiFormatForSubmission;
-                desc.Texture2DArray.ArraySize = 1;
-                desc.Texture2DArray.MipLevels = xrSwapchain.xrDesc.mipCount;
-                desc.Texture2DArray.FirstArraySlice = D3D11CalcSubresource(0, slice, desc.Texture2DArray.MipLevels);
+            PrecompositionWork& work = m_precompositionWork.emplace_back();
+            work.swapchain = &xrSwapchain;
+            work.slice = slice;
+            work.sourceIndex = lastReleasedIndex;
+            work.destIndex = pvrDestIndex;
+            work.needClearAlpha = needClearAlpha;
+            work.needPremultiplyAlpha = needPremultiplyAlpha;
+            committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+            return submittedSwapchain;
+        }
 
-                CHECK_HRCMD(m_pvrSubmissionDevice->CreateShaderResourceView(
-                    xrSwapchain.images[lastReleasedIndex].Get(),
-                    &desc,
-                    xrSwapchain.imagesResourceView[slice][lastReleasedIndex].ReleaseAndGetAddressOf()));
-                setDebugName(xrSwapchain.imagesResourceView[slice][lastReleasedIndex].Get(),
-                             fmt::format("Convert SRV[{}, {}, {}]", slice, lastReleasedIndex, (void*)&xrSwapchain));
-            }
+        xrSwapchain.lastProcessedIndex[slice] = lastReleasedIndex;
 
-            // We are about to do something destructive to the application context. Save the context. It will be
-            // restored at the end of xrEndFrame().
-            if (m_d3d11Device == m_pvrSubmissionDevice && !m_d3d11ContextState) {
-                m_pvrSubmissionContext->SwapDeviceContextState(m_pvrSubmissionContextState.Get(),
-                                                               m_d3d11ContextState.ReleaseAndGetAddressOf());
+        // Commit the texture to PVR.
+        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, xrSwapchain.pvrSwapchain[slice]));
+        committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+        return submittedSwapchain;
+    }
+
+    // Whether alpha correction can write directly into the PVR swapchain, without going through the intermediate
+    // texture.
+    bool OpenXrRuntime::canUseSinglePassPrecomposition(const Swapchain& xrSwapchain, uint32_t slice) const {
+        // Because we use a compute shader, we cannot use an SRGB format as destination. When possible, we do the SRGB
+        // encoding in the compute shader and write the PVR swapchain image through a view of its raw texels. Otherwise,
+        // we need to do a conversion pass at the very end.
+        return isSRGBFormatWithPackedUAV(xrSwapchain.dxgiFormatForSubmission) &&
+               (xrSwapchain.xrDesc.arraySize == 1 || slice > 0);
+    }
+
+    // Run the alpha correction queued by prepareAndCommitSwapchainImage() for all the layers, then commit the textures.
+    // This lets us upload the constants once and avoid rebinding the pipeline for each layer.
+    void OpenXrRuntime::flushPrecomposition() {
+        if (m_precompositionWork.empty()) {
+            return;
+        }
+
+        // Upload the constants for all the layers at once. Each layer uses its own slice of the buffer, or its own
+        // buffer without constant buffer offsetting.
+        {
+            D3D11_MAPPED_SUBRESOURCE mappedResources;
+            if (m_useConstantBufferOffsetting) {
+                CHECK_HRCMD(m_pvrSubmissionContext->Map(
+                    m_precompositionConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResources));
             }
+            for (size_t i = 0; i < m_precompositionWork.size(); i++) {
+                const PrecompositionWork& work = m_precompositionWork[i];
+                const bool useSinglePass = canUseSinglePassPrecomposition(*work.swapchain, work.slice);
 
-            // 0: shader for Tex2D, 1: shader for Tex2DArray.
-            const int shaderToUse = xrSwapchain.xrDesc.arraySize == 1 ? 0 : 1;
-            {
                 AlphaBlendingCSConstants constants{};
-                constants.ignoreAlpha = needClearAlpha;
-                constants.isUnpremultipliedAlpha = needPremultiplyAlpha;
+                constants.ignoreAlpha = work.needClearAlpha;
+                constants.isUnpremultipliedAlpha = work.needPremultiplyAlpha;
+                constants.isInPlace =
+                    !work.needConvert && useSinglePass && work.slice == 0 && work.destIndex == work.sourceIndex;
+                if (m_useConstantBufferOffsetting) {
+                    memcpy((uint8_t*)mappedResources.pData + i * k_precompositionConstantsStride,
+                           &constants,
+                           sizeof(constants));
+                } else {
+                    CHECK_HRCMD(m_pvrSubmissionContext->Map(
+                        m_precompositionConstantsPerWork[i].Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResources));
+                    memcpy(mappedResources.pData, &constants, sizeof(constants));
+                    m_pvrSubmissionContext->Unmap(m_precompositionConstantsPerWork[i].Get(), 0);
+                }
+            }
+            if (m_useConstantBufferOffsetting) {
+                m_pvrSubmissionContext->Unmap(m_precompositionConstants.Get(), 0);
+            }
+        }
 
-                D3D11_MAPPED_SUBRESOURCE mappedResources;
-                CHECK_HRCMD(m_pvrSubmissionContext->Map(
-                    xrSwapchain.convertConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResources));
-                memcpy(mappedResources.pData, &constants, sizeof(constants));
-                m_pvrSubmissionContext->Unmap(xrSwapchain.convertConstants.Get(), 0);
-                m_pvrSubmissionContext->CSSetConstantBuffers(0, 1, xrSwapchain.convertConstants.GetAddressOf());
+        // We are about to do something destructive to the application context. Save the context. It will be
+        // restored at the end of xrEndFrame().
+        if (m_d3d11Device == m_pvrSubmissionDevice && !m_d3d11ContextState) {
+            m_pvrSubmissionContext->SwapDeviceContextState(m_pvrSubmissionContextState.Get(),
+                                                           m_d3d11ContextState.ReleaseAndGetAddressOf());
+        }
 
-                m_pvrSubmissionContext->CSSetShader(m_alphaCorrectShader[shaderToUse].Get(), nullptr, 0);
+        // Resources that may be created lazily must be created ahead of the recording, which may happen in parallel.
+        for (const PrecompositionWork& work : m_precompositionWork) {
+            if ((work.needClearAlpha || work.needPremultiplyAlpha) && !work.needConvert &&
+                !canUseSinglePassPrecomposition(*work.swapchain, work.slice) &&
+                isSRGBFormat(work.swapchain->dxgiFormatForSubmission)) {
+                ensureSwapchainRenderTargetView(*work.swapchain, work.slice, work.destIndex);
             }
+        }
 
-            m_pvrSubmissionContext->CSSetShaderResources(
-                0, 1, xrSwapchain.imagesResourceView[slice][lastReleasedIndex].GetAddressOf());
-            m_pvrSubmissionContext->CSSetUnorderedAccessViews(
-                0, 1, xrSwapchain.convertAccessView.GetAddressOf(), nullptr);
+        // Each chunk must hold a few layers to amortize the cost of executing a command list.
+        const size_t chunkCount = m_useParallelPrecomposition
+                                      ? std::min(m_precompositionContexts.size(), m_precompositionWork.size() / 2)
+                                      : 0;
+        if (chunkCount > 1) {
+            // Record contiguous chunks of the layers into deferred contexts in parallel, then execute them in order so
+            // that the GPU sees the same sequence of commands as with serial recording.
+            const size_t chunkSize = (m_precompositionWork.size() + chunkCount - 1) / chunkCount;
+            m_precompositionWorkers.run(chunkCount, [&](size_t chunk) {
+                ID3D11DeviceContext1* context = m_precompositionContexts[chunk].Get();
+                const size_t begin = chunk * chunkSize;
+                const size_t end = std::min(begin + chunkSize, m_precompositionWork.size());
+                recordPrecomposition(context, begin, end);
+                CHECK_HRCMD(
+                    context->FinishCommandList(FALSE, m_precompositionCommandLists[chunk].ReleaseAndGetAddressOf()));
+            });
+
+            // All the state is unbound at the end of each chunk, so there is no need to restore the context state.
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                m_pvrSubmissionContext->ExecuteCommandList(m_precompositionCommandLists[chunk].Get(), FALSE);
+                m_precompositionCommandLists[chunk].Reset();
+            }
+        } else {
+            recordPrecomposition(m_pvrSubmissionContext.Get(), 0, m_precompositionWork.size());
+        }
 
-            m_pvrSubmissionContext->Dispatch((unsigned int)std::ceil(xrSwapchain.xrDesc.width / 32),
-                                             (unsigned int)std::ceil(xrSwapchain.xrDesc.height / 32),
-                                             1);
+        // Commit the textures to PVR, in the order the layers were queued.
+        for (const PrecompositionWork& work : m_precompositionWork) {
+            work.swapchain->lastProcessedIndex[work.slice] = work.sourceIndex;
+            if (work.needConvert) {
+                CHECK_PVRCMD(
+                    pvr_commitTextureSwapChain(m_pvrSession, work.swapchain->convertedPvrSwapchain[work.slice]));
+
+                // The application's swapchain is not submitted, but it must still be committed to keep the PVR
+                // swapchain in step with the images acquired by the application, see xrAcquireSwapchainImage().
+                if (work.slice != 0) {
+                    continue;
+                }
+            }
+            CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, work.swapchain->pvrSwapchain[work.slice]));
+        }
 
-            // Unbind all resources to avoid D3D validation errors.
-            {
-                m_pvrSubmissionContext->CSSetShader(nullptr, nullptr, 0);
-                ID3D11Buffer* nullCBV[] = {nullptr};
-                m_pvrSubmissionContext->CSSetConstantBuffers(0, 1, nullCBV);
-                ID3D11UnorderedAccessView* nullUAV[] = {nullptr};
-                m_pvrSubmissionContext->CSSetUnorderedAccessViews(0, 1, nullUAV, nullptr);
-                ID3D11ShaderResourceView* nullSRV[] = {nullptr};
-                m_pvrSubmissionContext->CSSetShaderResources(0, 1, nullSRV);
+        m_precompositionWork.clear();
+    }
+
+    // Record the alpha correction for the layers [begin, end) of the work queued for flushPrecomposition(). The context
+    // is either the immediate context of the submission device, or a deferred context.
+    void OpenXrRuntime::recordPrecomposition(ID3D11DeviceContext1* context, size_t begin, size_t end) const {
+        ID3D11ComputeShader* boundShader = nullptr;
+        for (size_t i = begin; i < end; i++) {
+            const PrecompositionWork& work = m_precompositionWork[i];
+            const Swapchain& xrSwapchain = *work.swapchain;
+            const uint32_t slice = work.slice;
+            const int lastReleasedIndex = work.sourceIndex;
+            const int pvrDestIndex = work.destIndex;
+
+            // With asynchronous commit, the copies and plain commits are queued along with the alpha correction. See
+            // prepareAndCommitSwapchainImage() for the copies.
+            if (work.needCopy) {
+                context->CopySubresourceRegion(xrSwapchain.slices[slice][pvrDestIndex].Get(),
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               xrSwapchain.slices[0][lastReleasedIndex].Get(),
+                                               slice,
+                                               nullptr);
+                continue;
+            }
+            if (!work.needConvert && !work.needClearAlpha && !work.needPremultiplyAlpha) {
+                continue;
             }
 
-            // Final copy into the PVR texture.
-            if (!isSRGBFormat(xrSwapchain.dxgiFormatForSubmission)) {
-                m_pvrSubmissionContext->CopySubresourceRegion(
-                    xrSwapchain.slices[slice][pvrDestIndex].Get(), 0, 0, 0, 0, xrSwapchain.resolved.Get(), 0, nullptr);
+            // The conversion writes straight into the converted PVR swapchain, through a UAV of the narrower format.
+            const bool useSinglePass = work.needConvert || canUseSinglePassPrecomposition(xrSwapchain, slice);
+            const bool isInPlace =
+                !work.needConvert && useSinglePass && slice == 0 && pvrDestIndex == lastReleasedIndex;
+
+            // 0: shader for Tex2D, 1: shader for Tex2DArray.
+            const int shaderToUse = xrSwapchain.xrDesc.arraySize == 1 ? 0 : 1;
+            ID3D11ComputeShader* shader = useSinglePass && !work.needConvert
+                                              ? m_alphaCorrectSRGBShader[shaderToUse].Get()
+                                              : m_alphaCorrectShader[shaderToUse].Get();
+            if (shader != boundShader) {
+                context->CSSetShader(shader, nullptr, 0);
+                boundShader = shader;
+            }
+
+            if (m_useConstantBufferOffsetting) {
+                const UINT firstConstant = (UINT)(i * k_precompositionConstantsStride / 16);
+                const UINT numConstants = k_precompositionConstantsStride / 16;
+                context->CSSetConstantBuffers1(
+                    0, 1, m_precompositionConstants.GetAddressOf(), &firstConstant, &numConstants);
             } else {
-                // Lazily create RTV.
-                if (!xrSwapchain.renderTargetView[slice][pvrDestIndex]) {
-                    D3D11_RENDER_TARGET_VIEW_DESC desc{};
-
-                    // When rendering to a swapchain with slice > 0, we know the swapchain is always arraySize of 1.
-                    desc.ViewDimension = (xrSwapchain.xrDesc.arraySize == 1) || slice > 0
-                                             ? D3D11_RTV_DIMENSION_TEXTURE2D
-                                             : D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-                    desc.Format = xrSwapchain.dxgiFormatForSubmission;
-                    desc.Texture2DArray.ArraySize = 1;
-                    desc.Texture2DArray.MipSlice = D3D11CalcSubresource(0, 0, xrSwapchain.xrDesc.mipCount);
-                    desc.Texture2DArray.FirstArraySlice = slice;
-
-                    CHECK_HRCMD(m_pvrSubmissionDevice->CreateRenderTargetView(
-                        xrSwapchain.slices[slice][pvrDestIndex].Get(),
-                        &desc,
-                        xrSwapchain.renderTargetView[slice][pvrDestIndex].ReleaseAndGetAddressOf()));
-                    setDebugName(xrSwapchain.renderTargetView[slice][lastReleasedIndex].Get(),
-                                 fmt::format("Convert RTV[{}, {}, {}]", slice, pvrDestIndex, (void*)&xrSwapchain));
-                }
+                context->CSSetConstantBuffers(0, 1, m_precompositionConstantsPerWork[i].GetAddressOf());
+            }
 
-                // Use a full quad shader for color conversion to sRGB.
-                m_pvrSubmissionContext->ClearState();
-                m_pvrSubmissionContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-                m_pvrSubmissionContext->OMSetRenderTargets(
-                    1, xrSwapchain.renderTargetView[slice][lastReleasedIndex].GetAddressOf(), nullptr);
-                m_pvrSubmissionContext->RSSetState(m_noDepthRasterizer.Get());
-                D3D11_VIEWPORT viewport{};
-                viewport.Width = (float)xrSwapchain.pvrDesc.Width;
-                viewport.Height = (float)xrSwapchain.pvrDesc.Height;
-                viewport.MaxDepth = 1.f;
-                m_pvrSubmissionContext->RSSetViewports(1, &viewport);
-                m_pvrSubmissionContext->VSSetShader(m_fullQuadVS.Get(), nullptr, 0);
-                m_pvrSubmissionContext->PSSetSamplers(0, 1, m_linearClampSampler.GetAddressOf());
-                m_pvrSubmissionContext->PSSetShaderResources(0, 1, xrSwapchain.convertResourceView.GetAddressOf());
-                m_pvrSubmissionContext->PSSetShader(m_colorConversionPS.Get(), nullptr, 0);
-                m_pvrSubmissionContext->Draw(3, 0);
-
-                // Unbind all resources to avoid D3D validation errors.
-                {
-                    ID3D11RenderTargetView* nullRTV[] = {nullptr};
-                    m_pvrSubmissionContext->OMSetRenderTargets(1, nullRTV, nullptr);
-                    ID3D11ShaderResourceView* nullSRV[] = {nullptr};
-                    m_pvrSubmissionContext->PSSetShaderResources(0, 1, nullSRV);
+            // When the source image is also the destination, it cannot be bound as both SRV and UAV.
+            ID3D11ShaderResourceView* srv =
+                !isInPlace ? xrSwapchain.imagesResourceView[slice][lastReleasedIndex].Get() : nullptr;
+            context->CSSetShaderResources(0, 1, &srv);
+            context->CSSetUnorderedAccessViews(
+                0,
+                1,
+                work.needConvert ? xrSwapchain.convertedAccessView[slice][pvrDestIndex].GetAddressOf()
+                : useSinglePass  ? xrSwapchain.encodeAccessView[slice][pvrDestIndex].GetAddressOf()
+                                 : xrSwapchain.intermediate->accessView.GetAddressOf(),
+                nullptr);
+
+            context->Dispatch((xrSwapchain.xrDesc.width + 31) / 32, (xrSwapchain.xrDesc.height + 31) / 32, 1);
+
+            // Final copy from the intermediate texture into the PVR texture.
+            if (!useSinglePass) {
+                // Unbind the intermediate texture to avoid D3D validation errors.
+                ID3D11UnorderedAccessView* nullUAV[] = {nullptr};
+                context->CSSetUnorderedAccessViews(0, 1, nullUAV, nullptr);
+
+                // The intermediate texture may be larger than the swapchain.
+                const IntermediateTexture& intermediate = *xrSwapchain.intermediate;
+                if (!isSRGBFormat(xrSwapchain.dxgiFormatForSubmission)) {
+                    D3D11_BOX box{};
+                    box.right = xrSwapchain.pvrDesc.Width;
+                    box.bottom = xrSwapchain.pvrDesc.Height;
+                    box.back = 1;
+                    context->CopySubresourceRegion(xrSwapchain.slices[slice][pvrDestIndex].Get(),
+                                                   0,
+                                                   0,
+                                                   0,
+                                                   0,
+                                                   intermediate.texture.Get(),
+                                                   0,
+                                                   &box);
+                } else {
+                    // Use a full quad shader for color conversion to sRGB.
+                    context->ClearState();
+                    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+                    context->OMSetRenderTargets(
+                        1, xrSwapchain.renderTargetView[slice][pvrDestIndex].GetAddressOf(), nullptr);
+                    context->RSSetState(m_noDepthRasterizer.Get());
+                    // Size the viewport like the intermediate texture to keep a 1:1 texel mapping. The pixels past
+                    // the render target are discarded.
+                    D3D11_VIEWPORT viewport{};
+                    viewport.Width = (float)intermediate.width;
+                    viewport.Height = (float)intermediate.height;
+                    viewport.MaxDepth = 1.f;
+                    context->RSSetViewports(1, &viewport);
+                    context->VSSetShader(m_fullQuadVS.Get(), nullptr, 0);
+                    context->PSSetSamplers(0, 1, m_linearClampSampler.GetAddressOf());
+                    context->PSSetShaderResources(0, 1, intermediate.resourceView.GetAddressOf());
+                    context->PSSetShader(m_colorConversionPS.Get(), nullptr, 0);
+                    context->Draw(3, 0);
+
+                    // Unbind all resources to avoid D3D validation errors.
+                    {
+                        ID3D11RenderTargetView* nullRTV[] = {nullptr};
+                        context->OMSetRenderTargets(1, nullRTV, nullptr);
+                        ID3D11ShaderResourceView* nullSRV[] = {nullptr};
+                        context->PSSetShaderResources(0, 1, nullSRV);
+                    }
+
+                    // The compute shader must be bound again for the next layer.
+                    boundShader = nullptr;
                 }
             }
         }
 
-        xrSwapchain.lastProcessedIndex[slice] = lastReleasedIndex;
+        // Unbind all resources to avoid D3D validation errors.
+        {
+            context->CSSetShader(nullptr, nullptr, 0);
+            ID3D11Buffer* nullCBV[] = {nullptr};
+            context->CSSetConstantBuffers(0, 1, nullCBV);
+            ID3D11UnorderedAccessView* nullUAV[] = {nullptr};
+            context->CSSetUnorderedAccessViews(0, 1, nullUAV, nullptr);
+            ID3D11ShaderResourceView* nullSRV[] = {nullptr};
+            context->CSSetShaderResources(0, 1, nullSRV);
+        }
+    }
 
-        // Commit the texture to PVR.
-        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, xrSwapchain.pvrSwapchain[slice]));
-        committed.insert(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
+    // Whether the layer can be submitted in a narrower format than the application's swapchain. The conversion drops
+    // the alpha channel, so it is only possible for opaque layers.
+    bool OpenXrRuntime::canConvertSubmissionFormat(const Swapchain& xrSwapchain,
+                                                   DXGI_FORMAT submissionFormat,
+                                                   uint32_t layerIndex,
+                                                   XrCompositionLayerFlags compositionFlags) {
+        return submissionFormat != DXGI_FORMAT_UNKNOWN &&
+               xrSwapchain.dxgiFormatForSubmission == DXGI_FORMAT_R16G16B16A16_FLOAT &&
+               xrSwapchain.xrDesc.sampleCount == 1 && xrSwapchain.xrDesc.mipCount == 1 &&
+               !(xrSwapchain.xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) &&
+               (layerIndex == 0 || !(compositionFlags & XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT));
+    }
+
+    void OpenXrRuntime::ensureSwapchainConvertedResources(Swapchain& xrSwapchain, uint32_t slice) const {
+        if (xrSwapchain.convertedPvrSwapchain.empty()) {
+            xrSwapchain.convertedPvrSwapchain.resize(xrSwapchain.xrDesc.arraySize);
+            xrSwapchain.convertedAccessView.resize(xrSwapchain.xrDesc.arraySize);
+        }
+
+        // Lazily create a swapchain in the narrower format for this slice of the array.
+        if (!xrSwapchain.convertedPvrSwapchain[slice]) {
+            auto desc = xrSwapchain.pvrDesc;
+            desc.Format = PVR_FORMAT_R11G11B10_FLOAT;
+            desc.ArraySize = 1;
+            desc.MipLevels = 1;
+            desc.SampleCount = 1;
+            desc.BindFlags = pvrTextureBind_DX_UnorderedAccess;
+            desc.MiscFlags = 0;
+            CHECK_PVRCMD(pvr_createTextureSwapChainDX(
+                m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &xrSwapchain.convertedPvrSwapchain[slice]));
+
+            int count = -1;
+            CHECK_PVRCMD(
+                pvr_getTextureSwapChainLength(m_pvrSession, xrSwapchain.convertedPvrSwapchain[slice], &count));
+
+            // Query the textures for the swapchain and create the UAVs for the conversion.
+            for (int i = 0; i < count; i++) {
+                ComPtr<ID3D11Texture2D> texture;
+                CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(m_pvrSession,
+                                                             xrSwapchain.convertedPvrSwapchain[slice],
+                                                             i,
+                                                             IID_PPV_ARGS(texture.ReleaseAndGetAddressOf())));
+                setDebugName(texture.Get(),
+                             fmt::format("Runtime Converted Texture[{}, {}, {}]", slice, i, (void*)&xrSwapchain));
+
+                D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+                uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+                uavDesc.Format = DXGI_FORMAT_R11G11B10_FLOAT;
+                uavDesc.Texture2D.MipSlice = 0;
+
+                ComPtr<ID3D11UnorderedAccessView> uav;
+                CHECK_HRCMD(m_pvrSubmissionDevice->CreateUnorderedAccessView(
+                    texture.Get(), &uavDesc, uav.ReleaseAndGetAddressOf()));
+                setDebugName(uav.Get(), fmt::format("Converted UAV[{}, {}, {}]", slice, i, (void*)&xrSwapchain));
+
+                xrSwapchain.convertedAccessView[slice].push_back(uav);
+            }
+        }
     }
 
     void OpenXrRuntime::ensureSwapchainSliceResources(Swapchain& xrSwapchain, uint32_t slice) const {
@@ -663,83 +1091,446 @@ namespace pimax_openxr {
     }
 
     void OpenXrRuntime::ensureSwapchainIntermediateResources(Swapchain& xrSwapchain) const {
-        // Lazily create our intermediate buffer and compute shader resources.
-        if (!xrSwapchain.resolved) {
+        // Lazily acquire our intermediate buffer and compute shader resources.
+        if (!xrSwapchain.intermediate) {
             const bool isSRGBDestination = isSRGBFormat(xrSwapchain.dxgiFormatForSubmission);
 
+            // Use a non-SRGB format that has enough precision to avoid loss of colors.
+            const DXGI_FORMAT viewFormat =
+                !isSRGBDestination ? xrSwapchain.dxgiFormatForSubmission : DXGI_FORMAT_R16G16B16A16_FLOAT;
+            const auto roundUp = [](uint32_t value) {
+                return (value + k_intermediateTextureSizeClass - 1) / k_intermediateTextureSizeClass *
+                       k_intermediateTextureSizeClass;
+            };
+            const auto key =
+                std::make_tuple(viewFormat, roundUp(xrSwapchain.xrDesc.width), roundUp(xrSwapchain.xrDesc.height));
+
+            std::unique_lock lock(m_intermediateTexturePoolMutex);
+
+            auto& entry = m_intermediateTexturePool[key];
+            xrSwapchain.intermediate = entry.lock();
+            if (xrSwapchain.intermediate) {
+                return;
+            }
+
+            auto intermediate = std::make_shared<IntermediateTexture>();
+            intermediate->width = std::get<1>(key);
+            intermediate->height = std::get<2>(key);
             {
+                // Only the first mip level is ever written, and a UAV cannot be multisampled.
                 D3D11_TEXTURE2D_DESC desc{};
                 desc.ArraySize = 1;
-                if (!isSRGBDestination) {
-                    desc.Format = getTypelessFormat(xrSwapchain.dxgiFormatForSubmission);
-                } else {
-                    // Use a non-SRGB format that has enough precision to avoid loss of colors.
-                    desc.Format = DXGI_FORMAT_R16G16B16A16_TYPELESS;
-                }
-                desc.Width = xrSwapchain.xrDesc.width;
-                desc.Height = xrSwapchain.xrDesc.height;
-                desc.MipLevels = xrSwapchain.xrDesc.mipCount;
-                desc.SampleDesc.Count = xrSwapchain.xrDesc.sampleCount;
+                desc.Format = !isSRGBDestination ? getTypelessFormat(xrSwapchain.dxgiFormatForSubmission)
+                                                 : DXGI_FORMAT_R16G16B16A16_TYPELESS;
+                desc.Width = intermediate->width;
+                desc.Height = intermediate->height;
+                desc.MipLevels = 1;
+                desc.SampleDesc.Count = 1;
                 desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
 
                 CHECK_HRCMD(m_pvrSubmissionDevice->CreateTexture2D(
-                    &desc, nullptr, xrSwapchain.resolved.ReleaseAndGetAddressOf()));
-                setDebugName(xrSwapchain.resolved.Get(), fmt::format("Resolved Texture[{}]", (void*)&xrSwapchain));
-            }
-            {
-                D3D11_BUFFER_DESC desc{};
-                desc.ByteWidth = 16; // Minimal size. We we only use 4 bytes.
-                desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-                desc.Usage = D3D11_USAGE_DYNAMIC;
-                desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-                CHECK_HRCMD(m_pvrSubmissionDevice->CreateBuffer(
-                    &desc, nullptr, xrSwapchain.convertConstants.ReleaseAndGetAddressOf()));
-                setDebugName(xrSwapchain.convertConstants.Get(),
-                             fmt::format("Convert Constants[{}]", (void*)&xrSwapchain));
+                    &desc, nullptr, intermediate->texture.ReleaseAndGetAddressOf()));
+                setDebugName(intermediate->texture.Get(),
+                             fmt::format("Intermediate Texture[{}, {}x{}]",
+                                         (int)viewFormat,
+                                         intermediate->width,
+                                         intermediate->height));
+                intermediate->sizeInBytes =
+                    (uint64_t)desc.Width * desc.Height * (DirectX::BitsPerPixel(desc.Format) / 8);
             }
             {
                 D3D11_UNORDERED_ACCESS_VIEW_DESC desc{};
 
                 desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-                if (!isSRGBDestination) {
-                    desc.Format = xrSwapchain.dxgiFormatForSubmission;
-                } else {
-                    desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-                }
+                desc.Format = viewFormat;
                 desc.Texture2D.MipSlice = 0;
 
                 CHECK_HRCMD(m_pvrSubmissionDevice->CreateUnorderedAccessView(
-                    xrSwapchain.resolved.Get(), &desc, xrSwapchain.convertAccessView.ReleaseAndGetAddressOf()));
-                setDebugName(xrSwapchain.convertAccessView.Get(), fmt::format("Convert UAV[{}]", (void*)&xrSwapchain));
+                    intermediate->texture.Get(), &desc, intermediate->accessView.ReleaseAndGetAddressOf()));
+                setDebugName(intermediate->accessView.Get(), fmt::format("Convert UAV[{}]", (void*)intermediate.get()));
             }
             if (isSRGBDestination) {
                 D3D11_SHADER_RESOURCE_VIEW_DESC desc{};
 
-                desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
                 // We only every use the SRV for color conversion when destination is SRGB.
-                desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-                desc.Texture2D.MipLevels = xrSwapchain.xrDesc.mipCount;
-                desc.Texture2D.MostDetailedMip = D3D11CalcSubresource(0, 0, desc.Texture2DArray.MipLevels);
+                desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+                desc.Format = viewFormat;
+                desc.Texture2D.MipLevels = 1;
+                desc.Texture2D.MostDetailedMip = 0;
 
                 CHECK_HRCMD(m_pvrSubmissionDevice->CreateShaderResourceView(
-                    xrSwapchain.resolved.Get(), &desc, xrSwapchain.convertResourceView.ReleaseAndGetAddressOf()));
-                setDebugName(xrSwapchain.convertResourceView.Get(),
-                             fmt::format("Convert SRV[{}]", (void*)&xrSwapchain));
+                    intermediate->texture.Get(), &desc, intermediate->resourceView.ReleaseAndGetAddressOf()));
+                setDebugName(intermediate->resourceView.Get(),
+                             fmt::format("Convert SRV[{}]", (void*)intermediate.get()));
+            }
+
+            entry = xrSwapchain.intermediate = std::move(intermediate);
+            traceIntermediateTexturePool();
+        }
+    }
+
+    // Report the video memory held by the intermediate textures, along with the usage of the whole adapter. Must be
+    // called with the pool mutex held.
+    void OpenXrRuntime::traceIntermediateTexturePool() const {
+        uint32_t count = 0;
+        uint64_t sizeInBytes = 0;
+        for (auto it = m_intermediateTexturePool.begin(); it != m_intermediateTexturePool.end();) {
+            const auto intermediate = it->second.lock();
+            if (!intermediate) {
+                it = m_intermediateTexturePool.erase(it);
+                continue;
+            }
+            count++;
+            sizeInBytes += intermediate->sizeInBytes;
+            it++;
+        }
+
+        DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo{};
+        ComPtr<IDXGIDevice> dxgiDevice;
+        ComPtr<IDXGIAdapter> dxgiAdapter;
+        ComPtr<IDXGIAdapter3> dxgiAdapter3;
+        if (SUCCEEDED(m_pvrSubmissionDevice.As(&dxgiDevice)) &&
+            SUCCEEDED(dxgiDevice->GetAdapter(dxgiAdapter.ReleaseAndGetAddressOf())) &&
+            SUCCEEDED(dxgiAdapter.As(&dxgiAdapter3))) {
+            dxgiAdapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo);
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "IntermediateTexturePool",
+                          TLArg(count, "Count"),
+                          TLArg(sizeInBytes, "Size"),
+                          TLArg(memoryInfo.CurrentUsage, "AdapterUsage"),
+                          TLArg(memoryInfo.Budget, "AdapterBudget"));
+    }
+
+    void OpenXrRuntime::ensureSwapchainImageResourceView(Swapchain& xrSwapchain, uint32_t slice, int index) const {
+        // Lazily create SRV.
+        if (!xrSwapchain.imagesResourceView[slice][index]) {
+            D3D11_SHADER_RESOURCE_VIEW_DESC desc{};
+
+            desc.ViewDimension = xrSwapchain.xrDesc.arraySize == 1 ? D3D11_SRV_DIMENSION_TEXTURE2D
+                                                                   : D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            desc.Format = xrSwapchain.dxgiFormatForSubmission;
+            desc.Texture2DArray.ArraySize = 1;
+            desc.Texture2DArray.MipLevels = xrSwapchain.xrDesc.mipCount;
+            desc.Texture2DArray.FirstArraySlice = D3D11CalcSubresource(0, slice, desc.Texture2DArray.MipLevels);
+
+            CHECK_HRCMD(m_pvrSubmissionDevice->CreateShaderResourceView(
+                xrSwapchain.images[index].Get(),
+                &desc,
+                xrSwapchain.imagesResourceView[slice][index].ReleaseAndGetAddressOf()));
+            setDebugName(xrSwapchain.imagesResourceView[slice][index].Get(),
+                         fmt::format("Convert SRV[{}, {}, {}]", slice, index, (void*)&xrSwapchain));
+        }
+    }
+
+    void OpenXrRuntime::ensureSwapchainEncodeAccessView(Swapchain& xrSwapchain, uint32_t slice, int index) const {
+        // Lazily create UAV.
+        if (xrSwapchain.encodeAccessView[slice].empty()) {
+            xrSwapchain.encodeAccessView[slice].resize(xrSwapchain.slices[slice].size());
+        }
+        if (!xrSwapchain.encodeAccessView[slice][index]) {
+            D3D11_UNORDERED_ACCESS_VIEW_DESC desc{};
+
+            desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+            desc.Format = DXGI_FORMAT_R32_UINT;
+            desc.Texture2D.MipSlice = 0;
+
+            CHECK_HRCMD(m_pvrSubmissionDevice->CreateUnorderedAccessView(
+                xrSwapchain.slices[slice][index].Get(),
+                &desc,
+                xrSwapchain.encodeAccessView[slice][index].ReleaseAndGetAddressOf()));
+            setDebugName(xrSwapchain.encodeAccessView[slice][index].Get(),
+                         fmt::format("Encode UAV[{}, {}, {}]", slice, index, (void*)&xrSwapchain));
+        }
+    }
+
+    void OpenXrRuntime::ensureSwapchainRenderTargetView(Swapchain& xrSwapchain, uint32_t slice, int index) const {
+        // Lazily create RTV.
+        if (!xrSwapchain.renderTargetView[slice][index]) {
+            D3D11_RENDER_TARGET_VIEW_DESC desc{};
+
+            // When rendering to a swapchain with slice > 0, we know the swapchain is always arraySize of 1.
+            desc.ViewDimension = (xrSwapchain.xrDesc.arraySize == 1) || slice > 0 ? D3D11_RTV_DIMENSION_TEXTURE2D
+                                                                                  : D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+            desc.Format = xrSwapchain.dxgiFormatForSubmission;
+            desc.Texture2DArray.ArraySize = 1;
+            desc.Texture2DArray.MipSlice = D3D11CalcSubresource(0, 0, xrSwapchain.xrDesc.mipCount);
+            desc.Texture2DArray.FirstArraySlice = slice;
+
+            CHECK_HRCMD(m_pvrSubmissionDevice->CreateRenderTargetView(
+                xrSwapchain.slices[slice][index].Get(),
+                &desc,
+                xrSwapchain.renderTargetView[slice][index].ReleaseAndGetAddressOf()));
+            setDebugName(xrSwapchain.renderTargetView[slice][index].Get(),
+                         fmt::format("Convert RTV[{}, {}, {}]", slice, index, (void*)&xrSwapchain));
+        }
+    }
+
+    // Create ahead of time all the resources that prepareAndCommitSwapchainImage() and flushPrecomposition() might
+    // otherwise create lazily upon the first submission of each image, in the middle of the frame loop.
+    void OpenXrRuntime::warmUpSwapchainResources(Swapchain& xrSwapchain) const {
+        // Depth buffers are submitted as-is.
+        if (xrSwapchain.xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            return;
+        }
+
+        TraceLoggingWrite(g_traceProvider, "WarmUpSwapchainResources", TLPArg(&xrSwapchain, "Swapchain"));
+
+        const int count = (int)xrSwapchain.images.size();
+        for (uint32_t slice = 0; slice < xrSwapchain.xrDesc.arraySize; slice++) {
+            ensureSwapchainSliceResources(xrSwapchain, slice);
+
+            const bool useSinglePass = canUseSinglePassPrecomposition(xrSwapchain, slice);
+            if (!useSinglePass) {
+                ensureSwapchainIntermediateResources(xrSwapchain);
+            }
+
+            for (int i = 0; i < count; i++) {
+                ensureSwapchainImageResourceView(xrSwapchain, slice, i);
+                if (useSinglePass) {
+                    ensureSwapchainEncodeAccessView(xrSwapchain, slice, i);
+                } else if (isSRGBFormat(xrSwapchain.dxgiFormatForSubmission)) {
+                    ensureSwapchainRenderTargetView(xrSwapchain, slice, i);
+                }
+            }
+        }
+    }
+
+    // Queue the resampling of a parallel view into the canted view of an eye, and return the PVR swapchain to submit
+    // instead of the application's swapchain. The work is done in flushParallelReprojection().
+    pvrTextureSwapChain OpenXrRuntime::queueParallelReprojection(Swapchain& xrSwapchain,
+                                                                 uint32_t layerIndex,
+                                                                 uint32_t eye,
+                                                                 const XrCompositionLayerProjectionView& view,
+                                                                 XrCompositionLayerFlags compositionFlags,
+                                                                 CommittedImageList& committed) {
+        const uint32_t slice = view.subImage.imageArrayIndex;
+        const int lastReleasedIndex = xrSwapchain.lastReleasedIndex;
+
+        ensureSwapchainImageResourceView(xrSwapchain, slice, lastReleasedIndex);
+
+        // The resampling writes the canted view, so it also takes care of the conversion to the submission format.
+        const DXGI_FORMAT targetFormat =
+            canConvertSubmissionFormat(xrSwapchain, m_projectionSubmissionFormat, layerIndex, compositionFlags)
+                ? m_projectionSubmissionFormat
+                : xrSwapchain.dxgiFormatForSubmission;
+        ensureParallelReprojectionTarget(eye, targetFormat, view.subImage.imageRect.extent);
+
+        ParallelReprojectionWork& work = m_parallelReprojectionWork.emplace_back();
+
+        // The application's swapchain is not submitted, but it must still be committed to keep the PVR swapchain in
+        // step with the images acquired by the application, see xrAcquireSwapchainImage().
+        if (!committed.contains(std::make_pair(xrSwapchain.pvrSwapchain[0], 0u))) {
+            work.needCommitSource = true;
+            committed.push_back(std::make_pair(xrSwapchain.pvrSwapchain[0], 0u));
+        }
+        work.swapchain = &xrSwapchain;
+        work.slice = slice;
+        work.sourceIndex = lastReleasedIndex;
+        work.eye = eye;
+        work.imageRect = view.subImage.imageRect;
+        work.fov = view.fov;
+        // Same as prepareAndCommitSwapchainImage().
+        work.needClearAlpha =
+            layerIndex > 0 && !(compositionFlags & XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT);
+        work.needPremultiplyAlpha = (m_honorPremultiplyFlagOnProj0 || layerIndex > 0) &&
+                                    (compositionFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT);
+
+        return m_parallelReprojectionTargets[eye].pvrSwapchain;
+    }
+
+    void OpenXrRuntime::ensureParallelReprojectionTarget(uint32_t eye,
+                                                         DXGI_FORMAT format,
+                                                         const XrExtent2Di& extent) {
+        ParallelReprojectionTarget& target = m_parallelReprojectionTargets[eye];
+        const pvrEyeType pvrEye = eye == xr::StereoView::Left ? pvrEye_Left : pvrEye_Right;
+
+        // Match the pixel density that the application renders the parallel view at.
+        if (!target.nominalSourceWidth) {
+            pvrSizei viewportSize{};
+            CHECK_PVRCMD(
+                pvr_getFovTextureSize(m_pvrSession, pvrEye, m_cachedEyeInfo[eye].Fov, 1.f, &viewportSize));
+            target.nominalSourceWidth = std::max(viewportSize.w, 1);
+        }
+        const float pixelDensity = (float)extent.width / target.nominalSourceWidth;
+        pvrSizei size{};
+        CHECK_PVRCMD(pvr_getFovTextureSize(m_pvrSession, pvrEye, m_cantedEyeInfo[eye].Fov, pixelDensity, &size));
+
+        if (target.pvrSwapchain && target.format == format &&
+            target.extent.width == size.w && target.extent.height == size.h) {
+            return;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "ParallelReprojectionTarget",
+                          TLArg(eye, "Eye"),
+                          TLArg(size.w, "Width"),
+                          TLArg(size.h, "Height"),
+                          TLArg((int)format, "Format"));
+
+        // The previous swapchain might still be referenced by a frame being submitted asynchronously.
+        if (m_useAsyncSubmission && !m_needStartAsyncSubmissionThread) {
+            waitForAsyncSubmissionIdle();
+        }
+        target.renderTargetViews.clear();
+        if (target.pvrSwapchain) {
+            pvr_destroyTextureSwapChain(m_pvrSession, target.pvrSwapchain);
+            target.pvrSwapchain = nullptr;
+        }
+
+        pvrTextureSwapChainDesc desc{};
+        desc.Type = pvrTexture_2D;
+        desc.ArraySize = 1;
+        desc.Width = target.extent.width = size.w;
+        desc.Height = target.extent.height = size.h;
+        desc.MipLevels = 1;
+        desc.SampleCount = 1;
+        target.format = format;
+        desc.Format = target.format == DXGI_FORMAT_R11G11B10_FLOAT ? PVR_FORMAT_R11G11B10_FLOAT
+                                                                   : dxgiToPvrTextureFormat(target.format);
+        desc.BindFlags = pvrTextureBind_DX_RenderTarget;
+        CHECK_PVRCMD(
+            pvr_createTextureSwapChainDX(m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &target.pvrSwapchain));
+
+        int length = 0;
+        CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, target.pvrSwapchain, &length));
+        for (int i = 0; i < length; i++) {
+            ComPtr<ID3D11Texture2D> texture;
+            CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
+                m_pvrSession, target.pvrSwapchain, i, IID_PPV_ARGS(texture.ReleaseAndGetAddressOf())));
+
+            D3D11_RENDER_TARGET_VIEW_DESC rtvDesc{};
+            rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+            rtvDesc.Format = target.format;
+            ComPtr<ID3D11RenderTargetView> rtv;
+            CHECK_HRCMD(
+                m_pvrSubmissionDevice->CreateRenderTargetView(texture.Get(), &rtvDesc, rtv.ReleaseAndGetAddressOf()));
+            setDebugName(rtv.Get(), fmt::format("ParallelReprojection RTV[{}, {}]", eye, i));
+
+            target.renderTargetViews.push_back(rtv);
+        }
+    }
+
+    // Run the resampling queued by queueParallelReprojection(), then commit the canted views.
+    void OpenXrRuntime::flushParallelReprojection() {
+        if (m_parallelReprojectionWork.empty()) {
+            return;
+        }
+
+        // We are about to do something destructive to the application context. Save the context. It will be
+        // restored at the end of xrEndFrame().
+        if (m_d3d11Device == m_pvrSubmissionDevice && !m_d3d11ContextState) {
+            m_pvrSubmissionContext->SwapDeviceContextState(m_pvrSubmissionContextState.Get(),
+                                                           m_d3d11ContextState.ReleaseAndGetAddressOf());
+        }
+
+        m_pvrSubmissionContext->ClearState();
+        m_pvrSubmissionContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        m_pvrSubmissionContext->RSSetState(m_noDepthRasterizer.Get());
+        m_pvrSubmissionContext->VSSetShader(m_fullQuadVS.Get(), nullptr, 0);
+        m_pvrSubmissionContext->PSSetSamplers(0, 1, m_linearClampSampler.GetAddressOf());
+        m_pvrSubmissionContext->PSSetConstantBuffers(0, 1, m_parallelReprojectionConstants.GetAddressOf());
+
+        for (const ParallelReprojectionWork& work : m_parallelReprojectionWork) {
+            Swapchain& xrSwapchain = *work.swapchain;
+            ParallelReprojectionTarget& target = m_parallelReprojectionTargets[work.eye];
+
+            // Both views are located at the eye, and the parallel view is not rotated relative to the head.
+            XrPosef cantedToParallel = pvrPoseToXrPose(m_cantedEyeInfo[work.eye].HmdToEyePose);
+            cantedToParallel.position = {0, 0, 0};
+            const XrVector3f axes[] = {Pose::Multiply(Pose::Translation({1, 0, 0}), cantedToParallel).position,
+                                       Pose::Multiply(Pose::Translation({0, 1, 0}), cantedToParallel).position,
+                                       Pose::Multiply(Pose::Translation({0, 0, 1}), cantedToParallel).position};
+
+            ParallelReprojectionPSConstants constants{};
+            constants.cantedToParallel[0] = {axes[0].x, axes[1].x, axes[2].x, 0};
+            constants.cantedToParallel[1] = {axes[0].y, axes[1].y, axes[2].y, 0};
+            constants.cantedToParallel[2] = {axes[0].z, axes[1].z, axes[2].z, 0};
+            const pvrFovPort& cantedFov = m_cantedEyeInfo[work.eye].Fov;
+            constants.destinationTan = {-cantedFov.LeftTan, cantedFov.RightTan, cantedFov.UpTan, -cantedFov.DownTan};
+            constants.sourceTan = {
+                tan(work.fov.angleLeft), tan(work.fov.angleRight), tan(work.fov.angleUp), tan(work.fov.angleDown)};
+            constants.sourceRect = {(float)work.imageRect.offset.x / xrSwapchain.xrDesc.width,
+                                    (float)work.imageRect.offset.y / xrSwapchain.xrDesc.height,
+                                    (float)work.imageRect.extent.width / xrSwapchain.xrDesc.width,
+                                    (float)work.imageRect.extent.height / xrSwapchain.xrDesc.height};
+            constants.ignoreAlpha = work.needClearAlpha;
+            constants.isUnpremultipliedAlpha = work.needPremultiplyAlpha;
+            {
+                D3D11_MAPPED_SUBRESOURCE mappedResources;
+                CHECK_HRCMD(m_pvrSubmissionContext->Map(
+                    m_parallelReprojectionConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResources));
+                memcpy(mappedResources.pData, &constants, sizeof(constants));
+                m_pvrSubmissionContext->Unmap(m_parallelReprojectionConstants.Get(), 0);
+            }
+
+            int pvrDestIndex = -1;
+            CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, target.pvrSwapchain, &pvrDestIndex));
+
+            m_pvrSubmissionContext->OMSetRenderTargets(
+                1, target.renderTargetViews[pvrDestIndex].GetAddressOf(), nullptr);
+            D3D11_VIEWPORT viewport{};
+            viewport.Width = (float)target.extent.width;
+            viewport.Height = (float)target.extent.height;
+            viewport.MaxDepth = 1.f;
+            m_pvrSubmissionContext->RSSetViewports(1, &viewport);
+            m_pvrSubmissionContext->PSSetShaderResources(
+                0, 1, xrSwapchain.imagesResourceView[work.slice][work.sourceIndex].GetAddressOf());
+            // 0: shader for Tex2D, 1: shader for Tex2DArray.
+            m_pvrSubmissionContext->PSSetShader(
+                m_parallelReprojectionPS[xrSwapchain.xrDesc.arraySize == 1 ? 0 : 1].Get(), nullptr, 0);
+            m_pvrSubmissionContext->Draw(3, 0);
+
+            // Unbind the target and the source to avoid D3D validation errors.
+            {
+                ID3D11RenderTargetView* nullRTV[] = {nullptr};
+                m_pvrSubmissionContext->OMSetRenderTargets(1, nullRTV, nullptr);
+                ID3D11ShaderResourceView* nullSRV[] = {nullptr};
+                m_pvrSubmissionContext->PSSetShaderResources(0, 1, nullSRV);
+            }
+
+            // Commit the textures to PVR.
+            CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, target.pvrSwapchain));
+            if (work.needCommitSource) {
+                CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, xrSwapchain.pvrSwapchain[0]));
+            }
+        }
+
+        m_pvrSubmissionContext->ClearState();
+        m_parallelReprojectionWork.clear();
+    }
+
+    void OpenXrRuntime::cleanupParallelReprojectionResources() {
+        for (ParallelReprojectionTarget& target : m_parallelReprojectionTargets) {
+            target.renderTargetViews.clear();
+            if (target.pvrSwapchain) {
+                pvr_destroyTextureSwapChain(m_pvrSession, target.pvrSwapchain);
             }
+            target = {};
         }
+        for (int i = 0; i < ARRAYSIZE(m_parallelReprojectionPS); i++) {
+            m_parallelReprojectionPS[i].Reset();
+        }
+        m_parallelReprojectionConstants.Reset();
+        m_parallelReprojectionWork.clear();
     }
 
     // Flush any pending work in the app context.
     void OpenXrRuntime::flushD3D11Context() {
         if (m_d3d11Context && m_d3d11Fence) {
-            wil::unique_handle eventHandle;
-            m_fenceValue++;
+            UINT64 fenceValue;
+            {
+                std::unique_lock lock(m_fenceMutex);
+
+                fenceValue = ++m_fenceValue;
+                CHECK_HRCMD(m_d3d11Context->Signal(m_d3d11Fence.Get(), fenceValue));
+            }
             TraceLoggingWrite(
-                g_traceProvider, "FlushContext_Wait", TLArg("D3D11", "Api"), TLArg(m_fenceValue, "FenceValue"));
-            CHECK_HRCMD(m_d3d11Context->Signal(m_d3d11Fence.Get(), m_fenceValue));
+                g_traceProvider, "FlushContext_Wait", TLArg("D3D11", "Api"), TLArg(fenceValue, "FenceValue"));
+            wil::unique_handle eventHandle;
             *eventHandle.put() = CreateEventEx(nullptr, L"Flush Fence", 0, EVENT_ALL_ACCESS);
-            CHECK_HRCMD(m_d3d11Fence->SetEventOnCompletion(m_fenceValue, eventHandle.get()));
+            CHECK_HRCMD(m_d3d11Fence->SetEventOnCompletion(fenceValue, eventHandle.get()));
             WaitForSingleObject(eventHandle.get(), INFINITE);
             ResetEvent(eventHandle.get());
         }
@@ -747,39 +1538,93 @@ namespace pimax_openxr {
 
     // Flush any pending work in the submission context.
     void OpenXrRuntime::flushSubmissionContext() {
-        wil::unique_handle eventHandle;
-        m_fenceValue++;
+        UINT64 fenceValue;
+        {
+            std::unique_lock lock(m_fenceMutex);
+
+            fenceValue = ++m_fenceValue;
+            CHECK_HRCMD(m_pvrSubmissionContext->Signal(m_pvrSubmissionFence.Get(), fenceValue));
+        }
         TraceLoggingWrite(
-            g_traceProvider, "FlushContext_Wait", TLArg("D3D11", "Api"), TLArg(m_fenceValue, "FenceValue"));
-        CHECK_HRCMD(m_pvrSubmissionContext->Signal(m_pvrSubmissionFence.Get(), m_fenceValue));
+            g_traceProvider, "FlushContext_Wait", TLArg("D3D11", "Api"), TLArg(fenceValue, "FenceValue"));
+        wil::unique_handle eventHandle;
         *eventHandle.put() = CreateEventEx(nullptr, L"Flush Fence", 0, EVENT_ALL_ACCESS);
-        CHECK_HRCMD(m_pvrSubmissionFence->SetEventOnCompletion(m_fenceValue, eventHandle.get()));
+        CHECK_HRCMD(m_pvrSubmissionFence->SetEventOnCompletion(fenceValue, eventHandle.get()));
         WaitForSingleObject(eventHandle.get(), INFINITE);
         ResetEvent(eventHandle.get());
     }
 
+    // Wait on the CPU for the shared fence to reach a value, typically signaled from the application device.
+    void OpenXrRuntime::waitForSubmissionFenceValue(UINT64 value) {
+        if (m_pvrSubmissionFence->GetCompletedValue() >= value) {
+            return;
+        }
+
+        // Each waiting thread uses its own event, so that concurrent waits do not consume each other's signal. A slow
+        // frame is not an error: keep waiting, but leave a trace in case the device was lost.
+        thread_local wil::unique_handle eventHandle;
+        if (!eventHandle) {
+            *eventHandle.put() = CreateEventEx(nullptr, L"Submission Fence", 0, EVENT_ALL_ACCESS);
+        }
+        CHECK_HRCMD(m_pvrSubmissionFence->SetEventOnCompletion(value, eventHandle.get()));
+        while (WaitForSingleObject(eventHandle.get(), 1000) == WAIT_TIMEOUT) {
+            Log("Still waiting for the submission fence to reach %llu (currently %llu)\n",
+                value,
+                m_pvrSubmissionFence->GetCompletedValue());
+        }
+    }
+
     // Serialize commands from the application context to the D3D11 context used by PVR.
     void OpenXrRuntime::serializeD3D11Frame() {
         if (m_pvrSubmissionDevice != m_d3d11Device) {
-            m_fenceValue++;
+            {
+                std::unique_lock lock(m_fenceMutex);
+
+                m_frameFenceValue = ++m_fenceValue;
+                CHECK_HRCMD(m_d3d11Context->Signal(m_d3d11Fence.Get(), m_frameFenceValue));
+            }
             TraceLoggingWrite(
-                g_traceProvider, "xrEndFrame_Sync", TLArg("D3D11", "Api"), TLArg(m_fenceValue, "FenceValue"));
-            CHECK_HRCMD(m_d3d11Context->Signal(m_d3d11Fence.Get(), m_fenceValue));
+                g_traceProvider, "xrEndFrame_Sync", TLArg("D3D11", "Api"), TLArg(m_frameFenceValue, "FenceValue"));
 
             waitOnSubmissionDevice();
         }
     }
 
     void OpenXrRuntime::waitOnSubmissionDevice() {
+        // With asynchronous commit, the submission thread does the wait before processing the frame, see
+        // flushAsyncCommit().
+        if (!m_useAsyncCommit) {
+            waitOnSubmissionDevice(m_frameFenceValue);
+        }
+    }
+
+    void OpenXrRuntime::waitOnSubmissionDevice(uint64_t fenceValue) {
         if (!m_syncGpuWorkInEndFrame) {
-            CHECK_HRCMD(m_pvrSubmissionContext->Wait(m_pvrSubmissionFence.Get(), m_fenceValue));
+            CHECK_HRCMD(m_pvrSubmissionContext->Wait(m_pvrSubmissionFence.Get(), fenceValue));
         } else {
             // Workaround: PVR does not seem to reliably measure GPU frame times and therefore choses an incorrect rate
             // for smart smoothing. By waiting on the CPU here, we force the CPU time measure the same as GPU time.
-            CHECK_HRCMD(m_pvrSubmissionFence->SetEventOnCompletion(m_fenceValue, m_eventForSubmissionFence.get()));
-            WaitForSingleObject(m_eventForSubmissionFence.get(), INFINITE);
-            ResetEvent(m_eventForSubmissionFence.get());
+            waitForSubmissionFenceValue(fenceValue);
+        }
+    }
+
+    // With asynchronous commit, process and commit the swapchain images of a frame from the submission thread. The
+    // work was queued by xrEndFrame(), and the GPU waits for the application to be done rendering before running it.
+    void OpenXrRuntime::flushAsyncCommit(uint64_t fenceValue) {
+        TraceLocalActivity(local);
+        TraceLoggingWriteStart(local, "AsyncCommit", TLArg(fenceValue, "FenceValue"));
+
+        waitOnSubmissionDevice(fenceValue);
+        flushPrecomposition();
+        flushParallelReprojection();
+
+        // The timer was started by xrEndFrame().
+        if (IsTraceEnabled() || m_telemetry.isActive()) {
+            m_gpuTimerPrecomposition->stop();
+            m_gpuTimestampsPrecomposition->nextFrame();
         }
+
+        TraceLoggingWriteStop(local, "AsyncCommit");
     }
 
 } // namespace pimax_openxr
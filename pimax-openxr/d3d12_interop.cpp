@@ -26,6 +26,9 @@
 #include "runtime.h"
 #include "utils.h"
 
+#include "AlphaBlendingSRGBCS.h"
+#include "AlphaBlendingTexArraySRGBCS.h"
+
 // Implements the necessary support for the XR_KHR_D3D12_enable extension:
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_KHR_D3D12_enable
 
@@ -34,6 +37,38 @@ namespace pimax_openxr {
     using namespace pimax_openxr::log;
     using namespace pimax_openxr::utils;
 
+    // Root parameters for the alpha correction shaders. The constants (b0) are passed as root constants, with the
+    // same layout as the constant buffer used on D3D11.
+    enum D3D12AlphaCorrectRootParameter : UINT {
+        Constants = 0,
+        SourceTable,
+        DestinationTable,
+        RootParameterCount,
+    };
+    constexpr UINT k_alphaCorrectConstantsCount = 3;
+
+    // The state of an application swapchain image outside of the application's use.
+    static D3D12_RESOURCE_STATES getSwapchainImageState(const XrSwapchainCreateInfo& xrDesc) {
+        if (xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT) {
+            return D3D12_RESOURCE_STATE_RENDER_TARGET;
+        } else if (xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+        }
+        return D3D12_RESOURCE_STATE_COMMON;
+    }
+
+    static D3D12_RESOURCE_BARRIER makeTransition(ID3D12Resource* resource,
+                                                 D3D12_RESOURCE_STATES stateBefore,
+                                                 D3D12_RESOURCE_STATES stateAfter) {
+        D3D12_RESOURCE_BARRIER barrier{};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = resource;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = stateBefore;
+        barrier.Transition.StateAfter = stateAfter;
+        return barrier;
+    }
+
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetD3D12GraphicsRequirementsKHR
     XrResult OpenXrRuntime::xrGetD3D12GraphicsRequirementsKHR(XrInstance instance,
                                                               XrSystemId systemId,
@@ -59,6 +94,11 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
+        // The adapter LUID is not stable across reboots, so it cannot come from the cached system.
+        if (!ensureLiveSystem()) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+
         memcpy(&graphicsRequirements->adapterLuid, &m_adapterLuid, sizeof(LUID));
         graphicsRequirements->minFeatureLevel = D3D_FEATURE_LEVEL_12_0;
 
@@ -129,21 +169,149 @@ namespace pimax_openxr {
                                                      nullptr,
                                                      IID_PPV_ARGS(m_d3d12CommandList.ReleaseAndGetAddressOf())));
         CHECK_HRCMD(m_d3d12CommandList->Close());
+        *m_eventForD3D12Fence.put() = CreateEventEx(nullptr, L"D3D12 Fence", 0, EVENT_ALL_ACCESS);
 
         // Frame timers.
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i] = std::make_unique<D3D12GpuTimer>(m_d3d12Device.Get(), m_d3d12CommandQueue.Get());
+        m_gpuTimestampsApp = std::make_unique<D3D12TimestampPool>(
+            m_d3d12Device.Get(), m_d3d12CommandQueue.Get(), k_maxGpuTimersPerPool, k_gpuTimersLatency);
+        m_gpuTimerApp = std::make_unique<GpuTimer>(*m_gpuTimestampsApp);
+
+        m_useD3D12Precomposition = getSetting("d3d12_native_precomposition").value_or(true);
+        TraceLoggingWrite(g_traceProvider,
+                          "xrCreateSession",
+                          TLArg("D3D12", "Api"),
+                          TLArg(m_useD3D12Precomposition, "NativePrecomposition"));
+        if (m_useD3D12Precomposition) {
+            initializeD3D12Precomposition();
         }
 
         return XR_SUCCESS;
     }
 
+    // Initialize the resources to perform precomposition directly on the application queue, instead of serializing
+    // the frame to the submission device first.
+    void OpenXrRuntime::initializeD3D12Precomposition() {
+        {
+            D3D12_DESCRIPTOR_RANGE sourceRange{};
+            sourceRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+            sourceRange.NumDescriptors = 1;
+            D3D12_DESCRIPTOR_RANGE destinationRange{};
+            destinationRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+            destinationRange.NumDescriptors = 1;
+
+            D3D12_ROOT_PARAMETER parameters[RootParameterCount]{};
+            parameters[Constants].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+            parameters[Constants].Constants.Num32BitValues = k_alphaCorrectConstantsCount;
+            parameters[SourceTable].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+            parameters[SourceTable].DescriptorTable.NumDescriptorRanges = 1;
+            parameters[SourceTable].DescriptorTable.pDescriptorRanges = &sourceRange;
+            parameters[DestinationTable].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+            parameters[DestinationTable].DescriptorTable.NumDescriptorRanges = 1;
+            parameters[DestinationTable].DescriptorTable.pDescriptorRanges = &destinationRange;
+
+            D3D12_ROOT_SIGNATURE_DESC desc{};
+            desc.NumParameters = RootParameterCount;
+            desc.pParameters = parameters;
+
+            ComPtr<ID3DBlob> serialized;
+            ComPtr<ID3DBlob> errors;
+            CHECK_HRCMD(D3D12SerializeRootSignature(&desc,
+                                                    D3D_ROOT_SIGNATURE_VERSION_1,
+                                                    serialized.ReleaseAndGetAddressOf(),
+                                                    errors.ReleaseAndGetAddressOf()));
+            CHECK_HRCMD(m_d3d12Device->CreateRootSignature(
+                0,
+                serialized->GetBufferPointer(),
+                serialized->GetBufferSize(),
+                IID_PPV_ARGS(m_d3d12AlphaCorrectRootSignature.ReleaseAndGetAddressOf())));
+            m_d3d12AlphaCorrectRootSignature->SetName(L"AlphaBlending Root Signature");
+        }
+
+        // Only the shaders writing directly to the PVR swapchain are needed, see canUseD3D12Precomposition().
+        {
+            D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+            desc.pRootSignature = m_d3d12AlphaCorrectRootSignature.Get();
+            desc.CS = {g_AlphaBlendingSRGBCS, sizeof(g_AlphaBlendingSRGBCS)};
+            CHECK_HRCMD(m_d3d12Device->CreateComputePipelineState(
+                &desc, IID_PPV_ARGS(m_d3d12AlphaCorrectSRGBPipeline[0].ReleaseAndGetAddressOf())));
+            m_d3d12AlphaCorrectSRGBPipeline[0]->SetName(L"AlphaBlendingSRGB CS");
+            desc.CS = {g_AlphaBlendingTexArraySRGBCS, sizeof(g_AlphaBlendingTexArraySRGBCS)};
+            CHECK_HRCMD(m_d3d12Device->CreateComputePipelineState(
+                &desc, IID_PPV_ARGS(m_d3d12AlphaCorrectSRGBPipeline[1].ReleaseAndGetAddressOf())));
+            m_d3d12AlphaCorrectSRGBPipeline[1]->SetName(L"AlphaBlendingSRGB CS");
+        }
+
+        // One SRV and one UAV per layer and per frame slot.
+        {
+            D3D12_DESCRIPTOR_HEAP_DESC desc{};
+            desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+            desc.NumDescriptors = (UINT)(k_maxPrecompositionWork * 2 * k_d3d12PrecompositionLatency);
+            desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+            CHECK_HRCMD(m_d3d12Device->CreateDescriptorHeap(
+                &desc, IID_PPV_ARGS(m_d3d12PrecompositionHeap.ReleaseAndGetAddressOf())));
+            m_d3d12PrecompositionHeap->SetName(L"Precomposition Descriptor Heap");
+            m_d3d12DescriptorSize =
+                m_d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        }
+
+        for (uint32_t i = 0; i < k_d3d12PrecompositionLatency; i++) {
+            CHECK_HRCMD(m_d3d12Device->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                IID_PPV_ARGS(m_d3d12PrecompositionAllocator[i].ReleaseAndGetAddressOf())));
+            m_d3d12PrecompositionAllocator[i]->SetName(L"Precomposition Command Allocator");
+            m_d3d12PrecompositionFenceValue[i] = 0;
+        }
+        CHECK_HRCMD(m_d3d12Device->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            m_d3d12PrecompositionAllocator[0].Get(),
+            nullptr,
+            IID_PPV_ARGS(m_d3d12PrecompositionCommandList.ReleaseAndGetAddressOf())));
+        m_d3d12PrecompositionCommandList->SetName(L"Precomposition Command List");
+        CHECK_HRCMD(m_d3d12PrecompositionCommandList->Close());
+        m_d3d12PrecompositionSlot = 0;
+
+        // A high priority queue lets the precomposition preempt the application's GPU work.
+        if (m_useHighPrioritySubmission) {
+            D3D12_COMMAND_QUEUE_DESC desc{};
+            desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+            desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_HIGH;
+            CHECK_HRCMD(m_d3d12Device->CreateCommandQueue(
+                &desc, IID_PPV_ARGS(m_d3d12PrecompositionQueue.ReleaseAndGetAddressOf())));
+            m_d3d12PrecompositionQueue->SetName(L"Precomposition Queue");
+        }
+
+        // Measure the precomposition where it now happens.
+        m_gpuTimestampsPrecomposition = std::make_unique<D3D12TimestampPool>(
+            m_d3d12Device.Get(),
+            m_d3d12PrecompositionQueue ? m_d3d12PrecompositionQueue.Get() : m_d3d12CommandQueue.Get(),
+            k_maxGpuTimersPerPool,
+            k_gpuTimersLatency);
+        m_gpuTimerPrecomposition = std::make_unique<GpuTimer>(*m_gpuTimestampsPrecomposition);
+    }
+
     void OpenXrRuntime::cleanupD3D12() {
         flushD3D12CommandQueue();
 
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i].reset();
+        if (m_useD3D12Precomposition) {
+            m_gpuTimerPrecomposition.reset();
+            m_gpuTimestampsPrecomposition.reset();
+        }
+        m_d3d12PrecompositionCommandList.Reset();
+        for (uint32_t i = 0; i < k_d3d12PrecompositionLatency; i++) {
+            m_d3d12PrecompositionAllocator[i].Reset();
         }
+        m_d3d12PrecompositionHeap.Reset();
+        m_d3d12PrecompositionQueue.Reset();
+        for (uint32_t i = 0; i < ARRAYSIZE(m_d3d12AlphaCorrectSRGBPipeline); i++) {
+            m_d3d12AlphaCorrectSRGBPipeline[i].Reset();
+        }
+        m_d3d12AlphaCorrectRootSignature.Reset();
+        m_useD3D12Precomposition = false;
+
+        m_gpuTimerApp.reset();
+        m_gpuTimestampsApp.reset();
+        m_eventForD3D12Fence.reset();
         m_d3d12CommandList.Reset();
         m_d3d12CommandAllocator.Reset();
         m_d3d12Fence.Reset();
@@ -196,15 +364,8 @@ namespace pimax_openxr {
                 xrSwapchain.d3d12Images.push_back(d3d12Resource);
 
                 if (needTransition) {
-                    D3D12_RESOURCE_BARRIER barrier{};
-                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-                    barrier.Transition.pResource = d3d12Resource.Get();
-                    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
-                    barrier.Transition.StateAfter =
-                        xrSwapchain.xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT
-                            ? D3D12_RESOURCE_STATE_RENDER_TARGET
-                            : D3D12_RESOURCE_STATE_DEPTH_WRITE;
+                    const D3D12_RESOURCE_BARRIER barrier = makeTransition(
+                        d3d12Resource.Get(), D3D12_RESOURCE_STATE_COMMON, getSwapchainImageState(xrSwapchain.xrDesc));
                     m_d3d12CommandList->ResourceBarrier(1, &barrier);
                 }
             }
@@ -246,25 +407,279 @@ namespace pimax_openxr {
     // Wait for all pending commands to finish.
     void OpenXrRuntime::flushD3D12CommandQueue() {
         if (m_d3d12CommandQueue && m_d3d12Fence) {
-            wil::unique_handle eventHandle;
-            m_fenceValue++;
+            UINT64 fenceValue;
+            {
+                std::unique_lock lock(m_fenceMutex);
+
+                // Keep the fence values monotonic: the precomposition queue may not have signaled its last value yet.
+                if (m_d3d12PrecompositionQueue) {
+                    CHECK_HRCMD(m_d3d12CommandQueue->Wait(m_d3d12Fence.Get(), m_fenceValue));
+                }
+                fenceValue = ++m_fenceValue;
+                m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), fenceValue);
+            }
             TraceLoggingWrite(
-                g_traceProvider, "FlushContext_Wait", TLArg("D3D12", "Api"), TLArg(m_fenceValue, "FenceValue"));
-            m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), m_fenceValue);
-            *eventHandle.put() = CreateEventEx(nullptr, L"Flush Fence", 0, EVENT_ALL_ACCESS);
-            CHECK_HRCMD(m_d3d12Fence->SetEventOnCompletion(m_fenceValue, eventHandle.get()));
-            WaitForSingleObject(eventHandle.get(), INFINITE);
-            ResetEvent(eventHandle.get());
+                g_traceProvider, "FlushContext_Wait", TLArg("D3D12", "Api"), TLArg(fenceValue, "FenceValue"));
+            waitForD3D12FenceValue(fenceValue);
         }
     }
 
-    // Serialize commands from the D3D12 queue to the D3D11 context used by PVR.
+    // Wait on the CPU for the application queue to reach a fence value.
+    void OpenXrRuntime::waitForD3D12FenceValue(UINT64 value) {
+        if (m_d3d12Fence->GetCompletedValue() >= value) {
+            return;
+        }
+
+        CHECK_HRCMD(m_d3d12Fence->SetEventOnCompletion(value, m_eventForD3D12Fence.get()));
+        WaitForSingleObject(m_eventForD3D12Fence.get(), INFINITE);
+        ResetEvent(m_eventForD3D12Fence.get());
+    }
+
+    // Serialize commands from the D3D12 queue to the D3D11 context used by PVR. With high priority submission, the
+    // precomposition queue is the last one to touch the frame, see beginD3D12Precomposition().
     void OpenXrRuntime::serializeD3D12Frame() {
-        m_fenceValue++;
-        TraceLoggingWrite(g_traceProvider, "xrEndFrame_Sync", TLArg("D3D12", "Api"), TLArg(m_fenceValue, "FenceValue"));
-        CHECK_HRCMD(m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), m_fenceValue));
+        {
+            std::unique_lock lock(m_fenceMutex);
+
+            m_frameFenceValue = ++m_fenceValue;
+            ID3D12CommandQueue* const queue =
+                m_d3d12PrecompositionQueue ? m_d3d12PrecompositionQueue.Get() : m_d3d12CommandQueue.Get();
+            CHECK_HRCMD(queue->Signal(m_d3d12Fence.Get(), m_frameFenceValue));
+        }
+        TraceLoggingWrite(
+            g_traceProvider, "xrEndFrame_Sync", TLArg("D3D12", "Api"), TLArg(m_frameFenceValue, "FenceValue"));
 
         waitOnSubmissionDevice();
     }
 
+    // With high priority submission, make the precomposition queue wait for the application to be done rendering the
+    // frame. This must happen before the precomposition timer is started, to only measure the precomposition.
+    void OpenXrRuntime::beginD3D12Precomposition() {
+        if (!m_d3d12PrecompositionQueue) {
+            return;
+        }
+
+        std::unique_lock lock(m_fenceMutex);
+
+        // Keep the fence values monotonic: the precomposition queue may not have signaled its last value yet.
+        CHECK_HRCMD(m_d3d12CommandQueue->Wait(m_d3d12Fence.Get(), m_fenceValue));
+        const UINT64 fenceValue = ++m_fenceValue;
+        TraceLoggingWrite(
+            g_traceProvider, "xrEndFrame_Sync", TLArg("D3D12Precomposition", "Api"), TLArg(fenceValue, "FenceValue"));
+        CHECK_HRCMD(m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), fenceValue));
+        CHECK_HRCMD(m_d3d12PrecompositionQueue->Wait(m_d3d12Fence.Get(), fenceValue));
+    }
+
+    // Whether the precomposition of a swapchain image can be recorded on the D3D12 queue. Alpha correction going
+    // through the intermediate texture is left to the submission device.
+    bool OpenXrRuntime::canUseD3D12Precomposition(const Swapchain& xrSwapchain,
+                                                  uint32_t slice,
+                                                  bool needCopy,
+                                                  bool needAlphaCorrection) const {
+        return needCopy || !needAlphaCorrection || canUseSinglePassPrecomposition(xrSwapchain, slice);
+    }
+
+    // Retrieve an image of the PVR swapchain for a slice on the D3D12 device. The images of slice 0 are the ones
+    // exported to the application, unless the application did not enumerate them (static images).
+    ID3D12Resource* OpenXrRuntime::getD3D12SliceImage(Swapchain& xrSwapchain, uint32_t slice, int index) {
+        if (slice == 0 && index < xrSwapchain.d3d12Images.size()) {
+            return xrSwapchain.d3d12Images[index].Get();
+        }
+
+        auto& images = xrSwapchain.d3d12Slices[slice];
+        if (images.empty()) {
+            images.resize(xrSwapchain.slices[slice].size());
+        }
+        if (!images[index]) {
+            ComPtr<IDXGIResource1> dxgiResource;
+            CHECK_HRCMD(xrSwapchain.slices[slice][index]->QueryInterface(
+                IID_PPV_ARGS(dxgiResource.ReleaseAndGetAddressOf())));
+
+            HANDLE textureHandle;
+            CHECK_HRCMD(dxgiResource->GetSharedHandle(&textureHandle));
+
+            CHECK_HRCMD(m_d3d12Device->OpenSharedHandle(textureHandle,
+                                                        IID_PPV_ARGS(images[index].ReleaseAndGetAddressOf())));
+            setDebugName(images[index].Get(),
+                         fmt::format("Runtime Slice Texture[{}, {}, {}]", slice, index, (void*)&xrSwapchain));
+        }
+        return images[index].Get();
+    }
+
+    // Record the precomposition queued by prepareAndCommitSwapchainImage() on the application queue (or the high
+    // priority precomposition queue), serialize the frame to the submission device, then commit the textures. The work
+    // that cannot be done on D3D12 is left for flushPrecomposition().
+    void OpenXrRuntime::flushPrecompositionD3D12() {
+        decltype(m_precompositionWork) processedWork;
+        decltype(m_precompositionWork) remainingWork;
+
+        const uint32_t frameSlot = m_d3d12PrecompositionSlot;
+        ID3D12CommandAllocator* const allocator = m_d3d12PrecompositionAllocator[frameSlot].Get();
+        ID3D12GraphicsCommandList* const commandList = m_d3d12PrecompositionCommandList.Get();
+        const UINT firstDescriptor = (UINT)(frameSlot * k_maxPrecompositionWork * 2);
+        const auto cpuDescriptor = [&](UINT index) {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle = m_d3d12PrecompositionHeap->GetCPUDescriptorHandleForHeapStart();
+            handle.ptr += (SIZE_T)(firstDescriptor + index) * m_d3d12DescriptorSize;
+            return handle;
+        };
+        const auto gpuDescriptor = [&](UINT index) {
+            D3D12_GPU_DESCRIPTOR_HANDLE handle = m_d3d12PrecompositionHeap->GetGPUDescriptorHandleForHeapStart();
+            handle.ptr += (UINT64)(firstDescriptor + index) * m_d3d12DescriptorSize;
+            return handle;
+        };
+
+        bool hasCommands = false;
+        bool isRootSignatureBound = false;
+        ID3D12PipelineState* boundPipeline = nullptr;
+        for (size_t i = 0; i < m_precompositionWork.size(); i++) {
+            const PrecompositionWork& work = m_precompositionWork[i];
+            Swapchain& xrSwapchain = *work.swapchain;
+            const uint32_t slice = work.slice;
+            const bool needAlphaCorrection = work.needClearAlpha || work.needPremultiplyAlpha;
+
+            // The conversion to the submission format is only implemented with D3D11.
+            if (work.needConvert ||
+                !canUseD3D12Precomposition(xrSwapchain, slice, work.needCopy, needAlphaCorrection)) {
+                remainingWork.push_back(work);
+                continue;
+            }
+            processedWork.push_back(work);
+
+            ID3D12Resource* const source = xrSwapchain.d3d12Images[work.sourceIndex].Get();
+            ID3D12Resource* const destination = getD3D12SliceImage(xrSwapchain, slice, work.destIndex);
+            if (!needAlphaCorrection && (!work.needCopy || source == destination)) {
+                // Nothing to do but committing the texture.
+                continue;
+            }
+
+            if (!hasCommands) {
+                // Wait for the GPU to be done with the commands and descriptors previously recorded for this frame
+                // slot. The application queue is rarely that far behind, so this is not expected to block.
+                waitForD3D12FenceValue(m_d3d12PrecompositionFenceValue[frameSlot]);
+                CHECK_HRCMD(allocator->Reset());
+                CHECK_HRCMD(commandList->Reset(allocator, nullptr));
+                hasCommands = true;
+            }
+
+            // Images that the application never saw are left in the common state.
+            const D3D12_RESOURCE_STATES sourceState = getSwapchainImageState(xrSwapchain.xrDesc);
+            const D3D12_RESOURCE_STATES destinationState =
+                slice == 0 && work.destIndex < xrSwapchain.d3d12Images.size() ? sourceState
+                                                                              : D3D12_RESOURCE_STATE_COMMON;
+
+            if (work.needCopy) {
+                // See prepareAndCommitSwapchainImage() for why we need copies.
+                D3D12_RESOURCE_BARRIER barriers[] = {
+                    makeTransition(source, sourceState, D3D12_RESOURCE_STATE_COPY_SOURCE),
+                    makeTransition(destination, destinationState, D3D12_RESOURCE_STATE_COPY_DEST)};
+                commandList->ResourceBarrier(ARRAYSIZE(barriers), barriers);
+
+                D3D12_TEXTURE_COPY_LOCATION sourceLocation{};
+                sourceLocation.pResource = source;
+                sourceLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                sourceLocation.SubresourceIndex =
+                    D3D12CalcSubresource(0, slice, 0, xrSwapchain.xrDesc.mipCount, xrSwapchain.xrDesc.arraySize);
+                D3D12_TEXTURE_COPY_LOCATION destinationLocation{};
+                destinationLocation.pResource = destination;
+                destinationLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                destinationLocation.SubresourceIndex = 0;
+                commandList->CopyTextureRegion(&destinationLocation, 0, 0, 0, &sourceLocation, nullptr);
+
+                for (auto& barrier : barriers) {
+                    std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+                }
+                commandList->ResourceBarrier(ARRAYSIZE(barriers), barriers);
+            } else {
+                const bool isInPlace = source == destination;
+                const UINT sourceDescriptor = (UINT)(i * 2);
+                const UINT destinationDescriptor = sourceDescriptor + 1;
+
+                // When the source image is also the destination, the shader only reads from the UAV.
+                {
+                    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+                    desc.Format = xrSwapchain.dxgiFormatForSubmission;
+                    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+                    if (xrSwapchain.xrDesc.arraySize == 1) {
+                        desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+                        desc.Texture2D.MipLevels = xrSwapchain.xrDesc.mipCount;
+                    } else {
+                        desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+                        desc.Texture2DArray.MipLevels = xrSwapchain.xrDesc.mipCount;
+                        desc.Texture2DArray.FirstArraySlice = slice;
+                        desc.Texture2DArray.ArraySize = 1;
+                    }
+                    m_d3d12Device->CreateShaderResourceView(
+                        !isInPlace ? source : nullptr, &desc, cpuDescriptor(sourceDescriptor));
+                }
+                {
+                    D3D12_UNORDERED_ACCESS_VIEW_DESC desc{};
+                    desc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+                    desc.Format = DXGI_FORMAT_R32_UINT;
+                    desc.Texture2D.MipSlice = 0;
+                    m_d3d12Device->CreateUnorderedAccessView(
+                        destination, nullptr, &desc, cpuDescriptor(destinationDescriptor));
+                }
+
+                FixedVector<D3D12_RESOURCE_BARRIER, 2> barriers;
+                barriers.push_back(
+                    makeTransition(destination, destinationState, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+                if (!isInPlace) {
+                    barriers.push_back(
+                        makeTransition(source, sourceState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+                }
+                commandList->ResourceBarrier((UINT)barriers.size(), barriers.begin());
+
+                if (!isRootSignatureBound) {
+                    ID3D12DescriptorHeap* const heaps[] = {m_d3d12PrecompositionHeap.Get()};
+                    commandList->SetDescriptorHeaps(ARRAYSIZE(heaps), heaps);
+                    commandList->SetComputeRootSignature(m_d3d12AlphaCorrectRootSignature.Get());
+                    isRootSignatureBound = true;
+                }
+
+                // 0: shader for Tex2D, 1: shader for Tex2DArray.
+                const int shaderToUse = xrSwapchain.xrDesc.arraySize == 1 ? 0 : 1;
+                ID3D12PipelineState* const pipeline = m_d3d12AlphaCorrectSRGBPipeline[shaderToUse].Get();
+                if (pipeline != boundPipeline) {
+                    commandList->SetPipelineState(pipeline);
+                    boundPipeline = pipeline;
+                }
+
+                const UINT constants[k_alphaCorrectConstantsCount] = {
+                    work.needClearAlpha, work.needPremultiplyAlpha, isInPlace};
+                commandList->SetComputeRoot32BitConstants(Constants, ARRAYSIZE(constants), constants, 0);
+                commandList->SetComputeRootDescriptorTable(SourceTable, gpuDescriptor(sourceDescriptor));
+                commandList->SetComputeRootDescriptorTable(DestinationTable, gpuDescriptor(destinationDescriptor));
+                commandList->Dispatch((xrSwapchain.xrDesc.width + 31) / 32, (xrSwapchain.xrDesc.height + 31) / 32, 1);
+
+                for (auto& barrier : barriers) {
+                    std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+                }
+                commandList->ResourceBarrier((UINT)barriers.size(), barriers.begin());
+            }
+        }
+
+        if (hasCommands) {
+            CHECK_HRCMD(commandList->Close());
+            ID3D12CommandQueue* const queue =
+                m_d3d12PrecompositionQueue ? m_d3d12PrecompositionQueue.Get() : m_d3d12CommandQueue.Get();
+            queue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList* const*>(&commandList));
+        }
+
+        // The precomposition is part of the work that the submission device waits for.
+        serializeD3D12Frame();
+
+        if (hasCommands) {
+            m_d3d12PrecompositionFenceValue[frameSlot] = m_frameFenceValue;
+            m_d3d12PrecompositionSlot = (frameSlot + 1) % k_d3d12PrecompositionLatency;
+        }
+
+        // Commit the textures to PVR.
+        for (const PrecompositionWork& work : processedWork) {
+            work.swapchain->lastProcessedIndex[work.slice] = work.sourceIndex;
+            CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, work.swapchain->pvrSwapchain[work.slice]));
+        }
+
+        m_precompositionWork = remainingWork;
+    }
+
 } // namespace pimax_openxr
@@ -34,84 +34,203 @@ namespace pimax_openxr {
     using namespace pimax_openxr::utils;
     using namespace xr::math;
 
+    namespace {
+
+        // Use polar coordinates to create a unit vector from the gaze tangents.
+        XrVector3f gazeTangentsToUnitVector(float tanHorizontal, float tanVertical) {
+            const float angleHorizontal = atan(tanHorizontal);
+            const float angleVertical = atan(tanVertical);
+            return {
+                sin(angleHorizontal) * cos(angleVertical),
+                -sin(angleVertical),
+                -cos(angleHorizontal) * cos(angleVertical),
+            };
+        }
+
+        // Find the point where the gaze rays of both eyes converge, and return the direction to that point from the
+        // center of the eyes. Falls back to averaging both eyes when the rays do not converge in front of the user.
+        XrVector3f getVergenceGaze(const pvrEyeTrackingInfo& state, const XrVector3f eyePosition[]) {
+            const XrVector3f& leftOrigin = eyePosition[xr::StereoView::Left];
+            const XrVector3f& rightOrigin = eyePosition[xr::StereoView::Right];
+            const XrVector3f leftDirection = gazeTangentsToUnitVector(state.GazeTan[xr::StereoView::Left].x,
+                                                                      state.GazeTan[xr::StereoView::Left].y);
+            const XrVector3f rightDirection = gazeTangentsToUnitVector(state.GazeTan[xr::StereoView::Right].x,
+                                                                       state.GazeTan[xr::StereoView::Right].y);
+
+            // Closest points between the two rays.
+            const XrVector3f w0 = leftOrigin - rightOrigin;
+            const float b = Dot(leftDirection, rightDirection);
+            const float d = Dot(leftDirection, w0);
+            const float e = Dot(rightDirection, w0);
+            const float denominator = 1.f - b * b;
+            if (denominator > 1e-6f) {
+                const float s = (b * e - d) / denominator;
+                const float t = (e - b * d) / denominator;
+                if (s > 0.f && t > 0.f) {
+                    const XrVector3f center = (leftOrigin + rightOrigin) / 2.f;
+                    const XrVector3f vergencePoint =
+                        ((leftOrigin + leftDirection * s) + (rightOrigin + rightDirection * t)) / 2.f;
+                    return Normalize(vergencePoint - center);
+                }
+            }
+
+            return gazeTangentsToUnitVector(
+                (state.GazeTan[xr::StereoView::Left].x + state.GazeTan[xr::StereoView::Right].x) / 2.f,
+                (state.GazeTan[xr::StereoView::Left].y + state.GazeTan[xr::StereoView::Right].y) / 2.f);
+        }
+
+    } // namespace
+
     bool OpenXrRuntime::getEyeGaze(XrTime time, bool getStateOnly, XrVector3f& unitVector, double& sampleTime) const {
         if (!m_isEyeTrackingAvailable) {
             return false;
         }
 
         if (m_eyeTrackingType == EyeTracking::PVR) {
-            pvrEyeTrackingInfo state{};
-            CHECK_PVRCMD(pvr_getEyeTrackingInfo(m_pvrSession, xrTimeToPvrTime(time), &state));
-            TraceLoggingWrite(g_traceProvider,
-                              "PVR_EyeTrackerPoseState",
-                              TLArg(xr::ToString(state.GazeTan[xr::StereoView::Left]).c_str(), "LeftGaze"),
-                              TLArg(xr::ToString(state.GazeTan[xr::StereoView::Right]).c_str(), "RightGaze"),
-                              TLArg(state.TimeInSeconds, "TimeInSeconds"));
+            pollPvrEyeTracker();
+
+            return sampleGaze(xrTimeToPvrTime(time), unitVector, sampleTime);
+
+#ifndef NOASEEVRCLIENT
+        } else if (m_eyeTrackingType == EyeTracking::aSeeVR) {
+            TraceLoggingWrite(g_traceProvider, "aSeeVR_EyeTrackerState", TLArg(m_isDroolonReady.load(), "Ready"));
 
-            // According to Pimax, this is how we detect gaze not valid.
-            if (state.TimeInSeconds == 0) {
+            if (!m_isDroolonReady) {
                 return false;
             }
 
-            // Compute the gaze pitch/yaw angles by averaging both eyes.
-            // TODO: Find the convergence point instead.
-            const float angleHorizontal =
-                atan((state.GazeTan[xr::StereoView::Left].x + state.GazeTan[xr::StereoView::Right].x) / 2.f);
-            const float angleVertical =
-                atan((state.GazeTan[xr::StereoView::Left].y + state.GazeTan[xr::StereoView::Right].y) / 2.f);
+            return sampleGaze(xrTimeToPvrTime(time), unitVector, sampleTime);
+#endif
 
-            // Use polar coordinates to create a unit vector.
-            unitVector = {
-                sin(angleHorizontal) * cos(angleVertical),
-                -sin(angleVertical),
-                -cos(angleHorizontal) * cos(angleVertical),
-            };
+        } else if (m_eyeTrackingType == EyeTracking::Simulated) {
+            // Use the mouse to simulate eye tracking.
+            RECT rect;
+            rect.left = 1;
+            rect.right = 999;
+            rect.top = 1;
+            rect.bottom = 999;
+            ClipCursor(&rect);
 
-            sampleTime = state.TimeInSeconds;
+            POINT pt{};
+            GetCursorPos(&pt);
 
-        } else if (m_eyeTrackingType == EyeTracking::aSeeVR || m_eyeTrackingType == EyeTracking::Simulated) {
-            XrVector2f point{0.5f, 0.5f};
-#ifndef NOASEEVRCLIENT
-            if (m_eyeTrackingType == EyeTracking::aSeeVR) {
-                std::unique_lock lock(m_droolonMutex);
+            const XrVector2f point = {(float)pt.x / 1000.f, (1000.f - pt.y) / 1000.f};
+            sampleTime = pvr_getTimeSeconds(m_pvr);
+
+            unitVector = Normalize({point.x - 0.5f, 0.5f - point.y, -m_droolonProjectionDistance});
 
-                TraceLoggingWrite(g_traceProvider,
-                                  "aSeeVR_EyeTrackerState",
-                                  TLArg(m_isDroolonReady, "Ready"),
-                                  TLArg(xr::ToString(m_droolonGaze).c_str(), "Gaze"),
-                                  TLArg(m_droolonTimestamp, "Timestamp"));
+        } else {
+            return false;
+        }
 
-                if (!m_isDroolonReady) {
-                    return false;
-                }
+        return true;
+    }
 
-                point = m_droolonGaze;
-                sampleTime = m_droolonTimestamp;
-            } else
-#endif
-            {
-                // Use the mouse to simulate eye tracking.
-                RECT rect;
-                rect.left = 1;
-                rect.right = 999;
-                rect.top = 1;
-                rect.bottom = 999;
-                ClipCursor(&rect);
-
-                POINT pt{};
-                GetCursorPos(&pt);
-
-                point = {(float)pt.x / 1000.f, (1000.f - pt.y) / 1000.f};
-                sampleTime = pvr_getTimeSeconds(m_pvr);
+    // Read the latest sample from the PVR eye tracker into the gaze ring. The PVR API is not cheap to call and the eye
+    // tracker runs at a lower rate than the applications may query the gaze, so we do not query it more than once per
+    // poll period, and only one thread polls at a time while the others use what is already in the ring.
+    void OpenXrRuntime::pollPvrEyeTracker() const {
+        const double now = pvr_getTimeSeconds(m_pvr);
+        if (now - m_lastGazePollTime.load(std::memory_order_relaxed) < k_gazePollPeriod) {
+            return;
+        }
+
+        std::unique_lock lock(m_gazePollMutex, std::try_to_lock);
+        if (!lock || now - m_lastGazePollTime.load(std::memory_order_relaxed) < k_gazePollPeriod) {
+            return;
+        }
+        m_lastGazePollTime.store(now, std::memory_order_relaxed);
+
+        pvrEyeTrackingInfo state{};
+        CHECK_PVRCMD(pvr_getEyeTrackingInfo(m_pvrSession, now, &state));
+        TraceLoggingWrite(g_traceProvider,
+                          "PVR_EyeTrackerPoseState",
+                          TLArg(xr::ToString(state.GazeTan[xr::StereoView::Left]).c_str(), "LeftGaze"),
+                          TLArg(xr::ToString(state.GazeTan[xr::StereoView::Right]).c_str(), "RightGaze"),
+                          TLArg(state.TimeInSeconds, "TimeInSeconds"));
+
+        // According to Pimax, this is how we detect gaze not valid.
+        if (state.TimeInSeconds == 0) {
+            m_gazeSamples.clear();
+            return;
+        }
+
+        double newestTime = 0;
+        m_gazeSamples.forEachNewest([&](const GazeSample& sample) {
+            newestTime = sample.time;
+            return false;
+        });
+        if (state.TimeInSeconds <= newestTime) {
+            return;
+        }
+
+        const XrVector3f eyePosition[xr::StereoView::Count] = {
+            pvrPoseToXrPose(m_cachedEyeInfo[xr::StereoView::Left].HmdToEyePose).position,
+            pvrPoseToXrPose(m_cachedEyeInfo[xr::StereoView::Right].HmdToEyePose).position,
+        };
+
+        GazeSample sample;
+        sample.time = state.TimeInSeconds;
+        sample.unitVector = getVergenceGaze(state, eyePosition);
+        m_gazeSamples.push(sample);
+    }
+
+    // Estimate the gaze at the requested time from the samples in the ring, by interpolating between the two samples
+    // around that time, or by extrapolating (for a limited time) from the two most recent samples.
+    bool OpenXrRuntime::sampleGaze(double time, XrVector3f& unitVector, double& sampleTime) const {
+        GazeSample newest, beforeNewest, before, after;
+        bool hasNewest = false, hasBeforeNewest = false, hasBefore = false, hasAfter = false;
+        m_gazeSamples.forEachNewest([&](const GazeSample& sample) {
+            if (!hasNewest) {
+                newest = sample;
+                hasNewest = true;
+            } else if (!hasBeforeNewest) {
+                beforeNewest = sample;
+                hasBeforeNewest = true;
             }
 
-            // Experimentally determined that Z should be 0.35m in front for Droolon.
-            unitVector = Normalize({point.x - 0.5f, 0.5f - point.y, -m_droolonProjectionDistance});
+            if (sample.time > time) {
+                after = sample;
+                hasAfter = true;
+                return true;
+            }
+            if (!hasBefore) {
+                before = sample;
+                hasBefore = true;
+            }
 
-        } else {
+            // When the requested time is past the newest sample, we need one more sample to extrapolate.
+            return !hasBeforeNewest;
+        });
+
+        if (!hasNewest) {
             return false;
         }
 
+        if (!hasBefore) {
+            // Only samples newer than the requested time, use the oldest one.
+            unitVector = after.unitVector;
+            sampleTime = after.time;
+        } else if (!hasAfter) {
+            unitVector = newest.unitVector;
+            if (hasBeforeNewest && newest.time > beforeNewest.time) {
+                const double horizon = std::min(time - newest.time, k_maxGazeExtrapolation);
+                const float factor = (float)(horizon / (newest.time - beforeNewest.time));
+                unitVector = Normalize(newest.unitVector + (newest.unitVector - beforeNewest.unitVector) * factor);
+            }
+            sampleTime = newest.time;
+        } else {
+            const float alpha = (float)((time - before.time) / (after.time - before.time));
+            unitVector = Normalize(before.unitVector + (after.unitVector - before.unitVector) * alpha);
+            sampleTime = time;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "EyeGazeSample",
+                          TLArg(time, "Time"),
+                          TLArg(xr::ToString(unitVector).c_str(), "UnitVector"),
+                          TLArg(sampleTime, "SampleTime"));
+
         return true;
     }
 
@@ -174,18 +293,24 @@ namespace pimax_openxr {
     }
 
     void OpenXrRuntime::setDroolonReady(bool ready) {
-        std::unique_lock lock(m_droolonMutex);
-
         m_isDroolonReady = ready;
     }
 
+    // Invoked from the aSeeVR client thread, which is the only writer to the gaze ring when using Droolon.
     void OpenXrRuntime::setDroolonData(int64_t timestamp, const XrVector2f& gaze) {
-        std::unique_lock lock(m_droolonMutex);
+        TraceLoggingWrite(g_traceProvider,
+                          "aSeeVR_EyeTrackerState",
+                          TLArg(xr::ToString(gaze).c_str(), "Gaze"),
+                          TLArg(timestamp, "Timestamp"));
 
         // There is no direct translation between the timestamp from the eye tracking service and the rest of the
         // system. We capture the "time of arrival" as a best effort.
-        m_droolonTimestamp = pvr_getTimeSeconds(m_pvr);
-        m_droolonGaze = gaze;
+        GazeSample sample;
+        sample.time = pvr_getTimeSeconds(m_pvr);
+
+        // Experimentally determined that Z should be 0.35m in front for Droolon.
+        sample.unitVector = Normalize({gaze.x - 0.5f, 0.5f - gaze.y, -m_droolonProjectionDistance});
+        m_gazeSamples.push(sample);
     }
 
     void OpenXrRuntime::aSeeVRgetCoefficientCallback(const aSeeVRCoefficient* data, void* context) {
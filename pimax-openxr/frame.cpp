@@ -33,6 +33,24 @@ namespace pimax_openxr {
     using namespace DirectX;
     using namespace xr::math;
 
+    namespace {
+
+        // Gather the layer headers to pass to pvr_endFrame(), up to the limit that PVR supports.
+        template <typename Layers>
+        unsigned int getLayerHeaders(Layers& layers, pvrLayerHeader* (&headers)[pvrMaxLayerCount]) {
+            unsigned int count = 0;
+            for (auto& layer : layers) {
+                if (count == pvrMaxLayerCount) {
+                    ErrorLog("Too many layers in this frame (%u)\n", layers.size());
+                    break;
+                }
+                headers[count++] = &layer.Header;
+            }
+            return count;
+        }
+
+    } // namespace
+
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrWaitFrame
     XrResult OpenXrRuntime::xrWaitFrame(XrSession session,
                                         const XrFrameWaitInfo* frameWaitInfo,
@@ -52,6 +70,9 @@ namespace pimax_openxr {
             return XR_ERROR_SESSION_NOT_RUNNING;
         }
 
+        // Poses queried in the previous frame are stale.
+        invalidatePoseCache();
+
         // Check for user presence and exit conditions.
         CHECK_PVRCMD(pvr_getHmdStatus(m_pvrSession, &m_hmdStatus));
         TraceLoggingWrite(g_traceProvider,
@@ -81,9 +102,10 @@ namespace pimax_openxr {
         // Critical section.
         {
             CpuTimer waitTimer;
-            if (IsTraceEnabled()) {
+            if (IsTraceEnabled() || m_telemetry.isActive()) {
                 waitTimer.start();
             }
+            const double waitFrameStart = m_timelineRecorder.isRecording() ? pvr_getTimeSeconds(m_pvr) : 0.0;
 
             std::unique_lock lock(m_frameMutex);
 
@@ -130,6 +152,7 @@ namespace pimax_openxr {
 
             if (m_needStartAsyncSubmissionThread) {
                 m_terminateAsyncThread = false;
+                m_asyncCommittedFrameId = -1;
                 m_asyncSubmissionThread = std::thread([&]() { asyncSubmissionThread(); });
                 m_needStartAsyncSubmissionThread = false;
             }
@@ -153,13 +176,14 @@ namespace pimax_openxr {
                     waitToBeginFrame, "PVR_WaitToBeginFrame", TLArg(xr::ToString(result).c_str(), "Result"));
             } else {
                 if (!m_useDeferredFrameWaitThisFrame) {
-                    waitForAsyncSubmissionIdle(m_useRunningStart);
+                    waitForAsyncSubmissionSlot(m_useRunningStart);
                 }
                 TraceLoggingWrite(g_traceProvider, "AcquiredFrame", TLArg(pvrFrameId, "FrameId"));
             }
 
-            if (IsTraceEnabled()) {
+            if (IsTraceEnabled() || m_telemetry.isActive()) {
                 waitTimer.stop();
+                m_lastWaitDurationUs = waitTimer.query(false);
             }
 
             const double now = pvr_getTimeSeconds(m_pvr);
@@ -171,6 +195,15 @@ namespace pimax_openxr {
                               TLArg(predictedDisplayTime - now, "PhotonTime"),
                               TLArg(waitTimer.query(), "WaitDurationUs"));
 
+            if (m_timelineRecorder.isRecording()) {
+                timeline::FrameRecord& frameTimeline = m_timelineFrames[pvrFrameId % k_timelineFramesInFlight];
+                frameTimeline = {};
+                frameTimeline.frameId = pvrFrameId;
+                frameTimeline.waitFrameStart = waitFrameStart;
+                frameTimeline.waitFrameEnd = now;
+                frameTimeline.predictedDisplayTime = predictedDisplayTime;
+            }
+
             // Setup the app frame for use and the next frame for this call.
             frameState->predictedDisplayTime = pvrTimeToXrTime(predictedDisplayTime);
 
@@ -224,7 +257,7 @@ namespace pimax_openxr {
         // Critical section.
         {
             CpuTimer waitTimer;
-            if (IsTraceEnabled()) {
+            if (IsTraceEnabled() || m_telemetry.isActive()) {
                 waitTimer.start();
             }
 
@@ -272,7 +305,15 @@ namespace pimax_openxr {
             // Therefore, we always advance m_frameBegun even upon discard.
             m_frameBegun = m_frameWaited;
 
-            if (IsTraceEnabled()) {
+            if (m_timelineRecorder.isRecording()) {
+                timeline::FrameRecord& frameTimeline = m_timelineFrames[pvrFrameId % k_timelineFramesInFlight];
+                frameTimeline.beginFrame = pvr_getTimeSeconds(m_pvr);
+                if (frameDiscarded) {
+                    frameTimeline.flags |= timeline::FrameDiscarded;
+                }
+            }
+
+            if (IsTraceEnabled() || m_telemetry.isActive()) {
                 waitTimer.stop();
             }
 
@@ -282,28 +323,45 @@ namespace pimax_openxr {
                               TLArg(waitTimer.query(), "WaitDurationUs"));
 
             // Statistics for the previous frame.
-            if (m_useFrameTimingOverride || IsTraceEnabled()) {
+            if (m_useFrameTimingOverride || m_useDynamicResolution || m_useAdaptivePacing || IsTraceEnabled() ||
+                m_telemetry.isActive()) {
                 // Our principle is to always query() a timer before we start() it. This means that we get measurements
-                // with k_numGpuTimers frames latency.
-                m_lastGpuFrameTimeUs =
-                    m_gpuTimerApp[m_currentTimerIndex] ? m_gpuTimerApp[m_currentTimerIndex]->query() : 0;
+                // with k_gpuTimersLatency frames latency.
+                m_lastGpuFrameTimeUs = m_gpuTimerApp ? m_gpuTimerApp->query() : 0;
+
+                m_lastRenderCpuTimeUs = m_renderTimerApp.query();
 
                 TraceLoggingWrite(g_traceProvider,
                                   "App_Statistics",
                                   TLArg(m_frameCompleted - 1, "FrameId"),
-                                  TLArg(m_renderTimerApp.query(), "AppRenderCpuTime"));
+                                  TLArg(m_lastRenderCpuTimeUs, "AppRenderCpuTime"));
 
-                if (m_frameCompleted >= k_numGpuTimers) {
+                if (m_frameCompleted >= k_gpuTimersLatency) {
                     TraceLoggingWrite(g_traceProvider,
                                       "App_Statistics",
-                                      TLArg(m_frameCompleted - k_numGpuTimers, "FrameId"),
+                                      TLArg(m_frameCompleted - k_gpuTimersLatency, "FrameId"),
                                       TLArg(m_lastGpuFrameTimeUs, "AppRenderGpuTime"));
                 }
 
+                // Estimate the scale the application renders at from the last projection layer it submitted.
+                if (m_useDynamicResolution && m_dynamicResolutionNominalExtent.width && m_proj0Extent.width) {
+                    const double currentScale =
+                        std::sqrt((double)m_proj0Extent.width * m_proj0Extent.height /
+                                  ((double)m_dynamicResolutionNominalExtent.width *
+                                   m_dynamicResolutionNominalExtent.height));
+                    if (m_dynamicResolution.update(m_lastGpuFrameTimeUs, m_idealFrameDuration * 1e6, currentScale)) {
+                        TraceLoggingWrite(g_traceProvider,
+                                          "DynamicResolution",
+                                          TLArg(currentScale, "CurrentScale"),
+                                          TLArg(m_dynamicResolution.lastUtilization(), "GpuUtilization"),
+                                          TLArg(m_dynamicResolution.scale(), "RecommendedScale"));
+                    }
+                }
+
                 // Start app timers.
                 m_renderTimerApp.start();
-                if (m_gpuTimerApp[m_currentTimerIndex]) {
-                    m_gpuTimerApp[m_currentTimerIndex]->start();
+                if (m_gpuTimerApp) {
+                    m_gpuTimerApp->start();
                 }
             }
 
@@ -378,24 +436,41 @@ namespace pimax_openxr {
                 return XR_ERROR_CALL_ORDER_INVALID;
             }
 
-            if (m_useFrameTimingOverride || IsTraceEnabled()) {
+            const double endFrameStart = m_timelineRecorder.isRecording() ? pvr_getTimeSeconds(m_pvr) : 0.0;
+
+            if (m_useFrameTimingOverride || m_useDynamicResolution || m_useAdaptivePacing || IsTraceEnabled() ||
+                m_telemetry.isActive()) {
                 m_renderTimerApp.stop();
-                if (m_gpuTimerApp[m_currentTimerIndex]) {
-                    m_gpuTimerApp[m_currentTimerIndex]->stop();
+                if (m_gpuTimerApp) {
+                    m_gpuTimerApp->stop();
+                    m_gpuTimestampsApp->nextFrame();
                 }
             }
 
-            // Make sure the previous frame finished submission.
+            ScopedAllocationCounter allocationCounter;
+
+            // Make sure there is room in the submission queue for this frame.
+            AsyncSubmissionPacket* asyncPacket = nullptr;
             if (m_useAsyncSubmission) {
-                waitForAsyncSubmissionIdle();
+                waitForAsyncSubmissionSlot();
 
-                // From this point, we know that the asynchronous thread is waiting, and we may use the submission
-                // context.
+                // From this point, we know that the asynchronous thread will not consume more frames than what is
+                // already queued. Since the queue holds a single frame, the asynchronous thread is waiting, and we may
+                // use the submission context.
+
+                // We are the only producer, so the free slot remains ours until we push it at the end of the frame.
+                asyncPacket = m_asyncSubmissionQueue.beginPush();
+                CHECK_MSG(asyncPacket, "Asynchronous submission queue is full");
             }
 
-            // Serializes the app work between D3D12/Vulkan and D3D11.
+            // Serializes the app work between D3D12/Vulkan and D3D11. With native D3D12 precomposition, this is done
+            // after recording the precomposition, see flushPrecompositionD3D12().
             if (isD3D12Session()) {
-                serializeD3D12Frame();
+                if (!m_useD3D12Precomposition) {
+                    serializeD3D12Frame();
+                } else {
+                    beginD3D12Precomposition();
+                }
             } else if (isVulkanSession()) {
                 serializeVulkanFrame();
             } else if (isOpenGLSession()) {
@@ -418,19 +493,36 @@ namespace pimax_openxr {
             }
             m_actionsSyncedThisFrame = false;
 
-            const auto lastPrecompositionTime = m_gpuTimerPrecomposition[m_currentTimerIndex]->query();
-            if (IsTraceEnabled()) {
-                m_gpuTimerPrecomposition[m_currentTimerIndex]->start();
+            const auto lastPrecompositionTime = m_gpuTimerPrecomposition->query();
+            if (IsTraceEnabled() || m_telemetry.isActive()) {
+                m_gpuTimerPrecomposition->start();
             }
 
-            std::set<std::pair<pvrTextureSwapChain, uint32_t>> committedSwapchainImages;
-
-            bool isProj0SRGB = false;
-            bool isFirstProjectionLayer = true;
-
-            // Construct the list of layers.
-            std::vector<pvrLayer_Union> layersAllocator;
-            layersAllocator.reserve(frameEndInfo->layerCount + 1);
+            CommittedImageList& committedSwapchainImages = m_committedSwapchainImages;
+            committedSwapchainImages.clear();
+            m_precompositionWork.clear();
+            m_parallelReprojectionWork.clear();
+
+            // Construct the list of layers. For asynchronous submission, we write directly into the queue.
+            LayerList& layersAllocator = asyncPacket ? asyncPacket->layers : m_layersForSubmission;
+            layersAllocator.clear();
+
+            // The layers commonly share a handful of spaces, and every view of a projection layer shares its space.
+            // Locate each space only once for the frame.
+            FixedVector<std::pair<XrSpace, XrPosef>, 8> layerSpacePoses;
+            auto locateLayerSpace = [&](XrSpace space) {
+                for (const auto& [cachedSpace, pose] : layerSpacePoses) {
+                    if (cachedSpace == space) {
+                        return pose;
+                    }
+                }
+                XrPosef pose;
+                locateSpace(*m_spaces.get(space), *m_originSpace, frameEndInfo->displayTime, pose);
+                if (layerSpacePoses.size() < layerSpacePoses.capacity()) {
+                    layerSpacePoses.push_back(std::make_pair(space, pose));
+                }
+                return pose;
+            };
             for (uint32_t i = 0; i < frameEndInfo->layerCount; i++) {
                 if (!frameEndInfo->layers[i]) {
                     return XR_ERROR_LAYER_INVALID;
@@ -438,12 +530,16 @@ namespace pimax_openxr {
 
                 std::unique_lock lock3(m_actionsAndSpacesMutex);
 
-                if (!m_spaces.count(frameEndInfo->layers[i]->space)) {
+                if (!m_spaces.contains(frameEndInfo->layers[i]->space)) {
                     return XR_ERROR_HANDLE_INVALID;
                 }
 
-                layersAllocator.push_back({});
-                auto* layer = &layersAllocator.back();
+                // Refuse the frame rather than overflowing the layer list.
+                if (layersAllocator.full()) {
+                    return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+                }
+
+                auto* layer = &layersAllocator.emplace_back();
                 layer->Header.Flags = 0;
 
                 // OpenGL needs to flip the texture vertically, which PVR can conveniently do for us.
@@ -461,7 +557,8 @@ namespace pimax_openxr {
                                       TLArg(proj->layerFlags, "Flags"),
                                       TLXArg(proj->space, "Space"));
 
-                    if (proj->viewCount != xr::StereoView::Count) {
+                    const uint32_t viewCount = getViewCount(m_primaryViewConfigurationType);
+                    if (proj->viewCount != viewCount) {
                         return XR_ERROR_VALIDATION_FAILURE;
                     }
 
@@ -480,7 +577,31 @@ namespace pimax_openxr {
                     // Start without depth. We might change the type to pvrLayerType_EyeFovDepth further below.
                     layer->Header.Type = pvrLayerType_EyeFov;
 
-                    for (uint32_t viewIndex = 0; viewIndex < xr::StereoView::Count; viewIndex++) {
+                    // With parallel projection reprojection, the stereo views of the first projection layer are
+                    // resampled into the canted views that PVR expects. The other layers are submitted as-is.
+                    const bool useParallelReprojection =
+                        m_useParallelReprojection && m_parallelReprojectionWork.empty();
+
+                    // With quad views, the focus views are submitted as another layer on top of the stereo views, and
+                    // the PVR compositor merges them. The focus layer must fit along with all the remaining layers,
+                    // and the overlay and guardian, which must never be the ones left out of pvr_endFrame().
+                    pvrLayer_Union* focusLayer = nullptr;
+                    if (viewCount > xr::StereoView::Count) {
+                        if (layersAllocator.size() + 1 + (frameEndInfo->layerCount - i - 1) + k_runtimeLayerCount >
+                            pvrMaxLayerCount) {
+                            return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+                        }
+                        focusLayer = &layersAllocator.emplace_back();
+                        focusLayer->Header.Type = pvrLayerType_EyeFov;
+                        focusLayer->Header.Flags = layer->Header.Flags;
+                    }
+
+                    const XrPosef layerPose = locateLayerSpace(proj->space);
+
+                    for (uint32_t viewIndex = 0; viewIndex < viewCount; viewIndex++) {
+                        pvrLayer_Union* const viewLayer = viewIndex < xr::StereoView::Count ? layer : focusLayer;
+                        const uint32_t eye = viewIndex % xr::StereoView::Count;
+
                         if (viewIndex == 0) {
                             m_proj0Extent = proj->views[viewIndex].subImage.imageRect.extent;
                         }
@@ -500,11 +621,11 @@ namespace pimax_openxr {
                             return XR_ERROR_POSE_INVALID;
                         }
 
-                        if (!m_swapchains.count(proj->views[viewIndex].subImage.swapchain)) {
+                        if (!m_swapchains.contains(proj->views[viewIndex].subImage.swapchain)) {
                             return XR_ERROR_HANDLE_INVALID;
                         }
 
-                        Swapchain& xrSwapchain = *(Swapchain*)proj->views[viewIndex].subImage.swapchain;
+                        Swapchain& xrSwapchain = *m_swapchains.get(proj->views[viewIndex].subImage.swapchain);
 
                         if (xrSwapchain.lastReleasedIndex == -1) {
                             return XR_ERROR_LAYER_INVALID;
@@ -514,48 +635,70 @@ namespace pimax_openxr {
                             return XR_ERROR_VALIDATION_FAILURE;
                         }
 
-                        if (isFirstProjectionLayer) {
-                            isProj0SRGB = isSRGBFormat(xrSwapchain.dxgiFormatForSubmission);
-                        }
-
-                        // Fill out color buffer information.
-                        prepareAndCommitSwapchainImage(xrSwapchain,
-                                                       i,
-                                                       proj->views[viewIndex].subImage.imageArrayIndex,
-                                                       frameEndInfo->layers[i]->layerFlags,
-                                                       committedSwapchainImages);
-                        layer->EyeFov.ColorTexture[viewIndex] =
-                            xrSwapchain.pvrSwapchain[proj->views[viewIndex].subImage.imageArrayIndex];
+                        const bool isReprojected = useParallelReprojection && viewIndex < xr::StereoView::Count;
 
                         if (!isValidSwapchainRect(xrSwapchain.pvrDesc, proj->views[viewIndex].subImage.imageRect)) {
                             return XR_ERROR_SWAPCHAIN_RECT_INVALID;
                         }
-                        layer->EyeFov.Viewport[viewIndex].x = proj->views[viewIndex].subImage.imageRect.offset.x;
-                        layer->EyeFov.Viewport[viewIndex].y = proj->views[viewIndex].subImage.imageRect.offset.y;
-                        layer->EyeFov.Viewport[viewIndex].width =
-                            proj->views[viewIndex].subImage.imageRect.extent.width;
-                        layer->EyeFov.Viewport[viewIndex].height =
-                            proj->views[viewIndex].subImage.imageRect.extent.height;
 
-                        // Fill out pose and FOV information.
-                        XrPosef layerPose;
-                        locateSpace(*(Space*)proj->space, *m_originSpace, frameEndInfo->displayTime, layerPose);
-                        layer->EyeFov.RenderPose[viewIndex] =
-                            xrPoseToPvrPose(Pose::Multiply(proj->views[viewIndex].pose, layerPose));
+                        // Fill out color buffer information. The focus views are processed like a layer above this one,
+                        // so that they are opaque unless the application requested alpha-blending.
+                        if (!isReprojected) {
+                            viewLayer->EyeFov.ColorTexture[eye] =
+                                prepareAndCommitSwapchainImage(xrSwapchain,
+                                                               viewLayer == layer ? i : i + 1,
+                                                               proj->views[viewIndex].subImage.imageArrayIndex,
+                                                               frameEndInfo->layers[i]->layerFlags,
+                                                               m_projectionSubmissionFormat,
+                                                               committedSwapchainImages);
+
+                            viewLayer->EyeFov.Viewport[eye].x = proj->views[viewIndex].subImage.imageRect.offset.x;
+                            viewLayer->EyeFov.Viewport[eye].y = proj->views[viewIndex].subImage.imageRect.offset.y;
+                            viewLayer->EyeFov.Viewport[eye].width =
+                                proj->views[viewIndex].subImage.imageRect.extent.width;
+                            viewLayer->EyeFov.Viewport[eye].height =
+                                proj->views[viewIndex].subImage.imageRect.extent.height;
+                        } else {
+                            viewLayer->EyeFov.ColorTexture[eye] =
+                                queueParallelReprojection(xrSwapchain,
+                                                          i,
+                                                          eye,
+                                                          proj->views[viewIndex],
+                                                          frameEndInfo->layers[i]->layerFlags,
+                                                          committedSwapchainImages);
+
+                            viewLayer->EyeFov.Viewport[eye].x = 0;
+                            viewLayer->EyeFov.Viewport[eye].y = 0;
+                            viewLayer->EyeFov.Viewport[eye].width = m_parallelReprojectionTargets[eye].extent.width;
+                            viewLayer->EyeFov.Viewport[eye].height = m_parallelReprojectionTargets[eye].extent.height;
+                        }
 
-                        const XrFovf fov = proj->views[viewIndex].fov;
-                        layer->EyeFov.Fov[viewIndex].DownTan = -tan(fov.angleDown);
-                        layer->EyeFov.Fov[viewIndex].UpTan = tan(fov.angleUp);
-                        layer->EyeFov.Fov[viewIndex].LeftTan = -tan(fov.angleLeft);
-                        layer->EyeFov.Fov[viewIndex].RightTan = tan(fov.angleRight);
+                        // Fill out pose and FOV information.
+                        if (!isReprojected) {
+                            viewLayer->EyeFov.RenderPose[eye] =
+                                xrPoseToPvrPose(Pose::Multiply(proj->views[viewIndex].pose, layerPose));
+
+                            const XrFovf fov = proj->views[viewIndex].fov;
+                            viewLayer->EyeFov.Fov[eye].DownTan = -tan(fov.angleDown);
+                            viewLayer->EyeFov.Fov[eye].UpTan = tan(fov.angleUp);
+                            viewLayer->EyeFov.Fov[eye].LeftTan = -tan(fov.angleLeft);
+                            viewLayer->EyeFov.Fov[eye].RightTan = tan(fov.angleRight);
+                        } else {
+                            // The canted view is rotated relative to the parallel view that the application rendered.
+                            XrPosef cantedToParallel = pvrPoseToXrPose(m_cantedEyeInfo[eye].HmdToEyePose);
+                            cantedToParallel.position = {0, 0, 0};
+                            viewLayer->EyeFov.RenderPose[eye] = xrPoseToPvrPose(Pose::Multiply(
+                                Pose::Multiply(cantedToParallel, proj->views[viewIndex].pose), layerPose));
+                            viewLayer->EyeFov.Fov[eye] = m_cantedEyeInfo[eye].Fov;
+                        }
 
                         // Per Pimax: this value is currently unused, but should be set to the timestamp of the head
                         // pose. In the case of OpenXR, we expect the app to use the predictedDisplayTime to query the
                         // head pose, and pass that same time as displayTime.
-                        layer->EyeFov.SensorSampleTime = xrTimeToPvrTime(frameEndInfo->displayTime);
+                        viewLayer->EyeFov.SensorSampleTime = xrTimeToPvrTime(frameEndInfo->displayTime);
 
-                        // Submit depth.
-                        if (has_XR_KHR_composition_layer_depth) {
+                        // Submit depth. The depth of a reprojected view would not match the canted view.
+                        if (has_XR_KHR_composition_layer_depth && !isReprojected) {
                             const XrBaseInStructure* entry =
                                 reinterpret_cast<const XrBaseInStructure*>(proj->views[viewIndex].next);
                             while (entry) {
@@ -563,7 +706,7 @@ namespace pimax_openxr {
                                     const XrCompositionLayerDepthInfoKHR* depth =
                                         reinterpret_cast<const XrCompositionLayerDepthInfoKHR*>(entry);
 
-                                    layer->Header.Type = pvrLayerType_EyeFovDepth;
+                                    viewLayer->Header.Type = pvrLayerType_EyeFovDepth;
 
                                     TraceLoggingWrite(
                                         g_traceProvider,
@@ -578,11 +721,11 @@ namespace pimax_openxr {
                                         TLArg(depth->minDepth, "MinDepth"),
                                         TLArg(depth->maxDepth, "MaxDepth"));
 
-                                    if (!m_swapchains.count(depth->subImage.swapchain)) {
+                                    if (!m_swapchains.contains(depth->subImage.swapchain)) {
                                         return XR_ERROR_HANDLE_INVALID;
                                     }
 
-                                    Swapchain& xrDepthSwapchain = *(Swapchain*)depth->subImage.swapchain;
+                                    Swapchain& xrDepthSwapchain = *m_swapchains.get(depth->subImage.swapchain);
 
                                     if (xrDepthSwapchain.lastReleasedIndex == -1) {
                                         return XR_ERROR_LAYER_INVALID;
@@ -599,8 +742,9 @@ namespace pimax_openxr {
                                         depth->subImage.imageArrayIndex,
                                         XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT, /* Not applicable for depth
                                                                                               */
+                                        DXGI_FORMAT_UNKNOWN,
                                         committedSwapchainImages);
-                                    layer->EyeFovDepth.DepthTexture[viewIndex] =
+                                    viewLayer->EyeFovDepth.DepthTexture[eye] =
                                         xrDepthSwapchain.pvrSwapchain[depth->subImage.imageArrayIndex];
 
                                     if (!isValidSwapchainRect(xrDepthSwapchain.pvrDesc, depth->subImage.imageRect)) {
@@ -608,11 +752,11 @@ namespace pimax_openxr {
                                     }
 
                                     // Fill out projection information.
-                                    layer->EyeFovDepth.DepthProjectionDesc.Projection22 =
+                                    viewLayer->EyeFovDepth.DepthProjectionDesc.Projection22 =
                                         depth->farZ / (depth->nearZ - depth->farZ);
-                                    layer->EyeFovDepth.DepthProjectionDesc.Projection23 =
+                                    viewLayer->EyeFovDepth.DepthProjectionDesc.Projection23 =
                                         (depth->farZ * depth->nearZ) / (depth->nearZ - depth->farZ);
-                                    layer->EyeFovDepth.DepthProjectionDesc.Projection32 = -1.f;
+                                    viewLayer->EyeFovDepth.DepthProjectionDesc.Projection32 = -1.f;
 
                                     break;
                                 }
@@ -620,8 +764,6 @@ namespace pimax_openxr {
                             }
                         }
                     }
-                    isFirstProjectionLayer = false;
-
                 } else if (frameEndInfo->layers[i]->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
                     const XrCompositionLayerQuad* quad =
                         reinterpret_cast<const XrCompositionLayerQuad*>(frameEndInfo->layers[i]);
@@ -648,11 +790,11 @@ namespace pimax_openxr {
                         return XR_ERROR_POSE_INVALID;
                     }
 
-                    if (!m_swapchains.count(quad->subImage.swapchain)) {
+                    if (!m_swapchains.contains(quad->subImage.swapchain)) {
                         return XR_ERROR_HANDLE_INVALID;
                     }
 
-                    Swapchain& xrSwapchain = *(Swapchain*)quad->subImage.swapchain;
+                    Swapchain& xrSwapchain = *m_swapchains.get(quad->subImage.swapchain);
 
                     if (xrSwapchain.lastReleasedIndex == -1) {
                         return XR_ERROR_LAYER_INVALID;
@@ -666,12 +808,12 @@ namespace pimax_openxr {
                     }
 
                     // Fill out color buffer information.
-                    prepareAndCommitSwapchainImage(xrSwapchain,
-                                                   i,
-                                                   quad->subImage.imageArrayIndex,
-                                                   frameEndInfo->layers[i]->layerFlags,
-                                                   committedSwapchainImages);
-                    layer->Quad.ColorTexture = xrSwapchain.pvrSwapchain[quad->subImage.imageArrayIndex];
+                    layer->Quad.ColorTexture = prepareAndCommitSwapchainImage(xrSwapchain,
+                                                                              i,
+                                                                              quad->subImage.imageArrayIndex,
+                                                                              frameEndInfo->layers[i]->layerFlags,
+                                                                              m_quadSubmissionFormat,
+                                                                              committedSwapchainImages);
 
                     if (!isValidSwapchainRect(xrSwapchain.pvrDesc, quad->subImage.imageRect)) {
                         return XR_ERROR_SWAPCHAIN_RECT_INVALID;
@@ -681,15 +823,14 @@ namespace pimax_openxr {
                     layer->Quad.Viewport.width = quad->subImage.imageRect.extent.width;
                     layer->Quad.Viewport.height = quad->subImage.imageRect.extent.height;
 
-                    if (!m_spaces.count(quad->space)) {
+                    if (!m_spaces.contains(quad->space)) {
                         return XR_ERROR_HANDLE_INVALID;
                     }
-                    Space& xrSpace = *(Space*)quad->space;
+                    Space& xrSpace = *m_spaces.get(quad->space);
 
                     // Fill out pose and quad information.
                     if (xrSpace.referenceType != XR_REFERENCE_SPACE_TYPE_VIEW) {
-                        XrPosef layerPose;
-                        locateSpace(*(Space*)quad->space, *m_originSpace, frameEndInfo->displayTime, layerPose);
+                        const XrPosef layerPose = locateLayerSpace(quad->space);
                         layer->Quad.QuadPoseCenter = xrPoseToPvrPose(Pose::Multiply(quad->pose, layerPose));
                     } else {
                         layer->Quad.QuadPoseCenter = xrPoseToPvrPose(Pose::Multiply(quad->pose, xrSpace.poseInSpace));
@@ -709,12 +850,11 @@ namespace pimax_openxr {
                     initializeOverlayResources();
                 }
 
-                if (m_isOverlayVisible) {
-                    refreshOverlay();
-
+                if (m_isOverlayVisible && m_overlaySwapchain && layersAllocator.full()) {
+                    ErrorLog("Too many layers in this frame (%u)\n", layersAllocator.size() + 1);
+                } else if (m_isOverlayVisible && m_overlaySwapchain && refreshOverlay()) {
                     // Draw the overlay on top of everything but below the guardian (see below).
-                    layersAllocator.push_back({});
-                    auto& layer = layersAllocator.back();
+                    auto& layer = layersAllocator.emplace_back();
                     layer.Header.Type = pvrLayerType_Quad;
                     layer.Header.Flags = 0;
                     layer.Quad.ColorTexture = m_overlaySwapchain;
@@ -737,73 +877,135 @@ namespace pimax_openxr {
                     initializeGuardianResources();
                 }
 
-                // Measure the floor distance between the center of the guardian and the headset.
+                // Measure the floor distance between the center of the guardian and the headset. The headset pose at
+                // this time is normally already in the pose cache, from when the application located its views.
                 XrPosef viewToOrigin;
                 XrSpaceLocationFlags locationFlags =
                     locateSpace(*m_viewSpace, *m_originSpace, frameEndInfo->displayTime, viewToOrigin);
                 XrPosef guardianToOrigin;
                 locateSpace(*m_guardianSpace, *m_originSpace, frameEndInfo->displayTime, guardianToOrigin);
-                if (Pose::IsPoseValid(locationFlags) &&
+                const float distance =
                     Length(XrVector3f{guardianToOrigin.position.x, 0.f, guardianToOrigin.position.z} -
-                           XrVector3f{viewToOrigin.position.x, 0.f, viewToOrigin.position.z}) > m_guardianThreshold) {
+                           XrVector3f{viewToOrigin.position.x, 0.f, viewToOrigin.position.z});
+
+                // Pick the fade level, fully opaque past the threshold.
+                const float opacity = std::clamp(
+                    (distance - m_guardianThreshold + m_guardianFadeDistance) / m_guardianFadeDistance, 0.f, 1.f);
+                const int fadeLevel = (int)std::ceil(opacity * k_guardianFadeLevels);
+                if (Pose::IsPoseValid(locationFlags) && m_guardianSwapchain && fadeLevel > 0 &&
+                    layersAllocator.full()) {
+                    ErrorLog("Too many layers in this frame (%u)\n", layersAllocator.size() + 1);
+                } else if (Pose::IsPoseValid(locationFlags) && m_guardianSwapchain && fadeLevel > 0) {
                     // Draw the guardian on top of everything.
-                    layersAllocator.push_back({});
-                    auto& layer = layersAllocator.back();
+                    auto& layer = layersAllocator.emplace_back();
                     layer.Header.Type = pvrLayerType_Quad;
                     layer.Header.Flags = 0;
                     layer.Quad.ColorTexture = m_guardianSwapchain;
-                    layer.Quad.Viewport.x = layer.Quad.Viewport.y = 0;
+                    layer.Quad.Viewport.x =
+                        (fadeLevel - 1) * (m_guardianExtent.width + (int)k_guardianFadeLevelGutter);
+                    layer.Quad.Viewport.y = 0;
                     layer.Quad.Viewport.width = m_guardianExtent.width;
                     layer.Quad.Viewport.height = m_guardianExtent.height;
 
                     // Place the guardian in 3D space as a 2D overlay.
-                    XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
                     layer.Quad.QuadPoseCenter = xrPoseToPvrPose(guardianToOrigin);
                     layer.Quad.QuadSize.x = layer.Quad.QuadSize.y = m_guardianRadius * 2;
                 }
             }
 
+            const long long pvrFrameId = m_frameBegun - 1;
+
+            // Process and commit the swapchain images for all the layers. With asynchronous commit, this is left to the
+            // submission thread, see flushAsyncCommit().
+            if (!m_useAsyncCommit) {
+                if (isD3D12Session() && m_useD3D12Precomposition) {
+                    flushPrecompositionD3D12();
+                }
+                flushPrecomposition();
+                flushParallelReprojection();
+            } else {
+                // Remember the images that the submission thread will access, so that the application does not render
+                // into them in the meantime. See xrWaitSwapchainImage().
+                const auto markInFlight = [&](Swapchain& xrSwapchain, int index) {
+                    if (xrSwapchain.inFlightFrameId != pvrFrameId) {
+                        xrSwapchain.inFlightFrameId = pvrFrameId;
+                        xrSwapchain.inFlightImages = 0;
+                    }
+                    xrSwapchain.inFlightImages |= 1ull << index;
+                };
+                for (const PrecompositionWork& work : m_precompositionWork) {
+                    markInFlight(*work.swapchain, work.sourceIndex);
+                    // Only the images of the first slice are visible to the application.
+                    if (work.slice == 0 && !work.needConvert) {
+                        markInFlight(*work.swapchain, work.destIndex);
+                    }
+                }
+                for (const ParallelReprojectionWork& work : m_parallelReprojectionWork) {
+                    markInFlight(*work.swapchain, work.sourceIndex);
+                }
+            }
+
             // Add a dummy layer so we can still call pvr_endFrame() for timing purposes.
             if (layersAllocator.empty()) {
-                layersAllocator.push_back({});
-                layersAllocator.back().Header.Type = pvrLayerType_Disabled;
+                layersAllocator.emplace_back().Header.Type = pvrLayerType_Disabled;
             }
 
-            if (IsTraceEnabled()) {
-                m_gpuTimerPrecomposition[m_currentTimerIndex]->stop();
+            if ((IsTraceEnabled() || m_telemetry.isActive()) && !m_useAsyncCommit) {
+                m_gpuTimerPrecomposition->stop();
+                m_gpuTimestampsPrecomposition->nextFrame();
             }
 
             // Update the FPS counter.
             const auto now = pvr_getTimeSeconds(m_pvr);
+            const double frameInterval = !m_frameTimes.empty() ? now - m_frameTimes.back() : 0.0;
             m_frameTimes.push_back(now);
             while (now - m_frameTimes.front() >= 1.0) {
                 m_frameTimes.pop_front();
             }
 
+            // Adapt the frame pacing to the application. Running start and deferred wait only apply to asynchronous
+            // submission. The wait duration is accumulated by the thread waiting for the submission thread.
+            const uint64_t asyncWaitDurationUs = m_asyncWaitDurationUs.exchange(0);
+            if (m_useAdaptivePacing && m_useAsyncSubmission) {
+                const uint64_t frameTimeUs = std::max(m_lastRenderCpuTimeUs, m_lastGpuFrameTimeUs);
+                if (m_pacingController.update(
+                        asyncWaitDurationUs, frameInterval * 1e6, frameTimeUs, m_idealFrameDuration * 1e6)) {
+                    const auto mode = m_pacingController.mode();
+                    TraceLoggingWrite(g_traceProvider,
+                                      "AdaptivePacing",
+                                      TLArg(PacingController::toString(mode), "Mode"),
+                                      TLArg(m_pacingController.lastMissedRate(), "MissedRate"),
+                                      TLArg(m_pacingController.lastWaitRatio(), "WaitRatio"),
+                                      TLArg(m_pacingController.lastUtilization(), "Utilization"));
+                    Log("Adaptive pacing: switching to %s (missed %.1f%%, throttled %.1f%%, utilization %.1f%%)\n",
+                        PacingController::toString(mode),
+                        m_pacingController.lastMissedRate() * 100,
+                        m_pacingController.lastWaitRatio() * 100,
+                        m_pacingController.lastUtilization() * 100);
+
+                    applyPacingMode(mode);
+                    pvr_setIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", m_lockFramerate ? 2 : 1);
+                }
+            }
+
             // Submit the layers to PVR.
             if (m_useFrameTimingOverride) {
                 float renderMs = 0.f;
                 if (!m_frameTimeOverrideUs) {
-                    // No inherent biasing today. Might change in the future.
-                    // TODO: We should account for m_lastCpuFrameTimeUs here.
-                    const auto biasedCpuFrameTimeUs = 0ll;
-                    const auto biasedGpuFrameTimeUs = (int64_t)m_lastGpuFrameTimeUs + 0;
-
-                    const auto latestFrameTimeUs = std::max(
-                        0ll, std::max(biasedCpuFrameTimeUs, biasedGpuFrameTimeUs) + m_frameTimeOverrideOffsetUs);
-
-                    // Simple median filter to smooth out the values.
-                    m_frameTimeFilter.push_back(latestFrameTimeUs);
-                    while (m_frameTimeFilter.size() > m_frameTimeFilterLength) {
-                        m_frameTimeFilter.pop_front();
-                    }
-                    auto sortedFrameTimes = m_frameTimeFilter;
-                    std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+                    const auto estimatedFrameTimeUs =
+                        m_frameTimeEstimator.update(m_lastCpuFrameTimeUs, m_lastRenderCpuTimeUs, m_lastGpuFrameTimeUs);
 
-                    const auto filteredFrameTimeUs = sortedFrameTimes[sortedFrameTimes.size() / 2];
-                    renderMs = filteredFrameTimeUs / 1e3f;
+                    TraceLoggingWrite(g_traceProvider,
+                                      "FrameTimeEstimator",
+                                      TLArg(m_lastCpuFrameTimeUs, "CpuFrameTimeUs"),
+                                      TLArg(m_lastRenderCpuTimeUs, "RenderCpuTimeUs"),
+                                      TLArg(m_lastGpuFrameTimeUs, "GpuFrameTimeUs"),
+                                      TLArg(estimatedFrameTimeUs, "EstimatedFrameTimeUs"),
+                                      TLArg(m_frameTimeEstimator.lastWasSpike(), "IsSpike"));
+
+                    renderMs = std::max(0ll, (int64_t)estimatedFrameTimeUs + m_frameTimeOverrideOffsetUs) / 1e3f;
                 } else {
-                    m_frameTimeFilter.clear();
+                    m_frameTimeEstimator.reset();
 
                     renderMs = std::max(0ll, (int64_t)m_frameTimeOverrideUs + m_frameTimeOverrideOffsetUs) / 1e3f;
                 }
@@ -816,28 +1018,81 @@ namespace pimax_openxr {
                 pvr_setFloatConfig(m_pvrSession, "openvr_client_render_ms", renderMs);
             }
 
-            const long long pvrFrameId = m_frameBegun - 1;
-            if (!m_useAsyncSubmission) {
-                std::vector<pvrLayerHeader*> layers;
-                for (auto& layer : layersAllocator) {
-                    layers.push_back(&layer.Header);
+            // Capture the frame statistics for the telemetry. The pvr_endFrame() duration and layer count are filled
+            // upon submission.
+            telemetry::FrameRecord frameTelemetry{};
+            if (m_telemetry.isActive()) {
+                frameTelemetry.submitTime = now;
+                frameTelemetry.waitDurationUs = (uint32_t)m_lastWaitDurationUs;
+                frameTelemetry.appCpuTimeUs = (uint32_t)m_lastRenderCpuTimeUs;
+                frameTelemetry.appGpuTimeUs = (uint32_t)m_lastGpuFrameTimeUs;
+                frameTelemetry.precompositionGpuTimeUs = (uint32_t)lastPrecompositionTime;
+                frameTelemetry.endFrameAllocations = (uint32_t)m_lastEndFrameAllocations;
+                if (m_isSmartSmoothingActive) {
+                    frameTelemetry.smartSmoothingState = telemetry::SmartSmoothingState::Active;
+                } else if (m_isSmartSmoothingEnabled) {
+                    frameTelemetry.smartSmoothingState = telemetry::SmartSmoothingState::Enabled;
+                }
+            }
 
-                    if (layers.size() == pvrMaxLayerCount) {
-                        ErrorLog("Too many layers in this frame (%u)\n", layersAllocator.size());
-                        break;
-                    }
+            timeline::FrameRecord frameTimeline{};
+            if (m_timelineRecorder.isRecording()) {
+                frameTimeline = m_timelineFrames[pvrFrameId % k_timelineFramesInFlight];
+                frameTimeline.endFrameStart = endFrameStart;
+                frameTimeline.displayTime = xrTimeToPvrTime(frameEndInfo->displayTime);
+                frameTimeline.precompositionEnd = now;
+                if (m_useAsyncSubmission) {
+                    frameTimeline.flags |= timeline::AsyncSubmission;
                 }
+                if (m_isSmartSmoothingActive) {
+                    frameTimeline.flags |= timeline::SmartSmoothingActive;
+                }
+            }
+
+            // Keep the session status up-to-date for the companion app.
+            const float measuredFps = (float)m_frameTimes.size();
+            if (m_telemetry.isOpen() && (m_runtimeStatus.fps != measuredFps ||
+                                         m_runtimeStatus.useSmartSmoothing != m_isSmartSmoothingEnabled)) {
+                m_runtimeStatus.fps = measuredFps;
+                m_runtimeStatus.useSmartSmoothing = m_isSmartSmoothingEnabled;
+                m_telemetry.publishStatus(m_runtimeStatus);
+            }
+#ifdef DISPATCH_STATS
+            if (m_telemetry.isActive() && now - m_lastDispatchStatsPublishTime >= 1.0) {
+                publishDispatchStats();
+                m_lastDispatchStatsPublishTime = now;
+            }
+#endif
+
+            if (!m_useAsyncSubmission) {
+                pvrLayerHeader* layers[pvrMaxLayerCount];
+                const unsigned int layerCount = getLayerHeaders(layersAllocator, layers);
 
                 TraceLocalActivity(endFrame);
                 TraceLoggingWriteStart(endFrame,
                                        "PVR_EndFrame",
                                        TLArg(pvrFrameId, "FrameId"),
-                                       TLArg(layers.size(), "NumLayers"),
+                                       TLArg(layerCount, "NumLayers"),
                                        TLArg(m_frameTimes.size(), "MeasuredFps"),
                                        TLArg(pvr_getFloatConfig(m_pvrSession, "client_fps", 0), "ClientFps"),
                                        TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"));
-                CHECK_PVRCMD(pvr_endFrame(m_pvrSession, pvrFrameId, layers.data(), (unsigned int)layers.size()));
+                const double pvrEndFrameStart = pvr_getTimeSeconds(m_pvr);
+                CHECK_PVRCMD(pvr_endFrame(m_pvrSession, pvrFrameId, layers, layerCount));
+                const double pvrEndFrameEnd = pvr_getTimeSeconds(m_pvr);
                 TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
+
+                if (m_telemetry.isActive()) {
+                    frameTelemetry.frameId = pvrFrameId;
+                    frameTelemetry.endFrameDurationUs = (uint32_t)((pvrEndFrameEnd - pvrEndFrameStart) * 1e6);
+                    frameTelemetry.layerCount = layerCount;
+                    m_telemetry.publish(frameTelemetry);
+                }
+                if (m_timelineRecorder.isRecording()) {
+                    frameTimeline.pvrEndFrameStart = pvrEndFrameStart;
+                    frameTimeline.pvrEndFrameEnd = pvrEndFrameEnd;
+                    frameTimeline.layerCount = layerCount;
+                    m_timelineRecorder.record(frameTimeline);
+                }
             }
 
             // Defer initialization of mirror window resources until they are first needed.
@@ -845,7 +1100,7 @@ namespace pimax_openxr {
                 if (m_useMirrorWindow && !m_mirrorWindowThread.joinable()) {
                     createMirrorWindow();
                 }
-                updateMirrorWindow(isProj0SRGB);
+                updateMirrorWindow();
             } catch (std::exception& exc) {
                 TraceLoggingWrite(g_traceProvider, "MirrorWindow", TLArg(exc.what(), "Error"));
                 ErrorLog("Failed to update the mirror window: %s\n", exc.what());
@@ -866,10 +1121,14 @@ namespace pimax_openxr {
                                       TLArg(pvr_getFloatConfig(m_pvrSession, "client_fps", 0), "ClientFps"),
                                       TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"));
 
-                    std::unique_lock lock(m_asyncSubmissionMutex);
-                    m_layersForAsyncSubmission = layersAllocator;
+                    asyncPacket->frameId = pvrFrameId;
+                    asyncPacket->fenceValue = m_frameFenceValue;
+                    asyncPacket->submitTime = now;
+                    asyncPacket->telemetry = frameTelemetry;
+                    asyncPacket->timeline = frameTimeline;
 
-                    m_asyncSubmissionCondVar.notify_all();
+                    m_asyncSubmissionQueue.endPush();
+                    m_asyncSubmissionSignal.notify();
 
                     // From this point, we know that the asynchronous thread may be executing, and we shall not use the
                     // submission context.
@@ -879,12 +1138,19 @@ namespace pimax_openxr {
             m_frameCompleted = m_frameBegun;
             updateSessionState();
 
-            m_currentTimerIndex = (m_currentTimerIndex + 1) % k_numGpuTimers;
-
             m_useDeferredFrameWaitThisFrame = m_useDeferredFrameWait;
 
             m_sessionTotalFrameCount++;
 
+            // The steady-state frame loop is expected to be free of heap allocations.
+            if (IsAllocationCountingEnabled()) {
+                m_lastEndFrameAllocations = allocationCounter.count();
+                TraceLoggingWrite(g_traceProvider,
+                                  "EndFrame_Allocations",
+                                  TLArg(m_frameCompleted, "FrameCompleted"),
+                                  TLArg(m_lastEndFrameAllocations, "Allocations"));
+            }
+
             // Signal xrBeginFrame().
             TraceLoggingWrite(g_traceProvider,
                               "EndFrame_Signal",
@@ -903,9 +1169,45 @@ namespace pimax_openxr {
 
         SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 
+        const auto submitLayers = [&](long long frameId, AsyncSubmissionPacket& packet) {
+            pvrLayerHeader* layers[pvrMaxLayerCount];
+            const unsigned int layerCount = getLayerHeaders(packet.layers, layers);
+
+            TraceLocalActivity(endFrame);
+            TraceLoggingWriteStart(endFrame,
+                                   "PVR_EndFrame",
+                                   TLArg(frameId, "FrameId"),
+                                   TLArg(packet.frameId, "AppFrameId"),
+                                   TLArg(layerCount, "NumLayers"));
+            const double pvrEndFrameStart = pvr_getTimeSeconds(m_pvr);
+            CHECK_PVRCMD(pvr_endFrame(m_pvrSession, frameId, layers, layerCount));
+            const double pvrEndFrameEnd = pvr_getTimeSeconds(m_pvr);
+            TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
+
+            if (m_telemetry.isActive()) {
+                telemetry::FrameRecord& frameTelemetry = packet.telemetry;
+                frameTelemetry.frameId = frameId;
+                frameTelemetry.endFrameDurationUs = (uint32_t)((pvrEndFrameEnd - pvrEndFrameStart) * 1e6);
+                frameTelemetry.layerCount = layerCount;
+                m_telemetry.publish(frameTelemetry);
+            }
+            if (m_timelineRecorder.isRecording()) {
+                // Frames re-submitted to fill gaps are recorded under their new PVR frame ID.
+                timeline::FrameRecord frameTimeline = packet.timeline;
+                frameTimeline.frameId = frameId;
+                frameTimeline.pvrEndFrameStart = pvrEndFrameStart;
+                frameTimeline.pvrEndFrameEnd = pvrEndFrameEnd;
+                frameTimeline.layerCount = layerCount;
+                m_timelineRecorder.record(frameTimeline);
+            }
+        };
+
+        // The last frame we submitted. We hold on to its slot in the queue until we have waited for the next frame, so
+        // that it may be re-submitted to fill gaps.
+        AsyncSubmissionPacket* lastPacket = nullptr;
         std::optional<long long> lastWaitedFrameId;
+        long long pvrFrameId = m_frameCompleted;
         while (true) {
-            const long long pvrFrameId = m_frameCompleted;
             // PVR doesn't like gaps in frame ID, but these can happen when an app intentionally discard a frame. So
             // we make sure we never skip a frame ID.
             for (long long frameId = lastWaitedFrameId.value_or(pvrFrameId - 1) + 1; frameId <= pvrFrameId; frameId++) {
@@ -920,7 +1222,7 @@ namespace pimax_openxr {
                     waitToBeginFrame, "PVR_WaitToBeginFrame", TLArg(xr::ToString(result).c_str(), "Result"));
 
                 // PVR requires us to complete each frame...
-                if (frameId != pvrFrameId) {
+                if (frameId != pvrFrameId && lastPacket) {
                     {
                         TraceLocalActivity(beginFrame);
                         TraceLoggingWriteStart(beginFrame, "PVR_BeginFrame", TLArg(frameId, "FrameId"));
@@ -933,22 +1235,7 @@ namespace pimax_openxr {
                         TraceLoggingWriteStop(
                             beginFrame, "PVR_BeginFrame", TLArg(xr::ToString(result).c_str(), "Result"));
                     }
-                    {
-                        std::vector<pvrLayerHeader*> layers;
-                        for (auto& layer : m_layersForAsyncSubmission) {
-                            layers.push_back(&layer.Header);
-                            if (layers.size() == pvrMaxLayerCount) {
-                                break;
-                            }
-                        }
-
-                        TraceLocalActivity(endFrame);
-                        TraceLoggingWriteStart(
-                            endFrame, "PVR_EndFrame", TLArg(pvrFrameId, "FrameId"), TLArg(layers.size(), "NumLayers"));
-                        CHECK_PVRCMD(
-                            pvr_endFrame(m_pvrSession, pvrFrameId, layers.data(), (unsigned int)layers.size()));
-                        TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
-                    }
+                    submitLayers(frameId, *lastPacket);
                 }
             }
             lastWaitedFrameId = pvrFrameId;
@@ -966,21 +1253,36 @@ namespace pimax_openxr {
                 TraceLoggingWriteStop(beginFrame, "PVR_BeginFrame", TLArg(xr::ToString(result).c_str(), "Result"));
             }
 
-            {
-                std::unique_lock lock(m_asyncSubmissionMutex);
-
-                // Mark us as ready to accept a new frame.
-                m_layersForAsyncSubmission.clear();
-                m_asyncSubmissionCondVar.notify_all();
-
-                // Wait for the frame.
-                m_asyncSubmissionCondVar.wait(
-                    lock, [&] { return m_terminateAsyncThread || !m_layersForAsyncSubmission.empty(); });
+            // Mark us as ready to accept a new frame.
+            if (lastPacket) {
+                m_asyncSubmissionQueue.pop();
+                lastPacket = nullptr;
+                m_asyncSubmissionSignal.notify();
             }
+
+            // Wait for the frame.
+            AsyncSubmissionPacket* packet = nullptr;
+            m_asyncSubmissionSignal.wait(
+                [&] { return m_terminateAsyncThread || (packet = m_asyncSubmissionQueue.peek()); });
             if (m_terminateAsyncThread) {
                 break;
             }
 
+            TraceLoggingWrite(g_traceProvider,
+                              "AsyncSubmission_Dequeue",
+                              TLArg(packet->frameId, "AppFrameId"),
+                              TLArg(m_asyncSubmissionQueue.size(), "QueuedFrames"),
+                              TLArg(packet->fenceValue, "FenceValue"),
+                              TLArg((pvr_getTimeSeconds(m_pvr) - packet->submitTime) * 1e6, "QueuedTimeUs"));
+
+            if (m_useAsyncCommit) {
+                flushAsyncCommit(packet->fenceValue);
+
+                // Release the swapchain images to the application.
+                m_asyncCommittedFrameId = packet->frameId;
+                m_asyncSubmissionSignal.notify();
+            }
+
             // Deferring the call to pvr_beginFrame() prevents PVR from measuring the frame and lets us override it via
             // openvr_render_ms.
             if (m_useFrameTimingOverride) {
@@ -993,48 +1295,112 @@ namespace pimax_openxr {
                 }
                 TraceLoggingWriteStop(beginFrame, "PVR_BeginFrame", TLArg(xr::ToString(result).c_str(), "Result"));
             }
-            {
-                std::vector<pvrLayerHeader*> layers;
-                for (auto& layer : m_layersForAsyncSubmission) {
-                    layers.push_back(&layer.Header);
+            submitLayers(pvrFrameId, *packet);
+            lastPacket = packet;
 
-                    if (layers.size() == pvrMaxLayerCount) {
-                        ErrorLog("Too many layers in this frame (%u)\n", m_layersForAsyncSubmission.size());
-                        break;
-                    }
-                }
+            // Catch up with the application's frame ID if it discarded frames.
+            pvrFrameId = std::max(pvrFrameId, packet->frameId) + 1;
+        }
 
-                TraceLocalActivity(endFrame);
-                TraceLoggingWriteStart(
-                    endFrame, "PVR_EndFrame", TLArg(pvrFrameId, "FrameId"), TLArg(layers.size(), "NumLayers"));
-                CHECK_PVRCMD(pvr_endFrame(m_pvrSession, pvrFrameId, layers.data(), (unsigned int)layers.size()));
-                TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
-            }
+        // Release any frame left in the queue.
+        while (!m_asyncSubmissionQueue.empty()) {
+            m_asyncSubmissionQueue.pop();
         }
+        m_asyncSubmissionSignal.notify();
 
         TraceLoggingWriteStop(local, "AsyncSubmissionThread");
     }
 
-    void OpenXrRuntime::waitForAsyncSubmissionIdle(bool doRunningStart) {
+    void OpenXrRuntime::waitForAsyncSubmissionIdle() {
+        waitForAsyncSubmission(0, false);
+    }
+
+    void OpenXrRuntime::waitForAsyncSubmissionSlot(bool doRunningStart) {
+        waitForAsyncSubmission(m_asyncSubmissionQueue.capacity() - 1, doRunningStart);
+    }
+
+    void OpenXrRuntime::waitForAsyncSubmission(size_t maxFramesInFlight, bool doRunningStart) {
         TraceLocalActivity(waitToBeginFrame);
-        TraceLoggingWriteStart(waitToBeginFrame, "WaitForAsyncSubmissionIdle", TLArg(doRunningStart, "DoRunningStart"));
+        TraceLoggingWriteStart(waitToBeginFrame,
+                               "WaitForAsyncSubmission",
+                               TLArg(maxFramesInFlight, "MaxFramesInFlight"),
+                               TLArg(doRunningStart, "DoRunningStart"));
 
-        std::unique_lock lock(m_asyncSubmissionMutex);
+        const auto waitStart = std::chrono::high_resolution_clock::now();
+
+        const auto isReady = [&] { return m_asyncSubmissionQueue.size() <= maxFramesInFlight; };
 
         bool wokeUpEarly = false;
         if (doRunningStart) {
             constexpr double RunningStart = 0.002;
-            const auto timeout =
-                m_lastWaitToBeginFrameTime + std::chrono::duration<double>(m_predictedFrameDuration - RunningStart);
+            const auto timeout = m_lastWaitToBeginFrameTime.load() +
+                                 std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                                     std::chrono::duration<double>(m_predictedFrameDuration - RunningStart));
 
-            wokeUpEarly =
-                !m_asyncSubmissionCondVar.wait_until(lock, timeout, [&] { return m_layersForAsyncSubmission.empty(); });
+            wokeUpEarly = !m_asyncSubmissionSignal.waitUntil(isReady, timeout);
         } else {
-            m_asyncSubmissionCondVar.wait(lock, [&] { return m_layersForAsyncSubmission.empty(); });
+            m_asyncSubmissionSignal.wait(isReady);
         }
 
+        const auto waitDuration = std::chrono::high_resolution_clock::now() - waitStart;
+        m_asyncWaitDurationUs += std::chrono::duration_cast<std::chrono::microseconds>(waitDuration).count();
+
+        TraceLoggingWriteStop(waitToBeginFrame,
+                              "WaitForAsyncSubmission",
+                              TLArg(m_asyncSubmissionQueue.size(), "QueuedFrames"),
+                              TLArg(wokeUpEarly, "WokeUpForRunningStart"));
+    }
+
+    // With asynchronous commit, whether the submission thread is still processing the images of a frame.
+    bool OpenXrRuntime::isAsyncCommitPending(long long frameId) {
+        return frameId > m_asyncCommittedFrameId && !m_terminateAsyncThread;
+    }
+
+    void OpenXrRuntime::waitForAsyncCommit(long long frameId) {
+        TraceLocalActivity(waitForCommit);
+        TraceLoggingWriteStart(waitForCommit, "WaitForAsyncCommit", TLArg(frameId, "FrameId"));
+
+        m_asyncSubmissionSignal.wait([&] { return frameId <= m_asyncCommittedFrameId || m_terminateAsyncThread; });
+
         TraceLoggingWriteStop(
-            waitToBeginFrame, "WaitForAsyncSubmissionIdle", TLArg(wokeUpEarly, "WokeUpForRunningStart"));
+            waitForCommit, "WaitForAsyncCommit", TLArg(m_asyncCommittedFrameId.load(), "CommittedFrameId"));
+    }
+
+    // Override the static pacing settings with the mode selected by the adaptive pacing controller.
+    void OpenXrRuntime::applyPacingMode(PacingController::Mode mode) {
+        m_useDeferredFrameWait = mode == PacingController::Mode::DeferredWait;
+        m_lockFramerate = mode == PacingController::Mode::LockedFramerate;
+    }
+
+#ifdef DISPATCH_STATS
+    // Merge the call statistics of the entry points from all threads, and publish them to the telemetry.
+    void OpenXrRuntime::publishDispatchStats(bool doLog) {
+        static_assert(dispatch_stats::k_histogramBuckets == telemetry::k_dispatchHistogramBuckets);
+        static_assert(dispatch_stats::k_maxEntries <= telemetry::k_maxDispatchStats);
+
+        dispatch_stats::collect(m_dispatchStats);
+
+        m_dispatchStatsRecords.resize(m_dispatchStats.size());
+        for (size_t i = 0; i < m_dispatchStats.size(); i++) {
+            const auto& stats = m_dispatchStats[i];
+            auto& record = m_dispatchStatsRecords[i];
+            strncpy_s(record.name, stats.name, _TRUNCATE);
+            record.calls = stats.calls;
+            record.totalNs = stats.totalNs;
+            record.maxNs = stats.maxNs;
+            std::copy_n(stats.histogram, telemetry::k_dispatchHistogramBuckets, record.histogram);
+
+            if (doLog) {
+                Log("%s: %llu calls, %.1f us total, %.2f us average, %.1f us max\n",
+                    stats.name,
+                    stats.calls,
+                    stats.totalNs / 1e3,
+                    stats.totalNs / 1e3 / stats.calls,
+                    stats.maxNs / 1e3);
+            }
+        }
+        m_telemetry.publishDispatchStats(m_dispatchStatsRecords.data(), (uint32_t)m_dispatchStatsRecords.size());
     }
+#endif
 
 } // namespace pimax_openxr
@@ -0,0 +1,372 @@
+#pragma once
+
+#include "pch.h"
+
+namespace pimax_openxr::utils {
+
+    // A streaming estimate of a quantile of a series, updated in constant time and without storing any history.
+    // The estimate moves up or down by a step for each sample, weighted so that it settles where the requested fraction
+    // of the samples falls below it. The step is proportional to the spread of the samples.
+    class RollingQuantile {
+      public:
+        void reset(double quantile, double stepGain) {
+            m_quantile = quantile;
+            m_stepGain = stepGain;
+            m_count = 0;
+            m_estimate = 0;
+            m_spread = 0;
+        }
+
+        void push(double value) {
+            if (m_count++ == 0) {
+                m_estimate = value;
+                m_spread = 0;
+                return;
+            }
+
+            const double deviation = value - m_estimate;
+            m_spread += m_stepGain * (std::abs(deviation) - m_spread);
+
+            // The step must never collapse to 0, otherwise a constant series would freeze the estimate forever.
+            const double step = std::max(m_spread * m_stepGain, 1.0);
+            m_estimate += 2 * step * (deviation > 0 ? m_quantile : m_quantile - 1.0);
+        }
+
+        double estimate() const {
+            return m_estimate;
+        }
+
+        uint64_t count() const {
+            return m_count;
+        }
+
+      private:
+        double m_quantile{0.5};
+        double m_stepGain{0.2};
+        uint64_t m_count{0};
+        double m_estimate{0};
+        double m_spread{0};
+    };
+
+    // Estimates the time the application needs to produce a frame, from the measurements of the last frames.
+    class FrameTimeEstimator {
+      public:
+        struct Config {
+            // The quantile of the frame times to track (0.5 is the median).
+            double quantile{0.5};
+            // The number of frames to smooth over.
+            uint32_t smoothingLength{5};
+            // How much of the CPU frame time to include in the critical path.
+            double cpuWeight{1.0};
+            // A frame time longer than this factor times the estimate is considered as a spike.
+            double spikeThreshold{2.0};
+            // After this many consecutive spikes, the frame times are considered to have durably increased.
+            uint32_t maxConsecutiveSpikes{3};
+        };
+
+        void configure(const Config& config) {
+            m_config = config;
+            reset();
+        }
+
+        void reset() {
+            m_quantile.reset(m_config.quantile, 1.0 / std::max(m_config.smoothingLength, 1u));
+            m_consecutiveSpikes = 0;
+        }
+
+        // Returns the estimated frame time, in microseconds.
+        uint64_t update(uint64_t cpuFrameTimeUs, uint64_t renderCpuTimeUs, uint64_t gpuFrameTimeUs) {
+            // The GPU work can overlap with the CPU work of the next frame, but it cannot complete before the CPU is
+            // done submitting it. The frame rate is bound by the longest of the two paths.
+            const double criticalPathUs = std::max(m_config.cpuWeight * cpuFrameTimeUs,
+                                                   (double)std::max(renderCpuTimeUs, gpuFrameTimeUs));
+
+            // Ignore isolated spikes (eg: loading or shader compilation) to avoid dropping to a lower refresh rate in
+            // the compositor. When the spikes persist, restart the estimation from the new level.
+            m_lastWasSpike = false;
+            if (m_quantile.count() && criticalPathUs > m_config.spikeThreshold * m_quantile.estimate()) {
+                if (++m_consecutiveSpikes <= m_config.maxConsecutiveSpikes) {
+                    m_lastWasSpike = true;
+                    return (uint64_t)m_quantile.estimate();
+                }
+                reset();
+            }
+            m_consecutiveSpikes = 0;
+
+            m_quantile.push(criticalPathUs);
+
+            return (uint64_t)std::max(m_quantile.estimate(), 0.0);
+        }
+
+        bool lastWasSpike() const {
+            return m_lastWasSpike;
+        }
+
+      private:
+        Config m_config;
+        RollingQuantile m_quantile;
+        uint32_t m_consecutiveSpikes{0};
+        bool m_lastWasSpike{false};
+    };
+
+    // Recommends a render scale to the application so that its GPU frame time stays within the frame budget, and the
+    // compositor does not have to fall back to Smart Smoothing. The GPU time is assumed to be proportional to the
+    // number of pixels rendered. To avoid oscillating, the recommendation only changes when the GPU utilization leaves
+    // a deadband around the target, and it is then held until the measurements reflect the new resolution.
+    class DynamicResolutionController {
+      public:
+        struct Config {
+            // The bounds of the recommended scale (per axis), relative to the nominal resolution.
+            double minScale{0.5};
+            double maxScale{1.0};
+            // The fraction of the frame duration that the GPU time should settle at.
+            double targetUtilization{0.85};
+            // No change is made while the utilization is within this distance from the target.
+            double deadband{0.05};
+            // The largest relative change of the scale in one step. Lowering the resolution is more urgent than
+            // raising it, since a missed frame is more noticeable than a few frames at a lower resolution.
+            double maxStepDown{0.15};
+            double maxStepUp{0.05};
+            // The number of frames to ignore after a change, which must cover the latency of the GPU timers and of
+            // the application adopting the new resolution.
+            uint32_t holdFrames{10};
+            // The number of frames to smooth the GPU time over.
+            uint32_t smoothingLength{10};
+        };
+
+        void configure(const Config& config) {
+            m_config = config;
+            reset();
+        }
+
+        void reset() {
+            m_scale = std::clamp(1.0, m_config.minScale, m_config.maxScale);
+            m_isValid = false;
+            m_samples = 0;
+            m_smoothedGpuTimeUs = 0;
+            m_holdFramesLeft = 0;
+        }
+
+        // Returns true if the recommended scale has changed.
+        bool update(uint64_t gpuFrameTimeUs, double frameDurationUs, double currentScale) {
+            if (!gpuFrameTimeUs || frameDurationUs <= 0 || currentScale <= 0) {
+                return false;
+            }
+
+            if (m_holdFramesLeft) {
+                m_holdFramesLeft--;
+                return false;
+            }
+
+            const double alpha = 1.0 / std::max(m_config.smoothingLength, 1u);
+            m_smoothedGpuTimeUs =
+                m_samples++ ? m_smoothedGpuTimeUs + alpha * (gpuFrameTimeUs - m_smoothedGpuTimeUs) : gpuFrameTimeUs;
+            if (m_samples < m_config.smoothingLength) {
+                return false;
+            }
+            m_isValid = true;
+
+            m_lastUtilization = m_smoothedGpuTimeUs / frameDurationUs;
+            if (std::abs(m_lastUtilization - m_config.targetUtilization) <= m_config.deadband) {
+                return false;
+            }
+
+            // Start from the resolution the application actually renders at, in case it did not follow the last
+            // recommendation.
+            double scale = currentScale * std::sqrt(m_config.targetUtilization / m_lastUtilization);
+            scale = std::clamp(
+                scale, currentScale * (1.0 - m_config.maxStepDown), currentScale * (1.0 + m_config.maxStepUp));
+            scale = std::clamp(scale, m_config.minScale, m_config.maxScale);
+            if (std::abs(scale - m_scale) < 0.01) {
+                return false;
+            }
+
+            m_scale = scale;
+            m_samples = 0;
+            m_holdFramesLeft = m_config.holdFrames;
+
+            return true;
+        }
+
+        // Whether enough frames were measured to make a recommendation.
+        bool isValid() const {
+            return m_isValid;
+        }
+
+        double scale() const {
+            return m_scale;
+        }
+
+        double lastUtilization() const {
+            return m_lastUtilization;
+        }
+
+      private:
+        Config m_config;
+        double m_scale{1.0};
+        bool m_isValid{false};
+        uint32_t m_samples{0};
+        double m_smoothedGpuTimeUs{0};
+        double m_lastUtilization{0};
+        uint32_t m_holdFramesLeft{0};
+    };
+
+    // Selects the frame pacing mode from the behavior of the application, instead of relying on static settings:
+    // - Running start wakes up the application slightly ahead of the next frame, for the lowest latency.
+    // - Deferred wait moves the throttling from xrWaitFrame() to xrEndFrame(), so that a CPU-bound application can
+    //   overlap its simulation with the previous frame.
+    // - Locked frame rate halves the frame rate, for applications that cannot sustain the full rate.
+    // The measurements are accumulated over a window of frames, and a decision is made at the end of each window.
+    class PacingController {
+      public:
+        enum class Mode : uint32_t {
+            RunningStart = 0,
+            DeferredWait,
+            LockedFramerate,
+        };
+
+        struct Config {
+            // The number of frames in each observation window.
+            uint32_t windowFrames{180};
+            // The fraction of missed frames above which the application cannot sustain the full frame rate.
+            double lockMissedRate{0.25};
+            // The frame rate is unlocked when the frame time would fit within this fraction of the full-rate budget.
+            double unlockUtilization{0.75};
+            // The fraction of missed frames below which the full frame rate is considered stable.
+            double stableMissedRate{0.02};
+            // Deferred wait is preferred when the application spends less than this fraction of the frame duration
+            // being throttled, and running start is preferred when it spends more than the second threshold.
+            double deferWaitRatio{0.1};
+            double runningStartRatio{0.25};
+            // The number of windows to stay in a mode after a switch. It doubles each time unlocking the frame rate
+            // fails, up to 16 times this value.
+            uint32_t holdWindows{2};
+        };
+
+        void configure(const Config& config, Mode mode) {
+            m_config = config;
+            m_unlockHoldWindows = m_config.holdWindows;
+            reset(mode);
+        }
+
+        void reset(Mode mode) {
+            m_mode = mode;
+            m_holdWindowsLeft = 0;
+            m_wasUnlocked = false;
+            resetWindow();
+        }
+
+        // Account for one frame. The wait duration is the time spent throttling the application, and the frame time is
+        // the time the application needs to produce a frame. Returns true if the mode has changed.
+        bool update(uint64_t waitDurationUs, double frameIntervalUs, uint64_t frameTimeUs, double frameDurationUs) {
+            if (frameIntervalUs <= 0 || frameDurationUs <= 0) {
+                return false;
+            }
+
+            // With a locked frame rate, only every other refresh is expected to receive a frame.
+            const double expectedIntervalUs = frameDurationUs * (m_mode == Mode::LockedFramerate ? 2 : 1);
+            if (frameIntervalUs > expectedIntervalUs * 1.5) {
+                m_missedFrames++;
+            }
+            m_totalWaitUs += waitDurationUs;
+            m_totalFrameTimeUs += frameTimeUs;
+            if (++m_frames < m_config.windowFrames) {
+                return false;
+            }
+
+            m_lastMissedRate = (double)m_missedFrames / m_frames;
+            m_lastWaitRatio = m_totalWaitUs / (m_frames * frameDurationUs);
+            m_lastUtilization = m_totalFrameTimeUs / (m_frames * frameDurationUs);
+            resetWindow();
+
+            if (m_holdWindowsLeft) {
+                m_holdWindowsLeft--;
+                return false;
+            }
+
+            Mode mode = m_mode;
+            if (m_mode != Mode::LockedFramerate && m_lastMissedRate > m_config.lockMissedRate) {
+                mode = Mode::LockedFramerate;
+
+                // We just unlocked the frame rate and the application could not keep up: wait longer next time.
+                if (m_wasUnlocked) {
+                    m_unlockHoldWindows = std::min(m_unlockHoldWindows * 2, m_config.holdWindows * 16);
+                }
+            } else if (m_mode == Mode::LockedFramerate) {
+                if (m_lastUtilization > 0 && m_lastUtilization < m_config.unlockUtilization) {
+                    mode = Mode::RunningStart;
+                }
+            } else if (m_mode == Mode::RunningStart) {
+                if (m_lastWaitRatio < m_config.deferWaitRatio && m_lastMissedRate > m_config.stableMissedRate) {
+                    mode = Mode::DeferredWait;
+                }
+            } else if (m_mode == Mode::DeferredWait) {
+                if (m_lastWaitRatio > m_config.runningStartRatio && m_lastMissedRate <= m_config.stableMissedRate) {
+                    mode = Mode::RunningStart;
+                }
+            }
+
+            // Only the first window after unlocking tells whether unlocking was premature.
+            m_wasUnlocked = m_mode == Mode::LockedFramerate && mode != Mode::LockedFramerate;
+            if (mode == m_mode) {
+                return false;
+            }
+
+            m_mode = mode;
+            m_holdWindowsLeft = mode == Mode::LockedFramerate ? m_unlockHoldWindows : m_config.holdWindows;
+
+            return true;
+        }
+
+        Mode mode() const {
+            return m_mode;
+        }
+
+        // The measurements of the last completed window.
+        double lastMissedRate() const {
+            return m_lastMissedRate;
+        }
+
+        double lastWaitRatio() const {
+            return m_lastWaitRatio;
+        }
+
+        double lastUtilization() const {
+            return m_lastUtilization;
+        }
+
+        static const char* toString(Mode mode) {
+            switch (mode) {
+            case Mode::RunningStart:
+                return "RunningStart";
+            case Mode::DeferredWait:
+                return "DeferredWait";
+            case Mode::LockedFramerate:
+                return "LockedFramerate";
+            }
+            return "Unknown";
+        }
+
+      private:
+        void resetWindow() {
+            m_frames = 0;
+            m_missedFrames = 0;
+            m_totalWaitUs = 0;
+            m_totalFrameTimeUs = 0;
+        }
+
+        Config m_config;
+        Mode m_mode{Mode::RunningStart};
+        uint32_t m_holdWindowsLeft{0};
+        uint32_t m_unlockHoldWindows{2};
+        bool m_wasUnlocked{false};
+        uint32_t m_frames{0};
+        uint32_t m_missedFrames{0};
+        double m_totalWaitUs{0};
+        double m_totalFrameTimeUs{0};
+        double m_lastMissedRate{0};
+        double m_lastWaitRatio{0};
+        double m_lastUtilization{0};
+    };
+
+} // namespace pimax_openxr::utils
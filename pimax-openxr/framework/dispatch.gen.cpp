@@ -26,6 +26,7 @@
 #include <runtime.h>
 
 #include "dispatch.h"
+#include "dispatch_stats.h"
 #include "log.h"
 
 #ifndef RUNTIME_NAMESPACE
@@ -41,6 +42,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateInstanceExtensionProperties(const char* layerName, uint32_t propertyCapacityInput, uint32_t* propertyCountOutput, XrExtensionProperties* properties) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateInstanceExtensionProperties");
+		DISPATCH_STATS_SCOPE(0);
 
 		XrResult result;
 		try {
@@ -62,6 +64,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* instance) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateInstance");
+		DISPATCH_STATS_SCOPE(1);
 
 		XrResult result;
 		try {
@@ -83,6 +86,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetInstanceProperties(XrInstance instance, XrInstanceProperties* instanceProperties) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetInstanceProperties");
+		DISPATCH_STATS_SCOPE(2);
 
 		XrResult result;
 		try {
@@ -104,6 +108,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrPollEvent");
+		DISPATCH_STATS_SCOPE(3);
 
 		XrResult result;
 		try {
@@ -125,6 +130,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrResultToString");
+		DISPATCH_STATS_SCOPE(4);
 
 		XrResult result;
 		try {
@@ -146,6 +152,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrStructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrStructureTypeToString");
+		DISPATCH_STATS_SCOPE(5);
 
 		XrResult result;
 		try {
@@ -167,6 +174,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetSystem");
+		DISPATCH_STATS_SCOPE(6);
 
 		XrResult result;
 		try {
@@ -188,6 +196,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSystemProperties* properties) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetSystemProperties");
+		DISPATCH_STATS_SCOPE(7);
 
 		XrResult result;
 		try {
@@ -209,6 +218,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t environmentBlendModeCapacityInput, uint32_t* environmentBlendModeCountOutput, XrEnvironmentBlendMode* environmentBlendModes) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateEnvironmentBlendModes");
+		DISPATCH_STATS_SCOPE(8);
 
 		XrResult result;
 		try {
@@ -230,6 +240,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateSession");
+		DISPATCH_STATS_SCOPE(9);
 
 		XrResult result;
 		try {
@@ -251,6 +262,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroySession(XrSession session) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroySession");
+		DISPATCH_STATS_SCOPE(10);
 
 		XrResult result;
 		try {
@@ -272,6 +284,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateReferenceSpaces(XrSession session, uint32_t spaceCapacityInput, uint32_t* spaceCountOutput, XrReferenceSpaceType* spaces) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateReferenceSpaces");
+		DISPATCH_STATS_SCOPE(11);
 
 		XrResult result;
 		try {
@@ -293,6 +306,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateReferenceSpace");
+		DISPATCH_STATS_SCOPE(12);
 
 		XrResult result;
 		try {
@@ -314,6 +328,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType referenceSpaceType, XrExtent2Df* bounds) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetReferenceSpaceBoundsRect");
+		DISPATCH_STATS_SCOPE(13);
 
 		XrResult result;
 		try {
@@ -335,6 +350,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* createInfo, XrSpace* space) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateActionSpace");
+		DISPATCH_STATS_SCOPE(14);
 
 		XrResult result;
 		try {
@@ -356,6 +372,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrLocateSpace");
+		DISPATCH_STATS_SCOPE(15);
 
 		XrResult result;
 		try {
@@ -377,6 +394,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroySpace(XrSpace space) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroySpace");
+		DISPATCH_STATS_SCOPE(16);
 
 		XrResult result;
 		try {
@@ -398,6 +416,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId, uint32_t viewConfigurationTypeCapacityInput, uint32_t* viewConfigurationTypeCountOutput, XrViewConfigurationType* viewConfigurationTypes) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateViewConfigurations");
+		DISPATCH_STATS_SCOPE(17);
 
 		XrResult result;
 		try {
@@ -419,6 +438,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetViewConfigurationProperties(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, XrViewConfigurationProperties* configurationProperties) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetViewConfigurationProperties");
+		DISPATCH_STATS_SCOPE(18);
 
 		XrResult result;
 		try {
@@ -440,6 +460,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrViewConfigurationView* views) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateViewConfigurationViews");
+		DISPATCH_STATS_SCOPE(19);
 
 		XrResult result;
 		try {
@@ -461,6 +482,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateSwapchainFormats(XrSession session, uint32_t formatCapacityInput, uint32_t* formatCountOutput, int64_t* formats) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateSwapchainFormats");
+		DISPATCH_STATS_SCOPE(20);
 
 		XrResult result;
 		try {
@@ -482,6 +504,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateSwapchain");
+		DISPATCH_STATS_SCOPE(21);
 
 		XrResult result;
 		try {
@@ -503,6 +526,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroySwapchain(XrSwapchain swapchain) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroySwapchain");
+		DISPATCH_STATS_SCOPE(22);
 
 		XrResult result;
 		try {
@@ -524,6 +548,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, uint32_t* imageCountOutput, XrSwapchainImageBaseHeader* images) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateSwapchainImages");
+		DISPATCH_STATS_SCOPE(23);
 
 		XrResult result;
 		try {
@@ -545,6 +570,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrAcquireSwapchainImage");
+		DISPATCH_STATS_SCOPE(24);
 
 		XrResult result;
 		try {
@@ -566,6 +592,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrWaitSwapchainImage");
+		DISPATCH_STATS_SCOPE(25);
 
 		XrResult result;
 		try {
@@ -587,6 +614,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrReleaseSwapchainImage");
+		DISPATCH_STATS_SCOPE(26);
 
 		XrResult result;
 		try {
@@ -608,6 +636,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrBeginSession");
+		DISPATCH_STATS_SCOPE(27);
 
 		XrResult result;
 		try {
@@ -629,6 +658,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEndSession(XrSession session) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEndSession");
+		DISPATCH_STATS_SCOPE(28);
 
 		XrResult result;
 		try {
@@ -650,6 +680,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrRequestExitSession(XrSession session) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrRequestExitSession");
+		DISPATCH_STATS_SCOPE(29);
 
 		XrResult result;
 		try {
@@ -671,6 +702,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrWaitFrame");
+		DISPATCH_STATS_SCOPE(30);
 
 		XrResult result;
 		try {
@@ -692,6 +724,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrBeginFrame");
+		DISPATCH_STATS_SCOPE(31);
 
 		XrResult result;
 		try {
@@ -713,6 +746,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEndFrame");
+		DISPATCH_STATS_SCOPE(32);
 
 		XrResult result;
 		try {
@@ -734,6 +768,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrLocateViews(XrSession session, const XrViewLocateInfo* viewLocateInfo, XrViewState* viewState, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrView* views) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrLocateViews");
+		DISPATCH_STATS_SCOPE(33);
 
 		XrResult result;
 		try {
@@ -755,6 +790,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrStringToPath(XrInstance instance, const char* pathString, XrPath* path) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrStringToPath");
+		DISPATCH_STATS_SCOPE(34);
 
 		XrResult result;
 		try {
@@ -776,6 +812,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrPathToString");
+		DISPATCH_STATS_SCOPE(35);
 
 		XrResult result;
 		try {
@@ -797,6 +834,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateActionSet");
+		DISPATCH_STATS_SCOPE(36);
 
 		XrResult result;
 		try {
@@ -818,6 +856,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroyActionSet(XrActionSet actionSet) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroyActionSet");
+		DISPATCH_STATS_SCOPE(37);
 
 		XrResult result;
 		try {
@@ -839,6 +878,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateAction");
+		DISPATCH_STATS_SCOPE(38);
 
 		XrResult result;
 		try {
@@ -860,6 +900,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroyAction(XrAction action) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroyAction");
+		DISPATCH_STATS_SCOPE(39);
 
 		XrResult result;
 		try {
@@ -881,6 +922,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrSuggestInteractionProfileBindings(XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrSuggestInteractionProfileBindings");
+		DISPATCH_STATS_SCOPE(40);
 
 		XrResult result;
 		try {
@@ -902,6 +944,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo* attachInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrAttachSessionActionSets");
+		DISPATCH_STATS_SCOPE(41);
 
 		XrResult result;
 		try {
@@ -923,6 +966,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath, XrInteractionProfileState* interactionProfile) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetCurrentInteractionProfile");
+		DISPATCH_STATS_SCOPE(42);
 
 		XrResult result;
 		try {
@@ -944,6 +988,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetActionStateBoolean");
+		DISPATCH_STATS_SCOPE(43);
 
 		XrResult result;
 		try {
@@ -965,6 +1010,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetActionStateFloat");
+		DISPATCH_STATS_SCOPE(44);
 
 		XrResult result;
 		try {
@@ -986,6 +1032,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetActionStateVector2f");
+		DISPATCH_STATS_SCOPE(45);
 
 		XrResult result;
 		try {
@@ -1007,6 +1054,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetActionStatePose");
+		DISPATCH_STATS_SCOPE(46);
 
 		XrResult result;
 		try {
@@ -1028,6 +1076,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrSyncActions");
+		DISPATCH_STATS_SCOPE(47);
 
 		XrResult result;
 		try {
@@ -1049,6 +1098,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateBoundSourcesForAction(XrSession session, const XrBoundSourcesForActionEnumerateInfo* enumerateInfo, uint32_t sourceCapacityInput, uint32_t* sourceCountOutput, XrPath* sources) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateBoundSourcesForAction");
+		DISPATCH_STATS_SCOPE(48);
 
 		XrResult result;
 		try {
@@ -1070,6 +1120,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetInputSourceLocalizedName(XrSession session, const XrInputSourceLocalizedNameGetInfo* getInfo, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetInputSourceLocalizedName");
+		DISPATCH_STATS_SCOPE(49);
 
 		XrResult result;
 		try {
@@ -1091,6 +1142,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrApplyHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo, const XrHapticBaseHeader* hapticFeedback) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrApplyHapticFeedback");
+		DISPATCH_STATS_SCOPE(50);
 
 		XrResult result;
 		try {
@@ -1112,6 +1164,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrStopHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrStopHapticFeedback");
+		DISPATCH_STATS_SCOPE(51);
 
 		XrResult result;
 		try {
@@ -1133,6 +1186,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetOpenGLGraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsOpenGLKHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetOpenGLGraphicsRequirementsKHR");
+		DISPATCH_STATS_SCOPE(52);
 
 		XrResult result;
 		try {
@@ -1154,6 +1208,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanInstanceExtensionsKHR(XrInstance instance, XrSystemId systemId, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanInstanceExtensionsKHR");
+		DISPATCH_STATS_SCOPE(53);
 
 		XrResult result;
 		try {
@@ -1175,6 +1230,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanDeviceExtensionsKHR(XrInstance instance, XrSystemId systemId, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanDeviceExtensionsKHR");
+		DISPATCH_STATS_SCOPE(54);
 
 		XrResult result;
 		try {
@@ -1196,6 +1252,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanGraphicsDeviceKHR(XrInstance instance, XrSystemId systemId, VkInstance vkInstance, VkPhysicalDevice* vkPhysicalDevice) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanGraphicsDeviceKHR");
+		DISPATCH_STATS_SCOPE(55);
 
 		XrResult result;
 		try {
@@ -1217,6 +1274,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanGraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsVulkanKHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanGraphicsRequirementsKHR");
+		DISPATCH_STATS_SCOPE(56);
 
 		XrResult result;
 		try {
@@ -1238,6 +1296,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetD3D11GraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsD3D11KHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetD3D11GraphicsRequirementsKHR");
+		DISPATCH_STATS_SCOPE(57);
 
 		XrResult result;
 		try {
@@ -1259,6 +1318,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetD3D12GraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsD3D12KHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetD3D12GraphicsRequirementsKHR");
+		DISPATCH_STATS_SCOPE(58);
 
 		XrResult result;
 		try {
@@ -1280,6 +1340,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVisibilityMaskKHR(XrSession session, XrViewConfigurationType viewConfigurationType, uint32_t viewIndex, XrVisibilityMaskTypeKHR visibilityMaskType, XrVisibilityMaskKHR* visibilityMask) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVisibilityMaskKHR");
+		DISPATCH_STATS_SCOPE(59);
 
 		XrResult result;
 		try {
@@ -1301,6 +1362,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrConvertWin32PerformanceCounterToTimeKHR(XrInstance instance, const LARGE_INTEGER* performanceCounter, XrTime* time) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrConvertWin32PerformanceCounterToTimeKHR");
+		DISPATCH_STATS_SCOPE(60);
 
 		XrResult result;
 		try {
@@ -1322,6 +1384,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrConvertTimeToWin32PerformanceCounterKHR(XrInstance instance, XrTime time, LARGE_INTEGER* performanceCounter) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrConvertTimeToWin32PerformanceCounterKHR");
+		DISPATCH_STATS_SCOPE(61);
 
 		XrResult result;
 		try {
@@ -1343,6 +1406,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateVulkanInstanceKHR(XrInstance instance, const XrVulkanInstanceCreateInfoKHR* createInfo, VkInstance* vulkanInstance, VkResult* vulkanResult) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateVulkanInstanceKHR");
+		DISPATCH_STATS_SCOPE(62);
 
 		XrResult result;
 		try {
@@ -1364,6 +1428,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateVulkanDeviceKHR(XrInstance instance, const XrVulkanDeviceCreateInfoKHR* createInfo, VkDevice* vulkanDevice, VkResult* vulkanResult) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateVulkanDeviceKHR");
+		DISPATCH_STATS_SCOPE(63);
 
 		XrResult result;
 		try {
@@ -1385,6 +1450,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanGraphicsDevice2KHR(XrInstance instance, const XrVulkanGraphicsDeviceGetInfoKHR* getInfo, VkPhysicalDevice* vulkanPhysicalDevice) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanGraphicsDevice2KHR");
+		DISPATCH_STATS_SCOPE(64);
 
 		XrResult result;
 		try {
@@ -1406,6 +1472,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetVulkanGraphicsRequirements2KHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsVulkanKHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetVulkanGraphicsRequirements2KHR");
+		DISPATCH_STATS_SCOPE(65);
 
 		XrResult result;
 		try {
@@ -1427,6 +1494,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrCreateHandTrackerEXT(XrSession session, const XrHandTrackerCreateInfoEXT* createInfo, XrHandTrackerEXT* handTracker) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrCreateHandTrackerEXT");
+		DISPATCH_STATS_SCOPE(66);
 
 		XrResult result;
 		try {
@@ -1448,6 +1516,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrDestroyHandTrackerEXT(XrHandTrackerEXT handTracker) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrDestroyHandTrackerEXT");
+		DISPATCH_STATS_SCOPE(67);
 
 		XrResult result;
 		try {
@@ -1469,6 +1538,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrLocateHandJointsEXT(XrHandTrackerEXT handTracker, const XrHandJointsLocateInfoEXT* locateInfo, XrHandJointLocationsEXT* locations) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrLocateHandJointsEXT");
+		DISPATCH_STATS_SCOPE(68);
 
 		XrResult result;
 		try {
@@ -1490,6 +1560,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrEnumerateDisplayRefreshRatesFB(XrSession session, uint32_t displayRefreshRateCapacityInput, uint32_t* displayRefreshRateCountOutput, float* displayRefreshRates) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrEnumerateDisplayRefreshRatesFB");
+		DISPATCH_STATS_SCOPE(69);
 
 		XrResult result;
 		try {
@@ -1511,6 +1582,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrGetDisplayRefreshRateFB(XrSession session, float* displayRefreshRate) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetDisplayRefreshRateFB");
+		DISPATCH_STATS_SCOPE(70);
 
 		XrResult result;
 		try {
@@ -1532,6 +1604,7 @@ namespace RUNTIME_NAMESPACE {
 	XrResult XRAPI_CALL xrRequestDisplayRefreshRateFB(XrSession session, float displayRefreshRate) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrRequestDisplayRefreshRateFB");
+		DISPATCH_STATS_SCOPE(71);
 
 		XrResult result;
 		try {
@@ -1550,6 +1623,72 @@ namespace RUNTIME_NAMESPACE {
 		return result;
 	}
 
+	XrResult XRAPI_CALL xrLocateSpacesKHR(XrSession session, const XrSpacesLocateInfoKHR* locateInfo, XrSpaceLocationsKHR* spaceLocations) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrLocateSpacesKHR");
+		DISPATCH_STATS_SCOPE(72);
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrLocateSpacesKHR(session, locateInfo, spaceLocations);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrLocateSpacesKHR_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrLocateSpacesKHR: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrLocateSpacesKHR", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrLocateSpacesKHR failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrGetRecommendedLayerResolutionMETA(XrSession session, const XrRecommendedLayerResolutionGetInfoMETA* info, XrRecommendedLayerResolutionMETA* resolution) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetRecommendedLayerResolutionMETA");
+		DISPATCH_STATS_SCOPE(73);
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrGetRecommendedLayerResolutionMETA(session, info, resolution);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrGetRecommendedLayerResolutionMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrGetRecommendedLayerResolutionMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetRecommendedLayerResolutionMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrGetRecommendedLayerResolutionMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrGetDeviceSampleRateFB(XrSession session, const XrHapticActionInfo* hapticActionInfo, XrDevicePcmSampleRateGetInfoFB* deviceSampleRate) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetDeviceSampleRateFB");
+		DISPATCH_STATS_SCOPE(74);
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrGetDeviceSampleRateFB(session, hapticActionInfo, deviceSampleRate);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrGetDeviceSampleRateFB_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrGetDeviceSampleRateFB: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetDeviceSampleRateFB", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrGetDeviceSampleRateFB failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 
 	// Auto-generated dispatcher handler.
 	XrResult OpenXrApi::xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
@@ -1777,6 +1916,15 @@ namespace RUNTIME_NAMESPACE {
 		else if (has_XR_FB_display_refresh_rate && apiName == "xrRequestDisplayRefreshRateFB") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrRequestDisplayRefreshRateFB);
 		}
+		else if (has_XR_KHR_locate_spaces && apiName == "xrLocateSpacesKHR") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrLocateSpacesKHR);
+		}
+		else if (has_XR_META_recommended_layer_resolution && apiName == "xrGetRecommendedLayerResolutionMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetRecommendedLayerResolutionMETA);
+		}
+		else if (has_XR_FB_haptic_pcm && apiName == "xrGetDeviceSampleRateFB") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetDeviceSampleRateFB);
+		}
 		else {
 			return XR_ERROR_FUNCTION_UNSUPPORTED;
 		}
@@ -1824,8 +1972,108 @@ namespace RUNTIME_NAMESPACE {
 		else if (extensionName == "XR_EXT_eye_gaze_interaction") {
 			has_XR_EXT_eye_gaze_interaction = true;
 		}
-
-	}
+		else if (extensionName == "XR_KHR_locate_spaces") {
+			has_XR_KHR_locate_spaces = true;
+		}
+		else if (extensionName == "XR_VARJO_quad_views") {
+			has_XR_VARJO_quad_views = true;
+		}
+		else if (extensionName == "XR_VARJO_foveated_rendering") {
+			has_XR_VARJO_foveated_rendering = true;
+		}
+		else if (extensionName == "XR_META_recommended_layer_resolution") {
+			has_XR_META_recommended_layer_resolution = true;
+		}
+		else if (extensionName == "XR_FB_haptic_pcm") {
+			has_XR_FB_haptic_pcm = true;
+		}
+
+	}
+
+	// Auto-generated names for the dispatch statistics.
+#ifdef DISPATCH_STATS
+	namespace dispatch_stats {
+		const char* const k_entryNames[] = {
+		"xrEnumerateInstanceExtensionProperties",
+		"xrCreateInstance",
+		"xrGetInstanceProperties",
+		"xrPollEvent",
+		"xrResultToString",
+		"xrStructureTypeToString",
+		"xrGetSystem",
+		"xrGetSystemProperties",
+		"xrEnumerateEnvironmentBlendModes",
+		"xrCreateSession",
+		"xrDestroySession",
+		"xrEnumerateReferenceSpaces",
+		"xrCreateReferenceSpace",
+		"xrGetReferenceSpaceBoundsRect",
+		"xrCreateActionSpace",
+		"xrLocateSpace",
+		"xrDestroySpace",
+		"xrEnumerateViewConfigurations",
+		"xrGetViewConfigurationProperties",
+		"xrEnumerateViewConfigurationViews",
+		"xrEnumerateSwapchainFormats",
+		"xrCreateSwapchain",
+		"xrDestroySwapchain",
+		"xrEnumerateSwapchainImages",
+		"xrAcquireSwapchainImage",
+		"xrWaitSwapchainImage",
+		"xrReleaseSwapchainImage",
+		"xrBeginSession",
+		"xrEndSession",
+		"xrRequestExitSession",
+		"xrWaitFrame",
+		"xrBeginFrame",
+		"xrEndFrame",
+		"xrLocateViews",
+		"xrStringToPath",
+		"xrPathToString",
+		"xrCreateActionSet",
+		"xrDestroyActionSet",
+		"xrCreateAction",
+		"xrDestroyAction",
+		"xrSuggestInteractionProfileBindings",
+		"xrAttachSessionActionSets",
+		"xrGetCurrentInteractionProfile",
+		"xrGetActionStateBoolean",
+		"xrGetActionStateFloat",
+		"xrGetActionStateVector2f",
+		"xrGetActionStatePose",
+		"xrSyncActions",
+		"xrEnumerateBoundSourcesForAction",
+		"xrGetInputSourceLocalizedName",
+		"xrApplyHapticFeedback",
+		"xrStopHapticFeedback",
+		"xrGetOpenGLGraphicsRequirementsKHR",
+		"xrGetVulkanInstanceExtensionsKHR",
+		"xrGetVulkanDeviceExtensionsKHR",
+		"xrGetVulkanGraphicsDeviceKHR",
+		"xrGetVulkanGraphicsRequirementsKHR",
+		"xrGetD3D11GraphicsRequirementsKHR",
+		"xrGetD3D12GraphicsRequirementsKHR",
+		"xrGetVisibilityMaskKHR",
+		"xrConvertWin32PerformanceCounterToTimeKHR",
+		"xrConvertTimeToWin32PerformanceCounterKHR",
+		"xrCreateVulkanInstanceKHR",
+		"xrCreateVulkanDeviceKHR",
+		"xrGetVulkanGraphicsDevice2KHR",
+		"xrGetVulkanGraphicsRequirements2KHR",
+		"xrCreateHandTrackerEXT",
+		"xrDestroyHandTrackerEXT",
+		"xrLocateHandJointsEXT",
+		"xrEnumerateDisplayRefreshRatesFB",
+		"xrGetDisplayRefreshRateFB",
+		"xrRequestDisplayRefreshRateFB",
+		"xrLocateSpacesKHR",
+		"xrGetRecommendedLayerResolutionMETA",
+		"xrGetDeviceSampleRateFB",
+		};
+		const size_t k_entriesCount = std::size(k_entryNames);
+		static_assert(std::size(k_entryNames) <= k_maxEntries);
+	} // namespace dispatch_stats
+#endif
 
 } // namespace RUNTIME_NAMESPACE
 
@@ -40,7 +40,9 @@ from xrconventions import OpenXRConventions
 EXCLUDED_API = ['xrGetInstanceProcAddr', 'xrEnumerateApiLayerProperties']
 EXTENSIONS = ['XR_KHR_D3D11_enable', 'XR_KHR_D3D12_enable', 'XR_KHR_vulkan_enable', 'XR_KHR_vulkan_enable2', 'XR_KHR_opengl_enable',
               'XR_KHR_composition_layer_depth', 'XR_KHR_visibility_mask', 'XR_KHR_win32_convert_performance_counter_time', 'XR_FB_display_refresh_rate',
-              'XR_EXT_hand_tracking', 'XR_EXT_hand_joints_motion_range', 'XR_EXT_eye_gaze_interaction']
+              'XR_EXT_hand_tracking', 'XR_EXT_hand_joints_motion_range', 'XR_EXT_eye_gaze_interaction',
+              'XR_KHR_locate_spaces', 'XR_VARJO_quad_views', 'XR_VARJO_foveated_rendering',
+              'XR_META_recommended_layer_resolution', 'XR_FB_haptic_pcm']
 
 SILENT_ERRORS = {
     'xrSuggestInteractionProfileBindings': ['XR_ERROR_PATH_UNSUPPORTED'],
@@ -107,6 +109,7 @@ class DispatchGenCppOutputGenerator(DispatchGenOutputGenerator):
 #include <runtime.h>
 
 #include "dispatch.h"
+#include "dispatch_stats.h"
 #include "log.h"
 
 #ifndef RUNTIME_NAMESPACE
@@ -122,6 +125,7 @@ namespace RUNTIME_NAMESPACE {
         generated_wrappers = self.genWrappers()
         generated_get_instance_proc_addr = self.genGetInstanceProcAddr()
         generated_register_instance_extension = self.genRegisterInstanceExtension()
+        generated_dispatch_stats_entries = self.genDispatchStatsEntries()
 
         postamble = '''} // namespace RUNTIME_NAMESPACE
 '''
@@ -136,26 +140,32 @@ namespace RUNTIME_NAMESPACE {
 	// Auto-generated extension registration handler.
 {generated_register_instance_extension}
 
+	// Auto-generated names for the dispatch statistics.
+{generated_dispatch_stats_entries}
+
 {postamble}'''
 
         write(contents, file=self.outFile)
         DispatchGenOutputGenerator.endFile(self)
 
+    def getWrappedCommands(self):
+        return [cmd for cmd in self.core_commands + self.ext_commands if cmd.name not in EXCLUDED_API + ['xrDestroyInstance']]
+
     def genWrappers(self):
         generated = ''
 
-        for cur_cmd in self.core_commands + self.ext_commands:
-            if cur_cmd.name not in EXCLUDED_API + ['xrDestroyInstance']:
-                parameters_list = self.makeParametersList(cur_cmd)
-                arguments_list = self.makeArgumentsList(cur_cmd)
+        for entry, cur_cmd in enumerate(self.getWrappedCommands()):
+            parameters_list = self.makeParametersList(cur_cmd)
+            arguments_list = self.makeArgumentsList(cur_cmd)
 
-                if cur_cmd.return_type is not None:
-                    silentErrors = ' && '.join([''] + [f'result != {err}' for err in SILENT_ERRORS[cur_cmd.name]]) if cur_cmd.name in SILENT_ERRORS else ''
+            if cur_cmd.return_type is not None:
+                silentErrors = ' && '.join([''] + [f'result != {err}' for err in SILENT_ERRORS[cur_cmd.name]]) if cur_cmd.name in SILENT_ERRORS else ''
 
-                    generated += f'''
+                generated += f'''
 	XrResult XRAPI_CALL {cur_cmd.name}({parameters_list}) {{
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "{cur_cmd.name}");
+		DISPATCH_STATS_SCOPE({entry});
 
 		XrResult result;
 		try {{
@@ -174,11 +184,12 @@ namespace RUNTIME_NAMESPACE {
 		return result;
 	}}
 '''
-                else:
-                    generated += f'''
+            else:
+                generated += f'''
 	void XRAPI_CALL {cur_cmd.name}({parameters_list}) {{
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "{cur_cmd.name}");
+		DISPATCH_STATS_SCOPE({entry});
 
 		try {{
 			RUNTIME_NAMESPACE::GetInstance()->{cur_cmd.name}({arguments_list});
@@ -190,7 +201,22 @@ namespace RUNTIME_NAMESPACE {
 		TraceLoggingWriteStop(local, "{cur_cmd.name}");
 	}}
 '''
-                
+            
+        return generated
+
+    def genDispatchStatsEntries(self):
+        names = "\n".join([f'''		"{cur_cmd.name}",''' for cur_cmd in self.getWrappedCommands()])
+
+        generated = f'''#ifdef DISPATCH_STATS
+	namespace dispatch_stats {{
+		const char* const k_entryNames[] = {{
+{names}
+		}};
+		const size_t k_entriesCount = std::size(k_entryNames);
+		static_assert(std::size(k_entryNames) <= k_maxEntries);
+	}} // namespace dispatch_stats
+#endif'''
+
         return generated
 
     def genGetInstanceProcAddr(self):
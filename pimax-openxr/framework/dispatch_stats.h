@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#ifndef RUNTIME_NAMESPACE
+#error Must define RUNTIME_NAMESPACE
+#endif
+
+// Per-entry point call statistics, recorded by the auto-generated wrappers when building with DISPATCH_STATS (defined
+// by the project when building with /p:DispatchStats=true). Without it, DISPATCH_STATS_SCOPE() compiles to nothing.
+namespace RUNTIME_NAMESPACE::dispatch_stats {
+
+    constexpr size_t k_maxEntries = 128;
+
+    // Bucket 0 counts the calls under 1us, bucket i the calls within [2^(i-1), 2^i) us, and the last bucket all the
+    // longer calls.
+    constexpr size_t k_histogramBuckets = 16;
+
+    struct EntryStats {
+        const char* name{nullptr};
+        uint64_t calls{0};
+        uint64_t totalNs{0};
+        uint64_t maxNs{0};
+        uint64_t histogram[k_histogramBuckets]{};
+    };
+
+#ifdef DISPATCH_STATS
+    // Defined in dispatch.gen.cpp, in the order of the entry indices.
+    extern const char* const k_entryNames[];
+    extern const size_t k_entriesCount;
+
+    namespace details {
+
+        // The counters of one thread. Only the owning thread updates them, so there are no atomic read-modify-write
+        // operations on the hot path, while collect() may read them at any time.
+        struct ThreadCounters {
+            struct Entry {
+                std::atomic<uint64_t> calls{0};
+                std::atomic<uint64_t> totalNs{0};
+                std::atomic<uint64_t> maxNs{0};
+                std::atomic<uint64_t> histogram[k_histogramBuckets]{};
+            };
+
+            ThreadCounters();
+            ~ThreadCounters();
+
+            Entry entries[k_maxEntries];
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<ThreadCounters*> threads;
+            // The counters of the threads that exited.
+            EntryStats retired[k_maxEntries];
+        };
+
+        inline Registry& getRegistry() {
+            static Registry registry;
+            return registry;
+        }
+
+        inline ThreadCounters::ThreadCounters() {
+            Registry& registry = getRegistry();
+            std::unique_lock lock(registry.mutex);
+            registry.threads.push_back(this);
+        }
+
+        inline ThreadCounters::~ThreadCounters() {
+            Registry& registry = getRegistry();
+            std::unique_lock lock(registry.mutex);
+            for (size_t i = 0; i < k_maxEntries; i++) {
+                EntryStats& retired = registry.retired[i];
+                retired.calls += entries[i].calls.load(std::memory_order_relaxed);
+                retired.totalNs += entries[i].totalNs.load(std::memory_order_relaxed);
+                retired.maxNs = std::max(retired.maxNs, entries[i].maxNs.load(std::memory_order_relaxed));
+                for (size_t j = 0; j < k_histogramBuckets; j++) {
+                    retired.histogram[j] += entries[i].histogram[j].load(std::memory_order_relaxed);
+                }
+            }
+            registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+        }
+
+        inline ThreadCounters& getThreadCounters() {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        inline void add(std::atomic<uint64_t>& counter, uint64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+    } // namespace details
+
+    class CallScope {
+      public:
+        explicit CallScope(size_t entry) : m_entry(entry), m_start(std::chrono::steady_clock::now()) {
+        }
+
+        ~CallScope() {
+            const uint64_t durationNs =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start)
+                    .count();
+
+            auto& counters = details::getThreadCounters().entries[m_entry];
+            details::add(counters.calls, 1);
+            details::add(counters.totalNs, durationNs);
+            if (durationNs > counters.maxNs.load(std::memory_order_relaxed)) {
+                counters.maxNs.store(durationNs, std::memory_order_relaxed);
+            }
+
+            const uint64_t durationUs = durationNs / 1000;
+            size_t bucket = 0;
+            while (bucket < k_histogramBuckets - 1 && durationUs >= (1ull << bucket)) {
+                bucket++;
+            }
+            details::add(counters.histogram[bucket], 1);
+        }
+
+      private:
+        const size_t m_entry;
+        const std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Merge the counters of all the threads. Only the entries that were called are returned.
+    inline void collect(std::vector<EntryStats>& stats) {
+        stats.clear();
+
+        details::Registry& registry = details::getRegistry();
+        std::unique_lock lock(registry.mutex);
+        for (size_t i = 0; i < k_entriesCount; i++) {
+            EntryStats entry = registry.retired[i];
+            entry.name = k_entryNames[i];
+            for (const auto thread : registry.threads) {
+                const auto& counters = thread->entries[i];
+                entry.calls += counters.calls.load(std::memory_order_relaxed);
+                entry.totalNs += counters.totalNs.load(std::memory_order_relaxed);
+                entry.maxNs = std::max(entry.maxNs, counters.maxNs.load(std::memory_order_relaxed));
+                for (size_t j = 0; j < k_histogramBuckets; j++) {
+                    entry.histogram[j] += counters.histogram[j].load(std::memory_order_relaxed);
+                }
+            }
+            if (entry.calls) {
+                stats.push_back(entry);
+            }
+        }
+    }
+
+#define DISPATCH_STATS_SCOPE(entry) RUNTIME_NAMESPACE::dispatch_stats::CallScope dispatchStatsScope(entry)
+#else
+#define DISPATCH_STATS_SCOPE(entry)
+#endif
+
+} // namespace RUNTIME_NAMESPACE::dispatch_stats
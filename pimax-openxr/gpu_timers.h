@@ -4,79 +4,205 @@
 
 namespace pimax_openxr::utils {
 
-    // An asynchronous GPU timer for Direct3D 11.
-    struct D3D11GpuTimer : public ITimer {
-        D3D11GpuTimer(ID3D11Device* device, ID3D11DeviceContext* context) : m_context(context) {
-            D3D11_QUERY_DESC queryDesc;
-            ZeroMemory(&queryDesc, sizeof(D3D11_QUERY_DESC));
-            queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampDis.ReleaseAndGetAddressOf()));
-            queryDesc.Query = D3D11_QUERY_TIMESTAMP;
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampStart.ReleaseAndGetAddressOf()));
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampEnd.ReleaseAndGetAddressOf()));
+    // A pool of GPU timestamp queries shared by all the timers on the same device (or queue). Each timer owns a span
+    // (a pair of queries) in every frame slot, and the slots are recycled in a ring, so that the results of a frame are
+    // read back several frames later without ever stalling. Whenever possible, the timestamps are recorded into one
+    // batch and the results of a frame are resolved together.
+    class GpuTimestampPool {
+      public:
+        GpuTimestampPool(uint32_t maxSpans, uint32_t frameLatency)
+            : m_maxSpans(maxSpans), m_frameLatency(frameLatency), m_written(maxSpans * 2 * frameLatency, false) {
+        }
+        virtual ~GpuTimestampPool() = default;
+
+        // Must be done before the first timestamp is written.
+        uint32_t allocateSpan() {
+            CHECK_MSG(m_spanCount < m_maxSpans, "Too many GPU timer spans");
+            return m_spanCount++;
+        }
+
+        // Write the start or the end timestamp of a span in the current frame slot.
+        void writeTimestamp(uint32_t span, bool isEnd) {
+            if (!m_isSlotOpen) {
+                openSlot(m_currentSlot);
+                m_isSlotOpen = true;
+            }
+            const uint32_t index = queryIndex(m_currentSlot, span * 2 + (isEnd ? 1 : 0));
+            writeQuery(index);
+            m_written[index] = true;
+        }
+
+        // Submit the timestamps recorded so far.
+        virtual void flush() {
+        }
+
+        // Close the current frame slot after the last span of the frame, and move to the next slot.
+        void nextFrame() {
+            if (m_isSlotOpen) {
+                closeSlot(m_currentSlot);
+                m_isSlotOpen = false;
+            }
+            m_currentSlot = (m_currentSlot + 1) % m_frameLatency;
+        }
+
+        // Read the duration of a span in the current frame slot, ie: the one recorded frameLatency frames ago. Must be
+        // invoked before the span is written again.
+        std::optional<uint64_t> readSpan(uint32_t span) const {
+            const uint32_t startIndex = queryIndex(m_currentSlot, span * 2);
+            if (m_isSlotOpen || !m_written[startIndex] || !m_written[startIndex + 1]) {
+                return {};
+            }
+            return readQueries(m_currentSlot, startIndex);
+        }
+
+        uint32_t frameLatency() const {
+            return m_frameLatency;
+        }
+
+      protected:
+        uint32_t queriesPerSlot() const {
+            return m_maxSpans * 2;
+        }
+
+        uint32_t queryIndex(uint32_t slot, uint32_t query) const {
+            return slot * queriesPerSlot() + query;
+        }
+
+        // Invoked before the first timestamp of a frame slot is written.
+        virtual void openSlot(uint32_t slot) {
+            std::fill_n(m_written.begin() + queryIndex(slot, 0), queriesPerSlot(), false);
+        }
+
+        virtual void closeSlot(uint32_t slot) {
+        }
+
+        virtual void writeQuery(uint32_t index) = 0;
+
+        // Returns the duration in microseconds between the timestamps at startIndex and startIndex + 1.
+        virtual std::optional<uint64_t> readQueries(uint32_t slot, uint32_t startIndex) const = 0;
+
+      private:
+        const uint32_t m_maxSpans;
+        const uint32_t m_frameLatency;
+        uint32_t m_spanCount{0};
+        uint32_t m_currentSlot{0};
+        bool m_isSlotOpen{false};
+        std::vector<bool> m_written;
+    };
+
+    // An asynchronous GPU timer, measuring one span of a timestamp pool.
+    struct GpuTimer : public ITimer {
+        GpuTimer(GpuTimestampPool& pool) : m_pool(pool), m_span(pool.allocateSpan()) {
         }
 
         void start() override {
-            m_context->Begin(m_timeStampDis.Get());
-            m_context->End(m_timeStampStart.Get());
+            m_pool.writeTimestamp(m_span, false /* isEnd */);
+            m_pool.flush();
         }
 
         void stop() override {
-            m_context->End(m_timeStampEnd.Get());
-            m_context->End(m_timeStampDis.Get());
+            m_pool.writeTimestamp(m_span, true /* isEnd */);
+            m_pool.flush();
             m_valid = true;
         }
 
         uint64_t query(bool reset = true) const override {
             uint64_t duration = 0;
             if (m_valid) {
-                UINT64 startime = 0, endtime = 0;
-                D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disData = {0};
-
-                if (m_context->GetData(m_timeStampStart.Get(), &startime, sizeof(UINT64), 0) == S_OK &&
-                    m_context->GetData(m_timeStampEnd.Get(), &endtime, sizeof(UINT64), 0) == S_OK &&
-                    m_context->GetData(
-                        m_timeStampDis.Get(), &disData, sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT), 0) == S_OK &&
-                    !disData.Disjoint) {
-                    duration = static_cast<uint64_t>(((endtime - startime) * 1e6) / disData.Frequency);
-                }
+                duration = m_pool.readSpan(m_span).value_or(0);
                 m_valid = !reset;
             }
             return duration;
         }
 
       private:
-        const ComPtr<ID3D11DeviceContext> m_context;
-        ComPtr<ID3D11Query> m_timeStampDis;
-        ComPtr<ID3D11Query> m_timeStampStart;
-        ComPtr<ID3D11Query> m_timeStampEnd;
+        GpuTimestampPool& m_pool;
+        const uint32_t m_span;
 
         // Can the timer be queried (it might still only read 0).
         mutable bool m_valid{false};
     };
 
-    // An asynchronous GPU timer for Direct3D 12.
-    struct D3D12GpuTimer : public ITimer {
-        D3D12GpuTimer(ID3D12Device* device, ID3D12CommandQueue* queue) : m_queue(queue) {
-            // Create the command context.
-            for (uint32_t i = 0; i < 2; i++) {
-                CHECK_HRCMD(device->CreateCommandAllocator(
-                    D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(m_commandAllocator[i].ReleaseAndGetAddressOf())));
-                m_commandAllocator[i]->SetName(L"Timer Command Allocator");
-                CHECK_HRCMD(device->CreateCommandList(0,
-                                                      D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                      m_commandAllocator[i].Get(),
-                                                      nullptr,
-                                                      IID_PPV_ARGS(m_commandList[i].ReleaseAndGetAddressOf())));
-                m_commandList[i]->SetName(L"Timer Command List");
-                CHECK_HRCMD(m_commandList[i]->Close());
+    // Timestamp queries for Direct3D 11. Each frame slot is bracketed by its own disjoint query.
+    class D3D11TimestampPool : public GpuTimestampPool {
+      public:
+        D3D11TimestampPool(ID3D11Device* device, ID3D11DeviceContext* context, uint32_t maxSpans, uint32_t frameLatency)
+            : GpuTimestampPool(maxSpans, frameLatency), m_context(context) {
+            D3D11_QUERY_DESC queryDesc;
+            ZeroMemory(&queryDesc, sizeof(D3D11_QUERY_DESC));
+            queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+            m_timeStampDis.resize(frameLatency);
+            for (auto& query : m_timeStampDis) {
+                CHECK_HRCMD(device->CreateQuery(&queryDesc, query.ReleaseAndGetAddressOf()));
+            }
+            queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+            m_timeStamps.resize(queriesPerSlot() * frameLatency);
+            for (auto& query : m_timeStamps) {
+                CHECK_HRCMD(device->CreateQuery(&queryDesc, query.ReleaseAndGetAddressOf()));
+            }
+        }
+
+      protected:
+        void openSlot(uint32_t slot) override {
+            GpuTimestampPool::openSlot(slot);
+            m_context->Begin(m_timeStampDis[slot].Get());
+        }
+
+        void closeSlot(uint32_t slot) override {
+            m_context->End(m_timeStampDis[slot].Get());
+        }
+
+        void writeQuery(uint32_t index) override {
+            m_context->End(m_timeStamps[index].Get());
+        }
+
+        std::optional<uint64_t> readQueries(uint32_t slot, uint32_t startIndex) const override {
+            UINT64 startime = 0, endtime = 0;
+            D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disData = {0};
+            if (m_context->GetData(m_timeStamps[startIndex].Get(), &startime, sizeof(UINT64), 0) == S_OK &&
+                m_context->GetData(m_timeStamps[startIndex + 1].Get(), &endtime, sizeof(UINT64), 0) == S_OK &&
+                m_context->GetData(
+                    m_timeStampDis[slot].Get(), &disData, sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT), 0) == S_OK &&
+                !disData.Disjoint) {
+                return static_cast<uint64_t>(((endtime - startime) * 1e6) / disData.Frequency);
+            }
+            return {};
+        }
+
+      private:
+        const ComPtr<ID3D11DeviceContext> m_context;
+        std::vector<ComPtr<ID3D11Query>> m_timeStampDis;
+        std::vector<ComPtr<ID3D11Query>> m_timeStamps;
+    };
+
+    // Timestamp queries for Direct3D 12. All the timestamps live in one query heap, and they are recorded into a
+    // single command list that is only submitted upon flush(). The whole frame slot is resolved with one command, which
+    // is submitted along with the next batch of timestamps.
+    class D3D12TimestampPool : public GpuTimestampPool {
+      public:
+        D3D12TimestampPool(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t maxSpans, uint32_t frameLatency)
+            : GpuTimestampPool(maxSpans, frameLatency), m_queue(queue), m_fenceValues(frameLatency, 0) {
+            // Create the command context. There is one allocator per frame slot, since we can only reset an allocator
+            // once the GPU is done with all the commands of the slot.
+            m_commandAllocators.resize(frameLatency);
+            for (auto& allocator : m_commandAllocators) {
+                CHECK_HRCMD(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                           IID_PPV_ARGS(allocator.ReleaseAndGetAddressOf())));
+                allocator->SetName(L"Timer Command Allocator");
             }
+            CHECK_HRCMD(device->CreateCommandList(0,
+                                                  D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                  m_commandAllocators[0].Get(),
+                                                  nullptr,
+                                                  IID_PPV_ARGS(m_commandList.ReleaseAndGetAddressOf())));
+            m_commandList->SetName(L"Timer Command List");
+            CHECK_HRCMD(m_commandList->Close());
             CHECK_HRCMD(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_fence.ReleaseAndGetAddressOf())));
             m_fence->SetName(L"Timer Readback Fence");
 
             // Create the query heap and readback resources.
             D3D12_QUERY_HEAP_DESC heapDesc{};
-            heapDesc.Count = 2;
+            heapDesc.Count = queriesPerSlot() * frameLatency;
             heapDesc.NodeMask = 0;
             heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
             CHECK_HRCMD(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(m_queryHeap.ReleaseAndGetAddressOf())));
@@ -98,71 +224,116 @@ namespace pimax_openxr::utils {
                                                         nullptr,
                                                         IID_PPV_ARGS(m_queryReadbackBuffer.ReleaseAndGetAddressOf())));
             m_queryReadbackBuffer->SetName(L"Query Readback Buffer");
+
+            // Readback buffers may remain mapped, we only read from them once the fence is signaled.
+            CHECK_HRCMD(m_queryReadbackBuffer->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedReadbackBuffer)));
+
+            if (FAILED(m_queue->GetTimestampFrequency(&m_gpuTickFrequency))) {
+                m_gpuTickFrequency = 0;
+            }
         }
 
-        void start() override {
-            CHECK_HRCMD(m_commandAllocator[0]->Reset());
-            CHECK_HRCMD(m_commandList[0]->Reset(m_commandAllocator[0].Get(), nullptr));
-            m_commandList[0]->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
-            CHECK_HRCMD(m_commandList[0]->Close());
-            ID3D12CommandList* const lists[] = {m_commandList[0].Get()};
-            m_queue->ExecuteCommandLists(1, lists);
+        ~D3D12TimestampPool() override {
+            m_queryReadbackBuffer->Unmap(0, nullptr);
         }
 
-        void stop() override {
-            CHECK_HRCMD(m_commandAllocator[1]->Reset());
-            CHECK_HRCMD(m_commandList[1]->Reset(m_commandAllocator[1].Get(), nullptr));
-            m_commandList[1]->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
-            m_commandList[1]->ResolveQueryData(
-                m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0, 2, m_queryReadbackBuffer.Get(), 0);
-            CHECK_HRCMD(m_commandList[1]->Close());
-            ID3D12CommandList* const lists[] = {m_commandList[1].Get()};
+        void flush() override {
+            if (!m_isCommandListOpen) {
+                return;
+            }
+
+            CHECK_HRCMD(m_commandList->Close());
+            ID3D12CommandList* const lists[] = {m_commandList.Get()};
             m_queue->ExecuteCommandLists(1, lists);
+            m_isCommandListOpen = false;
 
-            // Signal a fence for completion.
-            m_queue->Signal(m_fence.Get(), ++m_fenceValue);
-            m_valid = true;
+            // Signal a fence for completion of the resolved frame slot.
+            if (m_slotPendingSignal) {
+                CHECK_HRCMD(m_queue->Signal(m_fence.Get(), ++m_fenceValue));
+                m_fenceValues[m_slotPendingSignal.value()] = m_fenceValue;
+                m_slotPendingSignal.reset();
+            }
         }
 
-        uint64_t query(bool reset = true) const override {
-            uint64_t duration = 0;
-            if (m_valid) {
-                uint64_t gpuTickFrequency;
-                if (m_fence->GetCompletedValue() >= m_fenceValue &&
-                    SUCCEEDED(m_queue->GetTimestampFrequency(&gpuTickFrequency))) {
-                    uint64_t* mappedBuffer;
-                    D3D12_RANGE range{0, 2 * sizeof(uint64_t)};
-                    CHECK_HRCMD(m_queryReadbackBuffer->Map(0, &range, reinterpret_cast<void**>(&mappedBuffer)));
-                    duration = ((mappedBuffer[1] - mappedBuffer[0]) * 1000000) / gpuTickFrequency;
-                    m_queryReadbackBuffer->Unmap(0, nullptr);
-                }
-                m_valid = !reset;
+      protected:
+        void openSlot(uint32_t slot) override {
+            GpuTimestampPool::openSlot(slot);
+
+            // The command list may still be open with the resolve of the previous slot, in which case the first
+            // timestamps of this slot are batched with it. Before reusing the allocator, make sure the GPU is done with
+            // the commands from frameLatency frames ago. In practice, this never waits.
+            if (m_currentAllocator == slot) {
+                flush();
             }
-            return duration;
+            if (m_fenceValues[slot] && m_fence->GetCompletedValue() < m_fenceValues[slot]) {
+                CHECK_HRCMD(m_fence->SetEventOnCompletion(m_fenceValues[slot], nullptr));
+            }
+            m_fenceValues[slot] = 0;
+            CHECK_HRCMD(m_commandAllocators[slot]->Reset());
+            m_currentAllocator = slot;
+        }
+
+        void closeSlot(uint32_t slot) override {
+            ensureCommandListOpen();
+            m_commandList->ResolveQueryData(m_queryHeap.Get(),
+                                            D3D12_QUERY_TYPE_TIMESTAMP,
+                                            queryIndex(slot, 0),
+                                            queriesPerSlot(),
+                                            m_queryReadbackBuffer.Get(),
+                                            queryIndex(slot, 0) * sizeof(uint64_t));
+            m_slotPendingSignal = slot;
+        }
+
+        void writeQuery(uint32_t index) override {
+            ensureCommandListOpen();
+            m_commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index);
+        }
+
+        std::optional<uint64_t> readQueries(uint32_t slot, uint32_t startIndex) const override {
+            if (!m_gpuTickFrequency || !m_fenceValues[slot] || m_fence->GetCompletedValue() < m_fenceValues[slot]) {
+                return {};
+            }
+            return ((m_mappedReadbackBuffer[startIndex + 1] - m_mappedReadbackBuffer[startIndex]) * 1000000) /
+                   m_gpuTickFrequency;
         }
 
       private:
+        void ensureCommandListOpen() {
+            if (!m_isCommandListOpen) {
+                CHECK_HRCMD(m_commandList->Reset(m_commandAllocators[m_currentAllocator].Get(), nullptr));
+                m_isCommandListOpen = true;
+            }
+        }
+
         const ComPtr<ID3D12CommandQueue> m_queue;
-        ComPtr<ID3D12CommandAllocator> m_commandAllocator[2];
-        ComPtr<ID3D12GraphicsCommandList> m_commandList[2];
+        std::vector<ComPtr<ID3D12CommandAllocator>> m_commandAllocators;
+        uint32_t m_currentAllocator{0};
+        ComPtr<ID3D12GraphicsCommandList> m_commandList;
+        bool m_isCommandListOpen{false};
         ComPtr<ID3D12Fence> m_fence;
         uint64_t m_fenceValue{0};
+        std::vector<uint64_t> m_fenceValues;
+        std::optional<uint32_t> m_slotPendingSignal;
         ComPtr<ID3D12QueryHeap> m_queryHeap;
         ComPtr<ID3D12Resource> m_queryReadbackBuffer;
-
-        // Can the timer be queried (it might still only read 0).
-        mutable bool m_valid{false};
+        const uint64_t* m_mappedReadbackBuffer{nullptr};
+        uint64_t m_gpuTickFrequency{0};
     };
 
-    // An asynchronous GPU timer for Vulkan.
-    struct VulkanGpuTimer : public ITimer {
-        VulkanGpuTimer(const VulkanDispatch& dispatch,
-                       VkPhysicalDevice physicalDevice,
-                       VkDevice device,
-                       VkQueue queue,
-                       uint32_t queueFamilyIndex,
-                       const std::optional<VkAllocationCallbacks>& allocator)
-            : m_dispatch(dispatch), m_device(device), m_queue(queue), m_allocator(allocator) {
+    // Timestamp queries for Vulkan. All the timestamps live in one query pool, and the queries of a frame slot are
+    // reset in the same command buffer as the first timestamp of the slot.
+    class VulkanTimestampPool : public GpuTimestampPool {
+      public:
+        VulkanTimestampPool(const VulkanDispatch& dispatch,
+                            VkPhysicalDevice physicalDevice,
+                            VkDevice device,
+                            VkQueue queue,
+                            uint32_t queueFamilyIndex,
+                            const std::optional<VkAllocationCallbacks>& allocator,
+                            uint32_t maxSpans,
+                            uint32_t frameLatency)
+            : GpuTimestampPool(maxSpans, frameLatency), m_dispatch(dispatch), m_device(device), m_queue(queue),
+              m_allocator(allocator), m_cmdBuffers(frameLatency) {
             // Query the timestamp period.
             VkPhysicalDeviceProperties2 properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
             m_dispatch.vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
@@ -174,146 +345,190 @@ namespace pimax_openxr::utils {
             poolCreateInfo.queueFamilyIndex = queueFamilyIndex;
             CHECK_VKCMD(m_dispatch.vkCreateCommandPool(
                 m_device, &poolCreateInfo, m_allocator ? &m_allocator.value() : nullptr, &m_cmdPool));
-            VkCommandBufferAllocateInfo allocateInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-            allocateInfo.commandPool = m_cmdPool;
-            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocateInfo.commandBufferCount = 2;
-            CHECK_VKCMD(m_dispatch.vkAllocateCommandBuffers(m_device, &allocateInfo, m_cmdBuffer));
 
             // Create the query pool.
             VkQueryPoolCreateInfo createInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
             createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-            createInfo.queryCount = 2;
+            createInfo.queryCount = queriesPerSlot() * frameLatency;
             CHECK_VKCMD(m_dispatch.vkCreateQueryPool(
                 m_device, &createInfo, m_allocator ? &m_allocator.value() : nullptr, &m_queryPool));
         }
 
-        ~VulkanGpuTimer() override {
+        ~VulkanTimestampPool() override {
             if (m_queryPool != VK_NULL_HANDLE) {
                 m_dispatch.vkDestroyQueryPool(m_device, m_queryPool, m_allocator ? &m_allocator.value() : nullptr);
             }
-            if (m_cmdBuffer[0] != VK_NULL_HANDLE) {
-                m_dispatch.vkFreeCommandBuffers(m_device, m_cmdPool, 2, m_cmdBuffer);
+            for (const auto& cmdBuffers : m_cmdBuffers) {
+                if (!cmdBuffers.empty()) {
+                    m_dispatch.vkFreeCommandBuffers(
+                        m_device, m_cmdPool, (uint32_t)cmdBuffers.size(), cmdBuffers.data());
+                }
             }
             if (m_cmdPool != VK_NULL_HANDLE) {
                 m_dispatch.vkDestroyCommandPool(m_device, m_cmdPool, m_allocator ? &m_allocator.value() : nullptr);
             }
         }
 
-        void start() override {
-            VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            CHECK_VKCMD(m_dispatch.vkBeginCommandBuffer(m_cmdBuffer[0], &beginInfo));
-            m_dispatch.vkCmdResetQueryPool(m_cmdBuffer[0], m_queryPool, 0, 2);
-            m_dispatch.vkCmdWriteTimestamp(m_cmdBuffer[0], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 0);
-            CHECK_VKCMD(m_dispatch.vkEndCommandBuffer(m_cmdBuffer[0]));
-            VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &m_cmdBuffer[0];
-            CHECK_VKCMD(m_dispatch.vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE));
+        // Only start timestamps need to be submitted right away, ahead of the work they measure. End timestamps are
+        // deferred to the next submission made by the pool.
+        void flush() override {
+            if (m_hasPendingStart) {
+                submit(VK_NULL_HANDLE, 0);
+            }
         }
 
-        void stop() override {
-            VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            CHECK_VKCMD(m_dispatch.vkBeginCommandBuffer(m_cmdBuffer[1], &beginInfo));
-            m_dispatch.vkCmdWriteTimestamp(m_cmdBuffer[1], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 1);
-            CHECK_VKCMD(m_dispatch.vkEndCommandBuffer(m_cmdBuffer[1]));
+        // Submit the pending timestamps (if any) in a batch signaling the timeline semaphore. This always makes exactly
+        // one submission, so it can replace the caller's own signal submission.
+        void flushAndSignal(VkSemaphore semaphore, uint64_t value) {
+            submit(semaphore, value);
+        }
+
+      protected:
+        void openSlot(uint32_t slot) override {
+            GpuTimestampPool::openSlot(slot);
+
+            // The command buffers of the slot were submitted frameLatency frames ago, and are reused.
+            if (m_isCmdBufferOpen) {
+                submit(VK_NULL_HANDLE, 0);
+            }
+            m_currentSlot = slot;
+            m_nextCmdBuffer = 0;
+            ensureCmdBufferOpen();
+            m_dispatch.vkCmdResetQueryPool(m_cmdBuffers[slot][0], m_queryPool, queryIndex(slot, 0), queriesPerSlot());
+        }
+
+        void writeQuery(uint32_t index) override {
+            ensureCmdBufferOpen();
+            // Start timestamps are at even indices.
+            if (index % 2 == 0) {
+                m_hasPendingStart = true;
+            }
+            m_dispatch.vkCmdWriteTimestamp(m_cmdBuffers[m_currentSlot][m_nextCmdBuffer],
+                                           index % 2 ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                                                     : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                           m_queryPool,
+                                           index);
+        }
+
+        std::optional<uint64_t> readQueries(uint32_t slot, uint32_t startIndex) const override {
+            uint64_t buffer[2];
+            const VkResult result = m_dispatch.vkGetQueryPoolResults(m_device,
+                                                                     m_queryPool,
+                                                                     startIndex,
+                                                                     2,
+                                                                     sizeof(uint64_t) * 2,
+                                                                     buffer,
+                                                                     sizeof(uint64_t),
+                                                                     VK_QUERY_RESULT_64_BIT);
+            if (result != VK_SUCCESS) {
+                return {};
+            }
+            return static_cast<uint64_t>(((buffer[1] - buffer[0]) * m_timestampPeriod) / 1000);
+        }
+
+      private:
+        void submit(VkSemaphore semaphore, uint64_t value) {
+            VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+            timelineInfo.signalSemaphoreValueCount = 1;
+            timelineInfo.pSignalSemaphoreValues = &value;
             VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &m_cmdBuffer[1];
+            if (semaphore != VK_NULL_HANDLE) {
+                submitInfo.pNext = &timelineInfo;
+                submitInfo.signalSemaphoreCount = 1;
+                submitInfo.pSignalSemaphores = &semaphore;
+            }
+
+            VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+            if (m_isCmdBufferOpen) {
+                cmdBuffer = m_cmdBuffers[m_currentSlot][m_nextCmdBuffer++];
+                CHECK_VKCMD(m_dispatch.vkEndCommandBuffer(cmdBuffer));
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &cmdBuffer;
+            }
             CHECK_VKCMD(m_dispatch.vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE));
-            m_valid = true;
+            m_isCmdBufferOpen = false;
+            m_hasPendingStart = false;
         }
 
-        uint64_t query(bool reset = true) const override {
-            uint64_t duration = 0;
-            if (m_valid) {
-                uint64_t buffer[2];
-                VkResult result = m_dispatch.vkGetQueryPoolResults(m_device,
-                                                                   m_queryPool,
-                                                                   0,
-                                                                   2,
-                                                                   sizeof(uint64_t) * 2,
-                                                                   buffer,
-                                                                   sizeof(uint64_t),
-                                                                   VK_QUERY_RESULT_64_BIT);
-                if (result == VK_SUCCESS) {
-                    duration = static_cast<uint64_t>(((buffer[1] - buffer[0]) * m_timestampPeriod) / 1000);
-                }
+        void ensureCmdBufferOpen() {
+            if (m_isCmdBufferOpen) {
+                return;
+            }
 
-                m_valid = !reset;
+            auto& cmdBuffers = m_cmdBuffers[m_currentSlot];
+            if (m_nextCmdBuffer == cmdBuffers.size()) {
+                VkCommandBufferAllocateInfo allocateInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+                allocateInfo.commandPool = m_cmdPool;
+                allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocateInfo.commandBufferCount = 1;
+                VkCommandBuffer cmdBuffer;
+                CHECK_VKCMD(m_dispatch.vkAllocateCommandBuffers(m_device, &allocateInfo, &cmdBuffer));
+                cmdBuffers.push_back(cmdBuffer);
             }
-            return duration;
+
+            VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            CHECK_VKCMD(m_dispatch.vkBeginCommandBuffer(cmdBuffers[m_nextCmdBuffer], &beginInfo));
+            m_isCmdBufferOpen = true;
         }
 
-      private:
         const VulkanDispatch& m_dispatch;
         const VkDevice m_device;
         const VkQueue m_queue;
         const std::optional<VkAllocationCallbacks> m_allocator;
         float m_timestampPeriod{};
         VkCommandPool m_cmdPool{VK_NULL_HANDLE};
-        VkCommandBuffer m_cmdBuffer[2]{VK_NULL_HANDLE, VK_NULL_HANDLE};
+        std::vector<std::vector<VkCommandBuffer>> m_cmdBuffers;
+        uint32_t m_currentSlot{0};
+        size_t m_nextCmdBuffer{0};
+        bool m_isCmdBufferOpen{false};
+        bool m_hasPendingStart{false};
         VkQueryPool m_queryPool{VK_NULL_HANDLE};
-
-        // Can the timer be queried (it might still only read 0).
-        mutable bool m_valid{false};
     };
 
-    // An asynchronous GPU timer for OpenGL.
-    struct GlGpuTimer : public ITimer {
-        GlGpuTimer(const GlDispatch& dispatch, const GlContext& context) : m_dispatch(dispatch), m_context(context) {
+    // Timestamp queries for OpenGL.
+    class GlTimestampPool : public GpuTimestampPool {
+      public:
+        GlTimestampPool(const GlDispatch& dispatch, const GlContext& context, uint32_t maxSpans, uint32_t frameLatency)
+            : GpuTimestampPool(maxSpans, frameLatency), m_dispatch(dispatch), m_context(context),
+              m_queries(queriesPerSlot() * frameLatency) {
             GlContextSwitch context_(m_context);
 
-            m_dispatch.glGenQueries(2, m_queries);
+            m_dispatch.glGenQueries((GLsizei)m_queries.size(), m_queries.data());
         }
 
-        ~GlGpuTimer() override {
+        ~GlTimestampPool() override {
             GlContextSwitch context(m_context);
 
-            m_dispatch.glDeleteQueries(2, m_queries);
+            m_dispatch.glDeleteQueries((GLsizei)m_queries.size(), m_queries.data());
         }
 
-        void start() override {
+      protected:
+        void writeQuery(uint32_t index) override {
             GlContextSwitch context(m_context);
 
-            m_dispatch.glQueryCounter(m_queries[0], GL_TIMESTAMP);
+            m_dispatch.glQueryCounter(m_queries[index], GL_TIMESTAMP);
         }
 
-        void stop() override {
+        std::optional<uint64_t> readQueries(uint32_t slot, uint32_t startIndex) const override {
             GlContextSwitch context(m_context);
 
-            m_dispatch.glQueryCounter(m_queries[1], GL_TIMESTAMP);
-            m_valid = true;
-        }
-
-        uint64_t query(bool reset = true) const override {
-            uint64_t duration = 0;
-            if (m_valid) {
-                GlContextSwitch context(m_context);
-
-                GLint stopTimerAvailable = 0;
-                m_dispatch.glGetQueryObjectiv(m_queries[1], GL_QUERY_RESULT_AVAILABLE, &stopTimerAvailable);
-                if (stopTimerAvailable) {
-                    uint64_t startTime, stopTime;
-                    m_dispatch.glGetQueryObjectui64v(m_queries[0], GL_QUERY_RESULT, &startTime);
-                    m_dispatch.glGetQueryObjectui64v(m_queries[1], GL_QUERY_RESULT, &stopTime);
-                    duration = (stopTime - startTime) / 1000;
-                }
-                m_valid = !reset;
+            GLint stopTimerAvailable = 0;
+            m_dispatch.glGetQueryObjectiv(m_queries[startIndex + 1], GL_QUERY_RESULT_AVAILABLE, &stopTimerAvailable);
+            if (!stopTimerAvailable) {
+                return {};
             }
-            return duration;
+            uint64_t startTime, stopTime;
+            m_dispatch.glGetQueryObjectui64v(m_queries[startIndex], GL_QUERY_RESULT, &startTime);
+            m_dispatch.glGetQueryObjectui64v(m_queries[startIndex + 1], GL_QUERY_RESULT, &stopTime);
+            return (stopTime - startTime) / 1000;
         }
 
       private:
         const GlDispatch& m_dispatch;
         const GlContext& m_context;
 
-        GLuint m_queries[2]{};
-
-        // Can the timer be queried (it might still only read 0).
-        mutable bool m_valid{false};
+        std::vector<GLuint> m_queries;
     };
 
 } // namespace pimax_openxr::utils
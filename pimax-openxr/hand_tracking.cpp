@@ -23,6 +23,7 @@
 #include "pch.h"
 
 #include "log.h"
+#include "pose_math.h"
 #include "runtime.h"
 #include "utils.h"
 
@@ -34,6 +35,7 @@ namespace pimax_openxr {
     using namespace pimax_openxr::log;
     using namespace pimax_openxr::utils;
     using namespace xr::math;
+    using namespace DirectX;
 
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrCreateHandTrackerEXT
     XrResult OpenXrRuntime::xrCreateHandTrackerEXT(XrSession session,
@@ -64,14 +66,11 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_handTrackersMutex);
 
-        HandTracker& xrHandTracker = *new HandTracker;
+        // Create the internal struct, owned by the table of known trackers used for validation.
+        *handTracker = m_handTrackers.insert(std::make_unique<HandTracker>());
+        HandTracker& xrHandTracker = *m_handTrackers.get(*handTracker);
         xrHandTracker.side = createInfo->hand == XR_HAND_LEFT_EXT ? 0 : 1;
 
-        *handTracker = (XrHandTrackerEXT)&xrHandTracker;
-
-        // Maintain a list of known trackers for validation.
-        m_handTrackers.insert(*handTracker);
-
         TraceLoggingWrite(g_traceProvider, "xrCreateHandTrackerEXT", TLXArg(*handTracker, "HandTracker"));
 
         return XR_SUCCESS;
@@ -87,13 +86,10 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_handTrackersMutex);
 
-        if (!m_handTrackers.count(handTracker)) {
+        if (!m_handTrackers.contains(handTracker)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        HandTracker* xrHandTracker = (HandTracker*)handTracker;
-
-        delete xrHandTracker;
         m_handTrackers.erase(handTracker);
 
         return XR_SUCCESS;
@@ -119,8 +115,10 @@ namespace pimax_openxr {
         }
 
         std::unique_lock lock(m_handTrackersMutex);
+        // The spaces table may grow from another thread.
+        std::unique_lock lock2(m_actionsAndSpacesMutex);
 
-        if (!m_handTrackers.count(handTracker) || !m_spaces.count(locateInfo->baseSpace)) {
+        if (!m_handTrackers.contains(handTracker) || !m_spaces.contains(locateInfo->baseSpace)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
@@ -148,7 +146,7 @@ namespace pimax_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
-        HandTracker& xrHandTracker = *(HandTracker*)handTracker;
+        const HandTracker& xrHandTracker = *m_handTrackers.get(handTracker);
 
         pvrSkeletalMotionRange range = pvrSkeletalMotionRange_WithoutController;
         if (motionRange) {
@@ -157,29 +155,85 @@ namespace pimax_openxr {
                         : pvrSkeletalMotionRange_WithController;
         }
 
-        Space& xrBaseSpace = *(Space*)locateInfo->baseSpace;
+        const Space& xrBaseSpace = *m_spaces.get(locateInfo->baseSpace);
 
         XrPosef baseSpaceToVirtual = Pose::Identity();
-        XrPosef basePose = Pose::Identity();
         const auto flags1 = locateSpaceToOrigin(xrBaseSpace, locateInfo->time, baseSpaceToVirtual, nullptr, nullptr);
-        const auto flags2 = getControllerPose(xrHandTracker.side, locateInfo->time, basePose, nullptr);
+
+        const CachedHandJoints& handJoints = getHandJoints(xrHandTracker.side, range, locateInfo->time);
+        locations->isActive = handJoints.isActive ? XR_TRUE : XR_FALSE;
+
+        // Hand tracking does not provide velocities.
+        if (velocities) {
+            for (uint32_t i = 0; i < velocities->jointCount; i++) {
+                velocities->jointVelocities[i].angularVelocity = {};
+                velocities->jointVelocities[i].linearVelocity = {};
+                velocities->jointVelocities[i].velocityFlags = 0;
+            }
+        }
+
+        // If base space pose is not valid, we cannot locate.
+        if (!handJoints.isActive || !Pose::IsPoseValid(flags1) || !Pose::IsPoseValid(handJoints.controllerFlags)) {
+            TraceLoggingWrite(g_traceProvider, "xrLocateHandJointsEXT", TLArg(0, "LocationFlags"));
+            for (uint32_t i = 0; i < locations->jointCount; i++) {
+                locations->jointLocations[i].radius = 0.0f;
+                locations->jointLocations[i].pose = Pose::Identity();
+                locations->jointLocations[i].locationFlags = 0;
+            }
+            return XR_SUCCESS;
+        }
+
+        // Move all the joints from the origin to the base space in one pass.
+        const XrSpaceLocationFlags locationFlags =
+            (XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT) |
+            handJoints.controllerFlags;
+        const simd::Pose virtualToBase = simd::Invert(simd::LoadPose(baseSpaceToVirtual));
+        for (uint32_t i = 0; i < locations->jointCount; i++) {
+            XrHandJointLocationEXT& location = locations->jointLocations[i];
+
+            location.pose = simd::StorePose(simd::Multiply(simd::LoadPose(handJoints.jointPoses[i]), virtualToBase));
+            location.radius = i != XR_HAND_JOINT_PALM_EXT ? 0.005f : 0.04f;
+            location.locationFlags = locationFlags;
+        }
+
+        return XR_SUCCESS;
+    }
+
+    // Retrieve the skeleton of a hand from PVR, and pre-compute the pose of each joint relative to the origin. The
+    // result is cached so that several queries for the same time (eg: for both motion ranges, or from different
+    // threads) do not go back to PVR nor walk the bone structure again. Must be invoked with the hand trackers mutex
+    // held.
+    const OpenXrRuntime::CachedHandJoints&
+    OpenXrRuntime::getHandJoints(int side, pvrSkeletalMotionRange range, XrTime time) {
+        auto& cache = m_handJointsCache[side];
+        for (size_t i = 0; i < cache.size(); i++) {
+            if (cache[i].time == time && cache[i].range == range) {
+                return cache[i];
+            }
+        }
+
+        CachedHandJoints handJoints{};
+        handJoints.time = time;
+        handJoints.range = range;
+
+        XrPosef basePose = Pose::Identity();
+        handJoints.controllerFlags = getControllerPose(side, time, basePose, nullptr);
 
         pvrSkeletalData skeletalData{};
         const auto result = pvr_getSkeletalData(m_pvrSession,
-                                                xrHandTracker.side == 0 ? pvrTrackedDevice_LeftController
-                                                                        : pvrTrackedDevice_RightController,
+                                                side == 0 ? pvrTrackedDevice_LeftController
+                                                          : pvrTrackedDevice_RightController,
                                                 range,
                                                 &skeletalData);
         if (result == pvr_not_support || skeletalData.boneCount == 0) {
             TraceLoggingWrite(g_traceProvider,
                               "PVR_SkeletalData",
-                              TLArg(xrHandTracker.side == 0 ? "Left" : "Right", "Side"),
+                              TLArg(side == 0 ? "Left" : "Right", "Side"),
                               TLArg(xr::ToString(result).c_str(), "Result"),
                               TLArg(skeletalData.boneCount, "Count"));
 
             // This is how we detect no hands presence.
-            locations->isActive = XR_FALSE;
-
+            handJoints.isActive = false;
         } else {
             CHECK_PVRCMD(result);
 
@@ -188,7 +242,7 @@ namespace pimax_openxr {
             TraceLoggingWrite(
                 g_traceProvider,
                 "PVR_SkeletalData",
-                TLArg(xrHandTracker.side == 0 ? "Left" : "Right", "Side"),
+                TLArg(side == 0 ? "Left" : "Right", "Side"),
                 TLArg(skeletalData.boneCount, "Count"),
                 TLArg(xr::ToString(skeletalData.boneTransforms[0]).c_str(), "Root"),
                 TLArg(xr::ToString(skeletalData.boneTransforms[XR_HAND_JOINT_WRIST_EXT]).c_str(), "Wrist"),
@@ -233,104 +287,68 @@ namespace pimax_openxr {
                       "LittleDistal"),
                 TLArg(xr::ToString(skeletalData.boneTransforms[XR_HAND_JOINT_LITTLE_TIP_EXT]).c_str(), "LittleTip"));
 
-            locations->isActive = XR_TRUE;
-        }
-
-        // If base space pose is not valid, we cannot locate.
-        if (locations->isActive != XR_TRUE || !Pose::IsPoseValid(flags1) || !Pose::IsPoseValid(flags2)) {
-            TraceLoggingWrite(g_traceProvider, "xrLocateHandJointsEXT", TLArg(0, "LocationFlags"));
-            for (uint32_t i = 0; i < locations->jointCount; i++) {
-                locations->jointLocations[i].radius = 0.0f;
-                locations->jointLocations[i].pose = Pose::Identity();
-                locations->jointLocations[i].locationFlags = 0;
-
-                if (velocities) {
-                    velocities->jointVelocities[i].angularVelocity = {};
-                    velocities->jointVelocities[i].linearVelocity = {};
-                    velocities->jointVelocities[i].velocityFlags = 0;
-                }
-            }
-            return XR_SUCCESS;
-        }
-
-        // We must apply the transforms in order of the bone structure:
-        // https://github.com/ValveSoftware/openvr/wiki/Hand-Skeleton#bone-structure
-        XrVector3f barycenter{};
-        XrPosef accumulatedPose = basePose;
-        XrPosef wristPose;
-        for (uint32_t i = 0; i < locations->jointCount; i++) {
-            accumulatedPose = Pose::Multiply(pvrPoseToXrPose(skeletalData.boneTransforms[i]), accumulatedPose);
-
-            // Palm is estimated after this loop.
-            if (i != XR_HAND_JOINT_PALM_EXT) {
-                locations->jointLocations[i].radius = 0.005f;
-
-                // We need extra rotations to convert from what SteamVR expects to what OpenXR expects.
-                XrPosef correctedPose;
-                if (i != XR_HAND_JOINT_WRIST_EXT) {
-                    correctedPose =
-                        Pose::Multiply(Pose::MakePose(Quaternion::RotationRollPitchYaw(
-                                                          {PVR::DegreeToRad(!xrHandTracker.side ? 0.f : 180.f),
-                                                           PVR::DegreeToRad(-90.f),
-                                                           PVR::DegreeToRad(180.f)}),
-                                                      XrVector3f{0, 0, 0}),
-                                       accumulatedPose);
-                } else {
-                    correctedPose =
-                        Pose::Multiply(Pose::MakePose(Quaternion::RotationRollPitchYaw(
-                                                          {PVR::DegreeToRad(180.f),
-                                                           PVR::DegreeToRad(0.f),
-                                                           PVR::DegreeToRad(!xrHandTracker.side ? -90.f : 90.f)}),
-                                                      XrVector3f{0, 0, 0}),
-                                       accumulatedPose);
+            handJoints.isActive = true;
+
+            // We need extra rotations to convert from what SteamVR expects to what OpenXR expects.
+            const XrPosef jointCorrection = Pose::MakePose(
+                Quaternion::RotationRollPitchYaw(
+                    {PVR::DegreeToRad(!side ? 0.f : 180.f), PVR::DegreeToRad(-90.f), PVR::DegreeToRad(180.f)}),
+                XrVector3f{0, 0, 0});
+            const XrPosef wristCorrection = Pose::MakePose(
+                Quaternion::RotationRollPitchYaw(
+                    {PVR::DegreeToRad(180.f), PVR::DegreeToRad(0.f), PVR::DegreeToRad(!side ? -90.f : 90.f)}),
+                XrVector3f{0, 0, 0});
+
+            // We must apply the transforms in order of the bone structure:
+            // https://github.com/ValveSoftware/openvr/wiki/Hand-Skeleton#bone-structure
+            XrVector3f barycenter{};
+            XrPosef accumulatedPose = basePose;
+            XrPosef wristPose;
+            for (uint32_t i = 0; i < XR_HAND_JOINT_COUNT_EXT; i++) {
+                accumulatedPose = simd::Multiply(pvrPoseToXrPose(skeletalData.boneTransforms[i]), accumulatedPose);
+
+                // Palm is estimated after this loop.
+                if (i != XR_HAND_JOINT_PALM_EXT) {
+                    handJoints.jointPoses[i] = simd::Multiply(
+                        i != XR_HAND_JOINT_WRIST_EXT ? jointCorrection : wristCorrection, accumulatedPose);
                 }
-                locations->jointLocations[i].pose = Pose::Multiply(correctedPose, Pose::Invert(baseSpaceToVirtual));
-            }
-            locations->jointLocations[i].locationFlags =
-                (XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT) | flags2;
 
-            switch (i) {
-            case XR_HAND_JOINT_WRIST_EXT:
-                wristPose = accumulatedPose;
-                break;
+                switch (i) {
+                case XR_HAND_JOINT_WRIST_EXT:
+                    wristPose = accumulatedPose;
+                    break;
 
-            case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
-            case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
-            case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
-            case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
-            case XR_HAND_JOINT_RING_METACARPAL_EXT:
-            case XR_HAND_JOINT_RING_PROXIMAL_EXT:
-            case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
-            case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
-                barycenter = barycenter + accumulatedPose.position;
-                break;
+                case XR_HAND_JOINT_INDEX_METACARPAL_EXT:
+                case XR_HAND_JOINT_INDEX_PROXIMAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_MIDDLE_PROXIMAL_EXT:
+                case XR_HAND_JOINT_RING_METACARPAL_EXT:
+                case XR_HAND_JOINT_RING_PROXIMAL_EXT:
+                case XR_HAND_JOINT_LITTLE_METACARPAL_EXT:
+                case XR_HAND_JOINT_LITTLE_PROXIMAL_EXT:
+                    barycenter = barycenter + accumulatedPose.position;
+                    break;
 
-            // Reset to the wrist base pose once we reach the tip.
-            case XR_HAND_JOINT_THUMB_TIP_EXT:
-            case XR_HAND_JOINT_INDEX_TIP_EXT:
-            case XR_HAND_JOINT_MIDDLE_TIP_EXT:
-            case XR_HAND_JOINT_RING_TIP_EXT:
-            case XR_HAND_JOINT_LITTLE_TIP_EXT:
-                accumulatedPose = wristPose;
-                break;
+                // Reset to the wrist base pose once we reach the tip.
+                case XR_HAND_JOINT_THUMB_TIP_EXT:
+                case XR_HAND_JOINT_INDEX_TIP_EXT:
+                case XR_HAND_JOINT_MIDDLE_TIP_EXT:
+                case XR_HAND_JOINT_RING_TIP_EXT:
+                case XR_HAND_JOINT_LITTLE_TIP_EXT:
+                    accumulatedPose = wristPose;
+                    break;
+                }
             }
 
-            if (velocities) {
-                velocities->jointVelocities[i].angularVelocity = {};
-                velocities->jointVelocities[i].linearVelocity = {};
-                velocities->jointVelocities[i].velocityFlags = 0;
-            }
+            // SteamVR doesn't have palm, we compute the barycenter of the metacarpal and proximal for
+            // index/middle/ring/little fingers.
+            barycenter = barycenter / 8.0f;
+            handJoints.jointPoses[XR_HAND_JOINT_PALM_EXT] =
+                Pose::MakePose(handJoints.jointPoses[XR_HAND_JOINT_MIDDLE_METACARPAL_EXT].orientation, barycenter);
         }
 
-        // SteamVR doesn't have palm, we compute the barycenter of the metacarpal and proximal for
-        // index/middle/ring/little fingers.
-        barycenter = barycenter / 8.0f;
-        locations->jointLocations[XR_HAND_JOINT_PALM_EXT].radius = 0.04f;
-        locations->jointLocations[XR_HAND_JOINT_PALM_EXT].pose = Pose::Multiply(
-            Pose::MakePose(locations->jointLocations[XR_HAND_JOINT_MIDDLE_METACARPAL_EXT].pose.orientation, barycenter),
-            Pose::Invert(baseSpaceToVirtual));
-
-        return XR_SUCCESS;
+        cache.push_back(handJoints);
+        return cache.back();
     }
 
 } // namespace pimax_openxr
\ No newline at end of file
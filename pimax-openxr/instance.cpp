@@ -116,6 +116,13 @@ namespace pimax_openxr {
             xr::ToString(XR_MAKE_VERSION(RuntimeVersionMajor, RuntimeVersionMinor, RuntimeVersionPatch));
         TraceLoggingWrite(g_traceProvider, "PimaxXR", TLArg(runtimeVersion.c_str(), "Version"));
 
+        // Load all the settings at once. The application-specific settings are loaded upon xrCreateInstance().
+        m_settings.load(RegPrefix, "");
+
+        // Let the companion app know that it must not open its own PVR session (see getRuntimeStatus()).
+        m_runtimeInstanceEvent.reset(
+            CreateEventExW(nullptr, telemetry::k_runtimeInstanceEventName, CREATE_EVENT_MANUAL_RESET, SYNCHRONIZE));
+
         // Identify the version of Pitool or Pimax Client.
         const auto clientVersion = getPimaxClientVersion();
         if (clientVersion) {
@@ -160,16 +167,58 @@ namespace pimax_openxr {
                 "kernel32.dll", "GetModuleFileNameA", hooked_GetModuleFileNameA, g_original_GetModuleFileNameA);
         }
 
-        CHECK_PVRCMD(pvr_initialise(&m_pvr));
-
-        if (m_useFrameTimingOverride) {
-            DetourDllDetach(
-                "kernel32.dll", "GetModuleFileNameA", hooked_GetModuleFileNameA, g_original_GetModuleFileNameA);
+        // Developer option: substitute the PVR client, for example with the mock from pvr-mock in order to run
+        // without a headset. Windows reuses an already loaded module with the same name, so pvr_initialise() will pick
+        // up this one.
+        wchar_t pvrClientOverride[MAX_PATH];
+        if (GetEnvironmentVariableW(L"PIMAX_OPENXR_PVR_CLIENT", pvrClientOverride, MAX_PATH)) {
+            *m_pvrClientOverride.put() = LoadLibraryW(pvrClientOverride);
+            if (!m_pvrClientOverride) {
+                throw std::runtime_error("Failed to load the PVR client override");
+            }
+            const std::string path = xr::wide_to_utf8(pvrClientOverride);
+            Log("Using PVR client: %s\n", path.c_str());
+            TraceLoggingWrite(g_traceProvider, "PVR_ClientOverride", TLArg(path.c_str(), "Path"));
         }
 
-        std::string_view versionString(pvr_getVersionString(m_pvr));
-        Log("PVR: %s\n", versionString.data());
-        TraceLoggingWrite(g_traceProvider, "PVR_SDK", TLArg(versionString.data(), "VersionString"));
+        // With fast startup, PVR is initialized in the background and xrGetSystem() may answer from the cached
+        // system properties. The GetModuleFileNameA() detour is process-wide, so it must remain on this thread.
+        // Until the startup completes, xrGetSystem() succeeds without knowing whether the headset is connected. The
+        // startup thread then checks the headset status, and without a headset, or with a different headset, the
+        // cached system becomes invalid (see isCachedSystemLost()). Calls that need the live system always check the
+        // headset (see ensureLiveSystem()).
+        m_useFastStartup = !m_useFrameTimingOverride && getSetting("fast_startup").value_or(false);
+        if (m_useFastStartup) {
+            m_pvrStartupThread = std::thread([&]() {
+                TraceLocalActivity(local);
+                TraceLoggingWriteStart(local, "PvrStartupThread");
+                bool isHmdPresent = false;
+                try {
+                    startPvr();
+
+                    pvrHmdStatus status{};
+                    isHmdPresent = m_pvrSession && pvr_getHmdStatus(m_pvrSession, &status) == pvr_success &&
+                                   status.ServiceReady && status.HmdPresent;
+                    if (isHmdPresent) {
+                        CHECK_PVRCMD(pvr_getHmdInfo(m_pvrSession, &m_hmdInfoAfterStartup));
+                    }
+                } catch (std::exception& exc) {
+                    TraceLoggingWriteTagged(local, "PvrStartupThread_Error", TLArg(exc.what(), "Error"));
+                    ErrorLog("PVR startup: %s\n", exc.what());
+                    m_pvrStartupError = std::current_exception();
+                }
+                if (!isHmdPresent) {
+                    m_hmdInfoAfterStartup = {};
+                    Log("PVR startup: headset not found\n");
+                }
+                m_isHmdPresentAfterStartup = isHmdPresent;
+                m_isPvrStarted = true;
+                TraceLoggingWriteStop(local, "PvrStartupThread");
+            });
+        } else {
+            startPvr();
+            m_isPvrStarted = true;
+        }
 
         // We want to log a warning if HAGS is on.
         const auto hwSchMode =
@@ -179,19 +228,6 @@ namespace pimax_openxr {
             Log("HAGS is on\n");
         }
 
-        QueryPerformanceFrequency(&m_qpcFrequency);
-
-        // Calibrate the timestamp conversion.
-        m_pvrTimeFromQpcTimeOffset = INFINITY;
-        for (int i = 0; i < 100; i++) {
-            LARGE_INTEGER now;
-            QueryPerformanceCounter(&now);
-            const double qpcTime = (double)now.QuadPart / m_qpcFrequency.QuadPart;
-            m_pvrTimeFromQpcTimeOffset = std::min(m_pvrTimeFromQpcTimeOffset, pvr_getTimeSeconds(m_pvr) - qpcTime);
-        }
-        TraceLoggingWrite(
-            g_traceProvider, "ConvertTime", TLArg(m_pvrTimeFromQpcTimeOffset, "PvrTimeFromQpcTimeOffset"));
-
         // Watch for changes in the registry.
         try {
             wil::unique_hkey keyToWatch;
@@ -201,7 +237,10 @@ namespace pimax_openxr {
                               KEY_WOW64_64KEY | KEY_READ,
                               keyToWatch.put()) == ERROR_SUCCESS) {
                 m_registryWatcher = wil::make_registry_watcher(
-                    std::move(keyToWatch), true, [&](wil::RegistryChangeKind changeType) { refreshSettings(); });
+                    std::move(keyToWatch), true, [&](wil::RegistryChangeKind changeType) {
+                        m_settings.reload();
+                        refreshSettings();
+                    });
             }
         } catch (std::exception&) {
             // Ignore errors that can happen with UWP applications not able to write to the registry.
@@ -228,13 +267,21 @@ namespace pimax_openxr {
             xrDestroySession((XrSession)1);
         }
 
+        // Never leave the startup thread running, even if it failed.
+        try {
+            waitForPvrStartup();
+        } catch (...) {
+        }
+
         if (m_pvrSession) {
             // Workaround: the environment doesn't appear to be cleared when re-initializing PVR. Clear the one pointer
             // we care about.
             m_pvrSession->envh->pvr_dxgl_interface = nullptr;
             pvr_destroySession(m_pvrSession);
         }
-        pvr_shutdown(m_pvr);
+        if (m_pvr) {
+            pvr_shutdown(m_pvr);
+        }
 
         DetourDllDetach("kernel32.dll", "VerifyVersionInfoW", hooked_VerifyVersionInfoW, g_original_VerifyVersionInfoW);
     }
@@ -319,6 +366,7 @@ namespace pimax_openxr {
         }
 
         m_applicationName = createInfo->applicationInfo.applicationName;
+        m_settings.load(RegPrefix, m_applicationName);
 
         for (uint32_t i = 0; i < createInfo->enabledApiLayerCount; i++) {
             TraceLoggingWrite(
@@ -345,6 +393,21 @@ namespace pimax_openxr {
         // Game-specific quirks.
         m_isConformanceTest = m_applicationName == "conformance test";
 
+        // The geometry of the quad views must not change once the application has sized its swapchains. The focus
+        // views cover a portion of the FOV of each eye, in each direction.
+        if (has_XR_VARJO_quad_views) {
+            m_quadViewsFocusSize = std::clamp(getSetting("quad_views_focus_size").value_or(40), 10, 100) / 100.f;
+            m_quadViewsFocusDensity =
+                std::clamp(getSetting("quad_views_focus_density").value_or(100), 10, 200) / 100.f;
+            m_quadViewsPeripheralDensity =
+                std::clamp(getSetting("quad_views_peripheral_density").value_or(50), 10, 100) / 100.f;
+            TraceLoggingWrite(g_traceProvider,
+                              "xrCreateInstance",
+                              TLArg(m_quadViewsFocusSize, "QuadViewsFocusSize"),
+                              TLArg(m_quadViewsFocusDensity, "QuadViewsFocusDensity"),
+                              TLArg(m_quadViewsPeripheralDensity, "QuadViewsPeripheralDensity"));
+        }
+
         m_instanceCreated = true;
         *instance = (XrInstance)1;
 
@@ -489,6 +552,55 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    void OpenXrRuntime::startPvr() {
+        CHECK_PVRCMD(pvr_initialise(&m_pvr));
+
+        if (m_useFrameTimingOverride) {
+            DetourDllDetach(
+                "kernel32.dll", "GetModuleFileNameA", hooked_GetModuleFileNameA, g_original_GetModuleFileNameA);
+        }
+
+        std::string_view versionString(pvr_getVersionString(m_pvr));
+        Log("PVR: %s\n", versionString.data());
+        TraceLoggingWrite(g_traceProvider, "PVR_SDK", TLArg(versionString.data(), "VersionString"));
+
+        QueryPerformanceFrequency(&m_qpcFrequency);
+
+        // Calibrate the timestamp conversion.
+        m_pvrTimeFromQpcTimeOffset = INFINITY;
+        for (int i = 0; i < 100; i++) {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            const double qpcTime = (double)now.QuadPart / m_qpcFrequency.QuadPart;
+            m_pvrTimeFromQpcTimeOffset = std::min(m_pvrTimeFromQpcTimeOffset, pvr_getTimeSeconds(m_pvr) - qpcTime);
+        }
+        TraceLoggingWrite(
+            g_traceProvider, "ConvertTime", TLArg(m_pvrTimeFromQpcTimeOffset, "PvrTimeFromQpcTimeOffset"));
+
+        if (m_useFastStartup) {
+            // Creating the session is the slowest part of the startup. Failures (eg: pi_server not running) are
+            // handled later by ensurePvrSession().
+            if (pvr_createSession(m_pvr, &m_pvrSession) != pvr_success) {
+                m_pvrSession = nullptr;
+            }
+        }
+    }
+
+    void OpenXrRuntime::waitForPvrStartup() {
+        std::unique_lock lock(m_pvrStartupMutex);
+
+        if (m_pvrStartupThread.joinable()) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "WaitForPvrStartup");
+            m_pvrStartupThread.join();
+            TraceLoggingWriteStop(local, "WaitForPvrStartup");
+        }
+
+        if (m_pvrStartupError) {
+            std::rethrow_exception(m_pvrStartupError);
+        }
+    }
+
     void OpenXrRuntime::initializeExtensionsTable() {
         m_extensionsTable.push_back( // Direct3D 11 support.
             {XR_KHR_D3D11_ENABLE_EXTENSION_NAME, XR_KHR_D3D11_enable_SPEC_VERSION});
@@ -522,11 +634,32 @@ namespace pimax_openxr {
         m_extensionsTable.push_back( // Eye tracking.
             {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME, XR_EXT_eye_gaze_interaction_SPEC_VERSION});
 
+        m_extensionsTable.push_back( // Batched space location.
+            {XR_KHR_LOCATE_SPACES_EXTENSION_NAME, XR_KHR_locate_spaces_SPEC_VERSION});
+
+        if (getSetting("enable_quad_views").value_or(false)) {
+            m_extensionsTable.push_back( // Fixed foveated rendering.
+                {XR_VARJO_QUAD_VIEWS_EXTENSION_NAME, XR_VARJO_quad_views_SPEC_VERSION});
+            m_extensionsTable.push_back( // Eye-tracked foveated rendering.
+                {XR_VARJO_FOVEATED_RENDERING_EXTENSION_NAME, XR_VARJO_foveated_rendering_SPEC_VERSION});
+        }
+
+        m_extensionsTable.push_back( // Dynamic resolution.
+            {XR_META_RECOMMENDED_LAYER_RESOLUTION_EXTENSION_NAME, XR_META_recommended_layer_resolution_SPEC_VERSION});
+
+        m_extensionsTable.push_back( // PCM haptics.
+            {XR_FB_HAPTIC_PCM_EXTENSION_NAME, XR_FB_haptic_pcm_SPEC_VERSION});
+
         // FIXME: Add new extensions here.
     }
 
     std::optional<int> OpenXrRuntime::getSetting(const std::string& value) const {
-        return RegGetDword(HKEY_LOCAL_MACHINE, RegPrefix, value);
+        return m_settings.get(value);
+    }
+
+    // Settings that can be overridden for a specific application, under a sub-key named after the application.
+    std::optional<int> OpenXrRuntime::getApplicationSetting(const std::string& value) const {
+        return m_settings.getForApplication(value);
     }
 
     // Singleton class instance.
@@ -541,6 +674,7 @@ namespace pimax_openxr {
 
     void ResetInstance() {
         g_instance.reset();
+        log::ShutdownLog();
     }
 
 } // namespace pimax_openxr
@@ -595,6 +729,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     } break;
 
     case DLL_PROCESS_DETACH:
+        // The writer thread might have been terminated already if the process is exiting.
+        pimax_openxr::log::FlushLog();
         TraceLoggingUnregister(pimax_openxr::log::g_traceProvider);
         break;
 
@@ -26,7 +26,7 @@
 
 namespace {
     constexpr uint32_t k_maxLoggedErrors = 100;
-    uint32_t g_globalErrorCount = 0;
+    std::atomic<uint32_t> g_globalErrorCount = 0;
 } // namespace
 
 namespace pimax_openxr::log {
@@ -41,18 +41,246 @@ namespace pimax_openxr::log {
 
     namespace {
 
-        // Utility logging function.
-        void InternalLog(const char* fmt, va_list va) {
+        constexpr size_t k_maxMessageLength = 1024;
+        constexpr size_t k_queueCapacity = 256;
+        constexpr DWORD k_writerPeriodMs = 1000;
+        constexpr auto k_duplicateSummaryPeriod = std::chrono::seconds(5);
+        constexpr auto k_flushTimeout = std::chrono::milliseconds(500);
+
+        struct Message {
+            char text[k_maxMessageLength];
+            uint32_t length;
+            // Where the text begins after the timestamp, used to detect duplicates.
+            uint32_t bodyOffset;
+        };
+
+        size_t FormatTimestamp(char* buf, size_t size) {
             const std::time_t now = std::time(nullptr);
+            return std::strftime(buf, size, "%Y-%m-%d %H:%M:%S %z: ", std::localtime(&now));
+        }
 
-            char buf[1024];
-            size_t offset = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %z: ", std::localtime(&now));
-            vsnprintf_s(buf + offset, sizeof(buf) - offset, _TRUNCATE, fmt, va);
-            OutputDebugStringA(buf);
-            if (logStream.is_open()) {
-                logStream << buf;
-                logStream.flush();
+        // The messages are formatted by the calling thread, then queued for a background thread that writes them to
+        // the file in batches. The calling thread never waits on the disk (or on an antivirus scanning the file): when
+        // the queue is full, the message is dropped and counted instead.
+        class LogWriter {
+          public:
+            void enqueue(const char* text, size_t length, size_t bodyOffset) {
+                const bool queued = m_queue.push([&](Message& message) {
+                    memcpy(message.text, text, length);
+                    message.text[length] = '\0';
+                    message.length = static_cast<uint32_t>(length);
+                    message.bodyOffset = static_cast<uint32_t>(bodyOffset);
+                });
+                if (!queued) {
+                    m_droppedCount++;
+                }
+
+                if (m_isRunning.load(std::memory_order_acquire) || start()) {
+                    m_wakeEvent.SetEvent();
+                }
+            }
+
+            // Write all the pending messages from the calling thread.
+            void flush() {
+                if (acquireConsumer(k_flushTimeout)) {
+                    drain();
+                    releaseConsumer();
+                }
+            }
+
+            // Stop the background thread, after writing all the pending messages. It is restarted upon the next
+            // message. This must not be called from DllMain(), since the thread cannot exit under the loader lock.
+            void stop() {
+                std::unique_lock lock(m_lifetimeMutex);
+
+                if (m_thread) {
+                    m_stopRequested = true;
+                    m_wakeEvent.SetEvent();
+                    WaitForSingleObject(m_thread.get(), INFINITE);
+                    m_thread.reset();
+                    m_module = nullptr;
+                    m_stopRequested = false;
+
+                    // Do not override a filter that was installed after ours.
+                    const auto current = SetUnhandledExceptionFilter(m_previousExceptionFilter);
+                    if (current != onUnhandledException) {
+                        SetUnhandledExceptionFilter(current);
+                    }
+                    m_previousExceptionFilter = nullptr;
+
+                    m_isRunning.store(false, std::memory_order_release);
+                }
+                lock.unlock();
+
+                flush();
+            }
+
+          private:
+            // Returns false if the thread could not be started, in which case the messages were written synchronously.
+            bool start() {
+                std::unique_lock lock(m_lifetimeMutex);
+
+                if (m_isRunning.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+
+                if (!m_wakeEvent) {
+                    m_wakeEvent.reset(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+                }
+
+                // Hold a reference to our DLL until the thread exits, so it is never unloaded under the thread.
+                // https://devblogs.microsoft.com/oldnewthing/20131105-00/?p=2733
+                if (!m_wakeEvent || !GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+                                                        reinterpret_cast<LPCWSTR>(this),
+                                                        &m_module)) {
+                    // Fallback to writing the messages synchronously.
+                    lock.unlock();
+                    flush();
+                    return false;
+                }
+
+                m_thread.reset(CreateThread(
+                    nullptr,
+                    0,
+                    [](void* param) -> DWORD {
+                        LogWriter* writer = reinterpret_cast<LogWriter*>(param);
+                        writer->run();
+                        FreeLibraryAndExitThread(writer->m_module, 0);
+                        return 0;
+                    },
+                    this,
+                    0,
+                    nullptr));
+                if (!m_thread) {
+                    FreeLibrary(m_module);
+                    m_module = nullptr;
+                    lock.unlock();
+                    flush();
+                    return false;
+                }
+
+                // Write the pending messages before the process is torn down by a crash.
+                m_previousExceptionFilter = SetUnhandledExceptionFilter(onUnhandledException);
+
+                m_isRunning.store(true, std::memory_order_release);
+
+                return true;
+            }
+
+            void run() {
+                while (!m_stopRequested) {
+                    WaitForSingleObject(m_wakeEvent.get(), k_writerPeriodMs);
+                    while (!acquireConsumer(std::chrono::milliseconds(k_writerPeriodMs))) {
+                    }
+                    drain();
+                    releaseConsumer();
+                }
+            }
+
+            // Only one thread at a time may consume the queue. This is a plain flag rather than a mutex, because the
+            // threads of a crashing or exiting process may be terminated while owning it.
+            bool acquireConsumer(std::chrono::milliseconds timeout) {
+                const auto deadline = std::chrono::steady_clock::now() + timeout;
+                while (m_isConsuming.test_and_set(std::memory_order_acquire)) {
+                    if (std::chrono::steady_clock::now() >= deadline) {
+                        return false;
+                    }
+                    Sleep(1);
+                }
+                return true;
             }
+
+            void releaseConsumer() {
+                m_isConsuming.clear(std::memory_order_release);
+            }
+
+            void drain() {
+                const auto now = std::chrono::steady_clock::now();
+
+                m_batch.clear();
+                while (const Message* message = m_queue.peek()) {
+                    const std::string_view body(message->text + message->bodyOffset,
+                                                message->length - message->bodyOffset);
+                    if (body == m_lastBody) {
+                        // Collapse the repeated messages, and only report their count periodically.
+                        m_repeatCount++;
+                    } else {
+                        writeRepeatSummary();
+                        m_lastBody = body;
+                        m_lastSummaryTime = now;
+
+                        OutputDebugStringA(message->text);
+                        m_batch.append(message->text, message->length);
+                    }
+                    m_queue.pop();
+                }
+
+                if (m_repeatCount && now - m_lastSummaryTime >= k_duplicateSummaryPeriod) {
+                    writeRepeatSummary();
+                    m_lastSummaryTime = now;
+                }
+
+                const uint32_t droppedCount = m_droppedCount.exchange(0);
+                if (droppedCount) {
+                    writeLine(fmt::format("{} messages were dropped\n", droppedCount));
+                }
+
+                if (!m_batch.empty() && logStream.is_open()) {
+                    logStream.write(m_batch.data(), m_batch.size());
+                    logStream.flush();
+                }
+            }
+
+            void writeRepeatSummary() {
+                if (m_repeatCount) {
+                    writeLine(fmt::format("Last message repeated {} times\n", m_repeatCount));
+                    m_repeatCount = 0;
+                }
+            }
+
+            void writeLine(const std::string& line) {
+                char buf[64];
+                FormatTimestamp(buf, sizeof(buf));
+                const std::string text = buf + line;
+                OutputDebugStringA(text.c_str());
+                m_batch += text;
+            }
+
+            static LONG WINAPI onUnhandledException(EXCEPTION_POINTERS* exceptionInfo);
+
+            utils::MpscRing<Message, k_queueCapacity> m_queue;
+            std::atomic<uint32_t> m_droppedCount{0};
+
+            std::mutex m_lifetimeMutex;
+            std::atomic<bool> m_isRunning{false};
+            wil::unique_event m_wakeEvent;
+            wil::unique_handle m_thread;
+            HMODULE m_module{nullptr};
+            std::atomic<bool> m_stopRequested{false};
+            LPTOP_LEVEL_EXCEPTION_FILTER m_previousExceptionFilter{nullptr};
+
+            // State of the consumer.
+            std::atomic_flag m_isConsuming = ATOMIC_FLAG_INIT;
+            std::string m_batch;
+            std::string m_lastBody;
+            uint32_t m_repeatCount{0};
+            std::chrono::steady_clock::time_point m_lastSummaryTime;
+        };
+
+        LogWriter g_writer;
+
+        LONG WINAPI LogWriter::onUnhandledException(EXCEPTION_POINTERS* exceptionInfo) {
+            g_writer.flush();
+            return g_writer.m_previousExceptionFilter ? g_writer.m_previousExceptionFilter(exceptionInfo)
+                                                      : EXCEPTION_CONTINUE_SEARCH;
+        }
+
+        // Utility logging function.
+        void InternalLog(const char* fmt, va_list va) {
+            char buf[k_maxMessageLength];
+            const size_t offset = FormatTimestamp(buf, sizeof(buf));
+            vsnprintf_s(buf + offset, sizeof(buf) - offset, _TRUNCATE, fmt, va);
+            g_writer.enqueue(buf, strlen(buf), offset);
         }
     } // namespace
 
@@ -64,12 +292,13 @@ namespace pimax_openxr::log {
     }
 
     void ErrorLog(const char* fmt, ...) {
-        if (g_globalErrorCount++ < k_maxLoggedErrors) {
+        const uint32_t errorCount = ++g_globalErrorCount;
+        if (errorCount <= k_maxLoggedErrors) {
             va_list va;
             va_start(va, fmt);
             InternalLog(fmt, va);
             va_end(va);
-            if (g_globalErrorCount == k_maxLoggedErrors) {
+            if (errorCount == k_maxLoggedErrors) {
                 Log("Maximum number of errors logged. Going silent.\n");
             }
         }
@@ -84,4 +313,12 @@ namespace pimax_openxr::log {
 #endif
     }
 
+    void FlushLog() {
+        g_writer.flush();
+    }
+
+    void ShutdownLog() {
+        g_writer.stop();
+    }
+
 } // namespace pimax_openxr::log
@@ -52,4 +52,10 @@ namespace pimax_openxr::log {
     // Error logging function. Goes silent after too many errors.
     void ErrorLog(const char* fmt, ...);
 
+    // Write the pending messages synchronously, eg: before the process is torn down.
+    void FlushLog();
+
+    // Stop the background writer after writing the pending messages. Must not be called from DllMain().
+    void ShutdownLog();
+
 } // namespace pimax_openxr::log
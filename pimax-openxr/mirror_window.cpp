@@ -35,9 +35,16 @@ namespace pimax_openxr {
         return static_cast<OpenXrRuntime*>(GetInstance())->mirrorWindowProc(hwnd, msg, wParam, lParam);
     }
 
+    // The mirror window is serviced and presented entirely from its own thread and its own D3D11 device, so that the
+    // headset frames never wait on the desktop presentation. The frame thread only signals that a new frame was
+    // submitted.
     void OpenXrRuntime::createMirrorWindow() {
         m_mirrorWindowReady = false;
+        m_mirrorFrameEvent.create(wil::EventOptions::None);
         m_mirrorWindowThread = std::thread([&]() {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "MirrorWindowThread");
+
             // Create the window.
             WNDCLASSEX wndClassEx = {sizeof(wndClassEx)};
             wndClassEx.lpfnWndProc = wndProcWrapper;
@@ -72,35 +79,90 @@ namespace pimax_openxr {
             ShowWindow(m_mirrorWindowHwnd, SW_SHOWNOACTIVATE);
             UpdateWindow(m_mirrorWindowHwnd);
 
-            // Service the window.
-            MSG msg;
-            while (GetMessage(&msg, m_mirrorWindowHwnd, 0, 0) > 0) {
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
+            // Service the window, and present new frames no faster than the refresh cap.
+            bool hasNewFrame = false;
+            bool hasFailed = false;
+            auto lastPresentTime = std::chrono::steady_clock::time_point{};
+            while (true) {
+                DWORD timeout = INFINITE;
+                if (hasNewFrame) {
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto period = m_mirrorWindowMaxFps > 0
+                                            ? std::chrono::microseconds(1'000'000 / m_mirrorWindowMaxFps)
+                                            : 0us;
+                    if (now - lastPresentTime >= period) {
+                        if (!hasFailed) {
+                            try {
+                                presentMirrorWindow();
+                            } catch (std::exception& exc) {
+                                TraceLoggingWrite(g_traceProvider, "MirrorWindow", TLArg(exc.what(), "Error"));
+                                ErrorLog("Failed to update the mirror window: %s\n", exc.what());
+                                hasFailed = true;
+                            }
+                        }
+                        lastPresentTime = now;
+                        hasNewFrame = false;
+                    } else {
+                        timeout = (DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      period - (now - lastPresentTime) + 999us)
+                                      .count();
+                    }
+                }
+
+                const DWORD result =
+                    MsgWaitForMultipleObjects(1, m_mirrorFrameEvent.addressof(), FALSE, timeout, QS_ALLINPUT);
+                if (result == WAIT_OBJECT_0) {
+                    hasNewFrame = true;
+                } else if (result == WAIT_OBJECT_0 + 1) {
+                    bool quit = false;
+                    MSG msg;
+                    while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                        if (msg.message == WM_QUIT) {
+                            quit = true;
+                        }
+                        TranslateMessage(&msg);
+                        DispatchMessage(&msg);
+                    }
+                    if (quit) {
+                        break;
+                    }
+                }
             }
 
             // Free resources ASAP.
             {
                 std::unique_lock lock(m_mirrorWindowMutex);
+                m_mirrorWindowWaitable.reset();
                 m_mirrorWindowSwapchain.Reset();
                 m_mirrorTexture.Reset();
                 pvr_destroyMirrorTexture(m_pvrSession, m_pvrMirrorSwapChain);
                 m_pvrMirrorSwapChain = nullptr;
+                m_mirrorContext.Reset();
+                m_mirrorDevice.Reset();
                 m_mirrorWindowHwnd = nullptr;
             }
+
+            TraceLoggingWriteStop(local, "MirrorWindowThread");
         });
     }
 
-    void OpenXrRuntime::updateMirrorWindow(bool preferSRGB) {
+    // Signal the mirror window thread that a new frame was submitted.
+    void OpenXrRuntime::updateMirrorWindow() {
+        if (m_mirrorWindowReady) {
+            m_mirrorFrameEvent.SetEvent();
+        }
+    }
+
+    // Invoked on the mirror window thread.
+    void OpenXrRuntime::presentMirrorWindow() {
         std::unique_lock lock(m_mirrorWindowMutex);
 
-        if (!m_mirrorWindowReady || !IsWindowVisible(m_mirrorWindowHwnd)) {
+        if (!IsWindowVisible(m_mirrorWindowHwnd)) {
             return;
         }
 
         RECT rect{};
         GetClientRect(m_mirrorWindowHwnd, &rect);
-        AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, false);
         const auto width = rect.right - rect.left;
         const auto height = rect.bottom - rect.top;
 
@@ -109,21 +171,33 @@ namespace pimax_openxr {
             return;
         }
 
-        // Workaround: PVR does not seem to correctly write to non-SRGB, so for now we always prefer non-SRGB.
-        preferSRGB = false;
+        // Use a device separate from the submission device, so we never contend on its context.
+        if (!m_mirrorDevice) {
+            ComPtr<IDXGIDevice> dxgiDevice;
+            CHECK_HRCMD(m_pvrSubmissionDevice->QueryInterface(IID_PPV_ARGS(dxgiDevice.ReleaseAndGetAddressOf())));
+            ComPtr<IDXGIAdapter> dxgiAdapter;
+            CHECK_HRCMD(dxgiDevice->GetAdapter(dxgiAdapter.ReleaseAndGetAddressOf()));
 
-        bool isSRGB = preferSRGB;
-        D3D11_TEXTURE2D_DESC mirrorDesc;
-        if (m_mirrorTexture) {
-            m_mirrorTexture->GetDesc(&mirrorDesc);
-            isSRGB = isSRGBFormat(mirrorDesc.Format);
+            const D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+            CHECK_HRCMD(D3D11CreateDevice(dxgiAdapter.Get(),
+                                          D3D_DRIVER_TYPE_UNKNOWN,
+                                          0,
+                                          0,
+                                          &featureLevel,
+                                          1,
+                                          D3D11_SDK_VERSION,
+                                          m_mirrorDevice.ReleaseAndGetAddressOf(),
+                                          nullptr,
+                                          m_mirrorContext.ReleaseAndGetAddressOf()));
         }
 
-        // Create the DXGI swapchain for the window.
-        if (!m_mirrorWindowSwapchain || preferSRGB != isSRGB) {
+        // Create the DXGI swapchain for the window. We use the flip model, which does not support sRGB formats for
+        // the back buffer. PVR does not seem to correctly write to non-SRGB anyway.
+        const UINT swapchainFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        if (!m_mirrorWindowSwapchain) {
             ComPtr<IDXGIFactory2> dxgiFactory;
             ComPtr<IDXGIDevice1> dxgiDevice;
-            CHECK_HRCMD(m_pvrSubmissionDevice->QueryInterface(IID_PPV_ARGS(dxgiDevice.ReleaseAndGetAddressOf())));
+            CHECK_HRCMD(m_mirrorDevice->QueryInterface(IID_PPV_ARGS(dxgiDevice.ReleaseAndGetAddressOf())));
 
             ComPtr<IDXGIAdapter> dxgiAdapter;
             CHECK_HRCMD(dxgiDevice->GetAdapter(&dxgiAdapter));
@@ -132,24 +206,31 @@ namespace pimax_openxr {
             DXGI_SWAP_CHAIN_DESC1 swapchainDesc{};
             swapchainDesc.Width = width;
             swapchainDesc.Height = height;
-            swapchainDesc.Format = preferSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+            swapchainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
             swapchainDesc.SampleDesc.Count = 1;
             swapchainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
             swapchainDesc.BufferCount = 2;
-            swapchainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-            CHECK_HRCMD(dxgiFactory->CreateSwapChainForHwnd(m_pvrSubmissionDevice.Get(),
-                                                            m_mirrorWindowHwnd,
-                                                            &swapchainDesc,
-                                                            nullptr,
-                                                            nullptr,
-                                                            m_mirrorWindowSwapchain.ReleaseAndGetAddressOf()));
+            swapchainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+            swapchainDesc.Flags = swapchainFlags;
+            ComPtr<IDXGISwapChain1> swapchain;
+            CHECK_HRCMD(dxgiFactory->CreateSwapChainForHwnd(
+                m_mirrorDevice.Get(), m_mirrorWindowHwnd, &swapchainDesc, nullptr, nullptr, swapchain.GetAddressOf()));
+            CHECK_HRCMD(swapchain->QueryInterface(IID_PPV_ARGS(m_mirrorWindowSwapchain.ReleaseAndGetAddressOf())));
+
+            CHECK_HRCMD(m_mirrorWindowSwapchain->SetMaximumFrameLatency(1));
+            m_mirrorWindowWaitable.reset(m_mirrorWindowSwapchain->GetFrameLatencyWaitableObject());
         }
 
-        // Check for resizing or initial creation.
-        if (!m_mirrorTexture || mirrorDesc.Width != width || mirrorDesc.Height != height || preferSRGB != isSRGB) {
+        // Check for resizing or initial creation. PVR composes the mirror view directly at the size of the window,
+        // which means the downscaling happens on the GPU as part of the composition, and we only do a plain copy.
+        D3D11_TEXTURE2D_DESC mirrorDesc;
+        if (m_mirrorTexture) {
+            m_mirrorTexture->GetDesc(&mirrorDesc);
+        }
+        if (!m_mirrorTexture || mirrorDesc.Width != width || mirrorDesc.Height != height) {
             TraceLoggingWrite(g_traceProvider, "MirrorWindow", TLArg(width, "Width"), TLArg(height, "Height"));
 
-            CHECK_HRCMD(m_mirrorWindowSwapchain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0));
+            CHECK_HRCMD(m_mirrorWindowSwapchain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, swapchainFlags));
 
             // Recreate a new PVR swapchain with the correct size.
             if (m_pvrMirrorSwapChain) {
@@ -158,13 +239,12 @@ namespace pimax_openxr {
             }
 
             pvrMirrorTextureDesc mirrorDesc;
-            mirrorDesc.Format = preferSRGB ? pvrTextureFormat::PVR_FORMAT_R8G8B8A8_UNORM_SRGB
-                                           : pvrTextureFormat::PVR_FORMAT_R8G8B8A8_UNORM;
+            mirrorDesc.Format = pvrTextureFormat::PVR_FORMAT_R8G8B8A8_UNORM;
             mirrorDesc.Width = width;
             mirrorDesc.Height = height;
             mirrorDesc.SampleCount = 1;
-            CHECK_PVRCMD(pvr_createMirrorTextureDX(
-                m_pvrSession, m_pvrSubmissionDevice.Get(), &mirrorDesc, &m_pvrMirrorSwapChain));
+            CHECK_PVRCMD(
+                pvr_createMirrorTextureDX(m_pvrSession, m_mirrorDevice.Get(), &mirrorDesc, &m_pvrMirrorSwapChain));
             CHECK_PVRCMD(pvr_getMirrorTextureBufferDX(
                 m_pvrSession, m_pvrMirrorSwapChain, IID_PPV_ARGS(m_mirrorTexture.ReleaseAndGetAddressOf())));
         }
@@ -172,10 +252,13 @@ namespace pimax_openxr {
         TraceLocalActivity(presentMirrorWindow);
         TraceLoggingWriteStart(presentMirrorWindow, "PresentMirrorWindow");
 
+        // Do not queue more than one frame ahead of the desktop compositor.
+        WaitForSingleObjectEx(m_mirrorWindowWaitable.get(), 100, TRUE);
+
         // Let those fail silently below so we do not crash the application.
         ComPtr<ID3D11Texture2D> frameBuffer;
         m_mirrorWindowSwapchain->GetBuffer(0, IID_PPV_ARGS(frameBuffer.ReleaseAndGetAddressOf()));
-        m_pvrSubmissionContext->CopyResource(frameBuffer.Get(), m_mirrorTexture.Get());
+        m_mirrorContext->CopyResource(frameBuffer.Get(), m_mirrorTexture.Get());
         m_mirrorWindowSwapchain->Present(0, 0);
         TraceLoggingWriteStop(presentMirrorWindow, "PresentMirrorWindow");
     }
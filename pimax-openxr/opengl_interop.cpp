@@ -111,9 +111,17 @@ namespace pimax_openxr {
             m_glSemaphore, GL_HANDLE_TYPE_D3D12_FENCE_EXT, m_fenceHandleForAMDWorkaround.get());
 
         // Frame timers.
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i] = std::make_unique<GlGpuTimer>(m_glDispatch, m_glContext);
-        }
+        m_gpuTimestampsApp =
+            std::make_unique<GlTimestampPool>(m_glDispatch, m_glContext, k_maxGpuTimersPerPool, k_gpuTimersLatency);
+        m_gpuTimerApp = std::make_unique<GpuTimer>(*m_gpuTimestampsApp);
+
+        m_useOpenGLPipelining = getSetting("opengl_pipelined_interop").value_or(true);
+        m_glReleasedImages.clear();
+        m_glReleasedImagesLayout.clear();
+        TraceLoggingWrite(g_traceProvider,
+                          "xrCreateSession",
+                          TLArg("OpenGL", "Api"),
+                          TLArg(m_useOpenGLPipelining, "PipelinedInterop"));
 
         return XR_SUCCESS;
     }
@@ -153,9 +161,8 @@ namespace pimax_openxr {
 
             glFinish();
 
-            for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-                m_gpuTimerApp[i].reset();
-            }
+            m_gpuTimerApp.reset();
+            m_gpuTimestampsApp.reset();
 
             m_glDispatch.glDeleteSemaphoresEXT(1, &m_glSemaphore);
             m_fenceHandleForAMDWorkaround.reset();
@@ -265,23 +272,66 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // Record an image released by the application, to be transitioned with the next semaphore signal.
+    void OpenXrRuntime::releaseSwapchainImageOpenGL(const Swapchain& xrSwapchain) {
+        if (!m_useOpenGLPipelining || xrSwapchain.lastReleasedIndex >= (int)xrSwapchain.glImages.size()) {
+            return;
+        }
+
+        // Images that do not fit are still made visible by the signal, just without the transition.
+        const GLuint image = xrSwapchain.glImages[xrSwapchain.lastReleasedIndex];
+        if (m_glReleasedImages.contains(image) || m_glReleasedImages.size() == m_glReleasedImages.capacity()) {
+            return;
+        }
+        const bool isDepth = xrSwapchain.xrDesc.usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        m_glReleasedImages.push_back(image);
+        m_glReleasedImagesLayout.push_back(isDepth ? GL_LAYOUT_DEPTH_STENCIL_READ_ONLY_EXT
+                                                   : GL_LAYOUT_SHADER_READ_ONLY_EXT);
+    }
+
     // Flush any pending work.
     void OpenXrRuntime::flushOpenGLContext() {
         GlContextSwitch context(m_glContext);
 
-        glFinish();
+        if (!m_useOpenGLPipelining) {
+            glFinish();
+            return;
+        }
+
+        // Wait for the semaphore instead of draining the whole pipeline.
+        const UINT64 fenceValue = signalOpenGLSemaphore();
+        TraceLoggingWrite(
+            g_traceProvider, "FlushContext_Wait", TLArg("OpenGL", "Api"), TLArg(fenceValue, "FenceValue"));
+        waitForSubmissionFenceValue(fenceValue);
+    }
+
+    // Signal the next value of the shared fence from the OpenGL context. Must be invoked with the context current.
+    // Returns that value.
+    UINT64 OpenXrRuntime::signalOpenGLSemaphore() {
+        std::unique_lock lock(m_fenceMutex);
+
+        UINT64 fenceValue = ++m_fenceValue;
+        m_glDispatch.glSemaphoreParameterui64vEXT(m_glSemaphore, GL_D3D12_FENCE_VALUE_EXT, &fenceValue);
+        m_glDispatch.glSignalSemaphoreEXT(m_glSemaphore,
+                                          0,
+                                          nullptr,
+                                          (GLuint)m_glReleasedImages.size(),
+                                          m_glReleasedImages.begin(),
+                                          m_glReleasedImagesLayout.begin());
+        m_glReleasedImages.clear();
+        m_glReleasedImagesLayout.clear();
+        glFlush();
+
+        return fenceValue;
     }
 
     // Serialize commands from the OpenGL context to the D3D11 context used by PVR.
     void OpenXrRuntime::serializeOpenGLFrame() {
         GlContextSwitch context(m_glContext);
 
-        m_fenceValue++;
+        m_frameFenceValue = signalOpenGLSemaphore();
         TraceLoggingWrite(
-            g_traceProvider, "xrEndFrame_Sync", TLArg("OpenGL", "Api"), TLArg(m_fenceValue, "FenceValue"));
-        m_glDispatch.glSemaphoreParameterui64vEXT(m_glSemaphore, GL_D3D12_FENCE_VALUE_EXT, &m_fenceValue);
-        m_glDispatch.glSignalSemaphoreEXT(m_glSemaphore, 0, nullptr, 0, nullptr, nullptr);
-        glFlush();
+            g_traceProvider, "xrEndFrame_Sync", TLArg("OpenGL", "Api"), TLArg(m_frameFenceValue, "FenceValue"));
 
         waitOnSubmissionDevice();
     }
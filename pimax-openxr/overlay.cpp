@@ -33,6 +33,32 @@ namespace pimax_openxr {
     using namespace pimax_openxr::log;
     using namespace pimax_openxr::utils;
 
+    namespace {
+
+        std::wstring getBatteryLevel(pvrSessionHandle pvrSession, pvrTrackedDeviceType device) {
+            const int batteryPercent =
+                pvr_getTrackedDeviceIntProperty(pvrSession, device, pvrTrackedDeviceProp_BatteryPercent_int, -1);
+            if (batteryPercent >= 0) {
+                return xr::utf8_to_wide(fmt::format("{}%", batteryPercent)) + (batteryPercent > 20 ? L"" : L"  \x26A0");
+            } else {
+                const int batteryLevel =
+                    pvr_getTrackedDeviceIntProperty(pvrSession, device, pvrTrackedDeviceProp_BatteryLevel_int, -1);
+                if (batteryLevel != pvrTrackedDeviceBateryLevel_NotSupport) {
+                    switch (batteryLevel) {
+                    case pvrTrackedDeviceBateryLevel_Low:
+                        return L"Low \x26A0";
+                    case pvrTrackedDeviceBateryLevel_Middle:
+                        return L"Medium";
+                    case pvrTrackedDeviceBateryLevel_High:
+                        return L"High";
+                    }
+                }
+            }
+            return L"???";
+        }
+
+    } // namespace
+
     // Create overlay resources.
     void OpenXrRuntime::initializeOverlayResources() {
         HRESULT hr;
@@ -64,6 +90,39 @@ namespace pimax_openxr {
 
                 CHECK_PVRCMD(pvr_createTextureSwapChainDX(
                     m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &m_overlaySwapchain));
+
+                // Create the render target views once for all the images.
+                int length = 0;
+                CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, m_overlaySwapchain, &length));
+                for (int i = 0; i < length; i++) {
+                    ComPtr<ID3D11Texture2D> swapchainTexture;
+                    CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
+                        m_pvrSession, m_overlaySwapchain, i, IID_PPV_ARGS(swapchainTexture.ReleaseAndGetAddressOf())));
+
+                    D3D11_RENDER_TARGET_VIEW_DESC rtvDesc{};
+                    rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+                    rtvDesc.Format = m_overlaySwapchainFormat;
+                    ComPtr<ID3D11RenderTargetView> rtv;
+                    CHECK_HRCMD(m_pvrSubmissionDevice->CreateRenderTargetView(
+                        swapchainTexture.Get(), &rtvDesc, rtv.ReleaseAndGetAddressOf()));
+
+                    m_overlayImages.push_back(swapchainTexture);
+                    m_overlayRTVs.push_back(rtv);
+                }
+                CHECK_PVRCMD(
+                    pvr_getTextureSwapChainCurrentIndex(m_pvrSession, m_overlaySwapchain, &m_overlayImageIndex));
+
+                if (!m_useApplicationDeviceForSubmission) {
+                    // The overlay is composed on a deferred context, and only replayed on the submission context.
+                    CHECK_HRCMD(
+                        m_pvrSubmissionDevice->CreateDeferredContext(0, m_overlayContext.ReleaseAndGetAddressOf()));
+
+                    startOverlayThread();
+                } else {
+                    // The submission device is the application's device, which might be single-threaded, and that we
+                    // shall not use from our own thread. Compose the overlay synchronously instead.
+                    m_overlayContext = m_pvrSubmissionContext;
+                }
             } else {
                 ErrorLog("Failed to create texture from overlay.png: %X\n");
             }
@@ -72,122 +131,224 @@ namespace pimax_openxr {
         }
     }
 
-    void OpenXrRuntime::refreshOverlay() {
+    void OpenXrRuntime::cleanupOverlayResources() {
+        stopOverlayThread();
+
+        m_overlayCommandList.Reset();
+        m_overlayContext.Reset();
+        m_overlayRTVs.clear();
+        m_overlayImages.clear();
+        m_isOverlayReady = false;
+        m_overlayRenderedContent = {};
+        if (m_overlaySwapchain) {
+            pvr_destroyTextureSwapChain(m_pvrSession, m_overlaySwapchain);
+            m_overlaySwapchain = nullptr;
+        }
+        m_overlayBackground.Reset();
+    }
+
+    // Invoked every frame while the overlay is visible. Publishes the frame statistics to the overlay thread, and
+    // commits the overlay image once the overlay thread has composed it. Returns whether the overlay swapchain has any
+    // content to display.
+    bool OpenXrRuntime::refreshOverlay() {
         const std::time_t now = std::time(nullptr);
-        if (now - m_lastOverlayRefresh < 1) {
-            return;
+        const bool needRefresh = now - m_lastOverlayRefresh >= 1;
+        if (needRefresh) {
+            m_lastOverlayRefresh = now;
         }
-        m_lastOverlayRefresh = now;
-
-        // Acquire the next image.
-        int imageIndex = -1;
-        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, m_overlaySwapchain, &imageIndex));
-        ComPtr<ID3D11Texture2D> swapchainTexture;
-        CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
-            m_pvrSession, m_overlaySwapchain, imageIndex, IID_PPV_ARGS(swapchainTexture.ReleaseAndGetAddressOf())));
-
-        // We are about to do something destructive to the application context. Save the context. It will be
-        // restored at the end of xrEndFrame().
-        if (m_d3d11Device == m_pvrSubmissionDevice && !m_d3d11ContextState) {
-            m_pvrSubmissionContext->SwapDeviceContextState(m_pvrSubmissionContextState.Get(),
-                                                           m_d3d11ContextState.ReleaseAndGetAddressOf());
+
+        const auto sampleStatus = [&](OverlayStatus& status) {
+            status.fps = m_frameTimes.size();
+            status.isSmartSmoothingEnabled = m_isSmartSmoothingEnabled;
+            status.isSmartSmoothingActive = m_isSmartSmoothingActive;
+            status.resolution = m_proj0Extent;
+            for (uint32_t side = 0; side < xr::Side::Count; side++) {
+                status.isControllerActive[side] = m_isControllerActive[side];
+            }
+        };
+
+        ComPtr<ID3D11CommandList> commandList;
+        bool needCommit = false;
+        if (!m_overlayThread.joinable()) {
+            // Synchronous composition on the submission context.
+            if (needRefresh) {
+                OverlayStatus status;
+                sampleStatus(status);
+
+                // We are about to do something destructive to the application context. Save the context. It will be
+                // restored at the end of xrEndFrame().
+                if (m_d3d11Device == m_pvrSubmissionDevice && !m_d3d11ContextState) {
+                    m_pvrSubmissionContext->SwapDeviceContextState(m_pvrSubmissionContextState.Get(),
+                                                                   m_d3d11ContextState.ReleaseAndGetAddressOf());
+                }
+                m_pvrSubmissionContext->ClearState();
+
+                needCommit = composeOverlay(status, m_overlayImageIndex);
+            }
+        } else {
+            std::unique_lock lock(m_overlayMutex);
+
+            if (needRefresh) {
+                sampleStatus(m_overlayStatus);
+                m_overlayStatusUpdated = true;
+                m_overlayCondVar.notify_all();
+            }
+
+            commandList = std::move(m_overlayCommandList);
+            needCommit = commandList != nullptr;
         }
 
-        // Copy the background.
-        m_pvrSubmissionContext->CopyResource(swapchainTexture.Get(), m_overlayBackground.Get());
-        m_pvrSubmissionContext->Flush();
+        if (needCommit) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "CommitOverlay", TLArg(m_overlayImageIndex, "ImageIndex"));
 
-        // Draw the text.
-        const auto getBatteryLevel = [&](pvrTrackedDeviceType device) -> std::wstring {
-            const int batteryPercent =
-                pvr_getTrackedDeviceIntProperty(m_pvrSession, device, pvrTrackedDeviceProp_BatteryPercent_int, -1);
-            if (batteryPercent >= 0) {
-                return xr::utf8_to_wide(fmt::format("{}%", batteryPercent)) + (batteryPercent > 20 ? L"" : L"  \x26A0");
-            } else {
-                const int batteryLevel =
-                    pvr_getTrackedDeviceIntProperty(m_pvrSession, device, pvrTrackedDeviceProp_BatteryLevel_int, -1);
-                if (batteryLevel != pvrTrackedDeviceBateryLevel_NotSupport) {
-                    switch (batteryLevel) {
-                    case pvrTrackedDeviceBateryLevel_Low:
-                        return L"Low \x26A0";
-                    case pvrTrackedDeviceBateryLevel_Middle:
-                        return L"Medium";
-                    case pvrTrackedDeviceBateryLevel_High:
-                        return L"High";
+            if (commandList) {
+                m_pvrSubmissionContext->ExecuteCommandList(commandList.Get(), TRUE /* RestoreContextState */);
+            }
+            CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, m_overlaySwapchain));
+
+            int imageIndex = -1;
+            CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, m_overlaySwapchain, &imageIndex));
+            {
+                std::unique_lock lock(m_overlayMutex);
+
+                m_overlayImageIndex = imageIndex;
+            }
+            m_isOverlayReady = true;
+
+            TraceLoggingWriteStop(local, "CommitOverlay");
+        }
+
+        return m_isOverlayReady;
+    }
+
+    void OpenXrRuntime::startOverlayThread() {
+        {
+            std::unique_lock lock(m_overlayMutex);
+
+            m_terminateOverlayThread = false;
+            m_overlayStatusUpdated = false;
+        }
+
+        m_overlayThread = std::thread([&]() {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "OverlayThread");
+
+            while (true) {
+                OverlayStatus status;
+                int imageIndex;
+                {
+                    std::unique_lock lock(m_overlayMutex);
+
+                    m_overlayCondVar.wait(lock, [&] { return m_overlayStatusUpdated || m_terminateOverlayThread; });
+                    if (m_terminateOverlayThread) {
+                        break;
                     }
+                    m_overlayStatusUpdated = false;
+
+                    // The previous image was not committed yet.
+                    if (m_overlayCommandList) {
+                        continue;
+                    }
+
+                    status = m_overlayStatus;
+                    imageIndex = m_overlayImageIndex;
+                }
+
+                try {
+                    composeOverlay(status, imageIndex);
+                } catch (std::exception& exc) {
+                    TraceLoggingWrite(g_traceProvider, "OverlayThread", TLArg(exc.what(), "Error"));
+                    ErrorLog("Failed to compose the overlay: %s\n", exc.what());
                 }
             }
-            return L"???";
-        };
 
-        m_pvrSubmissionContext->ClearState();
+            TraceLoggingWriteStop(local, "OverlayThread");
+        });
+    }
+
+    void OpenXrRuntime::stopOverlayThread() {
+        if (!m_overlayThread.joinable()) {
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_overlayMutex);
+
+            m_terminateOverlayThread = true;
+            m_overlayCondVar.notify_all();
+        }
+        m_overlayThread.join();
+        m_overlayThread = {};
+    }
 
-        ComPtr<ID3D11RenderTargetView> rtv;
+    // Record the drawing of the overlay into a command list, or draw it directly when composing on the submission
+    // context. This only happens when the text to display has changed, and returns whether the image was redrawn. The
+    // glyphs are cached by the font wrapper in between draws.
+    bool OpenXrRuntime::composeOverlay(const OverlayStatus& status, int imageIndex) {
+        OverlayContent content;
         {
-            D3D11_RENDER_TARGET_VIEW_DESC desc{};
-            desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-            desc.Format = m_overlaySwapchainFormat;
-            CHECK_HRCMD(m_pvrSubmissionDevice->CreateRenderTargetView(
-                swapchainTexture.Get(), &desc, rtv.ReleaseAndGetAddressOf()));
+            const std::time_t now = std::time(nullptr);
+            char buf[8]{};
+            std::strftime(buf, sizeof(buf), "%H:%M", std::localtime(&now));
+            content.clock = xr::utf8_to_wide(buf);
+        }
+        content.hmdBattery = getBatteryLevel(m_pvrSession, pvrTrackedDevice_HMD);
+        for (uint32_t side = 0; side < xr::Side::Count; side++) {
+            content.controllerBattery[side] =
+                status.isControllerActive[side]
+                    ? getBatteryLevel(m_pvrSession,
+                                      side == 0 ? pvrTrackedDevice_LeftController : pvrTrackedDevice_RightController)
+                    : L"-";
         }
-        m_pvrSubmissionContext->OMSetRenderTargets(1, rtv.GetAddressOf(), nullptr);
+        content.fps = xr::utf8_to_wide(fmt::format("{}", status.fps));
+        content.smartSmoothing =
+            status.isSmartSmoothingEnabled ? (status.isSmartSmoothingActive ? L"Active" : L"Standby") : L"Off";
+        content.resolution =
+            xr::utf8_to_wide(fmt::format("{}x{}", status.resolution.width, status.resolution.height));
+
+        if (content == m_overlayRenderedContent) {
+            return false;
+        }
+
+        TraceLocalActivity(local);
+        TraceLoggingWriteStart(local, "ComposeOverlay", TLArg(imageIndex, "ImageIndex"));
+
+        // Every image of the swapchain is fully redrawn, since they do not all hold the last content.
+        m_overlayContext->CopyResource(m_overlayImages[imageIndex].Get(), m_overlayBackground.Get());
+
+        m_overlayContext->OMSetRenderTargets(1, m_overlayRTVs[imageIndex].GetAddressOf(), nullptr);
         {
             D3D11_VIEWPORT viewport{};
             viewport.Width = (float)m_overlayExtent.width;
             viewport.Height = (float)m_overlayExtent.height;
             viewport.MaxDepth = 1;
-            m_pvrSubmissionContext->RSSetViewports(1, &viewport);
+            m_overlayContext->RSSetViewports(1, &viewport);
         }
 
         const uint32_t color = 0xffffffff;
 
-        {
-            char buf[8]{};
-            std::strftime(buf, sizeof(buf), "%H:%M", std::localtime(&now));
+        m_fontNormal->DrawString(
+            m_overlayContext.Get(), content.clock.c_str(), 200.f, 600.f, 12.f, color, FW1_LEFT | FW1_NOFLUSH);
 
-            m_fontNormal->DrawString(m_pvrSubmissionContext.Get(),
-                                     xr::utf8_to_wide(buf).c_str(),
-                                     200.f,
-                                     600.f,
-                                     12.f,
-                                     color,
-                                     FW1_LEFT | FW1_NOFLUSH);
-        }
+        m_fontNormal->DrawString(
+            m_overlayContext.Get(), content.hmdBattery.c_str(), 150.f, 726.f, 744.f, color, FW1_CENTER | FW1_NOFLUSH);
 
-        m_fontNormal->DrawString(m_pvrSubmissionContext.Get(),
-                                 getBatteryLevel(pvrTrackedDevice_HMD).c_str(),
-                                 150.f,
-                                 726.f,
-                                 744.f,
-                                 color,
-                                 FW1_CENTER | FW1_NOFLUSH);
-
-        for (uint32_t side = 0; side < 2; side++) {
-            m_fontNormal->DrawString(
-                m_pvrSubmissionContext.Get(),
-                m_isControllerActive[side]
-                    ? getBatteryLevel(side == 0 ? pvrTrackedDevice_LeftController : pvrTrackedDevice_RightController)
-                          .c_str()
-                    : L"-",
-                150.f,
-                side == 0 ? 204.f : 1278.f,
-                744.f,
-                color,
-                FW1_CENTER | FW1_NOFLUSH);
+        for (uint32_t side = 0; side < xr::Side::Count; side++) {
+            m_fontNormal->DrawString(m_overlayContext.Get(),
+                                     content.controllerBattery[side].c_str(),
+                                     150.f,
+                                     side == 0 ? 204.f : 1278.f,
+                                     744.f,
+                                     color,
+                                     FW1_CENTER | FW1_NOFLUSH);
         }
 
-        const auto fps = m_frameTimes.size();
-        m_fontNormal->DrawString(m_pvrSubmissionContext.Get(),
-                                 xr::utf8_to_wide(fmt::format("{}", fps)).c_str(),
-                                 150.f,
-                                 1400.f,
-                                 1098.f,
-                                 color,
-                                 FW1_RIGHT | FW1_NOFLUSH);
+        m_fontNormal->DrawString(
+            m_overlayContext.Get(), content.fps.c_str(), 150.f, 1400.f, 1098.f, color, FW1_RIGHT | FW1_NOFLUSH);
 
-        m_fontNormal->DrawString(m_pvrSubmissionContext.Get(),
-                                 m_isSmartSmoothingEnabled ? (m_isSmartSmoothingActive ? L"Active" : L"Standby")
-                                                           : L"Off",
+        m_fontNormal->DrawString(m_overlayContext.Get(),
+                                 content.smartSmoothing.c_str(),
                                  150.f,
                                  1400.f,
                                  1402.f,
@@ -195,17 +356,24 @@ namespace pimax_openxr {
                                  FW1_RIGHT | FW1_NOFLUSH);
 
         m_fontNormal->DrawString(
-            m_pvrSubmissionContext.Get(),
-            xr::utf8_to_wide(fmt::format("{}x{}", m_proj0Extent.width, m_proj0Extent.height)).c_str(),
-            150.f,
-            1400.f,
-            1754.f,
-            color,
-            FW1_RIGHT | FW1_NOFLUSH);
+            m_overlayContext.Get(), content.resolution.c_str(), 150.f, 1400.f, 1754.f, color, FW1_RIGHT | FW1_NOFLUSH);
+
+        m_fontNormal->Flush(m_overlayContext.Get());
+
+        if (m_overlayContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED) {
+            ComPtr<ID3D11CommandList> commandList;
+            CHECK_HRCMD(m_overlayContext->FinishCommandList(FALSE, commandList.ReleaseAndGetAddressOf()));
+            {
+                std::unique_lock lock(m_overlayMutex);
+
+                m_overlayCommandList = std::move(commandList);
+            }
+        }
+        m_overlayRenderedContent = std::move(content);
 
-        m_fontNormal->Flush(m_pvrSubmissionContext.Get());
+        TraceLoggingWriteStop(local, "ComposeOverlay");
 
-        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, m_overlaySwapchain));
+        return true;
     }
 
 } // namespace pimax_openxr
@@ -55,6 +55,9 @@ namespace pimax_openxr {
             return XR_ERROR_TIME_INVALID;
         }
 
+        // The timestamp conversion is calibrated upon startup of PVR.
+        waitForPvrStartup();
+
         double pvrTime = (double)performanceCounter->QuadPart / m_qpcFrequency.QuadPart;
         pvrTime += m_pvrTimeFromQpcTimeOffset;
 
@@ -86,6 +89,8 @@ namespace pimax_openxr {
             return XR_ERROR_TIME_INVALID;
         }
 
+        waitForPvrStartup();
+
         double pvrTime = xrTimeToPvrTime(time);
         pvrTime -= m_pvrTimeFromQpcTimeOffset;
 
@@ -0,0 +1,94 @@
+#pragma once
+
+// This header is also built into pimax_bench, and must not depend on the precompiled header.
+#include <DirectXMath.h>
+#include <openxr/openxr.h>
+
+namespace pimax_openxr::utils {
+
+    // Pose math for the locate paths, kept in SIMD registers from load to store. The conventions are those of
+    // xr::math::Pose: Multiply(a, b) applies a then b (ie: a is expressed relative to b).
+    namespace simd {
+
+        // A rigid transform. The orientation must be normalized.
+        struct Pose {
+            DirectX::XMVECTOR orientation;
+            DirectX::XMVECTOR position;
+        };
+
+        struct Velocity {
+            DirectX::XMVECTOR angular;
+            DirectX::XMVECTOR linear;
+        };
+
+        inline Pose LoadPose(const XrPosef& pose) {
+            using namespace DirectX;
+            return {XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pose.orientation)),
+                    XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&pose.position))};
+        }
+
+        inline XrPosef StorePose(const Pose& pose) {
+            using namespace DirectX;
+            XrPosef result;
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result.orientation), pose.orientation);
+            XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&result.position), pose.position);
+            return result;
+        }
+
+        inline DirectX::XMVECTOR XM_CALLCONV LoadVector(const XrVector3f& vector) {
+            return DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(&vector));
+        }
+
+        inline void XM_CALLCONV StoreVector(XrVector3f& vector, DirectX::FXMVECTOR value) {
+            DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&vector), value);
+        }
+
+        // Same as XMVector3Rotate(), but with two cross products instead of two quaternion products, since the
+        // orientation is normalized: v' = v + w * t + q x t, with t = 2 * q x v.
+        inline DirectX::XMVECTOR XM_CALLCONV Rotate(DirectX::FXMVECTOR vector, DirectX::FXMVECTOR orientation) {
+            using namespace DirectX;
+            const XMVECTOR t = XMVectorScale(XMVector3Cross(orientation, vector), 2.f);
+            return XMVectorAdd(XMVectorMultiplyAdd(XMVectorSplatW(orientation), t, vector),
+                               XMVector3Cross(orientation, t));
+        }
+
+        inline Pose Multiply(const Pose& a, const Pose& b) {
+            using namespace DirectX;
+            return {XMQuaternionMultiply(a.orientation, b.orientation),
+                    XMVectorAdd(Rotate(a.position, b.orientation), b.position)};
+        }
+
+        // The inverse of a normalized quaternion is its conjugate, there is no need to divide by its length.
+        inline Pose Invert(const Pose& pose) {
+            using namespace DirectX;
+            const XMVECTOR orientation = XMQuaternionConjugate(pose.orientation);
+            return {orientation, Rotate(XMVectorNegate(pose.position), orientation)};
+        }
+
+        inline XrPosef Multiply(const XrPosef& a, const XrPosef& b) {
+            return StorePose(Multiply(LoadPose(a), LoadPose(b)));
+        }
+
+        inline XrPosef Invert(const XrPosef& pose) {
+            return StorePose(Invert(LoadPose(pose)));
+        }
+
+        // Express the velocity of a space relative to a base space, in the base space. Both velocities are given
+        // relative to a common space, and spaceInBase is the pose of the space relative to the base space. The linear
+        // velocity includes the motion induced by the rotation of the base space around the space (v = w x r).
+        inline Velocity RelativeVelocity(const Pose& virtualToBase,
+                                         const Pose& spaceInBase,
+                                         const Velocity& spaceVelocity,
+                                         const Velocity& baseVelocity) {
+            using namespace DirectX;
+            const XMVECTOR baseAngular = Rotate(baseVelocity.angular, virtualToBase.orientation);
+            const XMVECTOR angular = XMVectorSubtract(spaceVelocity.angular, baseVelocity.angular);
+            const XMVECTOR linear = XMVectorSubtract(spaceVelocity.linear, baseVelocity.linear);
+            return {Rotate(angular, virtualToBase.orientation),
+                    XMVectorSubtract(Rotate(linear, virtualToBase.orientation),
+                                     XMVector3Cross(baseAngular, spaceInBase.position))};
+        }
+
+    } // namespace simd
+
+} // namespace pimax_openxr::utils
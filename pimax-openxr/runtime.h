@@ -23,6 +23,7 @@
 #pragma once
 
 #include "framework/dispatch.gen.h"
+#include "framework/dispatch_stats.h"
 
 #include "utils.h"
 
@@ -239,6 +240,15 @@ namespace pimax_openxr {
                                                   float* displayRefreshRates) override;
         XrResult xrGetDisplayRefreshRateFB(XrSession session, float* displayRefreshRate) override;
         XrResult xrRequestDisplayRefreshRateFB(XrSession session, float displayRefreshRate) override;
+        XrResult xrLocateSpacesKHR(XrSession session,
+                                   const XrSpacesLocateInfoKHR* locateInfo,
+                                   XrSpaceLocationsKHR* spaceLocations) override;
+        XrResult xrGetRecommendedLayerResolutionMETA(XrSession session,
+                                                     const XrRecommendedLayerResolutionGetInfoMETA* info,
+                                                     XrRecommendedLayerResolutionMETA* resolution) override;
+        XrResult xrGetDeviceSampleRateFB(XrSession session,
+                                         const XrHapticActionInfo* hapticActionInfo,
+                                         XrDevicePcmSampleRateGetInfoFB* deviceSampleRate) override;
 
       private:
         enum class ForcedInteractionProfile {
@@ -251,6 +261,18 @@ namespace pimax_openxr {
             uint32_t extensionVersion;
         };
 
+        // The intermediate texture used for alpha correction when it cannot write directly into the PVR swapchain.
+        // The alpha correction of all the layers is serialized on the submission context, so the swapchains with the
+        // same format and size class share one texture, see ensureSwapchainIntermediateResources().
+        struct IntermediateTexture {
+            ComPtr<ID3D11Texture2D> texture;
+            ComPtr<ID3D11UnorderedAccessView> accessView;
+            ComPtr<ID3D11ShaderResourceView> resourceView;
+            uint32_t width{0};
+            uint32_t height{0};
+            uint64_t sizeInBytes{0};
+        };
+
         struct Swapchain {
             // The PVR swapchain objects. For texture arrays, we must have one swapchain per slice due to PVR
             // limitation.
@@ -270,18 +292,27 @@ namespace pimax_openxr {
             // Whether a static image swapchain has been acquired at least once.
             bool frozen{false};
 
+            // With asynchronous commit, the images that the submission thread may still access for a frame.
+            long long inFlightFrameId{-1};
+            uint64_t inFlightImages{0};
+
             // Resources needed to resolve MSAA and/or format conversion or alpha correction.
             std::vector<int> lastProcessedIndex;
             std::vector<std::vector<ComPtr<ID3D11ShaderResourceView>>> imagesResourceView;
             std::vector<std::vector<ComPtr<ID3D11RenderTargetView>>> renderTargetView;
-            ComPtr<ID3D11Texture2D> resolved;
-            ComPtr<ID3D11Buffer> convertConstants;
-            ComPtr<ID3D11UnorderedAccessView> convertAccessView;
-            ComPtr<ID3D11ShaderResourceView> convertResourceView;
+            std::vector<std::vector<ComPtr<ID3D11UnorderedAccessView>>> encodeAccessView;
+            std::shared_ptr<IntermediateTexture> intermediate;
+
+            // With submission format conversion, the PVR swapchains in the narrower format (one per slice) that are
+            // submitted instead of the application's images. Decided upon the first submission of the swapchain.
+            std::optional<bool> useConversion;
+            std::vector<pvrTextureSwapChain> convertedPvrSwapchain;
+            std::vector<std::vector<ComPtr<ID3D11UnorderedAccessView>>> convertedAccessView;
 
             // Resources needed for interop.
             std::vector<ComPtr<ID3D11Texture2D>> d3d11Images;
             std::vector<ComPtr<ID3D12Resource>> d3d12Images;
+            std::vector<std::vector<ComPtr<ID3D12Resource>>> d3d12Slices;
             std::vector<VkDeviceMemory> vkDeviceMemory;
             std::vector<VkImage> vkImages;
             std::vector<GLuint> glMemory;
@@ -293,12 +324,18 @@ namespace pimax_openxr {
             pvrTextureSwapChainDesc pvrDesc;
         };
 
+        enum class ActionSpaceSource { None, Grip, Aim, EyeGaze };
+
         struct Space {
             // Information recorded at creation.
             XrReferenceSpaceType referenceType;
             XrAction action{XR_NULL_HANDLE};
             XrPath subActionPath{XR_NULL_PATH};
             XrPosef poseInSpace;
+
+            // For action spaces, the pose source resolved from the current bindings.
+            ActionSpaceSource source{ActionSpaceSource::None};
+            int side{-1};
         };
 
         struct ActionSource {
@@ -313,6 +350,19 @@ namespace pimax_openxr {
             std::string realPath;
         };
 
+        // The time at which each input of one side changed, which may precede the time of the input state. A time of
+        // 0 means that the input did not change before the newest sample.
+        struct InputChangeTime {
+            XrTime buttons[32]{};
+            XrTime touches[32]{};
+            XrTime trigger{0};
+            XrTime grip{0};
+            XrTime gripForce{0};
+            XrTime joystick{0};
+            XrTime touchPad{0};
+            XrTime touchPadForce{0};
+        };
+
         struct ActionSet {
             std::string name;
             std::string localizedName;
@@ -321,6 +371,7 @@ namespace pimax_openxr {
 
             // A copy of the input state. This is to handle when xrSyncActions() does not update all actionsets at once.
             pvrInputState cachedInputState;
+            InputChangeTime inputChangeTime[xr::Side::Count]{};
         };
 
         struct Action {
@@ -330,29 +381,166 @@ namespace pimax_openxr {
 
             XrActionSet actionSet{XR_NULL_HANDLE};
 
-            float lastFloatValue[xr::Side::Count]{0.f, 0.f};
-            XrTime lastFloatValueChangedTime[xr::Side::Count]{0, 0};
+            std::set<XrPath> subactionPaths;
+            std::map<std::string, ActionSource> actionSources;
+        };
 
-            XrVector2f lastVector2fValue[xr::Side::Count]{{0.f, 0.f}, {0.f, 0.f}};
-            XrTime lastVector2fValueChangedTime[xr::Side::Count]{0, 0};
+        // The state of an action for one subaction path, as computed during xrSyncActions().
+        struct ActionState {
+            XrPath subactionPath{XR_NULL_PATH};
+            bool isActive{false};
+            bool boolValue{false};
+            float floatValue{0.f};
+            XrVector2f vector2fValue{0.f, 0.f};
+            bool changedSinceLastSync{false};
+            XrTime lastChangeTime{0};
+        };
 
-            bool lastBoolValue[xr::Side::Count]{false, false};
-            XrTime lastBoolValueChangedTime[xr::Side::Count]{0, 0};
+        // An immutable view of all action states, published by xrSyncActions() and read without locking.
+        struct ActionStateSnapshot {
+            struct Entry {
+                XrActionType type;
 
-            std::set<XrPath> subactionPaths;
-            std::map<std::string, ActionSource> actionSources;
+                // One state per subaction path, starting with the XR_NULL_PATH state.
+                std::vector<ActionState> states;
+            };
+
+            std::unordered_map<XrAction, Entry> actions;
         };
 
         struct Haptic {
             std::chrono::high_resolution_clock::time_point startTime{};
             float amplitude{0.f};
             int64_t duration{0};
+
+            // The samples queued with XR_FB_haptic_pcm, played from pcmStartTime. The samples before pcmPosition were
+            // already played.
+            std::vector<float> pcmSamples;
+            size_t pcmPosition{0};
+            float pcmSampleRate{0.f};
+            std::chrono::high_resolution_clock::time_point pcmStartTime{};
+
+            // Whether the last amplitude sent to PVR was not 0.
+            bool isActive{false};
         };
 
         struct HandTracker {
             int side;
         };
 
+        // The skeleton of a hand at a given time, with all the joints (including the palm) relative to the origin.
+        struct CachedHandJoints {
+            XrTime time{0};
+            pvrSkeletalMotionRange range{pvrSkeletalMotionRange_WithoutController};
+            bool isActive{false};
+            XrSpaceLocationFlags controllerFlags{0};
+            XrPosef jointPoses[XR_HAND_JOINT_COUNT_EXT];
+        };
+
+        // The hidden area mesh of a view (deduplicated into an indexed mesh) and the outline of the visible area, for
+        // the FOV configuration they were computed with.
+        struct CachedVisibilityMask {
+            bool isValid{false};
+            int fovLevel{0};
+            pvrFovPort fov{};
+            std::vector<XrVector2f> hiddenVertices;
+            std::vector<uint32_t> hiddenIndices;
+            std::vector<XrVector2f> lineLoopVertices;
+            std::vector<uint32_t> lineLoopIndices;
+        };
+
+        // The frame statistics displayed by the overlay, sampled on the frame thread.
+        struct OverlayStatus {
+            size_t fps{0};
+            bool isSmartSmoothingEnabled{false};
+            bool isSmartSmoothingActive{false};
+            XrExtent2Di resolution{};
+            bool isControllerActive[xr::Side::Count]{false, false};
+        };
+
+        // The text drawn on the overlay, used to skip drawing when nothing has changed.
+        struct OverlayContent {
+            std::wstring clock;
+            std::wstring hmdBattery;
+            std::wstring controllerBattery[xr::Side::Count];
+            std::wstring fps;
+            std::wstring smartSmoothing;
+            std::wstring resolution;
+
+            bool operator==(const OverlayContent& other) const {
+                return clock == other.clock && hmdBattery == other.hmdBattery &&
+                       controllerBattery[xr::Side::Left] == other.controllerBattery[xr::Side::Left] &&
+                       controllerBattery[xr::Side::Right] == other.controllerBattery[xr::Side::Right] &&
+                       fps == other.fps && smartSmoothing == other.smartSmoothing && resolution == other.resolution;
+            }
+        };
+
+        // A gaze direction relative to the head, timestamped in PVR time.
+        struct GazeSample {
+            double time{0};
+            XrVector3f unitVector{0, 0, -1};
+        };
+
+        // The overlay and the guardian may add layers on top of the application's layers.
+        static constexpr size_t k_runtimeLayerCount = 2;
+        static constexpr size_t k_maxLayersPerFrame = pvrMaxLayerCount + k_runtimeLayerCount;
+        using LayerList = FixedVector<pvrLayer_Union, k_maxLayersPerFrame>;
+
+        // XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO has the stereo views, followed by the focus view of each eye.
+        static constexpr uint32_t k_quadViewCount = 4;
+
+        // At most color and depth for each view of each layer.
+        using CommittedImageList =
+            FixedVector<std::pair<pvrTextureSwapChain, uint32_t>, pvrMaxLayerCount * k_quadViewCount * 2>;
+
+        // Alpha correction for one swapchain image, deferred until all the layers of the frame have been processed.
+        // With native D3D12 precomposition, copies and plain commits are deferred too.
+        struct PrecompositionWork {
+            Swapchain* swapchain{nullptr};
+            uint32_t slice{0};
+            int sourceIndex{-1};
+            int destIndex{-1};
+            bool needCopy{false};
+            bool needClearAlpha{false};
+            bool needPremultiplyAlpha{false};
+            // The destination is the converted PVR swapchain, see ensureSwapchainConvertedResources().
+            bool needConvert{false};
+        };
+        static constexpr size_t k_maxPrecompositionWork = CommittedImageList::capacity();
+
+        // The resampling of a parallel view into the canted view of an eye, deferred like the alpha correction.
+        struct ParallelReprojectionWork {
+            Swapchain* swapchain{nullptr};
+            uint32_t slice{0};
+            int sourceIndex{-1};
+            uint32_t eye{0};
+            XrRect2Di imageRect{};
+            XrFovf fov{};
+            bool needClearAlpha{false};
+            bool needPremultiplyAlpha{false};
+            bool needCommitSource{false};
+        };
+
+        // The PVR swapchain receiving the canted view of an eye with parallel projection reprojection.
+        struct ParallelReprojectionTarget {
+            pvrTextureSwapChain pvrSwapchain{nullptr};
+            DXGI_FORMAT format{DXGI_FORMAT_UNKNOWN};
+            XrExtent2Di extent{};
+            std::vector<ComPtr<ID3D11RenderTargetView>> renderTargetViews;
+            // The width we recommend for the parallel view, to match the pixel density of the application.
+            int nominalSourceWidth{0};
+        };
+
+        // A frame handed over to the asynchronous submission thread.
+        struct AsyncSubmissionPacket {
+            long long frameId{0};
+            uint64_t fenceValue{0};
+            double submitTime{0};
+            LayerList layers;
+            telemetry::FrameRecord telemetry{};
+            timeline::FrameRecord timeline{};
+        };
+
         enum class EyeTracking {
             None = 0,
             PVR,
@@ -361,11 +549,21 @@ namespace pimax_openxr {
         };
 
         // instance.cpp
+        void startPvr();
+        void waitForPvrStartup();
         void initializeExtensionsTable();
         std::optional<int> getSetting(const std::string& value) const;
+        std::optional<int> getApplicationSetting(const std::string& value) const;
 
         // system.cpp
         bool ensurePvrSession();
+        bool ensureLiveSystem();
+        bool isCachedSystemLost() const;
+        bool loadSystemCache();
+        void saveSystemCache();
+        bool isViewConfigurationSupported(XrViewConfigurationType viewConfigurationType) const;
+        static uint32_t getViewCount(XrViewConfigurationType viewConfigurationType);
+        static pvrEyeRenderInfo getParallelEyeRenderInfo(const pvrEyeRenderInfo& cantedEyeInfo);
 
         // session.cpp
         void updateSessionState(bool forceSendEvent = false);
@@ -374,11 +572,26 @@ namespace pimax_openxr {
 
         // action.cpp
         void rebindControllerActions(int side);
-        std::string getXrPath(XrPath path) const;
+        void pollControllerTypes();
+        void startControllerWatcher();
+        void stopControllerWatcher();
+        void startHapticsThread();
+        void stopHapticsThread();
+        void hapticsThread();
+        float getHapticAmplitude(Haptic& haptic, std::chrono::high_resolution_clock::time_point now);
+        void startInputSampler();
+        void stopInputSampler();
+        void inputSamplerThread();
+        void latchInputState();
+        const std::string& getXrPath(XrPath path) const;
         XrPath stringToPath(const std::string& path, bool validate = false);
         int getActionSide(const std::string& fullPath, bool allowExtraPaths = false) const;
         bool isActionEyeTracker(const std::string& fullPath) const;
         XrVector2f handleJoystickDeadzone(pvrVector2f raw) const;
+        void computeActionState(const Action& xrAction, ActionState& state, const ActionState* previousState) const;
+        static XrTime getInputChangeTime(const ActionSet& xrActionSet, const ActionSource& source, int side);
+        void publishActionStateSnapshot(const XrActionsSyncInfo& syncInfo);
+        XrResult getActionState(XrAction action, XrPath subactionPath, XrActionType type, ActionState& state);
         void handleBuiltinActions(bool wasRecenteringPressed = false, bool wasSystemPressed = false);
 
         // mappings.cpp
@@ -429,12 +642,23 @@ namespace pimax_openxr {
                                                  XrPosef& pose,
                                                  XrSpaceVelocity* velocity,
                                                  XrEyeGazeSampleTimeEXT* gazeSampleTime) const;
+        static bool isSameSpaceOrigin(const Space& xrSpace, const Space& xrBaseSpace);
+        void resolveActionSpaceBinding(Space& xrSpace) const;
+        void resolveActionSpaceBindings();
+        void getTrackedDevicePoseState(pvrTrackedDeviceType device, XrTime time, pvrPoseStatef& state) const;
+        void invalidatePoseCache();
         XrSpaceLocationFlags getHmdPose(XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
         XrSpaceLocationFlags getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
         XrSpaceLocationFlags getEyeTrackerPose(XrTime time, XrPosef& pose, XrEyeGazeSampleTimeEXT* sampleTime) const;
+        XrFovf getFocusFov(uint32_t eye, const XrVector3f* gazeUnitVector) const;
+
+        // hand_tracking.cpp
+        const CachedHandJoints& getHandJoints(int side, pvrSkeletalMotionRange range, XrTime time);
 
         // eye_tracking.cpp
         bool getEyeGaze(XrTime time, bool getStateOnly, XrVector3f& unitVector, double& sampleTime) const;
+        void pollPvrEyeTracker() const;
+        bool sampleGaze(double time, XrVector3f& unitVector, double& sampleTime) const;
 #ifndef NOASEEVRCLIENT
         bool initializeDroolon();
         void startDroolonTracking();
@@ -449,7 +673,22 @@ namespace pimax_openxr {
 
         // frame.cpp
         void asyncSubmissionThread();
-        void waitForAsyncSubmissionIdle(bool doRunningStart = false);
+        void waitForAsyncSubmissionIdle();
+        void waitForAsyncSubmissionSlot(bool doRunningStart = false);
+        void waitForAsyncSubmission(size_t maxFramesInFlight, bool doRunningStart);
+        bool isAsyncCommitPending(long long frameId);
+        void waitForAsyncCommit(long long frameId);
+        void applyPacingMode(PacingController::Mode mode);
+#ifdef DISPATCH_STATS
+        void publishDispatchStats(bool doLog = false);
+#endif
+
+        // swapchain.cpp
+        std::unique_ptr<Swapchain> takeSwapchainFromPool(const XrSwapchainCreateInfo& createInfo);
+        void returnSwapchainToPool(std::unique_ptr<Swapchain> xrSwapchain);
+        void trimSwapchainPool(uint64_t budget);
+        void destroySwapchainResources(Swapchain& xrSwapchain);
+        static uint64_t getSwapchainMemorySize(const Swapchain& xrSwapchain);
 
         // d3d11_native.cpp
         XrResult initializeD3D11(const XrGraphicsBindingD3D11KHR& d3dBindings);
@@ -459,17 +698,43 @@ namespace pimax_openxr {
         void cleanupSubmissionDevice();
         std::vector<HANDLE> getSwapchainImages(Swapchain& xrSwapchain);
         XrResult getSwapchainImagesD3D11(Swapchain& xrSwapchain, XrSwapchainImageD3D11KHR* d3d11Images, uint32_t count);
-        void prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
-                                            uint32_t layerIndex,
-                                            uint32_t slice,
-                                            XrCompositionLayerFlags compositionFlags,
-                                            std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed);
+        pvrTextureSwapChain prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
+                                                           uint32_t layerIndex,
+                                                           uint32_t slice,
+                                                           XrCompositionLayerFlags compositionFlags,
+                                                           DXGI_FORMAT submissionFormat,
+                                                           CommittedImageList& committed);
+        static bool canConvertSubmissionFormat(const Swapchain& xrSwapchain,
+                                               DXGI_FORMAT submissionFormat,
+                                               uint32_t layerIndex,
+                                               XrCompositionLayerFlags compositionFlags);
+        void ensureSwapchainConvertedResources(Swapchain& xrSwapchain, uint32_t slice) const;
         void ensureSwapchainSliceResources(Swapchain& xrSwapchain, uint32_t slice) const;
+        bool canUseSinglePassPrecomposition(const Swapchain& xrSwapchain, uint32_t slice) const;
+        void flushPrecomposition();
+        void recordPrecomposition(ID3D11DeviceContext1* context, size_t begin, size_t end) const;
         void ensureSwapchainIntermediateResources(Swapchain& xrSwapchain) const;
+        void traceIntermediateTexturePool() const;
+        void ensureSwapchainImageResourceView(Swapchain& xrSwapchain, uint32_t slice, int index) const;
+        void ensureSwapchainEncodeAccessView(Swapchain& xrSwapchain, uint32_t slice, int index) const;
+        void ensureSwapchainRenderTargetView(Swapchain& xrSwapchain, uint32_t slice, int index) const;
+        void warmUpSwapchainResources(Swapchain& xrSwapchain) const;
+        pvrTextureSwapChain queueParallelReprojection(Swapchain& xrSwapchain,
+                                                      uint32_t layerIndex,
+                                                      uint32_t eye,
+                                                      const XrCompositionLayerProjectionView& view,
+                                                      XrCompositionLayerFlags compositionFlags,
+                                                      CommittedImageList& committed);
+        void ensureParallelReprojectionTarget(uint32_t eye, DXGI_FORMAT format, const XrExtent2Di& extent);
+        void flushParallelReprojection();
+        void cleanupParallelReprojectionResources();
         void flushD3D11Context();
         void flushSubmissionContext();
+        void waitForSubmissionFenceValue(UINT64 value);
         void serializeD3D11Frame();
         void waitOnSubmissionDevice();
+        void waitOnSubmissionDevice(uint64_t fenceValue);
+        void flushAsyncCommit(uint64_t fenceValue);
 
         // d3d12_interop.cpp
         XrResult initializeD3D12(const XrGraphicsBindingD3D12KHR& d3dBindings);
@@ -477,7 +742,16 @@ namespace pimax_openxr {
         bool isD3D12Session() const;
         XrResult getSwapchainImagesD3D12(Swapchain& xrSwapchain, XrSwapchainImageD3D12KHR* d3d12Images, uint32_t count);
         void flushD3D12CommandQueue();
+        void waitForD3D12FenceValue(UINT64 value);
         void serializeD3D12Frame();
+        void initializeD3D12Precomposition();
+        void beginD3D12Precomposition();
+        bool canUseD3D12Precomposition(const Swapchain& xrSwapchain,
+                                       uint32_t slice,
+                                       bool needCopy,
+                                       bool needAlphaCorrection) const;
+        ID3D12Resource* getD3D12SliceImage(Swapchain& xrSwapchain, uint32_t slice, int index);
+        void flushPrecompositionD3D12();
 
         // vulkan_interop.cpp
         XrResult initializeVulkan(const XrGraphicsBindingVulkanKHR& vkBindings);
@@ -486,6 +760,7 @@ namespace pimax_openxr {
         bool isVulkanSession() const;
         XrResult getSwapchainImagesVulkan(Swapchain& xrSwapchain, XrSwapchainImageVulkanKHR* vkImages, uint32_t count);
         void flushVulkanCommandQueue();
+        UINT64 submitVulkanAndSignal(VkCommandBuffer cmdBuffer);
         void serializeVulkanFrame();
 
         // opengl_interop.cpp
@@ -494,31 +769,50 @@ namespace pimax_openxr {
         void cleanupOpenGL();
         bool isOpenGLSession() const;
         XrResult getSwapchainImagesOpenGL(Swapchain& xrSwapchain, XrSwapchainImageOpenGLKHR* glImages, uint32_t count);
+        void releaseSwapchainImageOpenGL(const Swapchain& xrSwapchain);
         void flushOpenGLContext();
+        UINT64 signalOpenGLSemaphore();
         void serializeOpenGLFrame();
 
         // visibility_mask.cpp
-        void convertSteamVRToOpenXRHiddenMesh(const pvrFovPort& fov,
-                                              XrVector2f* vertices,
-                                              uint32_t* indices,
-                                              uint32_t count) const;
+        const CachedVisibilityMask& getVisibilityMask(uint32_t viewIndex);
+        static std::vector<uint32_t> getHiddenMeshInnerLoop(const std::vector<XrVector2f>& vertices,
+                                                            const std::vector<uint32_t>& indices);
+        void convertSteamVRToOpenXRHiddenMesh(const pvrFovPort& fov, XrVector2f* vertices, uint32_t count) const;
 
         // mirror_window.cpp
         void createMirrorWindow();
-        void updateMirrorWindow(bool preferSRGB = false);
+        void updateMirrorWindow();
+        void presentMirrorWindow();
         LRESULT CALLBACK mirrorWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
         friend LRESULT CALLBACK wndProcWrapper(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
         // overlay.cpp
         void initializeOverlayResources();
-        void refreshOverlay();
+        void cleanupOverlayResources();
+        bool refreshOverlay();
+        void startOverlayThread();
+        void stopOverlayThread();
+        bool composeOverlay(const OverlayStatus& status, int imageIndex);
 
         // Instance & PVR state.
+        wil::unique_hmodule m_pvrClientOverride;
+        wil::unique_event_nothrow m_runtimeInstanceEvent;
         pvrEnvHandle m_pvr{nullptr};
         pvrSessionHandle m_pvrSession{nullptr};
         bool m_instanceCreated{false};
         bool m_systemCreated{false};
         bool m_useFrameTimingOverride{false};
+        bool m_useFastStartup{false};
+        std::thread m_pvrStartupThread;
+        std::mutex m_pvrStartupMutex;
+        std::exception_ptr m_pvrStartupError;
+        std::atomic<bool> m_isPvrStarted{false};
+        // Whether the startup thread found the headset, and which one, see isCachedSystemLost(). The headset info is
+        // only valid once m_isPvrStarted is set.
+        std::atomic<bool> m_isHmdPresentAfterStartup{true};
+        pvrHmdInfo m_hmdInfoAfterStartup{};
+        bool m_isUsingCachedSystem{false};
         std::vector<Extension> m_extensionsTable;
         bool m_graphicsRequirementQueried{false};
         LUID m_adapterLuid{};
@@ -530,35 +824,60 @@ namespace pimax_openxr {
         float m_floorHeight{0.f};
         LARGE_INTEGER m_qpcFrequency{};
         double m_pvrTimeFromQpcTimeOffset{0};
-        XrPath m_stringIndex{0};
         using MappingFunction = std::function<bool(const Action&, XrPath, ActionSource&)>;
         using CheckValidPathFunction = std::function<bool(const std::string&)>;
         std::map<std::pair<std::string, std::string>, MappingFunction> m_controllerMappingTable;
         std::map<std::string, CheckValidPathFunction> m_controllerValidPathsTable;
+        SettingsStore m_settings;
         wil::unique_registry_watcher m_registryWatcher;
         bool m_loggedResolution{false};
         std::string m_applicationName;
         bool m_useApplicationDeviceForSubmission{true};
+        bool m_useHighPrioritySubmission{false};
         bool m_isConformanceTest{false};
         EyeTracking m_eyeTrackingType{EyeTracking::None};
 #ifndef NOASEEVRCLIENT
         aSeeVRCoefficient m_droolonCoefficients{};
-        mutable std::mutex m_droolonMutex;
-        bool m_isDroolonReady{false};
-        double m_droolonTimestamp{0};
-        XrVector2f m_droolonGaze{};
+        std::atomic<bool> m_isDroolonReady{false};
 #endif
         float m_droolonProjectionDistance{0.35f};
         bool m_isEyeTrackingAvailable{false};
 
+        // Gaze samples from either eye tracker backend. The aSeeVR callback is the only writer for Droolon, while the
+        // PVR eye tracker is polled by whichever thread holds the poll mutex.
+        static constexpr size_t k_gazeSamplesCount = 32;
+        static constexpr double k_gazePollPeriod = 0.002;
+        static constexpr double k_maxGazeExtrapolation = 0.05;
+        mutable SeqlockRing<GazeSample, k_gazeSamplesCount> m_gazeSamples;
+        mutable std::mutex m_gazePollMutex;
+        mutable std::atomic<double> m_lastGazePollTime{0};
+
         // Session state.
         ComPtr<ID3D11Device5> m_pvrSubmissionDevice;
         ComPtr<ID3D11DeviceContext4> m_pvrSubmissionContext;
         ComPtr<ID3DDeviceContextState> m_pvrSubmissionContextState;
         ComPtr<ID3D11Fence> m_pvrSubmissionFence;
-        wil::unique_handle m_eventForSubmissionFence;
         bool m_syncGpuWorkInEndFrame{false};
         ComPtr<ID3D11ComputeShader> m_alphaCorrectShader[2];
+        ComPtr<ID3D11ComputeShader> m_alphaCorrectSRGBShader[2];
+        ComPtr<ID3D11Buffer> m_precompositionConstants;
+        // Without constant buffer offsetting, each precomposition work item has its own constant buffer instead.
+        bool m_useConstantBufferOffsetting{false};
+        std::vector<ComPtr<ID3D11Buffer>> m_precompositionConstantsPerWork;
+        FixedVector<PrecompositionWork, k_maxPrecompositionWork> m_precompositionWork;
+        // The intermediate textures are released with the last swapchain using them.
+        static constexpr uint32_t k_intermediateTextureSizeClass = 256;
+        mutable std::mutex m_intermediateTexturePoolMutex;
+        mutable std::map<std::tuple<DXGI_FORMAT, uint32_t, uint32_t>, std::weak_ptr<IntermediateTexture>>
+            m_intermediateTexturePool;
+        bool m_useParallelPrecomposition{false};
+        std::vector<ComPtr<ID3D11DeviceContext1>> m_precompositionContexts;
+        std::vector<ComPtr<ID3D11CommandList>> m_precompositionCommandLists;
+        utils::WorkerPool m_precompositionWorkers;
+        ComPtr<ID3D11PixelShader> m_parallelReprojectionPS[2];
+        ComPtr<ID3D11Buffer> m_parallelReprojectionConstants;
+        FixedVector<ParallelReprojectionWork, xr::StereoView::Count> m_parallelReprojectionWork;
+        ParallelReprojectionTarget m_parallelReprojectionTargets[xr::StereoView::Count];
         ComPtr<IDXGISwapChain1> m_dxgiSwapchain;
         bool m_sessionCreated{false};
         XrViewConfigurationType m_primaryViewConfigurationType{XR_VIEW_CONFIGURATION_TYPE_MAX_ENUM};
@@ -571,22 +890,66 @@ namespace pimax_openxr {
         bool m_sessionStopping{false};
         bool m_sessionExiting{false};
         bool m_useParallelProjection{false};
+        bool m_useParallelReprojection{false};
+        pvrEyeRenderInfo m_cantedEyeInfo[xr::StereoView::Count]{};
         int m_fovLevel{0};
         XrFovf m_cachedEyeFov[xr::StereoView::Count];
+        float m_quadViewsFocusSize{0.4f};
+        float m_quadViewsFocusDensity{1.f};
+        float m_quadViewsPeripheralDensity{0.5f};
+        std::mutex m_visibilityMaskMutex;
+        CachedVisibilityMask m_cachedVisibilityMask[xr::StereoView::Count];
+        StringInternTable m_strings;
         std::mutex m_actionsAndSpacesMutex;
-        std::map<XrPath, std::string> m_strings; // protected by actionsAndSpacesMutex
         std::set<XrActionSet> m_actionSets;
         std::set<XrActionSet> m_activeActionSets;
         std::set<XrAction> m_actions;
         std::set<XrAction> m_actionsForCleanup;
+        std::shared_ptr<const ActionStateSnapshot> m_actionStateSnapshot; // only accessed with std::atomic_load/store()
         std::mutex m_handTrackersMutex;
-        std::set<XrHandTrackerEXT> m_handTrackers;
-        std::set<XrSpace> m_spaces;
+        HandleTable<XrHandTrackerEXT, HandTracker> m_handTrackers;
+        // Enough entries for both motion ranges at a couple of different times (eg: predicted display time and now).
+        static constexpr size_t k_handJointsCacheSize = 4;
+        RingBuffer<CachedHandJoints, k_handJointsCacheSize> m_handJointsCache[xr::Side::Count];
+        HandleTable<XrSpace, Space> m_spaces;
         Space* m_originSpace{nullptr};
         Space* m_viewSpace{nullptr};
         std::map<std::string, std::vector<XrActionSuggestedBinding>> m_suggestedBindings;
         bool m_isControllerActive[xr::Side::Count]{false, false};
         std::string m_cachedControllerType[xr::Side::Count];
+
+        // Controller watcher thread, detecting controller changes without querying PVR in xrSyncActions().
+        static constexpr std::chrono::milliseconds k_controllerWatcherPeriod{250};
+        std::thread m_controllerWatcherThread;
+        std::mutex m_controllerWatcherMutex;
+        std::condition_variable m_controllerWatcherCondVar;
+        bool m_terminateControllerWatcher{false};
+        bool m_isWatchedControllerPresent[xr::Side::Count]{false, false};
+        std::string m_watchedControllerType[xr::Side::Count];
+        std::atomic<bool> m_controllerStateChanged[xr::Side::Count]{false, false};
+
+        // The haptics are played by a dedicated thread, on its own timer, rather than from xrSyncActions().
+        static constexpr size_t k_maxHapticPcmSamples = 2 * XR_MAX_HAPTIC_PCM_BUFFER_SIZE_FB;
+        std::thread m_hapticsThread;
+        std::mutex m_hapticsMutex;
+        wil::unique_handle m_hapticsWakeEvent;
+        bool m_terminateHapticsThread{false};
+        std::chrono::microseconds m_hapticsPeriod{4000};
+        // Protected by m_hapticsMutex.
+        Haptic m_currentVibration[xr::Side::Count];
+
+        // The input sampler thread polls PVR at a high rate, so that xrSyncActions() only latches the newest samples.
+        static constexpr size_t k_inputSamplesCount = 64;
+        std::thread m_inputSamplerThread;
+        std::atomic<bool> m_terminateInputSampler{false};
+        std::chrono::microseconds m_inputSamplerPeriod{2000};
+        SeqlockRing<pvrInputState, k_inputSamplesCount> m_inputSamples;
+        // Only accessed by xrSyncActions().
+        std::vector<pvrInputState> m_newInputSamples;
+        pvrInputState m_lastInputSample{};
+        pvrInputState m_lastLatchedInputState{};
+        InputChangeTime m_inputChangeTime[xr::Side::Count]{};
+
         XrPosef m_controllerAimOffset;
         XrPosef m_controllerGripOffset;
         XrPosef m_controllerAimPose[xr::Side::Count];
@@ -594,44 +957,68 @@ namespace pimax_openxr {
         std::string m_localizedControllerType[xr::Side::Count];
         XrPath m_currentInteractionProfile[xr::Side::Count]{XR_NULL_PATH, XR_NULL_PATH};
         bool m_currentInteractionProfileDirty{false};
-        Haptic m_currentVibration[xr::Side::Count];
         std::optional<ForcedInteractionProfile> m_forcedInteractionProfile;
         std::optional<ForcedInteractionProfile> m_lastForcedInteractionProfile;
         std::string m_debugControllerType;
         std::optional<double> m_isRecenteringPressed;
         int64_t m_frameTimeOverrideOffsetUs{0};
         uint64_t m_frameTimeOverrideUs{0};
-        size_t m_frameTimeFilterLength{3};
         float m_joystickDeadzone{0.f};
         bool m_useDeferredFrameWait{true};
         bool m_lockFramerate{false};
         bool m_useDeferredFrameWaitThisFrame{false};
         bool m_honorPremultiplyFlagOnProj0{false};
         bool m_useRunningStart{true};
+        bool m_reuseStaticLayers{true};
+        bool m_useResourceWarmUp{true};
+        // The narrower formats to submit the layers in, or DXGI_FORMAT_UNKNOWN to submit the application's format.
+        DXGI_FORMAT m_projectionSubmissionFormat{DXGI_FORMAT_UNKNOWN};
+        DXGI_FORMAT m_quadSubmissionFormat{DXGI_FORMAT_UNKNOWN};
 
         // Swapchains and other graphics stuff.
         std::mutex m_swapchainsMutex;
-        std::set<XrSwapchain> m_swapchains;
+        HandleTable<XrSwapchain, Swapchain> m_swapchains;
+
+        // Recently destroyed swapchains kept alive for reuse, with the least recently destroyed at the front.
+        struct PooledSwapchain {
+            std::unique_ptr<Swapchain> swapchain;
+            uint64_t sizeInBytes{0};
+        };
+        std::deque<PooledSwapchain> m_swapchainPool;
+        uint64_t m_swapchainPoolSize{0};
+        uint64_t m_swapchainPoolBudget{0};
 
         // Mirror window.
         bool m_useMirrorWindow{false};
         std::mutex m_mirrorWindowMutex;
         HWND m_mirrorWindowHwnd{nullptr};
-        bool m_mirrorWindowReady{false};
+        std::atomic<bool> m_mirrorWindowReady{false};
+        int m_mirrorWindowMaxFps{0};
         std::thread m_mirrorWindowThread;
-        ComPtr<IDXGISwapChain1> m_mirrorWindowSwapchain;
+        wil::unique_event m_mirrorFrameEvent;
+        ComPtr<ID3D11Device> m_mirrorDevice;
+        ComPtr<ID3D11DeviceContext> m_mirrorContext;
+        ComPtr<IDXGISwapChain2> m_mirrorWindowSwapchain;
+        wil::unique_handle m_mirrorWindowWaitable;
         pvrMirrorTexture m_pvrMirrorSwapChain{nullptr};
         ComPtr<ID3D11Texture2D> m_mirrorTexture;
 
         // Async submittion thread.
         bool m_useAsyncSubmission{false};
         bool m_needStartAsyncSubmissionThread{false};
-        bool m_terminateAsyncThread{false};
+        std::atomic<bool> m_terminateAsyncThread{false};
         std::thread m_asyncSubmissionThread;
-        std::mutex m_asyncSubmissionMutex;
-        std::condition_variable m_asyncSubmissionCondVar;
-        std::vector<pvrLayer_Union> m_layersForAsyncSubmission;
-        std::chrono::high_resolution_clock::time_point m_lastWaitToBeginFrameTime{};
+        // Notified upon any change to the queue, m_asyncCommittedFrameId or m_terminateAsyncThread.
+        EpochSignal m_asyncSubmissionSignal;
+        // A frame remains in the queue until the submission thread has waited for the following frame. The queued
+        // layers reference the PVR swapchains, whose images are committed again for the next frame: a single frame
+        // may be in flight, otherwise pvr_endFrame() would present the images of a later frame.
+        SpscRing<AsyncSubmissionPacket, 1> m_asyncSubmissionQueue;
+        // With asynchronous commit, the precomposition and the commits are done by the submission thread too.
+        bool m_useAsyncCommit{false};
+        // The last frame committed by the submission thread.
+        std::atomic<long long> m_asyncCommittedFrameId{-1};
+        std::atomic<std::chrono::high_resolution_clock::time_point> m_lastWaitToBeginFrameTime{};
 
         // Guardian state.
         pvrTextureSwapChain m_guardianSwapchain{nullptr};
@@ -639,6 +1026,14 @@ namespace pimax_openxr {
         XrExtent2Di m_guardianExtent{};
         float m_guardianThreshold{1.1f};
         float m_guardianRadius{1.6f};
+        // The guardian fades in over this distance before the threshold. The texture holds the fade levels side by
+        // side, separated by a transparent gutter so that bilinear filtering never reads the neighboring level, see
+        // initializeGuardianResources(). With 4 levels of 1024x1024, the texture is about the size of the 2048x2048
+        // image it replaces (16MB).
+        static constexpr uint32_t k_guardianFadeLevels = 4;
+        static constexpr size_t k_guardianFadeLevelSize = 1024;
+        static constexpr size_t k_guardianFadeLevelGutter = 2;
+        float m_guardianFadeDistance{0.2f};
 
         // Overlay resources.
         ComPtr<IFW1Factory> m_fontWrapperFactory;
@@ -652,6 +1047,19 @@ namespace pimax_openxr {
         bool m_isOverlayVisible{false};
         XrExtent2Di m_proj0Extent{};
         std::time_t m_lastOverlayRefresh{0};
+        std::vector<ComPtr<ID3D11Texture2D>> m_overlayImages;
+        std::vector<ComPtr<ID3D11RenderTargetView>> m_overlayRTVs;
+        bool m_isOverlayReady{false};
+        ComPtr<ID3D11DeviceContext> m_overlayContext;
+        std::thread m_overlayThread;
+        std::mutex m_overlayMutex;
+        std::condition_variable m_overlayCondVar;
+        bool m_terminateOverlayThread{false};
+        bool m_overlayStatusUpdated{false};
+        OverlayStatus m_overlayStatus;
+        int m_overlayImageIndex{0};
+        ComPtr<ID3D11CommandList> m_overlayCommandList;
+        OverlayContent m_overlayRenderedContent; // only accessed by the overlay thread
 
         // Graphics API interop.
         ComPtr<ID3D11Device5> m_d3d11Device;
@@ -661,12 +1069,29 @@ namespace pimax_openxr {
         ComPtr<ID3D12CommandQueue> m_d3d12CommandQueue;
         ComPtr<ID3D12CommandAllocator> m_d3d12CommandAllocator;
         ComPtr<ID3D12GraphicsCommandList> m_d3d12CommandList;
+        wil::unique_handle m_eventForD3D12Fence;
+        // Native precomposition for D3D12. Each frame slot holds its own allocator and descriptors, which are reused
+        // once the GPU has reached the fence value of the frame that last used them.
+        static constexpr uint32_t k_d3d12PrecompositionLatency = 3;
+        bool m_useD3D12Precomposition{false};
+        ComPtr<ID3D12RootSignature> m_d3d12AlphaCorrectRootSignature;
+        ComPtr<ID3D12PipelineState> m_d3d12AlphaCorrectSRGBPipeline[2];
+        ComPtr<ID3D12DescriptorHeap> m_d3d12PrecompositionHeap;
+        UINT m_d3d12DescriptorSize{0};
+        ComPtr<ID3D12CommandAllocator> m_d3d12PrecompositionAllocator[k_d3d12PrecompositionLatency];
+        ComPtr<ID3D12GraphicsCommandList> m_d3d12PrecompositionCommandList;
+        UINT64 m_d3d12PrecompositionFenceValue[k_d3d12PrecompositionLatency]{};
+        uint32_t m_d3d12PrecompositionSlot{0};
+        // With high priority submission, the precomposition runs on a queue of its own instead of the application
+        // queue.
+        ComPtr<ID3D12CommandQueue> m_d3d12PrecompositionQueue;
         VkInstance m_vkBootstrapInstance{VK_NULL_HANDLE};
         VkPhysicalDevice m_vkBootstrapPhysicalDevice{VK_NULL_HANDLE};
         VkInstance m_vkInstance{VK_NULL_HANDLE};
         VkDevice m_vkDevice{VK_NULL_HANDLE};
         VkCommandPool m_vkCmdPool{VK_NULL_HANDLE};
         VkCommandBuffer m_vkCmdBuffer{VK_NULL_HANDLE};
+        UINT64 m_vkCmdBufferFenceValue{0};
         // Pointers in the dispatcher must be initialized in initializeVulkanDispatch().
         VulkanDispatch m_vkDispatch;
         std::optional<VkAllocationCallbacks> m_vkAllocator;
@@ -681,11 +1106,17 @@ namespace pimax_openxr {
         ComPtr<ID3D12Fence> m_d3d12Fence;
         VkSemaphore m_vkTimelineSemaphore{VK_NULL_HANDLE};
         GLuint m_glSemaphore{0};
+        // With pipelined OpenGL interop, the images released by the application are transitioned all at once when
+        // signaling the semaphore.
+        bool m_useOpenGLPipelining{false};
+        FixedVector<GLuint, k_maxPrecompositionWork> m_glReleasedImages;
+        FixedVector<GLenum, k_maxPrecompositionWork> m_glReleasedImagesLayout;
+        // The last value of the shared fence. Flushes may be requested from several threads (eg: from
+        // xrEnumerateSwapchainImages() and xrEndFrame()), so each increment and its signal are done under m_fenceMutex.
+        std::mutex m_fenceMutex;
         UINT64 m_fenceValue{0};
-
-        // Due to Vulkan semaphore transference rules(?) it looks like we may not be able to both signal and wait on an
-        // imported semaphore. Use a separate fence for host-side flushes.
-        VkFence m_vkFenceForFlush{VK_NULL_HANDLE};
+        // The value signaled for the current frame, only accessed by the frame thread.
+        UINT64 m_frameFenceValue{0};
 
         // Workaround: the AMD driver does not seem to like closing the handle for the shared fence when using
         // OpenGL. We keep it alive for the whole session.
@@ -704,25 +1135,68 @@ namespace pimax_openxr {
         uint64_t m_frameBegun{0};
         uint64_t m_frameCompleted{0};
         uint64_t m_lastCpuFrameTimeUs{0};
+        uint64_t m_lastRenderCpuTimeUs{0};
         uint64_t m_lastGpuFrameTimeUs{0};
         pvrInputState m_cachedInputState;
         bool m_actionsSyncedThisFrame{false};
         XrTime m_lastPredictedDisplayTime{0};
         mutable std::optional<XrPosef> m_lastValidHmdPose;
-        std::deque<uint64_t> m_frameTimeFilter;
+
+        // Tracked device poses queried from PVR, for the HMD and each controller. Invalidated every frame and when
+        // syncing actions.
+        struct CachedPoseState {
+            XrTime time{0};
+            pvrPoseStatef state{};
+        };
+        static constexpr size_t k_poseCacheEntriesPerDevice = 4;
+        mutable std::mutex m_poseCacheMutex;
+        mutable FixedVector<CachedPoseState, k_poseCacheEntriesPerDevice> m_poseCache[1 + xr::Side::Count];
+        mutable uint32_t m_poseCacheNextEntry[1 + xr::Side::Count]{};
+        mutable uint64_t m_poseCacheHits{0};
+        mutable uint64_t m_poseCacheMisses{0};
+        FrameTimeEstimator m_frameTimeEstimator;
+        bool m_useDynamicResolution{false};
+        DynamicResolutionController m_dynamicResolution;
+        // The resolution of the first projection view at a scale of 1, for the primary view configuration.
+        XrExtent2Di m_dynamicResolutionNominalExtent{};
+        bool m_useAdaptivePacing{false};
+        PacingController m_pacingController;
+        // The time spent throttling the application in waitForAsyncSubmission() since the last frame.
+        std::atomic<uint64_t> m_asyncWaitDurationUs{0};
+        // Storage reused by xrEndFrame() every frame (when not using asynchronous submission).
+        LayerList m_layersForSubmission;
+        CommittedImageList m_committedSwapchainImages;
         bool m_isSmartSmoothingEnabled{false};
         bool m_isSmartSmoothingActive{false};
 
         // Statistics.
         double m_sessionStartTime{0.0};
         uint64_t m_sessionTotalFrameCount{0};
-        std::deque<double> m_frameTimes;
+        RingBuffer<double, 1024> m_frameTimes;
+        uint64_t m_lastEndFrameAllocations{0};
+        uint64_t m_lastWaitDurationUs{0};
+        bool m_useTelemetry{false};
+        TelemetryPublisher m_telemetry;
+        telemetry::RuntimeStatus m_runtimeStatus{};
+#ifdef DISPATCH_STATS
+        std::vector<dispatch_stats::EntryStats> m_dispatchStats;
+        std::vector<telemetry::DispatchStatsRecord> m_dispatchStatsRecords;
+        double m_lastDispatchStatsPublishTime{0};
+#endif
+        // The frame timeline being recorded, for each frame in flight (indexed by PVR frame ID).
+        static constexpr uint32_t k_timelineFramesInFlight = 4;
+        bool m_useTimelineRecorder{false};
+        TimelineRecorder m_timelineRecorder;
+        timeline::FrameRecord m_timelineFrames[k_timelineFramesInFlight]{};
         CpuTimer m_frameTimerApp;
         CpuTimer m_renderTimerApp;
-        static constexpr uint32_t k_numGpuTimers = 3;
-        std::unique_ptr<ITimer> m_gpuTimerApp[k_numGpuTimers];
-        std::unique_ptr<ITimer> m_gpuTimerPrecomposition[k_numGpuTimers];
-        uint32_t m_currentTimerIndex{0};
+        // GPU timers are read with k_gpuTimersLatency frames of latency.
+        static constexpr uint32_t k_gpuTimersLatency = 3;
+        static constexpr uint32_t k_maxGpuTimersPerPool = 4;
+        std::unique_ptr<GpuTimestampPool> m_gpuTimestampsApp;
+        std::unique_ptr<GpuTimestampPool> m_gpuTimestampsPrecomposition;
+        std::unique_ptr<ITimer> m_gpuTimerApp;
+        std::unique_ptr<ITimer> m_gpuTimerPrecomposition;
     };
 
     // Singleton accessor.
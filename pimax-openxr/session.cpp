@@ -61,7 +61,7 @@ namespace pimax_openxr {
 
         // This should never happen if the app is properly polling xrGetSystem(). But there is still a tiny race
         // condition window even if it does.
-        if (!ensurePvrSession()) {
+        if (!ensureLiveSystem() || !ensurePvrSession()) {
             return XR_ERROR_INITIALIZATION_FAILED;
         }
 
@@ -170,10 +170,68 @@ namespace pimax_openxr {
         rebindControllerActions(xr::Side::Left);
         rebindControllerActions(xr::Side::Right);
         m_activeActionSets.clear();
+        std::atomic_store(&m_actionStateSnapshot, std::shared_ptr<const ActionStateSnapshot>());
 
         m_sessionStartTime = pvr_getTimeSeconds(m_pvr);
         m_sessionTotalFrameCount = 0;
 
+        // Publish the session status for the companion app and other tools, and the frame statistics when requested.
+        if (m_telemetry.open(m_applicationName, m_useTelemetry)) {
+            // The telemetry reports the heap allocations made by xrEndFrame().
+            if (m_useTelemetry) {
+                try {
+                    StartAllocationCounting();
+                } catch (std::exception& exc) {
+                    ErrorLog("Failed to enable allocation counting: %s\n", exc.what());
+                }
+            }
+            m_lastEndFrameAllocations = 0;
+
+            const float cantingAngle = PVR::Quatf{m_cachedEyeInfo[xr::StereoView::Left].HmdToEyePose.Orientation}.Angle(
+                                           m_cachedEyeInfo[xr::StereoView::Right].HmdToEyePose.Orientation) /
+                                       2.f;
+            pvrSizei viewportSize{};
+            CHECK_PVRCMD(pvr_getFovTextureSize(
+                m_pvrSession, pvrEye_Left, m_cachedEyeInfo[xr::StereoView::Left].Fov, 1.f, &viewportSize));
+
+            m_runtimeStatus = {};
+            m_runtimeStatus.refreshRate = m_displayRefreshRate;
+            m_runtimeStatus.resolutionWidth = viewportSize.w;
+            m_runtimeStatus.resolutionHeight = viewportSize.h;
+            m_runtimeStatus.fovLevel = m_fovLevel;
+            m_runtimeStatus.fov =
+                PVR::RadToDegree(-m_cachedEyeFov[xr::StereoView::Left].angleLeft +
+                                 m_cachedEyeFov[xr::StereoView::Right].angleRight + cantingAngle * 2.f);
+            m_runtimeStatus.floorHeight = m_floorHeight;
+            m_runtimeStatus.useParallelProjection = m_useParallelProjection;
+            m_runtimeStatus.useSmartSmoothing = pvr_getIntConfig(m_pvrSession, "dbg_asw_enable", 0);
+            m_telemetry.publishStatus(m_runtimeStatus);
+        } else {
+            Log("Telemetry is unavailable (in use by another application?)\n");
+        }
+        m_lastWaitDurationUs = 0;
+
+        // Record the frame timeline for offline analysis, when requested.
+        if (m_useTimelineRecorder) {
+            std::string fileName = m_applicationName;
+            std::replace_if(fileName.begin(), fileName.end(), [](char c) { return !isalnum((unsigned char)c); }, '_');
+            const std::time_t now = std::time(nullptr);
+            std::tm localTime{};
+            localtime_s(&localTime, &now);
+            char timestamp[32];
+            std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &localTime);
+
+            const auto timelineDir = localAppData / "timelines";
+            std::error_code ec;
+            std::filesystem::create_directories(timelineDir, ec);
+            const auto timelineFile = timelineDir / (fileName + "-" + timestamp + ".bin");
+            if (m_timelineRecorder.start(timelineFile, m_applicationName, m_displayRefreshRate)) {
+                Log("Recording frame timeline to: %s\n", timelineFile.string().c_str());
+            } else {
+                ErrorLog("Failed to create frame timeline file: %s\n", timelineFile.string().c_str());
+            }
+        }
+
         try {
             // Create a reference space with the origin and the HMD pose.
             m_originSpace = new Space;
@@ -187,6 +245,10 @@ namespace pimax_openxr {
             throw exc;
         }
 
+        startControllerWatcher();
+        startHapticsThread();
+        startInputSampler();
+
         *session = (XrSession)1;
 
         TraceLoggingWrite(g_traceProvider, "xrCreateSession", TLXArg(*session, "Session"));
@@ -203,17 +265,29 @@ namespace pimax_openxr {
         }
 
         if (m_useAsyncSubmission && !m_needStartAsyncSubmissionThread) {
-            {
-                std::unique_lock lock(m_asyncSubmissionMutex);
-
-                m_terminateAsyncThread = true;
-                m_asyncSubmissionCondVar.notify_all();
-            }
+            m_terminateAsyncThread = true;
+            m_asyncSubmissionSignal.notify();
             m_asyncSubmissionThread.join();
             m_asyncSubmissionThread = {};
             m_needStartAsyncSubmissionThread = true;
         }
 
+#ifdef DISPATCH_STATS
+        Log("Entry points statistics:\n");
+        publishDispatchStats(true /* doLog */);
+#endif
+        m_telemetry.close();
+        if (m_timelineRecorder.isRecording()) {
+            m_timelineRecorder.stop();
+            if (m_timelineRecorder.droppedRecords()) {
+                Log("Frame timeline dropped %llu records\n", m_timelineRecorder.droppedRecords());
+            }
+        }
+
+        stopInputSampler();
+        stopHapticsThread();
+        stopControllerWatcher();
+
         // Shutdown the mirror window.
         if (m_mirrorWindowThread.joinable()) {
             // Avoid race conditions where the window will not receive the message.
@@ -235,17 +309,9 @@ namespace pimax_openxr {
 #endif
 
         // Destroy hand trackers (tied to session).
-        for (auto handTracker : m_handTrackers) {
-            HandTracker* xrHandTracker = (HandTracker*)handTracker;
-            delete xrHandTracker;
-        }
         m_handTrackers.clear();
 
         // Destroy action spaces (tied to session).
-        for (auto space : m_spaces) {
-            Space* xrSpace = (Space*)space;
-            delete xrSpace;
-        }
         m_spaces.clear();
         if (m_guardianSpace) {
             delete m_guardianSpace;
@@ -255,20 +321,22 @@ namespace pimax_openxr {
         m_guardianSpace = m_originSpace = m_viewSpace = nullptr;
 
         // Destroy all swapchains (tied to session).
-        while (m_swapchains.size()) {
+        while (!m_swapchains.empty()) {
             // TODO: Ideally we do not invoke OpenXR public APIs to avoid confusing event tracing and possible
             // deadlocks.
-            CHECK_XRCMD(xrDestroySwapchain(*m_swapchains.begin()));
+            CHECK_XRCMD(xrDestroySwapchain(m_swapchains.handles().front()));
+        }
+        // The pooled swapchains are tied to the session too.
+        {
+            std::unique_lock lock(m_swapchainsMutex);
+
+            trimSwapchainPool(0);
         }
         if (m_guardianSwapchain) {
             pvr_destroyTextureSwapChain(m_pvrSession, m_guardianSwapchain);
             m_guardianSwapchain = nullptr;
         }
-        if (m_overlaySwapchain) {
-            pvr_destroyTextureSwapChain(m_pvrSession, m_overlaySwapchain);
-            m_overlaySwapchain = nullptr;
-        }
-        m_overlayBackground.Reset();
+        cleanupOverlayResources();
 
         // We do not destroy actionsets and actions, since they are tied to the instance.
 
@@ -314,7 +382,7 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(beginInfo->primaryViewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
@@ -334,11 +402,42 @@ namespace pimax_openxr {
 
         m_useAsyncSubmission = !m_useApplicationDeviceForSubmission && getSetting("async_submission").value_or(true);
         m_needStartAsyncSubmissionThread = m_useAsyncSubmission;
+        // Asynchronous commit relies on the submission thread being done with a frame before the next one is prepared,
+        // and cannot be combined with native D3D12 precomposition, which runs on the application queue.
+        m_useAsyncCommit = m_useAsyncSubmission && !(isD3D12Session() && m_useD3D12Precomposition) &&
+                           getSetting("async_commit").value_or(false);
+        if (m_useAsyncCommit) {
+            // The submission thread records the precomposition and commits on the submission context, while the
+            // application thread keeps copying and flushing on it.
+            ComPtr<ID3D11Multithread> multithread;
+            if (SUCCEEDED(m_pvrSubmissionContext->QueryInterface(IID_PPV_ARGS(multithread.ReleaseAndGetAddressOf())))) {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "xrBeginSession",
+                          TLArg(m_useAsyncSubmission, "UseAsyncSubmission"),
+                          TLArg(m_useAsyncCommit, "UseAsyncCommit"));
         // Creation of the submission threads is deferred to the first xrWaitFrame() to accomodate OpenComposite quirks.
 
         // Re-assert our compulsive smoothing setting.
         pvr_setIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", m_lockFramerate ? 2 : 1);
 
+        m_primaryViewConfigurationType = beginInfo->primaryViewConfigurationType;
+
+        // The scale of the application's rendering is measured against the resolution we recommend for the first view.
+        if (m_useDynamicResolution) {
+            const float pixelDensity =
+                m_primaryViewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO
+                    ? m_quadViewsPeripheralDensity
+                    : 1.f;
+            pvrSizei viewportSize{};
+            CHECK_PVRCMD(pvr_getFovTextureSize(
+                m_pvrSession, pvrEye_Left, m_cachedEyeInfo[xr::StereoView::Left].Fov, pixelDensity, &viewportSize));
+            m_dynamicResolutionNominalExtent = {viewportSize.w, viewportSize.h};
+            m_dynamicResolution.reset();
+        }
+
         m_sessionBegun = true;
         updateSessionState();
 
@@ -464,6 +563,7 @@ namespace pimax_openxr {
         if (getSetting("guardian").value_or(true)) {
             m_guardianThreshold = getSetting("guardian_threshold").value_or(1100) / 1e3f;
             m_guardianRadius = getSetting("guardian_radius").value_or(1600) / 1e3f;
+            m_guardianFadeDistance = std::max(getSetting("guardian_fade_distance").value_or(200) / 1e3f, 0.001f);
         } else {
             m_guardianThreshold = INFINITY;
         }
@@ -501,9 +601,58 @@ namespace pimax_openxr {
         m_frameTimeOverrideUs =
             (uint64_t)(getSetting("frame_time_override_multiplier").value_or(0) * 10.f * m_idealFrameDuration * 1000.f);
 
-        m_frameTimeFilterLength = getSetting("frame_time_filter_length").value_or(5);
+        {
+            FrameTimeEstimator::Config config;
+            config.smoothingLength = std::clamp(getApplicationSetting("frame_time_filter_length").value_or(5), 1, 100);
+            // Values are percentages.
+            config.quantile =
+                std::clamp(getApplicationSetting("frame_time_filter_quantile").value_or(50), 1, 99) / 100.0;
+            config.cpuWeight = std::max(getApplicationSetting("frame_time_cpu_weight").value_or(100), 0) / 100.0;
+            config.spikeThreshold =
+                std::max(getApplicationSetting("frame_time_spike_threshold").value_or(200), 100) / 100.0;
+            config.maxConsecutiveSpikes = std::max(getApplicationSetting("frame_time_max_spikes").value_or(3), 0);
+            m_frameTimeEstimator.configure(config);
+
+            TraceLoggingWrite(g_traceProvider,
+                              "PXR_FrameTimeEstimator",
+                              TLArg(config.smoothingLength, "SmoothingLength"),
+                              TLArg(config.quantile, "Quantile"),
+                              TLArg(config.cpuWeight, "CpuWeight"),
+                              TLArg(config.spikeThreshold, "SpikeThreshold"),
+                              TLArg(config.maxConsecutiveSpikes, "MaxConsecutiveSpikes"));
+        }
+
+        m_useDynamicResolution =
+            has_XR_META_recommended_layer_resolution && getSetting("dynamic_resolution").value_or(true);
+        {
+            DynamicResolutionController::Config config;
+            // Values are percentages.
+            config.minScale =
+                std::clamp(getApplicationSetting("dynamic_resolution_min_scale").value_or(50), 10, 100) / 100.0;
+            config.maxScale =
+                std::clamp(getApplicationSetting("dynamic_resolution_max_scale").value_or(100), 10, 200) / 100.0;
+            config.maxScale = std::max(config.minScale, config.maxScale);
+            config.targetUtilization =
+                std::clamp(getApplicationSetting("dynamic_resolution_target").value_or(85), 10, 100) / 100.0;
+            config.deadband =
+                std::clamp(getApplicationSetting("dynamic_resolution_deadband").value_or(5), 0, 50) / 100.0;
+            config.holdFrames = std::clamp(getApplicationSetting("dynamic_resolution_hold_frames").value_or(10),
+                                           (int)k_gpuTimersLatency,
+                                           1000);
+            m_dynamicResolution.configure(config);
+
+            TraceLoggingWrite(g_traceProvider,
+                              "PXR_DynamicResolution",
+                              TLArg(m_useDynamicResolution, "Enabled"),
+                              TLArg(config.minScale, "MinScale"),
+                              TLArg(config.maxScale, "MaxScale"),
+                              TLArg(config.targetUtilization, "TargetUtilization"),
+                              TLArg(config.deadband, "Deadband"),
+                              TLArg(config.holdFrames, "HoldFrames"));
+        }
 
         m_useMirrorWindow = getSetting("mirror_window").value_or(false);
+        m_mirrorWindowMaxFps = std::max(getSetting("mirror_window_max_fps").value_or(0), 0);
 
         m_droolonProjectionDistance = getSetting("droolon_projection_distance").value_or(35) / 100.f;
 
@@ -514,8 +663,41 @@ namespace pimax_openxr {
 
         m_useRunningStart = !getSetting("quirk_disable_running_start").value_or(false);
 
+        // With adaptive pacing, the settings above only select the initial mode. The controller keeps its state when
+        // the settings are refreshed during a running session.
+        const bool wasUsingAdaptivePacing = m_useAdaptivePacing;
+        m_useAdaptivePacing = getSetting("adaptive_pacing").value_or(false);
+        if (m_useAdaptivePacing) {
+            if (!wasUsingAdaptivePacing || !m_sessionBegun) {
+                PacingController::Config config;
+                config.windowFrames =
+                    (uint32_t)std::clamp(getSetting("adaptive_pacing_window").value_or(180), 30, 3600);
+                m_pacingController.configure(config,
+                                             m_lockFramerate          ? PacingController::Mode::LockedFramerate
+                                             : m_useDeferredFrameWait ? PacingController::Mode::DeferredWait
+                                                                      : PacingController::Mode::RunningStart);
+            }
+            applyPacingMode(m_pacingController.mode());
+        }
+
+        m_reuseStaticLayers = !getSetting("quirk_disable_static_layer_reuse").value_or(false);
+
         m_syncGpuWorkInEndFrame = getSetting("quirk_sync_gpu_work_in_end_frame").value_or(false);
 
+        m_useResourceWarmUp = getSetting("warm_up_swapchain_resources").value_or(true);
+
+        // PVR has no texture format for R10G10B10A2, so R11G11B10 is the only narrower format, and it has no alpha.
+        m_projectionSubmissionFormat = getSetting("submission_format_projection").value_or(0) == 1
+                                           ? DXGI_FORMAT_R11G11B10_FLOAT
+                                           : DXGI_FORMAT_UNKNOWN;
+        m_quadSubmissionFormat = getSetting("submission_format_quad").value_or(0) == 1 ? DXGI_FORMAT_R11G11B10_FLOAT
+                                                                                        : DXGI_FORMAT_UNKNOWN;
+
+        m_swapchainPoolBudget = (uint64_t)std::max(getSetting("swapchain_pool_budget_mb").value_or(0), 0) << 20;
+
+        m_useTelemetry = getSetting("telemetry").value_or(false);
+        m_useTimelineRecorder = getSetting("timeline_recorder").value_or(false);
+
         TraceLoggingWrite(
             g_traceProvider,
             "PXR_Config",
@@ -523,18 +705,28 @@ namespace pimax_openxr {
             TLArg((int)m_forcedInteractionProfile.value_or((ForcedInteractionProfile)-1), "ForcedInteractionProfile"),
             TLArg(m_guardianThreshold, "GuardianThreshold"),
             TLArg(m_guardianRadius, "GuardianRadius"),
+            TLArg(m_guardianFadeDistance, "GuardianFadeDistance"),
             TLArg(m_frameTimeOverrideOffsetUs, "FrameTimeOverrideOffset"),
             TLArg(m_frameTimeOverrideUs, "FrameTimeOverride"),
-            TLArg(m_frameTimeFilterLength, "FrameTimeFilterLength"),
             TLArg(m_useMirrorWindow, "MirrorWindow"),
+            TLArg(m_mirrorWindowMaxFps, "MirrorWindowMaxFps"),
             TLArg(m_droolonProjectionDistance, "DroolonProjectionDistance"),
             TLArg(m_useDeferredFrameWait, "UseDeferredFrameWait"),
             TLArg(m_lockFramerate, "LockFramerate"),
             TLArg(m_honorPremultiplyFlagOnProj0, "HonorPremultiplyFlagOnProj0"),
             TLArg(m_useRunningStart, "UseRunningStart"),
-            TLArg(m_syncGpuWorkInEndFrame, "SyncGpuWorkInEndFrame"));
-
-        if (m_pvrSession) {
+            TLArg(m_useAdaptivePacing, "UseAdaptivePacing"),
+            TLArg(m_reuseStaticLayers, "ReuseStaticLayers"),
+            TLArg(m_syncGpuWorkInEndFrame, "SyncGpuWorkInEndFrame"),
+            TLArg(m_useResourceWarmUp, "UseResourceWarmUp"),
+            TLArg((int)m_projectionSubmissionFormat, "ProjectionSubmissionFormat"),
+            TLArg((int)m_quadSubmissionFormat, "QuadSubmissionFormat"),
+            TLArg(m_swapchainPoolBudget, "SwapchainPoolBudget"),
+            TLArg(m_useTelemetry, "UseTelemetry"),
+            TLArg(m_useTimelineRecorder, "UseTimelineRecorder"));
+
+        // The PVR session might still be created by the startup thread.
+        if (m_isPvrStarted && m_pvrSession) {
             pvr_setIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", m_lockFramerate ? 2 : 1);
         }
 
@@ -548,6 +740,9 @@ namespace pimax_openxr {
         } else {
             m_debugControllerType.clear();
         }
+
+        // Let xrSyncActions() re-evaluate the controller types with the new override.
+        m_controllerStateChanged[xr::Side::Left] = m_controllerStateChanged[xr::Side::Right] = true;
     }
 
     // Create guardian resources.
@@ -558,47 +753,96 @@ namespace pimax_openxr {
         auto image = std::make_unique<DirectX::ScratchImage>();
         CoInitializeEx(nullptr, COINIT_MULTITHREADED);
         hr = DirectX::LoadFromWICFile((dllHome / L"guardian.png").c_str(), DirectX::WIC_FLAGS_NONE, nullptr, *image);
+        if (SUCCEEDED(hr) && image->GetMetadata().format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+            auto convertedImage = std::make_unique<DirectX::ScratchImage>();
+            hr = DirectX::Convert(*image->GetImage(0, 0, 0),
+                                  DXGI_FORMAT_R8G8B8A8_UNORM,
+                                  DirectX::TEX_FILTER_DEFAULT,
+                                  DirectX::TEX_THRESHOLD_DEFAULT,
+                                  *convertedImage);
+            image = std::move(convertedImage);
+        }
+        if (SUCCEEDED(hr) && image->GetMetadata().width > k_guardianFadeLevelSize) {
+            auto resizedImage = std::make_unique<DirectX::ScratchImage>();
+            hr = DirectX::Resize(*image->GetImage(0, 0, 0),
+                                 k_guardianFadeLevelSize,
+                                 image->GetMetadata().height * k_guardianFadeLevelSize / image->GetMetadata().width,
+                                 DirectX::TEX_FILTER_DEFAULT,
+                                 *resizedImage);
+            image = std::move(resizedImage);
+        }
 
         if (SUCCEEDED(hr)) {
-            ComPtr<ID3D11Resource> texture;
-            hr = DirectX::CreateTexture(m_pvrSubmissionDevice.Get(),
-                                        image->GetImages(),
-                                        1,
-                                        image->GetMetadata(),
-                                        texture.ReleaseAndGetAddressOf());
-
+            // Bake all the fade levels side by side into one static texture. Fading the guardian in and out only
+            // selects another region of the texture, so the swapchain is committed once and never again.
+            const DirectX::Image& source = *image->GetImage(0, 0, 0);
+            m_guardianExtent.width = (int)source.width;
+            m_guardianExtent.height = (int)source.height;
+            DirectX::ScratchImage fadeLevels;
+            const size_t levelStride = source.width + k_guardianFadeLevelGutter;
+            hr = fadeLevels.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM,
+                                         levelStride * k_guardianFadeLevels - k_guardianFadeLevelGutter,
+                                         source.height,
+                                         1,
+                                         1);
             if (SUCCEEDED(hr)) {
-                // Create a PVR swapchain for the texture.
-                pvrTextureSwapChainDesc desc{};
-                desc.Type = pvrTexture_2D;
-                desc.StaticImage = true;
-                desc.ArraySize = 1;
-                desc.Width = m_guardianExtent.width = (int)image->GetMetadata().width;
-                desc.Height = m_guardianExtent.height = (int)image->GetMetadata().height;
-                desc.MipLevels = (int)image->GetMetadata().mipLevels;
-                desc.SampleCount = 1;
-                desc.Format = dxgiToPvrTextureFormat(image->GetMetadata().format);
-
-                CHECK_PVRCMD(pvr_createTextureSwapChainDX(
-                    m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &m_guardianSwapchain));
-
-                // Copy and commit the guardian texture to the swapchain.
-                int imageIndex = -1;
-                CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, m_guardianSwapchain, &imageIndex));
-                ComPtr<ID3D11Texture2D> swapchainTexture;
-                CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(m_pvrSession,
-                                                             m_guardianSwapchain,
-                                                             imageIndex,
-                                                             IID_PPV_ARGS(swapchainTexture.ReleaseAndGetAddressOf())));
-
-                m_pvrSubmissionContext->CopyResource(swapchainTexture.Get(), texture.Get());
-                m_pvrSubmissionContext->Flush();
-                CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, m_guardianSwapchain));
+                const DirectX::Image& destination = *fadeLevels.GetImage(0, 0, 0);
+                // The gutters are left fully transparent.
+                memset(destination.pixels, 0, destination.slicePitch);
+                for (uint32_t level = 0; level < k_guardianFadeLevels; level++) {
+                    // The compositor expects premultiplied alpha, so all the channels are scaled.
+                    const float scale = (float)(level + 1) / k_guardianFadeLevels;
+                    for (size_t y = 0; y < source.height; y++) {
+                        const uint8_t* src = source.pixels + y * source.rowPitch;
+                        uint8_t* dst = destination.pixels + y * destination.rowPitch + level * levelStride * 4;
+                        for (size_t x = 0; x < source.width * 4; x++) {
+                            dst[x] = (uint8_t)(src[x] * scale + 0.5f);
+                        }
+                    }
+                }
+
+                ComPtr<ID3D11Resource> texture;
+                hr = DirectX::CreateTexture(m_pvrSubmissionDevice.Get(),
+                                            fadeLevels.GetImages(),
+                                            1,
+                                            fadeLevels.GetMetadata(),
+                                            texture.ReleaseAndGetAddressOf());
+                if (SUCCEEDED(hr)) {
+                    // Create a PVR swapchain for the texture.
+                    pvrTextureSwapChainDesc desc{};
+                    desc.Type = pvrTexture_2D;
+                    desc.StaticImage = true;
+                    desc.ArraySize = 1;
+                    desc.Width = (int)fadeLevels.GetMetadata().width;
+                    desc.Height = (int)fadeLevels.GetMetadata().height;
+                    desc.MipLevels = 1;
+                    desc.SampleCount = 1;
+                    desc.Format = dxgiToPvrTextureFormat(fadeLevels.GetMetadata().format);
+
+                    CHECK_PVRCMD(pvr_createTextureSwapChainDX(
+                        m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &m_guardianSwapchain));
+
+                    // Copy and commit the guardian texture to the swapchain.
+                    int imageIndex = -1;
+                    CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, m_guardianSwapchain, &imageIndex));
+                    ComPtr<ID3D11Texture2D> swapchainTexture;
+                    CHECK_PVRCMD(
+                        pvr_getTextureSwapChainBufferDX(m_pvrSession,
+                                                        m_guardianSwapchain,
+                                                        imageIndex,
+                                                        IID_PPV_ARGS(swapchainTexture.ReleaseAndGetAddressOf())));
+
+                    m_pvrSubmissionContext->CopyResource(swapchainTexture.Get(), texture.Get());
+                    m_pvrSubmissionContext->Flush();
+                    CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, m_guardianSwapchain));
+                } else {
+                    ErrorLog("Failed to create texture from guardian.png: %X\n", hr);
+                }
             } else {
-                ErrorLog("Failed to create texture from guardian.png: %X\n");
+                ErrorLog("Failed to create the guardian fade levels: %X\n", hr);
             }
         } else {
-            ErrorLog("Failed to load guardian.png: %X\n");
+            ErrorLog("Failed to load guardian.png: %X\n", hr);
         }
 
         // Create the guardian reference space, 1m below eyesight, flat on the floor.
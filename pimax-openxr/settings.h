@@ -0,0 +1,128 @@
+#pragma once
+
+#include "pch.h"
+
+namespace pimax_openxr::utils {
+
+    // An in-memory copy of the DWORD values under the runtime's registry key and under the sub-key of the current
+    // application. Both keys are read entirely in one go, and the result is published as an immutable snapshot, so
+    // that lookups never touch the registry nor wait on a lock held during a reload.
+    class SettingsStore {
+      public:
+        // Read all the values from the registry and publish them. This is the only method doing registry I/O.
+        void load(const std::string& key, const std::string& applicationName) {
+            std::unique_lock lock(m_loadMutex);
+
+            m_key = key;
+            m_applicationName = applicationName;
+
+            auto snapshot = std::make_shared<Snapshot>();
+            readKey(m_key, snapshot->values);
+            if (!m_applicationName.empty()) {
+                readKey(m_key + "\\" + m_applicationName, snapshot->applicationValues);
+            }
+
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+        }
+
+        // Re-read the same keys as the last load(), typically upon notification from a registry watcher.
+        void reload() {
+            std::string key, applicationName;
+            {
+                std::unique_lock lock(m_loadMutex);
+                key = m_key;
+                applicationName = m_applicationName;
+            }
+            load(key, applicationName);
+        }
+
+        std::optional<int> get(const std::string& name) const {
+            const auto snapshot = std::atomic_load(&m_snapshot);
+            if (!snapshot) {
+                return {};
+            }
+            return find(snapshot->values, name);
+        }
+
+        // Values under the application's sub-key take precedence.
+        std::optional<int> getForApplication(const std::string& name) const {
+            const auto snapshot = std::atomic_load(&m_snapshot);
+            if (!snapshot) {
+                return {};
+            }
+            const auto value = find(snapshot->applicationValues, name);
+            return value ? value : find(snapshot->values, name);
+        }
+
+      private:
+        // Registry value names are case-insensitive, so are the lookups. Our value names are plain ASCII, and comparing
+        // in place means that lookups do not need a lowercase copy of the name.
+        struct CaseInsensitiveHash {
+            size_t operator()(const std::string& name) const {
+                // FNV-1a.
+                uint64_t hash = 14695981039346656037ull;
+                for (const char c : name) {
+                    hash = (hash ^ (uint64_t)tolower((unsigned char)c)) * 1099511628211ull;
+                }
+                return (size_t)hash;
+            }
+        };
+        struct CaseInsensitiveEqual {
+            bool operator()(const std::string& a, const std::string& b) const {
+                return a.size() == b.size() && _strnicmp(a.c_str(), b.c_str(), a.size()) == 0;
+            }
+        };
+        using ValueMap = std::unordered_map<std::string, int, CaseInsensitiveHash, CaseInsensitiveEqual>;
+
+        struct Snapshot {
+            ValueMap values;
+            ValueMap applicationValues;
+        };
+
+        static std::optional<int> find(const ValueMap& values, const std::string& name) {
+            const auto it = values.find(name);
+            if (it == values.cend()) {
+                return {};
+            }
+            return it->second;
+        }
+
+        static void readKey(const std::string& key, ValueMap& values) {
+            wil::unique_hkey hkey;
+            if (RegOpenKeyExW(HKEY_LOCAL_MACHINE,
+                              xr::utf8_to_wide(key).c_str(),
+                              0,
+                              KEY_WOW64_64KEY | KEY_READ,
+                              hkey.put()) != ERROR_SUCCESS) {
+                return;
+            }
+
+            for (DWORD index = 0;; index++) {
+                // Registry value names are limited to 16383 characters.
+                wchar_t name[16384];
+                DWORD nameLength = ARRAYSIZE(name);
+                DWORD type{};
+                DWORD data{};
+                DWORD dataSize = sizeof(data);
+                const LONG retCode = RegEnumValueW(
+                    hkey.get(), index, name, &nameLength, nullptr, &type, reinterpret_cast<BYTE*>(&data), &dataSize);
+                if (retCode == ERROR_NO_MORE_ITEMS) {
+                    break;
+                }
+                if (retCode != ERROR_SUCCESS || type != REG_DWORD) {
+                    // Skip values that are not DWORD (including larger values that do not fit our buffer).
+                    continue;
+                }
+
+                values.insert_or_assign(xr::wide_to_utf8(std::wstring(name, nameLength)), (int)data);
+            }
+        }
+
+        std::mutex m_loadMutex;
+        std::string m_key;
+        std::string m_applicationName;
+
+        std::shared_ptr<const Snapshot> m_snapshot; // only accessed with std::atomic_load/store()
+    };
+
+} // namespace pimax_openxr::utils
@@ -23,6 +23,7 @@
 #include "pch.h"
 
 #include "log.h"
+#include "pose_math.h"
 #include "runtime.h"
 #include "utils.h"
 
@@ -32,6 +33,64 @@ namespace pimax_openxr {
     using namespace pimax_openxr::utils;
     using namespace xr::math;
 
+    namespace {
+
+        // Combine the locations of a space and a base space, both relative to the origin. The base space pose is
+        // passed inverted, so that it can be inverted only once when locating many spaces against the same base.
+        XrSpaceLocationFlags combineLocations(XrSpaceLocationFlags flags1,
+                                              const XrPosef& spaceToVirtual,
+                                              const XrSpaceVelocity& spaceToVirtualVelocity,
+                                              XrSpaceLocationFlags flags2,
+                                              const XrPosef& virtualToBaseSpace,
+                                              const XrSpaceVelocity& baseSpaceToVirtualVelocity,
+                                              XrPosef& pose,
+                                              XrSpaceVelocity* velocity) {
+            // If either pose is not valid, we cannot locate.
+            if (!(Pose::IsPoseValid(flags1) && Pose::IsPoseValid(flags2))) {
+                pose = Pose::Identity();
+                return 0;
+            }
+
+            XrSpaceLocationFlags locationFlags =
+                XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT;
+
+            // Both poses need to be tracked for the location to be tracked.
+            if (Pose::IsPoseTracked(flags1) && Pose::IsPoseTracked(flags2)) {
+                locationFlags |= XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+            }
+
+            // Combine the poses.
+            const simd::Pose virtualToBase = simd::LoadPose(virtualToBaseSpace);
+            const simd::Pose spaceToBase = simd::Multiply(simd::LoadPose(spaceToVirtual), virtualToBase);
+            pose = simd::StorePose(spaceToBase);
+            if (velocity) {
+                velocity->velocityFlags =
+                    spaceToVirtualVelocity.velocityFlags & baseSpaceToVirtualVelocity.velocityFlags;
+
+                // The rotation of the base space contributes to the linear velocity only when it is known.
+                simd::Velocity baseVelocity{simd::LoadVector(baseSpaceToVirtualVelocity.angularVelocity),
+                                            simd::LoadVector(baseSpaceToVirtualVelocity.linearVelocity)};
+                if (!(baseSpaceToVirtualVelocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT)) {
+                    baseVelocity.angular = DirectX::XMVectorZero();
+                }
+                const simd::Velocity spaceVelocity{simd::LoadVector(spaceToVirtualVelocity.angularVelocity),
+                                                   simd::LoadVector(spaceToVirtualVelocity.linearVelocity)};
+                const simd::Velocity relativeVelocity =
+                    simd::RelativeVelocity(virtualToBase, spaceToBase, spaceVelocity, baseVelocity);
+
+                if (velocity->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
+                    simd::StoreVector(velocity->angularVelocity, relativeVelocity.angular);
+                }
+                if (velocity->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
+                    simd::StoreVector(velocity->linearVelocity, relativeVelocity.linear);
+                }
+            }
+
+            return locationFlags;
+        }
+
+    } // namespace
+
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumerateReferenceSpaces
     XrResult OpenXrRuntime::xrEnumerateReferenceSpaces(XrSession session,
                                                        uint32_t spaceCapacityInput,
@@ -99,16 +158,12 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_actionsAndSpacesMutex);
 
-        // Create the internal struct.
-        Space& xrSpace = *new Space;
+        // Create the internal struct, owned by the table of known spaces used for validation and cleanup.
+        *space = m_spaces.insert(std::make_unique<Space>());
+        Space& xrSpace = *m_spaces.get(*space);
         xrSpace.referenceType = createInfo->referenceSpaceType;
         xrSpace.poseInSpace = createInfo->poseInReferenceSpace;
 
-        *space = (XrSpace)&xrSpace;
-
-        // Maintain a list of known spaces for validation and cleanup.
-        m_spaces.insert(*space);
-
         TraceLoggingWrite(g_traceProvider, "xrCreateReferenceSpace", TLXArg(*space, "Space"));
 
         return XR_SUCCESS;
@@ -147,17 +202,14 @@ namespace pimax_openxr {
             }
         }
 
-        // Create the internal struct.
-        Space& xrSpace = *new Space;
+        // Create the internal struct, owned by the table of known spaces used for validation and cleanup.
+        *space = m_spaces.insert(std::make_unique<Space>());
+        Space& xrSpace = *m_spaces.get(*space);
         xrSpace.referenceType = XR_REFERENCE_SPACE_TYPE_MAX_ENUM;
         xrSpace.action = createInfo->action;
         xrSpace.subActionPath = createInfo->subactionPath;
         xrSpace.poseInSpace = createInfo->poseInActionSpace;
-
-        *space = (XrSpace)&xrSpace;
-
-        // Maintain a list of known spaces for validation and cleanup.
-        m_spaces.insert(*space);
+        resolveActionSpaceBinding(xrSpace);
 
         TraceLoggingWrite(g_traceProvider, "xrCreateActionSpace", TLXArg(*space, "Space"));
 
@@ -203,7 +255,7 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_actionsAndSpacesMutex);
 
-        if (!m_spaces.count(space) || !m_spaces.count(baseSpace)) {
+        if (!m_spaces.contains(space) || !m_spaces.contains(baseSpace)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
@@ -227,8 +279,8 @@ namespace pimax_openxr {
             gazeSampleTime = reinterpret_cast<XrEyeGazeSampleTimeEXT*>(gazeSampleTime->next);
         }
 
-        Space& xrSpace = *(Space*)space;
-        Space& xrBaseSpace = *(Space*)baseSpace;
+        Space& xrSpace = *m_spaces.get(space);
+        Space& xrBaseSpace = *m_spaces.get(baseSpace);
 
         location->locationFlags = locateSpace(xrSpace, xrBaseSpace, time, location->pose, velocity, gazeSampleTime);
 
@@ -250,6 +302,118 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#xrLocateSpacesKHR
+    XrResult OpenXrRuntime::xrLocateSpacesKHR(XrSession session,
+                                              const XrSpacesLocateInfoKHR* locateInfo,
+                                              XrSpaceLocationsKHR* spaceLocations) {
+        if (locateInfo->type != XR_TYPE_SPACES_LOCATE_INFO_KHR || spaceLocations->type != XR_TYPE_SPACE_LOCATIONS_KHR) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrLocateSpacesKHR",
+                          TLXArg(session, "Session"),
+                          TLXArg(locateInfo->baseSpace, "BaseSpace"),
+                          TLArg(locateInfo->time, "Time"),
+                          TLArg(locateInfo->spaceCount, "SpaceCount"));
+
+        if (!has_XR_KHR_locate_spaces) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        if (!locateInfo->spaceCount || locateInfo->spaceCount != spaceLocations->locationCount) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        XrSpaceVelocitiesKHR* velocities = reinterpret_cast<XrSpaceVelocitiesKHR*>(spaceLocations->next);
+        while (velocities) {
+            if (velocities->type == XR_TYPE_SPACE_VELOCITIES_KHR) {
+                break;
+            }
+            velocities = reinterpret_cast<XrSpaceVelocitiesKHR*>(velocities->next);
+        }
+
+        if (velocities && velocities->velocityCount != locateInfo->spaceCount) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        std::unique_lock lock(m_actionsAndSpacesMutex);
+
+        if (!m_spaces.contains(locateInfo->baseSpace)) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+        for (uint32_t i = 0; i < locateInfo->spaceCount; i++) {
+            if (!m_spaces.contains(locateInfo->spaces[i])) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+        }
+
+        if (locateInfo->time <= 0) {
+            return XR_ERROR_TIME_INVALID;
+        }
+
+        const Space& xrBaseSpace = *m_spaces.get(locateInfo->baseSpace);
+
+        // Locate the base space only once for the whole batch. The tracked devices are sampled at most once per
+        // timestamp thanks to the pose cache, so spaces attached to the same device do not query PVR again.
+        XrPosef baseSpaceToVirtual = Pose::Identity();
+        XrSpaceVelocity baseSpaceToVirtualVelocity{};
+        const XrSpaceLocationFlags baseFlags = locateSpaceToOrigin(xrBaseSpace,
+                                                                   locateInfo->time,
+                                                                   baseSpaceToVirtual,
+                                                                   velocities ? &baseSpaceToVirtualVelocity : nullptr,
+                                                                   nullptr);
+        const XrPosef virtualToBaseSpace = simd::Invert(baseSpaceToVirtual);
+
+        for (uint32_t i = 0; i < locateInfo->spaceCount; i++) {
+            const Space& xrSpace = *m_spaces.get(locateInfo->spaces[i]);
+            XrSpaceLocationDataKHR& location = spaceLocations->locations[i];
+            XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+
+            if (isSameSpaceOrigin(xrSpace, xrBaseSpace)) {
+                // Reuse the optimization for locating against the same reference space or same action space.
+                location.locationFlags = locateSpace(
+                    xrSpace, xrBaseSpace, locateInfo->time, location.pose, velocities ? &velocity : nullptr, nullptr);
+            } else {
+                XrPosef spaceToVirtual = Pose::Identity();
+                XrSpaceVelocity spaceToVirtualVelocity{};
+                const XrSpaceLocationFlags flags = locateSpaceToOrigin(xrSpace,
+                                                                       locateInfo->time,
+                                                                       spaceToVirtual,
+                                                                       velocities ? &spaceToVirtualVelocity : nullptr,
+                                                                       nullptr);
+                location.locationFlags = combineLocations(flags,
+                                                          spaceToVirtual,
+                                                          spaceToVirtualVelocity,
+                                                          baseFlags,
+                                                          virtualToBaseSpace,
+                                                          baseSpaceToVirtualVelocity,
+                                                          location.pose,
+                                                          velocities ? &velocity : nullptr);
+            }
+
+            if (velocities) {
+                XrSpaceVelocityDataKHR& velocityData = velocities->velocities[i];
+                velocityData.velocityFlags = velocity.velocityFlags;
+                velocityData.angularVelocity = velocity.angularVelocity;
+                velocityData.linearVelocity = velocity.linearVelocity;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrLocateSpacesKHR",
+                              TLXArg(locateInfo->spaces[i], "Space"),
+                              TLArg(location.locationFlags, "LocationFlags"),
+                              TLArg(xr::ToString(location.pose).c_str(), "Pose"),
+                              TLArg(velocity.velocityFlags, "VelocityFlags"));
+        }
+
+        return XR_SUCCESS;
+    }
+
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrLocateViews
     XrResult OpenXrRuntime::xrLocateViews(XrSession session,
                                           const XrViewLocateInfo* viewLocateInfo,
@@ -277,28 +441,42 @@ namespace pimax_openxr {
             return XR_ERROR_TIME_INVALID;
         }
 
-        if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewLocateInfo->viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewCapacityInput && viewCapacityInput < xr::StereoView::Count) {
+        const uint32_t viewCount = getViewCount(viewLocateInfo->viewConfigurationType);
+        if (viewCapacityInput && viewCapacityInput < viewCount) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
+        bool isFoveatedRenderingActive = false;
+        if (has_XR_VARJO_foveated_rendering) {
+            const XrBaseInStructure* entry = reinterpret_cast<const XrBaseInStructure*>(viewLocateInfo->next);
+            while (entry) {
+                if (entry->type == XR_TYPE_VIEW_LOCATE_FOVEATED_RENDERING_VARJO) {
+                    isFoveatedRenderingActive =
+                        reinterpret_cast<const XrViewLocateFoveatedRenderingVARJO*>(entry)->foveatedRenderingActive;
+                    break;
+                }
+                entry = entry->next;
+            }
+        }
+
         std::unique_lock lock(m_actionsAndSpacesMutex);
 
-        if (!m_spaces.count(viewLocateInfo->space)) {
+        if (!m_spaces.contains(viewLocateInfo->space)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        *viewCountOutput = xr::StereoView::Count;
+        *viewCountOutput = viewCount;
         TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLArg(*viewCountOutput, "ViewCountOutput"));
 
         if (viewCapacityInput && views) {
             // Get the HMD pose in the base space.
             XrPosef headPose;
             viewState->viewStateFlags =
-                locateSpace(*m_viewSpace, *(Space*)viewLocateInfo->space, viewLocateInfo->displayTime, headPose);
+                locateSpace(*m_viewSpace, *m_spaces.get(viewLocateInfo->space), viewLocateInfo->displayTime, headPose);
 
             if (viewState->viewStateFlags & (XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_VALID_BIT)) {
                 // Calculate poses for each eye.
@@ -311,13 +489,28 @@ namespace pimax_openxr {
 
                 TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLArg(viewState->viewStateFlags, "ViewStateFlags"));
 
+                // With foveated rendering, the focus views follow the eye gaze when it is available.
+                XrVector3f gazeUnitVector{};
+                bool hasGaze = false;
+                if (isFoveatedRenderingActive && viewCount > xr::StereoView::Count) {
+                    double sampleTime;
+                    hasGaze = getEyeGaze(viewLocateInfo->displayTime, false, gazeUnitVector, sampleTime);
+                    TraceLoggingWrite(g_traceProvider,
+                                      "xrLocateViews",
+                                      TLArg(hasGaze, "HasGaze"),
+                                      TLArg(xr::ToString(gazeUnitVector).c_str(), "GazeUnitVector"));
+                }
+
                 for (uint32_t i = 0; i < *viewCountOutput; i++) {
                     if (views[i].type != XR_TYPE_VIEW) {
                         return XR_ERROR_VALIDATION_FAILURE;
                     }
 
-                    views[i].pose = pvrPoseToXrPose(eyePoses[i % xr::StereoView::Count]);
-                    views[i].fov = m_cachedEyeFov[i];
+                    // The focus views share the pose of the stereo views, but with a narrower FOV.
+                    const uint32_t eye = i % xr::StereoView::Count;
+                    views[i].pose = pvrPoseToXrPose(eyePoses[eye]);
+                    views[i].fov = i < xr::StereoView::Count ? m_cachedEyeFov[eye]
+                                                             : getFocusFov(eye, hasGaze ? &gazeUnitVector : nullptr);
 
                     TraceLoggingWrite(g_traceProvider,
                                       "xrLocateViews",
@@ -341,13 +534,10 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_actionsAndSpacesMutex);
 
-        if (!m_spaces.count(space)) {
+        if (!m_spaces.contains(space)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        Space* xrSpace = (Space*)space;
-
-        delete xrSpace;
         m_spaces.erase(space);
 
         return XR_SUCCESS;
@@ -363,10 +553,8 @@ namespace pimax_openxr {
         XrSpaceVelocity spaceToVirtualVelocity{};
         XrPosef baseSpaceToVirtual = Pose::Identity();
         XrSpaceVelocity baseSpaceToVirtualVelocity{};
-        XrSpaceLocationFlags flags1, flags2, locationFlags;
-        if (xrSpace.referenceType != xrBaseSpace.referenceType ||
-            (xrSpace.referenceType == XR_REFERENCE_SPACE_TYPE_MAX_ENUM && xrSpace.action != xrBaseSpace.action &&
-             xrSpace.subActionPath != xrBaseSpace.subActionPath)) {
+        XrSpaceLocationFlags flags1, flags2;
+        if (!isSameSpaceOrigin(xrSpace, xrBaseSpace)) {
             flags1 = locateSpaceToOrigin(
                 xrSpace, time, spaceToVirtual, velocity ? &spaceToVirtualVelocity : nullptr, gazeSampleTime);
             flags2 = locateSpaceToOrigin(xrBaseSpace,
@@ -388,35 +576,20 @@ namespace pimax_openxr {
             }
         }
 
-        // If either pose is not valid, we cannot locate.
-        if (!(Pose::IsPoseValid(flags1) && Pose::IsPoseValid(flags2))) {
-            pose = Pose::Identity();
-            return 0;
-        }
-
-        locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT;
-
-        // Both poses need to be tracked for the location to be tracked.
-        if (Pose::IsPoseTracked(flags1) && Pose::IsPoseTracked(flags2)) {
-            locationFlags |= XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
-        }
-
-        // Combine the poses.
-        pose = Pose::Multiply(spaceToVirtual, Pose::Invert(baseSpaceToVirtual));
-        if (velocity) {
-            velocity->velocityFlags = spaceToVirtualVelocity.velocityFlags & baseSpaceToVirtualVelocity.velocityFlags;
-            if (velocity->velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
-                velocity->angularVelocity =
-                    spaceToVirtualVelocity.angularVelocity - baseSpaceToVirtualVelocity.angularVelocity;
-            }
-            if (velocity->velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
-                // TODO: Does not account for centripetral forces.
-                velocity->linearVelocity =
-                    spaceToVirtualVelocity.linearVelocity - baseSpaceToVirtualVelocity.linearVelocity;
-            }
-        }
+        return combineLocations(flags1,
+                                spaceToVirtual,
+                                spaceToVirtualVelocity,
+                                flags2,
+                                simd::Invert(baseSpaceToVirtual),
+                                baseSpaceToVirtualVelocity,
+                                pose,
+                                velocity);
+    }
 
-        return locationFlags;
+    bool OpenXrRuntime::isSameSpaceOrigin(const Space& xrSpace, const Space& xrBaseSpace) {
+        return xrSpace.referenceType == xrBaseSpace.referenceType &&
+               (xrSpace.referenceType != XR_REFERENCE_SPACE_TYPE_MAX_ENUM || xrSpace.action == xrBaseSpace.action ||
+                xrSpace.subActionPath == xrBaseSpace.subActionPath);
     }
 
     XrSpaceLocationFlags OpenXrRuntime::locateSpaceToOrigin(const Space& xrSpace,
@@ -450,55 +623,130 @@ namespace pimax_openxr {
             if (velocity) {
                 velocity->velocityFlags = XR_SPACE_VELOCITY_ANGULAR_VALID_BIT | XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
             }
-        } else if (xrSpace.action != XR_NULL_HANDLE) {
+        } else if (xrSpace.source == ActionSpaceSource::Grip || xrSpace.source == ActionSpaceSource::Aim) {
             // Action spaces for motion controllers.
-            Action& xrAction = *(Action*)xrSpace.action;
+            result = getControllerPose(xrSpace.side, time, pose, velocity);
+
+            // Apply the pose offsets.
+            if (xrSpace.source == ActionSpaceSource::Aim) {
+                pose = simd::Multiply(m_controllerAimPose[xrSpace.side], pose);
+            } else {
+                pose = simd::Multiply(m_controllerGripPose[xrSpace.side], pose);
+            }
+        } else if (xrSpace.source == ActionSpaceSource::EyeGaze) {
+            result = getEyeTrackerPose(time, pose, gazeSampleTime);
+        }
+
+        // Apply the offset transform.
+        pose = simd::Multiply(xrSpace.poseInSpace, pose);
+
+        return result;
+    }
+
+    // Resolve the pose source of an action space from the action sources currently bound, so that locating the space
+    // does not need to look at the binding paths.
+    void OpenXrRuntime::resolveActionSpaceBinding(Space& xrSpace) const {
+        xrSpace.source = ActionSpaceSource::None;
+        xrSpace.side = -1;
+
+        // The action might have been destroyed before its space.
+        if (xrSpace.action == XR_NULL_HANDLE || !m_actions.count(xrSpace.action)) {
+            return;
+        }
 
-            const std::string& subActionPath = getXrPath(xrSpace.subActionPath);
-            for (const auto& source : xrAction.actionSources) {
-                if (!startsWith(source.first, subActionPath)) {
-                    continue;
+        const Action& xrAction = *(Action*)xrSpace.action;
+
+        const std::string& subActionPath = getXrPath(xrSpace.subActionPath);
+        for (const auto& source : xrAction.actionSources) {
+            if (!startsWith(source.first, subActionPath)) {
+                continue;
+            }
+
+            const std::string& fullPath = source.first;
+
+            if (!isActionEyeTracker(fullPath)) {
+                const bool isGripPose = endsWith(fullPath, "/input/grip/pose") || endsWith(fullPath, "/input/grip");
+                const bool isAimPose = endsWith(fullPath, "/input/aim/pose") || endsWith(fullPath, "/input/aim");
+                const int side = getActionSide(fullPath);
+                if ((isGripPose || isAimPose) && side >= 0) {
+                    xrSpace.source = isAimPose ? ActionSpaceSource::Aim : ActionSpaceSource::Grip;
+                    xrSpace.side = side;
                 }
+            } else {
+                xrSpace.source = ActionSpaceSource::EyeGaze;
+            }
 
-                const std::string& fullPath = source.first;
-                TraceLoggingWrite(g_traceProvider, "xrLocateSpace", TLArg(fullPath.c_str(), "ActionSourcePath"));
-
-                if (!isActionEyeTracker(fullPath)) {
-                    const bool isGripPose = endsWith(fullPath, "/input/grip/pose") || endsWith(fullPath, "/input/grip");
-                    const bool isAimPose = endsWith(fullPath, "/input/aim/pose") || endsWith(fullPath, "/input/aim");
-                    const int side = getActionSide(fullPath);
-                    if ((isGripPose || isAimPose) && side >= 0) {
-                        result = getControllerPose(side, time, pose, velocity);
-
-                        // Apply the pose offsets.
-                        if (isAimPose) {
-                            pose = Pose::Multiply(m_controllerAimPose[side], pose);
-                        } else {
-                            pose = Pose::Multiply(m_controllerGripPose[side], pose);
-                        }
-
-                        // Per spec we must consistently pick one source. We pick the first one.
-                        break;
-                    }
-                } else {
-                    result = getEyeTrackerPose(time, pose, gazeSampleTime);
+            if (xrSpace.source != ActionSpaceSource::None) {
+                TraceLoggingWrite(g_traceProvider,
+                                  "ResolveActionSpace",
+                                  TLXArg(&xrSpace, "Space"),
+                                  TLArg(fullPath.c_str(), "ActionSourcePath"));
 
-                    // Per spec we must consistently pick one source. We pick the first one.
-                    break;
+                // Per spec we must consistently pick one source. We pick the first one.
+                break;
+            }
+        }
+    }
+
+    // Must be invoked whenever the action sources are modified.
+    void OpenXrRuntime::resolveActionSpaceBindings() {
+        m_spaces.forEach([&](Space& xrSpace) { resolveActionSpaceBinding(xrSpace); });
+    }
+
+    // Query the pose of a tracked device, reusing a previous query for the same time when possible.
+    void
+    OpenXrRuntime::getTrackedDevicePoseState(pvrTrackedDeviceType device, XrTime time, pvrPoseStatef& state) const {
+        const size_t deviceIndex = device == pvrTrackedDevice_HMD              ? 0
+                                   : device == pvrTrackedDevice_LeftController ? 1 + xr::Side::Left
+                                                                               : 1 + xr::Side::Right;
+        auto& cache = m_poseCache[deviceIndex];
+
+        {
+            std::unique_lock lock(m_poseCacheMutex);
+
+            for (const auto& entry : cache) {
+                if (entry.time == time) {
+                    state = entry.state;
+                    m_poseCacheHits++;
+                    return;
                 }
             }
+            m_poseCacheMisses++;
         }
 
-        // Apply the offset transform.
-        pose = Pose::Multiply(xrSpace.poseInSpace, pose);
+        CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession, device, xrTimeToPvrTime(time), &state));
 
-        return result;
+        {
+            std::unique_lock lock(m_poseCacheMutex);
+
+            // Replace the oldest entry once the cache is full.
+            if (cache.size() < cache.capacity()) {
+                cache.push_back({time, state});
+            } else {
+                cache[m_poseCacheNextEntry[deviceIndex]] = {time, state};
+                m_poseCacheNextEntry[deviceIndex] = (m_poseCacheNextEntry[deviceIndex] + 1) % cache.capacity();
+            }
+        }
+    }
+
+    void OpenXrRuntime::invalidatePoseCache() {
+        std::unique_lock lock(m_poseCacheMutex);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "PoseCache_Statistics",
+                          TLArg(m_poseCacheHits, "Hits"),
+                          TLArg(m_poseCacheMisses, "Misses"));
+
+        for (uint32_t i = 0; i < ARRAYSIZE(m_poseCache); i++) {
+            m_poseCache[i].clear();
+            m_poseCacheNextEntry[i] = 0;
+        }
     }
 
     XrSpaceLocationFlags OpenXrRuntime::getHmdPose(XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
         XrSpaceLocationFlags locationFlags = 0;
         pvrPoseStatef state{};
-        CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession, pvrTrackedDevice_HMD, xrTimeToPvrTime(time), &state));
+        getTrackedDevicePoseState(pvrTrackedDevice_HMD, time, state);
         TraceLoggingWrite(g_traceProvider,
                           "PVR_HmdPoseState",
                           TLArg(state.StatusFlags, "StatusFlags"),
@@ -550,11 +798,8 @@ namespace pimax_openxr {
     OpenXrRuntime::getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
         XrSpaceLocationFlags locationFlags = 0;
         pvrPoseStatef state{};
-        CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession,
-                                                   side == 0 ? pvrTrackedDevice_LeftController
-                                                             : pvrTrackedDevice_RightController,
-                                                   xrTimeToPvrTime(time),
-                                                   &state));
+        getTrackedDevicePoseState(
+            side == 0 ? pvrTrackedDevice_LeftController : pvrTrackedDevice_RightController, time, state);
         TraceLoggingWrite(g_traceProvider,
                           "PVR_ControllerPoseState",
                           TLArg(side == 0 ? "Left" : "Right", "Side"),
@@ -622,4 +867,46 @@ namespace pimax_openxr {
                XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
     }
 
+    // Compute the FOV of the focus view for an eye, either centered in the FOV of the eye or following the eye gaze,
+    // expressed as a unit vector relative to the head.
+    XrFovf OpenXrRuntime::getFocusFov(uint32_t eye, const XrVector3f* gazeUnitVector) const {
+        const XrFovf& eyeFov = m_cachedEyeFov[eye];
+        const float left = tan(eyeFov.angleLeft);
+        const float right = tan(eyeFov.angleRight);
+        const float down = tan(eyeFov.angleDown);
+        const float up = tan(eyeFov.angleUp);
+
+        // The focus view covers a fixed portion of the image plane.
+        const float halfWidth = (right - left) * m_quadViewsFocusSize / 2.f;
+        const float halfHeight = (up - down) * m_quadViewsFocusSize / 2.f;
+
+        float centerX = 0.f;
+        float centerY = 0.f;
+        if (gazeUnitVector) {
+            // Project the gaze onto the image plane of the eye, which might be canted.
+            XrPosef eyeToHead = pvrPoseToXrPose(m_cachedEyeInfo[eye].HmdToEyePose);
+            eyeToHead.position = {0, 0, 0};
+            const XrVector3f gaze =
+                Pose::Multiply(Pose::Translation(*gazeUnitVector), Pose::Invert(eyeToHead)).position;
+            if (gaze.z < -0.01f) {
+                centerX = gaze.x / -gaze.z;
+                centerY = gaze.y / -gaze.z;
+            }
+        }
+
+        // Keep the focus view within the FOV of the eye. The bounds are reversed when the focus view is larger than the
+        // FOV of the eye, so they must be ordered for std::clamp().
+        centerX = std::clamp(
+            centerX, std::min(left + halfWidth, right - halfWidth), std::max(left + halfWidth, right - halfWidth));
+        centerY = std::clamp(
+            centerY, std::min(down + halfHeight, up - halfHeight), std::max(down + halfHeight, up - halfHeight));
+
+        XrFovf fov;
+        fov.angleLeft = atan(centerX - halfWidth);
+        fov.angleRight = atan(centerX + halfWidth);
+        fov.angleDown = atan(centerY - halfHeight);
+        fov.angleUp = atan(centerY + halfHeight);
+        return fov;
+    }
+
 } // namespace pimax_openxr
@@ -39,6 +39,9 @@ namespace pimax_openxr {
                                                           XrViewConfigurationType* viewConfigurationTypes) {
         std::vector<XrViewConfigurationType> types;
         types.push_back(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO);
+        if (has_XR_VARJO_quad_views) {
+            types.push_back(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+        }
 
         TraceLoggingWrite(g_traceProvider,
                           "xrEnumerateViewConfigurations",
@@ -98,7 +101,7 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
@@ -135,15 +138,21 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        // The recommended resolution is computed by PVR.
+        if (!ensureLiveSystem()) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewCapacityInput && viewCapacityInput < xr::StereoView::Count) {
+        const uint32_t viewCount = getViewCount(viewConfigurationType);
+        if (viewCapacityInput && viewCapacityInput < viewCount) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
-        *viewCountOutput = xr::StereoView::Count;
+        *viewCountOutput = viewCount;
         TraceLoggingWrite(
             g_traceProvider, "xrEnumerateViewConfigurationViews", TLArg(*viewCountOutput, "ViewCountOutput"));
 
@@ -165,18 +174,33 @@ namespace pimax_openxr {
                 views[i].maxSwapchainSampleCount = 1;
                 views[i].recommendedSwapchainSampleCount = 1;
 
+                // With quad views, the stereo views only cover the periphery and can use a lower pixel density. The
+                // focus views are always sized for their default position, since they move with the eye gaze but do
+                // not change size.
+                const uint32_t eye = i % xr::StereoView::Count;
+                XrFovf viewFov = m_cachedEyeFov[eye];
+                float pixelDensity = 1.f;
+                if (viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                    if (i < xr::StereoView::Count) {
+                        pixelDensity = m_quadViewsPeripheralDensity;
+                    } else {
+                        viewFov = getFocusFov(eye, nullptr);
+                        pixelDensity = m_quadViewsFocusDensity;
+                    }
+                }
+
                 // Recommend the resolution with distortion accounted for.
                 // There is a DistortedViewport in the EyeInfo struct, but it does not account for additional transforms
                 // such as parallel projection, so we recompute the resolution based on the actual FOV information.
                 pvrFovPort fov;
-                fov.UpTan = tan(m_cachedEyeFov[i].angleUp);
-                fov.DownTan = tan(-m_cachedEyeFov[i].angleDown);
-                fov.LeftTan = tan(-m_cachedEyeFov[i].angleLeft);
-                fov.RightTan = tan(m_cachedEyeFov[i].angleRight);
+                fov.UpTan = tan(viewFov.angleUp);
+                fov.DownTan = tan(-viewFov.angleDown);
+                fov.LeftTan = tan(-viewFov.angleLeft);
+                fov.RightTan = tan(viewFov.angleRight);
 
                 pvrSizei viewportSize;
-                CHECK_PVRCMD(
-                    pvr_getFovTextureSize(m_pvrSession, i == 0 ? pvrEye_Left : pvrEye_Right, fov, 1.f, &viewportSize));
+                CHECK_PVRCMD(pvr_getFovTextureSize(
+                    m_pvrSession, eye == 0 ? pvrEye_Left : pvrEye_Right, fov, pixelDensity, &viewportSize));
                 views[i].recommendedImageRectWidth = std::min((uint32_t)viewportSize.w, views[i].maxImageRectWidth);
                 views[i].recommendedImageRectHeight = std::min((uint32_t)viewportSize.h, views[i].maxImageRectHeight);
 
@@ -195,6 +219,11 @@ namespace pimax_openxr {
                 Log("Recommended resolution: %ux%u\n",
                     views[0].recommendedImageRectWidth,
                     views[0].recommendedImageRectHeight);
+                if (viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                    Log("Recommended focus resolution: %ux%u\n",
+                        views[xr::StereoView::Count].recommendedImageRectWidth,
+                        views[xr::StereoView::Count].recommendedImageRectHeight);
+                }
                 m_loggedResolution = true;
             }
         }
@@ -202,6 +231,84 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetRecommendedLayerResolutionMETA
+    XrResult OpenXrRuntime::xrGetRecommendedLayerResolutionMETA(XrSession session,
+                                                                const XrRecommendedLayerResolutionGetInfoMETA* info,
+                                                                XrRecommendedLayerResolutionMETA* resolution) {
+        if (info->type != XR_TYPE_RECOMMENDED_LAYER_RESOLUTION_GET_INFO_META ||
+            resolution->type != XR_TYPE_RECOMMENDED_LAYER_RESOLUTION_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrGetRecommendedLayerResolutionMETA",
+                          TLXArg(session, "Session"),
+                          TLPArg(info->layer, "Layer"),
+                          TLArg(info->predictedDisplayTime, "PredictedDisplayTime"));
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        if (!info->layer) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        if (info->predictedDisplayTime <= 0) {
+            return XR_ERROR_TIME_INVALID;
+        }
+
+        resolution->recommendedImageDimensions = {};
+        resolution->isValid = XR_FALSE;
+
+        // We only measure the GPU cost of the projection layers, and we make no recommendation for the other layers.
+        if (m_useDynamicResolution && info->layer->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+            const auto proj = reinterpret_cast<const XrCompositionLayerProjection*>(info->layer);
+            if (!proj->viewCount || !proj->views) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            std::optional<double> scale;
+            {
+                std::unique_lock lock(m_frameMutex);
+
+                if (m_dynamicResolution.isValid()) {
+                    scale = m_dynamicResolution.scale();
+                }
+            }
+
+            if (scale) {
+                // Apply the scale to the resolution we would recommend for the FOV of the layer, with distortion
+                // accounted for. This is the same computation as xrEnumerateViewConfigurationViews().
+                const XrFovf& viewFov = proj->views[0].fov;
+                pvrFovPort fov;
+                fov.UpTan = tan(viewFov.angleUp);
+                fov.DownTan = tan(-viewFov.angleDown);
+                fov.LeftTan = tan(-viewFov.angleLeft);
+                fov.RightTan = tan(viewFov.angleRight);
+
+                const float pixelDensity =
+                    m_primaryViewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO
+                        ? m_quadViewsPeripheralDensity
+                        : 1.f;
+                pvrSizei viewportSize;
+                CHECK_PVRCMD(pvr_getFovTextureSize(
+                    m_pvrSession, pvrEye_Left, fov, (float)(pixelDensity * scale.value()), &viewportSize));
+                resolution->recommendedImageDimensions = {viewportSize.w, viewportSize.h};
+                resolution->isValid = XR_TRUE;
+            }
+        }
+
+        TraceLoggingWrite(
+            g_traceProvider,
+            "xrGetRecommendedLayerResolutionMETA",
+            TLArg(resolution->recommendedImageDimensions.width, "RecommendedImageDimensionsWidth"),
+            TLArg(resolution->recommendedImageDimensions.height, "RecommendedImageDimensionsHeight"),
+            TLArg(!!resolution->isValid, "IsValid"));
+
+        return XR_SUCCESS;
+    }
+
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumerateSwapchainFormats
     XrResult OpenXrRuntime::xrEnumerateSwapchainFormats(XrSession session,
                                                         uint32_t formatCapacityInput,
@@ -319,6 +426,25 @@ namespace pimax_openxr {
             return XR_ERROR_FEATURE_UNSUPPORTED;
         }
 
+        // Reuse a recently destroyed swapchain with the same properties if possible, which avoids the cost of creating
+        // the PVR swapchains and importing them into the application's graphics API.
+        {
+            std::unique_lock lock(m_swapchainsMutex);
+
+            auto pooledSwapchain = takeSwapchainFromPool(*createInfo);
+            if (pooledSwapchain) {
+                *swapchain = m_swapchains.insert(std::move(pooledSwapchain));
+
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrCreateSwapchain",
+                                  TLXArg(*swapchain, "Swapchain"),
+                                  TLArg(true, "FromPool"),
+                                  TLArg(m_swapchainPoolSize, "PoolSize"));
+
+                return XR_SUCCESS;
+            }
+        }
+
         pvrTextureSwapChainDesc desc{};
 
         desc.Format = isVulkanSession()   ? vkToPvrTextureFormat((VkFormat)createInfo->format)
@@ -351,6 +477,10 @@ namespace pimax_openxr {
         if (createInfo->usageFlags & XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT) {
             desc.BindFlags |= pvrTextureBind_DX_UnorderedAccess;
         }
+        // We might use a compute shader to perform alpha correction and color conversion in-place.
+        if (isSRGBFormatWithPackedUAV(dxgiFormatForSubmission)) {
+            desc.BindFlags |= pvrTextureBind_DX_UnorderedAccess;
+        }
 
         // There are situations in PVR where we cannot use the PVR swapchain alone:
         // - PVR does not let you submit a slice of a texture array and always reads from the first slice.
@@ -361,13 +491,16 @@ namespace pimax_openxr {
         CHECK_PVRCMD(pvr_createTextureSwapChainDX(m_pvrSession, m_pvrSubmissionDevice.Get(), &desc, &pvrSwapchain));
 
         // Create the internal struct.
-        Swapchain& xrSwapchain = *new Swapchain;
+        auto newSwapchain = std::make_unique<Swapchain>();
+        Swapchain& xrSwapchain = *newSwapchain;
         xrSwapchain.pvrSwapchain.push_back(pvrSwapchain);
         CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, pvrSwapchain, &xrSwapchain.pvrSwapchainLength));
         xrSwapchain.slices.push_back({});
         xrSwapchain.lastProcessedIndex.push_back(-1);
         xrSwapchain.imagesResourceView.push_back({});
         xrSwapchain.renderTargetView.push_back({});
+        xrSwapchain.encodeAccessView.push_back({});
+        xrSwapchain.d3d12Slices.push_back({});
         xrSwapchain.pvrDesc = desc;
         xrSwapchain.xrDesc = *createInfo;
         xrSwapchain.dxgiFormatForSubmission = dxgiFormatForSubmission;
@@ -379,15 +512,15 @@ namespace pimax_openxr {
             xrSwapchain.lastProcessedIndex.push_back(-1);
             xrSwapchain.imagesResourceView.push_back({});
             xrSwapchain.renderTargetView.push_back({});
+            xrSwapchain.encodeAccessView.push_back({});
+            xrSwapchain.d3d12Slices.push_back({});
         }
 
-        *swapchain = (XrSwapchain)&xrSwapchain;
-
-        // Maintain a list of known swapchains for validation and cleanup.
+        // Maintain a table of known swapchains for validation and cleanup.
         {
             std::unique_lock lock(m_swapchainsMutex);
 
-            m_swapchains.insert(*swapchain);
+            *swapchain = m_swapchains.insert(std::move(newSwapchain));
         }
 
         TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain", TLXArg(*swapchain, "Swapchain"));
@@ -401,7 +534,7 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_swapchainsMutex);
 
-        if (!m_swapchains.count(swapchain)) {
+        if (!m_swapchains.contains(swapchain)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
@@ -420,45 +553,8 @@ namespace pimax_openxr {
         }
         flushSubmissionContext();
 
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
-
-        while (!xrSwapchain.pvrSwapchain.empty()) {
-            auto pvrSwapchain = xrSwapchain.pvrSwapchain.back();
-            if (pvrSwapchain) {
-                pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
-            }
-            xrSwapchain.pvrSwapchain.pop_back();
-        }
-
-        while (!xrSwapchain.vkImages.empty()) {
-            m_vkDispatch.vkDestroyImage(
-                m_vkDevice, xrSwapchain.vkImages.back(), m_vkAllocator ? &m_vkAllocator.value() : nullptr);
-            xrSwapchain.vkImages.pop_back();
-        }
-
-        while (!xrSwapchain.vkDeviceMemory.empty()) {
-            m_vkDispatch.vkFreeMemory(
-                m_vkDevice, xrSwapchain.vkDeviceMemory.back(), m_vkAllocator ? &m_vkAllocator.value() : nullptr);
-            xrSwapchain.vkDeviceMemory.pop_back();
-        }
-
-        // This will be a no-op if OpenGL is not used.
-        GlContextSwitch context(m_glContext);
-
-        while (!xrSwapchain.glImages.empty()) {
-            GLuint image = xrSwapchain.glImages.back();
-            glDeleteTextures(1, &image);
-            xrSwapchain.glImages.pop_back();
-        }
-
-        while (!xrSwapchain.glMemory.empty()) {
-            GLuint memory = xrSwapchain.glMemory.back();
-            m_glDispatch.glDeleteMemoryObjectsEXT(1, &memory);
-            xrSwapchain.glMemory.pop_back();
-        }
-
-        delete &xrSwapchain;
-        m_swapchains.erase(swapchain);
+        // Keep the swapchain around in case the application creates a similar one again.
+        returnSwapchainToPool(m_swapchains.extract(swapchain));
 
         return XR_SUCCESS;
     }
@@ -475,11 +571,11 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_swapchainsMutex);
 
-        if (!m_swapchains.count(swapchain)) {
+        if (!m_swapchains.contains(swapchain)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
+        Swapchain& xrSwapchain = *m_swapchains.get(swapchain);
 
         int count = !xrSwapchain.pvrDesc.StaticImage ? xrSwapchain.pvrSwapchainLength : 1;
 
@@ -521,11 +617,11 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_swapchainsMutex);
 
-        if (!m_swapchains.count(swapchain)) {
+        if (!m_swapchains.contains(swapchain)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
+        Swapchain& xrSwapchain = *m_swapchains.get(swapchain);
 
         // Check that we can acquire an image.
         if (xrSwapchain.frozen || xrSwapchain.acquiredIndices.size() == xrSwapchain.pvrSwapchainLength) {
@@ -534,7 +630,9 @@ namespace pimax_openxr {
 
         // Query the image index from PVR.
         int imageIndex = xrSwapchain.nextIndex;
-        if (xrSwapchain.acquiredIndices.empty()) {
+        // With asynchronous commit, the PVR swapchain only advances once the submission thread commits it.
+        if (xrSwapchain.acquiredIndices.empty() &&
+            !(m_useAsyncCommit && isAsyncCommitPending(xrSwapchain.inFlightFrameId))) {
             // "Re-synchronize" to the underlying swapchain. This should not be needed, but add robustness in case of a
             // bug.
             CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, xrSwapchain.pvrSwapchain[0], &imageIndex));
@@ -566,19 +664,24 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_swapchainsMutex);
 
-        if (!m_swapchains.count(swapchain)) {
+        if (!m_swapchains.contains(swapchain)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
+        Swapchain& xrSwapchain = *m_swapchains.get(swapchain);
 
         // Check an image is acquired but not waited.
         if (xrSwapchain.acquiredIndices.empty() || xrSwapchain.acquiredIndices.front() == xrSwapchain.lastWaitedIndex) {
             return XR_ERROR_CALL_ORDER_INVALID;
         }
 
-        // We assume that our frame timing in xrWaitFrame() guaranteed availability of the next image. No wait.
+        // We assume that our frame timing in xrWaitFrame() guaranteed availability of the next image. No wait, unless
+        // the submission thread is still processing the image with asynchronous commit.
         xrSwapchain.lastWaitedIndex = xrSwapchain.acquiredIndices.front();
+        if (m_useAsyncCommit && (xrSwapchain.inFlightImages & (1ull << xrSwapchain.lastWaitedIndex)) &&
+            isAsyncCommitPending(xrSwapchain.inFlightFrameId)) {
+            waitForAsyncCommit(xrSwapchain.inFlightFrameId);
+        }
 
         return XR_SUCCESS;
     }
@@ -594,11 +697,11 @@ namespace pimax_openxr {
 
         std::unique_lock lock(m_swapchainsMutex);
 
-        if (!m_swapchains.count(swapchain)) {
+        if (!m_swapchains.contains(swapchain)) {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
+        Swapchain& xrSwapchain = *m_swapchains.get(swapchain);
 
         // Check an image is acquired and waited.
         if (xrSwapchain.acquiredIndices.empty() || xrSwapchain.acquiredIndices.front() != xrSwapchain.lastWaitedIndex) {
@@ -610,7 +713,143 @@ namespace pimax_openxr {
         xrSwapchain.lastWaitedIndex = -1;
         xrSwapchain.acquiredIndices.pop_front();
 
+        if (isOpenGLSession()) {
+            releaseSwapchainImageOpenGL(xrSwapchain);
+        }
+
         return XR_SUCCESS;
     }
 
+    // Find a pooled swapchain compatible with the creation request. Must be called with m_swapchainsMutex held.
+    std::unique_ptr<OpenXrRuntime::Swapchain>
+    OpenXrRuntime::takeSwapchainFromPool(const XrSwapchainCreateInfo& createInfo) {
+        // Prefer the most recently destroyed swapchains, since they are the least likely to be evicted next.
+        for (auto it = m_swapchainPool.rbegin(); it != m_swapchainPool.rend(); it++) {
+            const XrSwapchainCreateInfo& desc = it->swapchain->xrDesc;
+            if (desc.createFlags != createInfo.createFlags || desc.usageFlags != createInfo.usageFlags ||
+                desc.format != createInfo.format || desc.sampleCount != createInfo.sampleCount ||
+                desc.width != createInfo.width || desc.height != createInfo.height ||
+                desc.faceCount != createInfo.faceCount || desc.arraySize != createInfo.arraySize ||
+                desc.mipCount != createInfo.mipCount) {
+                continue;
+            }
+
+            auto xrSwapchain = std::move(it->swapchain);
+            m_swapchainPoolSize -= it->sizeInBytes;
+            m_swapchainPool.erase(std::next(it).base());
+
+            // Reset the state from the previous use. The PVR swapchain index is resynchronized upon the first
+            // acquire.
+            xrSwapchain->acquiredIndices.clear();
+            xrSwapchain->lastWaitedIndex = -1;
+            xrSwapchain->lastReleasedIndex = -1;
+            xrSwapchain->nextIndex = 0;
+            xrSwapchain->frozen = false;
+            xrSwapchain->useConversion.reset();
+            std::fill(xrSwapchain->lastProcessedIndex.begin(), xrSwapchain->lastProcessedIndex.end(), -1);
+            xrSwapchain->xrDesc = createInfo;
+
+            return xrSwapchain;
+        }
+
+        return {};
+    }
+
+    // Must be called with m_swapchainsMutex held, and with no pending GPU work referencing the swapchain.
+    void OpenXrRuntime::returnSwapchainToPool(std::unique_ptr<Swapchain> xrSwapchain) {
+        const uint64_t sizeInBytes = getSwapchainMemorySize(*xrSwapchain);
+
+        // Static images can only be committed once with PVR, so they cannot be reused.
+        if (xrSwapchain->pvrDesc.StaticImage || sizeInBytes > m_swapchainPoolBudget) {
+            destroySwapchainResources(*xrSwapchain);
+            return;
+        }
+
+        m_swapchainPool.push_back({std::move(xrSwapchain), sizeInBytes});
+        m_swapchainPoolSize += sizeInBytes;
+        trimSwapchainPool(m_swapchainPoolBudget);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "SwapchainPool",
+                          TLArg(m_swapchainPool.size(), "Count"),
+                          TLArg(m_swapchainPoolSize, "Size"));
+    }
+
+    // Evict the least recently destroyed swapchains until the pool fits in the budget. Must be called with
+    // m_swapchainsMutex held.
+    void OpenXrRuntime::trimSwapchainPool(uint64_t budget) {
+        while (!m_swapchainPool.empty() && m_swapchainPoolSize > budget) {
+            PooledSwapchain& entry = m_swapchainPool.front();
+            destroySwapchainResources(*entry.swapchain);
+            m_swapchainPoolSize -= entry.sizeInBytes;
+            m_swapchainPool.pop_front();
+        }
+    }
+
+    void OpenXrRuntime::destroySwapchainResources(Swapchain& xrSwapchain) {
+        while (!xrSwapchain.pvrSwapchain.empty()) {
+            auto pvrSwapchain = xrSwapchain.pvrSwapchain.back();
+            if (pvrSwapchain) {
+                pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
+            }
+            xrSwapchain.pvrSwapchain.pop_back();
+        }
+        while (!xrSwapchain.convertedPvrSwapchain.empty()) {
+            auto pvrSwapchain = xrSwapchain.convertedPvrSwapchain.back();
+            if (pvrSwapchain) {
+                pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
+            }
+            xrSwapchain.convertedPvrSwapchain.pop_back();
+        }
+        xrSwapchain.convertedAccessView.clear();
+
+        while (!xrSwapchain.vkImages.empty()) {
+            m_vkDispatch.vkDestroyImage(
+                m_vkDevice, xrSwapchain.vkImages.back(), m_vkAllocator ? &m_vkAllocator.value() : nullptr);
+            xrSwapchain.vkImages.pop_back();
+        }
+
+        while (!xrSwapchain.vkDeviceMemory.empty()) {
+            m_vkDispatch.vkFreeMemory(
+                m_vkDevice, xrSwapchain.vkDeviceMemory.back(), m_vkAllocator ? &m_vkAllocator.value() : nullptr);
+            xrSwapchain.vkDeviceMemory.pop_back();
+        }
+
+        // This will be a no-op if OpenGL is not used.
+        GlContextSwitch context(m_glContext);
+
+        while (!xrSwapchain.glImages.empty()) {
+            GLuint image = xrSwapchain.glImages.back();
+            glDeleteTextures(1, &image);
+            xrSwapchain.glImages.pop_back();
+        }
+
+        while (!xrSwapchain.glMemory.empty()) {
+            GLuint memory = xrSwapchain.glMemory.back();
+            m_glDispatch.glDeleteMemoryObjectsEXT(1, &memory);
+            xrSwapchain.glMemory.pop_back();
+        }
+    }
+
+    // An estimate of the video memory held by the PVR swapchains.
+    uint64_t OpenXrRuntime::getSwapchainMemorySize(const Swapchain& xrSwapchain) {
+        const pvrTextureSwapChainDesc& desc = xrSwapchain.pvrDesc;
+        uint64_t sizeInBytes = (uint64_t)desc.Width * desc.Height *
+                               (DirectX::BitsPerPixel(xrSwapchain.dxgiFormatForSubmission) / 8) *
+                               desc.ArraySize * std::max(desc.SampleCount, 1) * xrSwapchain.pvrSwapchainLength;
+        if (desc.MipLevels > 1) {
+            sizeInBytes += sizeInBytes / 3;
+        }
+
+        // The converted PVR swapchains are created lazily, for the slices that need them, without mips or MSAA.
+        for (size_t slice = 0; slice < xrSwapchain.convertedPvrSwapchain.size(); slice++) {
+            if (xrSwapchain.convertedPvrSwapchain[slice]) {
+                sizeInBytes += (uint64_t)desc.Width * desc.Height *
+                               (DirectX::BitsPerPixel(DXGI_FORMAT_R11G11B10_FLOAT) / 8) *
+                               xrSwapchain.convertedAccessView[slice].size();
+            }
+        }
+        return sizeInBytes;
+    }
+
 } // namespace pimax_openxr
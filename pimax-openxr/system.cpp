@@ -26,6 +26,31 @@
 #include "runtime.h"
 #include "utils.h"
 
+namespace {
+
+    // The system properties persisted for fast startup. Any change to this structure must bump k_systemCacheVersion.
+    constexpr uint32_t k_systemCacheVersion = 1;
+
+    struct SystemCache {
+        uint32_t version;
+        uint32_t size;
+        pvrHmdInfo hmdInfo;
+        LUID adapterLuid;
+        float displayRefreshRate;
+        pvrEyeRenderInfo eyeInfo[xr::StereoView::Count];
+        pvrEyeRenderInfo cantedEyeInfo[xr::StereoView::Count];
+        int fovLevel;
+        float floorHeight;
+        uint32_t useParallelProjection;
+        uint32_t useParallelReprojection;
+
+        // The settings that the cached values depend on (-1 when not set).
+        int forceParallelProjectionState;
+        int parallelProjectionReprojection;
+    };
+
+} // namespace
+
 namespace pimax_openxr {
 
     using namespace pimax_openxr::log;
@@ -51,6 +76,25 @@ namespace pimax_openxr {
             return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
         }
 
+        // Fast startup: while PVR is still starting in the background, answer with the properties of the last headset
+        // seen. The live system takes over as soon as a call needs it (see ensureLiveSystem()).
+        if (m_useFastStartup && !m_isPvrStarted && (m_isUsingCachedSystem || loadSystemCache())) {
+            m_systemCreated = true;
+            *systemId = (XrSystemId)1;
+
+            TraceLoggingWrite(
+                g_traceProvider, "xrGetSystem", TLArg((int)*systemId, "SystemId"), TLArg(true, "IsCached"));
+
+            return XR_SUCCESS;
+        }
+
+        waitForPvrStartup();
+        if (m_isUsingCachedSystem) {
+            // Force the full query of the live system below.
+            m_isUsingCachedSystem = false;
+            m_cachedHmdInfo = {};
+        }
+
         pvrHmdStatus status{};
         bool isStatusValid = false;
 
@@ -108,7 +152,7 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_systemCreated || systemId != (XrSystemId)1) {
+        if (!m_systemCreated || systemId != (XrSystemId)1 || isCachedSystemLost()) {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
@@ -131,6 +175,16 @@ namespace pimax_openxr {
                 reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(eyeGazeInteractionProperties->next);
         }
 
+        XrSystemFoveatedRenderingPropertiesVARJO* foveatedRenderingProperties =
+            reinterpret_cast<XrSystemFoveatedRenderingPropertiesVARJO*>(properties->next);
+        while (foveatedRenderingProperties) {
+            if (foveatedRenderingProperties->type == XR_TYPE_SYSTEM_FOVEATED_RENDERING_PROPERTIES_VARJO) {
+                break;
+            }
+            foveatedRenderingProperties =
+                reinterpret_cast<XrSystemFoveatedRenderingPropertiesVARJO*>(foveatedRenderingProperties->next);
+        }
+
         properties->vendorId = m_cachedHmdInfo.VendorId;
 
         sprintf_s(properties->systemName, sizeof(properties->systemName), "%s", m_cachedHmdInfo.ProductName);
@@ -141,6 +195,11 @@ namespace pimax_openxr {
 
         static_assert(pvrMaxLayerCount >= XR_MIN_COMPOSITION_LAYERS_SUPPORTED);
         properties->graphicsProperties.maxLayerCount = pvrMaxLayerCount;
+        if (has_XR_VARJO_quad_views) {
+            // With quad views, the focus layer of the projection and the runtime layers must fit along with the
+            // application layers (see xrEndFrame()).
+            properties->graphicsProperties.maxLayerCount -= (uint32_t)k_runtimeLayerCount + 1;
+        }
         properties->graphicsProperties.maxSwapchainImageWidth = 16384;
         properties->graphicsProperties.maxSwapchainImageHeight = 16384;
 
@@ -174,6 +233,16 @@ namespace pimax_openxr {
                 TLArg(!!eyeGazeInteractionProperties->supportsEyeGazeInteraction, "SupportsEyeGazeInteraction"));
         }
 
+        if (has_XR_VARJO_foveated_rendering && foveatedRenderingProperties) {
+            foveatedRenderingProperties->supportsFoveatedRendering = m_isEyeTrackingAvailable ? XR_TRUE : XR_FALSE;
+
+            TraceLoggingWrite(
+                g_traceProvider,
+                "xrGetSystemProperties",
+                TLArg((int)properties->systemId, "SystemId"),
+                TLArg(!!foveatedRenderingProperties->supportsFoveatedRendering, "SupportsFoveatedRendering"));
+        }
+
         return XR_SUCCESS;
     }
 
@@ -198,11 +267,11 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_systemCreated || systemId != (XrSystemId)1) {
+        if (!m_systemCreated || systemId != (XrSystemId)1 || isCachedSystemLost()) {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
@@ -281,7 +350,7 @@ namespace pimax_openxr {
 
             // Detect eye tracker. This can take a while, so only do it when the app is requesting it.
             m_eyeTrackingType = EyeTracking::None;
-            if (has_XR_EXT_eye_gaze_interaction) {
+            if (has_XR_EXT_eye_gaze_interaction || has_XR_VARJO_foveated_rendering) {
                 if (getSetting("debug_eye_tracker").value_or(false)) {
                     m_eyeTrackingType = EyeTracking::Simulated;
                 } else if (m_cachedHmdInfo.VendorId == 0x34A4 && m_cachedHmdInfo.ProductId == 0x0012) {
@@ -329,7 +398,18 @@ namespace pimax_openxr {
             m_useParallelProjection =
                 cantingAngle > 0.0001f && getSetting("force_parallel_projection_state")
                                               .value_or(!pvr_getIntConfig(m_pvrSession, "steamvr_use_native_fov", 0));
-            if (m_useParallelProjection) {
+            m_useParallelReprojection =
+                m_useParallelProjection && getSetting("parallel_projection_reprojection").value_or(false);
+            if (m_useParallelReprojection) {
+                Log("Parallel projection is enabled (with reprojection)\n");
+
+                // Leave PVR with the canted views. The application renders parallel views that only cover the canted
+                // views, and we resample them into the canted views upon submission.
+                for (uint32_t i = 0; i < xr::StereoView::Count; i++) {
+                    m_cantedEyeInfo[i] = m_cachedEyeInfo[i];
+                    m_cachedEyeInfo[i] = getParallelEyeRenderInfo(m_cantedEyeInfo[i]);
+                }
+            } else if (m_useParallelProjection) {
                 Log("Parallel projection is enabled\n");
 
                 // Per Pimax, we must set this value for parallel projection to work properly.
@@ -362,9 +442,180 @@ namespace pimax_openxr {
                               TLArg(CONFIG_KEY_EYE_HEIGHT, "Config"),
                               TLArg(m_floorHeight, "EyeHeight"));
             CHECK_PVRCMD(pvr_setTrackingOriginType(m_pvrSession, pvrTrackingOrigin_EyeLevel));
+
+            if (m_useFastStartup) {
+                saveSystemCache();
+            }
         }
 
         return true;
     }
 
+    bool OpenXrRuntime::ensureLiveSystem() {
+        if (!m_isUsingCachedSystem) {
+            return true;
+        }
+
+        TraceLocalActivity(local);
+        TraceLoggingWriteStart(local, "EnsureLiveSystem");
+
+        // The cached system only stands in for the live system until a call needs it. Clearing the HMD info forces
+        // ensurePvrSession() to query all the properties again and to configure the PVR session.
+        waitForPvrStartup();
+        m_isUsingCachedSystem = false;
+        m_cachedHmdInfo = {};
+        const bool isAvailable = ensurePvrSession();
+
+        TraceLoggingWriteStop(local, "EnsureLiveSystem", TLArg(isAvailable, "IsAvailable"));
+
+        return isAvailable;
+    }
+
+    // The cached system was handed out before PVR was started. Once it is, the cached system must not be used anymore
+    // if the startup could not find the headset, or found a different headset than the one in the cache.
+    bool OpenXrRuntime::isCachedSystemLost() const {
+        return m_isUsingCachedSystem && m_isPvrStarted &&
+               (!m_isHmdPresentAfterStartup ||
+                std::string_view(m_hmdInfoAfterStartup.SerialNumber) != m_cachedHmdInfo.SerialNumber);
+    }
+
+    bool OpenXrRuntime::loadSystemCache() {
+        // The eye tracker must be detected with the live system.
+        if (has_XR_EXT_eye_gaze_interaction || has_XR_VARJO_foveated_rendering) {
+            return false;
+        }
+
+        SystemCache cache{};
+        {
+            std::ifstream file(localAppData / "system_cache.bin", std::ios::binary);
+            if (!file.read(reinterpret_cast<char*>(&cache), sizeof(cache))) {
+                return false;
+            }
+        }
+        if (cache.version != k_systemCacheVersion || cache.size != sizeof(cache) || !cache.hmdInfo.SerialNumber[0]) {
+            return false;
+        }
+
+        // Settings affecting the projection might have changed since the cache was written.
+        if (cache.forceParallelProjectionState != getSetting("force_parallel_projection_state").value_or(-1) ||
+            cache.parallelProjectionReprojection != getSetting("parallel_projection_reprojection").value_or(-1)) {
+            return false;
+        }
+
+        m_cachedHmdInfo = cache.hmdInfo;
+        m_adapterLuid = cache.adapterLuid;
+        m_displayRefreshRate = cache.displayRefreshRate;
+        m_idealFrameDuration = m_predictedFrameDuration = 1.0 / cache.displayRefreshRate;
+        m_fovLevel = cache.fovLevel;
+        m_floorHeight = cache.floorHeight;
+        m_useParallelProjection = cache.useParallelProjection;
+        m_useParallelReprojection = cache.useParallelReprojection;
+        for (uint32_t i = 0; i < xr::StereoView::Count; i++) {
+            m_cachedEyeInfo[i] = cache.eyeInfo[i];
+            m_cantedEyeInfo[i] = cache.cantedEyeInfo[i];
+
+            m_cachedEyeFov[i].angleDown = -atan(m_cachedEyeInfo[i].Fov.DownTan);
+            m_cachedEyeFov[i].angleUp = atan(m_cachedEyeInfo[i].Fov.UpTan);
+            m_cachedEyeFov[i].angleLeft = -atan(m_cachedEyeInfo[i].Fov.LeftTan);
+            m_cachedEyeFov[i].angleRight = atan(m_cachedEyeInfo[i].Fov.RightTan);
+        }
+        m_isEyeTrackingAvailable = false;
+        m_eyeTrackingType = EyeTracking::None;
+        m_isUsingCachedSystem = true;
+
+        TraceLoggingWrite(g_traceProvider,
+                          "PVR_SystemCache",
+                          TLArg("Load", "Action"),
+                          TLArg(m_cachedHmdInfo.ProductName, "ProductName"),
+                          TLArg(m_cachedHmdInfo.SerialNumber, "SerialNumber"),
+                          TLArg(m_displayRefreshRate, "RefreshRate"));
+
+        return true;
+    }
+
+    void OpenXrRuntime::saveSystemCache() {
+        SystemCache cache{};
+        cache.version = k_systemCacheVersion;
+        cache.size = sizeof(cache);
+        cache.hmdInfo = m_cachedHmdInfo;
+        cache.adapterLuid = m_adapterLuid;
+        cache.displayRefreshRate = m_displayRefreshRate;
+        for (uint32_t i = 0; i < xr::StereoView::Count; i++) {
+            cache.eyeInfo[i] = m_cachedEyeInfo[i];
+            cache.cantedEyeInfo[i] = m_cantedEyeInfo[i];
+        }
+        cache.fovLevel = m_fovLevel;
+        cache.floorHeight = m_floorHeight;
+        cache.useParallelProjection = m_useParallelProjection;
+        cache.useParallelReprojection = m_useParallelReprojection;
+        cache.forceParallelProjectionState = getSetting("force_parallel_projection_state").value_or(-1);
+        cache.parallelProjectionReprojection = getSetting("parallel_projection_reprojection").value_or(-1);
+
+        const auto path = localAppData / "system_cache.bin";
+
+        // Only rewrite the file when the headset or its properties changed.
+        SystemCache previousCache{};
+        {
+            std::ifstream file(path, std::ios::binary);
+            file.read(reinterpret_cast<char*>(&previousCache), sizeof(previousCache));
+        }
+        if (!memcmp(&cache, &previousCache, sizeof(cache))) {
+            return;
+        }
+        if (previousCache.hmdInfo.SerialNumber[0]) {
+            if (std::string_view(previousCache.hmdInfo.SerialNumber) != cache.hmdInfo.SerialNumber) {
+                Log("Headset changed since the system properties were cached\n");
+            } else {
+                Log("System properties changed since they were cached\n");
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&cache), sizeof(cache));
+
+        TraceLoggingWrite(g_traceProvider,
+                          "PVR_SystemCache",
+                          TLArg("Save", "Action"),
+                          TLArg(previousCache.hmdInfo.SerialNumber, "PreviousSerialNumber"),
+                          TLArg(cache.hmdInfo.SerialNumber, "SerialNumber"),
+                          TLArg(!!file, "Success"));
+    }
+
+    bool OpenXrRuntime::isViewConfigurationSupported(XrViewConfigurationType viewConfigurationType) const {
+        return viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO ||
+               (has_XR_VARJO_quad_views && viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+    }
+
+    uint32_t OpenXrRuntime::getViewCount(XrViewConfigurationType viewConfigurationType) {
+        return viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO ? k_quadViewCount
+                                                                                      : xr::StereoView::Count;
+    }
+
+    // Compute the parallel view that tightly encloses a canted view: the same eye position, no rotation relative to the
+    // head, and the smallest FOV containing the canted FOV. The edges of the canted FOV project onto lines in the
+    // image plane of the parallel view, so the corners are enough to bound it.
+    pvrEyeRenderInfo OpenXrRuntime::getParallelEyeRenderInfo(const pvrEyeRenderInfo& cantedEyeInfo) {
+        XrPosef cantedToHead = pvrPoseToXrPose(cantedEyeInfo.HmdToEyePose);
+        cantedToHead.position = {0, 0, 0};
+
+        pvrFovPort fov{};
+        for (const float x : {-cantedEyeInfo.Fov.LeftTan, cantedEyeInfo.Fov.RightTan}) {
+            for (const float y : {-cantedEyeInfo.Fov.DownTan, cantedEyeInfo.Fov.UpTan}) {
+                const XrVector3f corner = Pose::Multiply(Pose::Translation({x, y, -1.f}), cantedToHead).position;
+                fov.LeftTan = std::max(fov.LeftTan, corner.x / corner.z);
+                fov.RightTan = std::max(fov.RightTan, corner.x / -corner.z);
+                fov.DownTan = std::max(fov.DownTan, corner.y / corner.z);
+                fov.UpTan = std::max(fov.UpTan, corner.y / -corner.z);
+            }
+        }
+
+        XrPosef parallelToHead = pvrPoseToXrPose(cantedEyeInfo.HmdToEyePose);
+        parallelToHead.orientation = Quaternion::Identity();
+
+        pvrEyeRenderInfo parallelEyeInfo = cantedEyeInfo;
+        parallelEyeInfo.HmdToEyePose = xrPoseToPvrPose(parallelToHead);
+        parallelEyeInfo.Fov = fov;
+        return parallelEyeInfo;
+    }
+
 } // namespace pimax_openxr
@@ -0,0 +1,293 @@
+#pragma once
+
+// This header is also used by tools outside of the runtime, and therefore does not rely on the precompiled header.
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <windows.h>
+#include <wil/resource.h>
+
+namespace pimax_openxr::utils {
+
+    // Layout of the per-frame telemetry published in shared memory for the companion app and third-party tools. This
+    // is a contract with external readers: new fields may only be appended to the end of the structures, and
+    // k_version must be bumped for any other change.
+    //
+    // The shared memory begins with a Header, followed by k_recordsCount slots. Each slot is protected by a sequence
+    // counter that is odd while the record is being written. To read the newest record, a reader loads writeIndex,
+    // reads the slot at (writeIndex - 1) % recordsCount, and retries if the sequence counter was odd or changed while
+    // copying the record. The status of the session is published in the Header, with the same protocol.
+    //
+    // Builds with DISPATCH_STATS also publish the call statistics of the OpenXR entry points, as dispatchStatsCount
+    // records at dispatchStatsOffset from the beginning of the shared memory, protected by dispatchStatsSequence.
+    namespace telemetry {
+
+        constexpr wchar_t k_sharedMemoryName[] = L"Local\\PimaxXR_Telemetry";
+        // Held by every live runtime instance, regardless of telemetry, so that other processes know to stay off PVR.
+        constexpr wchar_t k_runtimeInstanceEventName[] = L"Local\\PimaxXR_RuntimeInstance";
+        constexpr uint32_t k_magic = 0x54525850; // 'PXRT'
+        constexpr uint32_t k_version = 1;
+        constexpr uint32_t k_recordsCount = 512;
+        constexpr uint32_t k_maxDispatchStats = 128;
+        constexpr uint32_t k_dispatchHistogramBuckets = 16;
+
+        enum class SmartSmoothingState : uint32_t {
+            Disabled = 0,
+            Enabled,
+            Active,
+        };
+
+        struct FrameRecord {
+            uint64_t frameId;
+            // Time of the submission, in the PVR timebase (pvr_getTimeSeconds()).
+            double submitTime;
+            uint32_t waitDurationUs;
+            uint32_t appCpuTimeUs;
+            // GPU durations are measured with a few frames of latency, and lag behind frameId.
+            uint32_t appGpuTimeUs;
+            uint32_t precompositionGpuTimeUs;
+            uint32_t endFrameDurationUs;
+            SmartSmoothingState smartSmoothingState;
+            uint32_t layerCount;
+            // Heap allocations made by the frame thread during the previous call to xrEndFrame() (debug builds only).
+            uint32_t endFrameAllocations;
+        };
+
+        struct RuntimeStatus {
+            float refreshRate;
+            uint32_t resolutionWidth;
+            uint32_t resolutionHeight;
+            uint32_t fovLevel;
+            // Horizontal field of view, in degrees.
+            float fov;
+            float floorHeight;
+            uint32_t useParallelProjection;
+            uint32_t useSmartSmoothing;
+            float fps;
+            uint32_t reserved;
+        };
+
+        struct DispatchStatsRecord {
+            char name[64];
+            uint64_t calls;
+            uint64_t totalNs;
+            uint64_t maxNs;
+            // Bucket 0 counts the calls under 1us, bucket i the calls within [2^(i-1), 2^i) us, and the last bucket
+            // all the longer calls.
+            uint64_t histogram[k_dispatchHistogramBuckets];
+        };
+
+        struct FrameSlot {
+            std::atomic<uint32_t> sequence;
+            uint32_t reserved;
+            FrameRecord record;
+        };
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t headerSize;
+            uint32_t slotSize;
+            uint32_t recordsCount;
+            // The process currently publishing, or 0 when none.
+            std::atomic<uint32_t> ownerProcessId;
+            // Total number of records published since the shared memory was claimed.
+            std::atomic<uint64_t> writeIndex;
+            char applicationName[128];
+            std::atomic<uint32_t> statusSequence;
+            uint32_t reserved;
+            RuntimeStatus status;
+            uint32_t dispatchStatsOffset;
+            std::atomic<uint32_t> dispatchStatsSequence;
+            uint32_t dispatchStatsCount;
+            // Non-zero when the frame records are published (the "telemetry" setting), otherwise only the status is.
+            uint32_t frameRecordsEnabled;
+        };
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free);
+        static_assert(std::is_standard_layout_v<Header> && std::is_standard_layout_v<FrameSlot>);
+
+    } // namespace telemetry
+
+    // The writer of the telemetry shared memory. Only one process publishes at a time (the first session to claim the
+    // shared memory), and publish() must only be called from one thread at a time.
+    class TelemetryPublisher {
+      public:
+        ~TelemetryPublisher() {
+            close();
+        }
+
+        // Returns false if the shared memory could not be created, or if it is already claimed by another process. The
+        // status is always published once opened, while the frame records are only published with publishFrames.
+        bool open(const std::string& applicationName, bool publishFrames) {
+            close();
+
+            constexpr DWORD slotsSize = telemetry::k_recordsCount * sizeof(telemetry::FrameSlot);
+            constexpr DWORD size = sizeof(telemetry::Header) + slotsSize +
+                                   telemetry::k_maxDispatchStats * sizeof(telemetry::DispatchStatsRecord);
+            m_mapping.reset(CreateFileMappingW(
+                INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, telemetry::k_sharedMemoryName));
+            if (!m_mapping) {
+                return false;
+            }
+            m_view.reset(MapViewOfFile(m_mapping.get(), FILE_MAP_ALL_ACCESS, 0, 0, size));
+            if (!m_view) {
+                m_mapping.reset();
+                return false;
+            }
+
+            // Claim the shared memory, unless another live process already publishes to it.
+            auto header = reinterpret_cast<telemetry::Header*>(m_view.get());
+            const DWORD processId = GetCurrentProcessId();
+            uint32_t owner = header->ownerProcessId.load();
+            while (owner != processId) {
+                if (owner && isProcessAlive(owner)) {
+                    m_view.reset();
+                    m_mapping.reset();
+                    return false;
+                }
+                if (header->ownerProcessId.compare_exchange_weak(owner, processId)) {
+                    break;
+                }
+            }
+
+            // Fresh memory is zero-filled, so the sequence counters start even.
+            header->magic = telemetry::k_magic;
+            header->version = telemetry::k_version;
+            header->headerSize = sizeof(telemetry::Header);
+            header->slotSize = sizeof(telemetry::FrameSlot);
+            header->recordsCount = telemetry::k_recordsCount;
+            header->dispatchStatsOffset = sizeof(telemetry::Header) + slotsSize;
+            header->dispatchStatsCount = 0;
+            header->frameRecordsEnabled = publishFrames;
+            strncpy_s(header->applicationName, applicationName.c_str(), _TRUNCATE);
+            header->writeIndex.store(0, std::memory_order_release);
+
+            m_header = header;
+            m_publishFrames = publishFrames;
+            m_slots = reinterpret_cast<telemetry::FrameSlot*>(header + 1);
+            m_dispatchStats = reinterpret_cast<telemetry::DispatchStatsRecord*>(
+                reinterpret_cast<uint8_t*>(m_view.get()) + header->dispatchStatsOffset);
+
+            return true;
+        }
+
+        void close() {
+            if (m_header) {
+                m_header->ownerProcessId.store(0);
+            }
+            m_header = nullptr;
+            m_publishFrames = false;
+            m_slots = nullptr;
+            m_dispatchStats = nullptr;
+            m_view.reset();
+            m_mapping.reset();
+        }
+
+        bool isOpen() const {
+            return m_header;
+        }
+
+        // Whether the frame records (and the statistics they need) are published.
+        bool isActive() const {
+            return m_header && m_publishFrames;
+        }
+
+        void publish(const telemetry::FrameRecord& record) {
+            if (!isActive()) {
+                return;
+            }
+
+            const uint64_t index = m_header->writeIndex.load(std::memory_order_relaxed);
+            telemetry::FrameSlot& slot = m_slots[index % telemetry::k_recordsCount];
+            const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.record = record;
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+            m_header->writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+        void publishStatus(const telemetry::RuntimeStatus& status) {
+            if (!m_header) {
+                return;
+            }
+
+            const uint32_t sequence = m_header->statusSequence.load(std::memory_order_relaxed);
+            m_header->statusSequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_header->status = status;
+            m_header->statusSequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Publish the records of the entry points, replacing the previous ones.
+        void publishDispatchStats(const telemetry::DispatchStatsRecord* records, uint32_t count) {
+            if (!m_header) {
+                return;
+            }
+
+            count = std::min(count, telemetry::k_maxDispatchStats);
+            const uint32_t sequence = m_header->dispatchStatsSequence.load(std::memory_order_relaxed);
+            m_header->dispatchStatsSequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::copy_n(records, count, m_dispatchStats);
+            m_header->dispatchStatsCount = count;
+            m_header->dispatchStatsSequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Read the status published by a running session, from any process. Returns false if no session is running.
+        static bool readStatus(telemetry::RuntimeStatus& status) {
+            wil::unique_handle mapping(OpenFileMappingW(FILE_MAP_READ, FALSE, telemetry::k_sharedMemoryName));
+            if (!mapping) {
+                return false;
+            }
+            wil::unique_mapview_ptr<void> view(
+                MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, sizeof(telemetry::Header)));
+            if (!view) {
+                return false;
+            }
+
+            const auto header = reinterpret_cast<const telemetry::Header*>(view.get());
+            if (header->magic != telemetry::k_magic || header->version != telemetry::k_version) {
+                return false;
+            }
+            const uint32_t owner = header->ownerProcessId.load();
+            if (!owner || !isProcessAlive(owner)) {
+                return false;
+            }
+
+            for (int retries = 0; retries < 100; retries++) {
+                const uint32_t sequence = header->statusSequence.load(std::memory_order_acquire);
+                if (!sequence || sequence & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                status = header->status;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header->statusSequence.load(std::memory_order_relaxed) == sequence) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+      private:
+        static bool isProcessAlive(DWORD processId) {
+            wil::unique_handle process(OpenProcess(SYNCHRONIZE, FALSE, processId));
+            return process && WaitForSingleObject(process.get(), 0) == WAIT_TIMEOUT;
+        }
+
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<void> m_view;
+        telemetry::Header* m_header{nullptr};
+        bool m_publishFrames{false};
+        telemetry::FrameSlot* m_slots{nullptr};
+        telemetry::DispatchStatsRecord* m_dispatchStats{nullptr};
+    };
+
+} // namespace pimax_openxr::utils
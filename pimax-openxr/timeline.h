@@ -0,0 +1,150 @@
+#pragma once
+
+#include "pch.h"
+
+namespace pimax_openxr::utils {
+
+    // Layout of the frame timeline files. A file begins with a FileHeader, followed by one FrameRecord per frame, in
+    // submission order. scripts/Analyze-Timeline.ps1 must be updated with any change to these structures.
+    namespace timeline {
+
+        constexpr uint32_t k_magic = 0x4C545850; // 'PXTL'
+        constexpr uint32_t k_version = 1;
+
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t recordSize;
+            uint32_t reserved;
+            double refreshRate;
+            char applicationName[128];
+        };
+
+        enum FrameFlags : uint32_t {
+            FrameDiscarded = 1 << 0,
+            AsyncSubmission = 1 << 1,
+            SmartSmoothingActive = 1 << 2,
+        };
+
+        // All times are in the PVR timebase (pvr_getTimeSeconds()), or 0 when the phase did not happen.
+        struct FrameRecord {
+            uint64_t frameId;
+            double waitFrameStart;
+            double waitFrameEnd;
+            // The display time predicted by PVR upon xrWaitFrame().
+            double predictedDisplayTime;
+            double beginFrame;
+            double endFrameStart;
+            // The display time passed by the application to xrEndFrame().
+            double displayTime;
+            double precompositionEnd;
+            double pvrEndFrameStart;
+            double pvrEndFrameEnd;
+            uint32_t layerCount;
+            uint32_t flags;
+        };
+
+    } // namespace timeline
+
+    // An in-process recorder for the frame timeline, for soak tests where ETW captures would be too heavy. Records are
+    // queued without locking by the frame loop (one thread at a time), and written to the file by a background thread.
+    class TimelineRecorder {
+      public:
+        ~TimelineRecorder() {
+            stop();
+        }
+
+        bool start(const std::filesystem::path& path, const std::string& applicationName, double refreshRate) {
+            stop();
+
+            m_file.open(path, std::ios_base::binary | std::ios_base::trunc);
+            if (!m_file.is_open()) {
+                return false;
+            }
+
+            timeline::FileHeader header{};
+            header.magic = timeline::k_magic;
+            header.version = timeline::k_version;
+            header.recordSize = sizeof(timeline::FrameRecord);
+            header.refreshRate = refreshRate;
+            strncpy_s(header.applicationName, applicationName.c_str(), _TRUNCATE);
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            m_droppedRecords = 0;
+            m_terminate = false;
+            m_thread = std::thread([&]() {
+                std::unique_lock lock(m_mutex);
+                while (!m_terminate) {
+                    m_cv.wait_for(lock, k_writePeriod);
+                    drain();
+                }
+                drain();
+            });
+            m_isRecording = true;
+
+            return true;
+        }
+
+        void stop() {
+            if (!m_thread.joinable()) {
+                return;
+            }
+
+            m_isRecording = false;
+            {
+                std::unique_lock lock(m_mutex);
+                m_terminate = true;
+                m_cv.notify_all();
+            }
+            m_thread.join();
+            m_thread = {};
+            m_file.close();
+        }
+
+        bool isRecording() const {
+            return m_isRecording;
+        }
+
+        // Records that could not be queued because the writer thread fell behind.
+        uint64_t droppedRecords() const {
+            return m_droppedRecords;
+        }
+
+        void record(const timeline::FrameRecord& record) {
+            if (!m_isRecording) {
+                return;
+            }
+
+            timeline::FrameRecord* const slot = m_queue.beginPush();
+            if (!slot) {
+                m_droppedRecords++;
+                return;
+            }
+            *slot = record;
+            m_queue.endPush();
+        }
+
+      private:
+        void drain() {
+            const timeline::FrameRecord* record;
+            while ((record = m_queue.peek())) {
+                m_file.write(reinterpret_cast<const char*>(record), sizeof(*record));
+                m_queue.pop();
+            }
+            m_file.flush();
+        }
+
+        static constexpr auto k_writePeriod = std::chrono::milliseconds(500);
+
+        SpscRing<timeline::FrameRecord, 1024> m_queue;
+        std::ofstream m_file;
+        std::atomic<bool> m_isRecording{false};
+        std::atomic<uint64_t> m_droppedRecords{0};
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_terminate{false};
+    };
+
+} // namespace pimax_openxr::utils
@@ -247,6 +247,24 @@ namespace pimax_openxr::utils {
         }
     }
 
+    // Enable the counting of heap allocations (see allocations.cpp). Counting hooks the process heap for the rest of
+    // the life of the process, and is only available in debug builds.
+    void StartAllocationCounting();
+    bool IsAllocationCountingEnabled();
+
+    // Counts the heap allocations made by the calling thread during the lifetime of the object, while allocation
+    // counting is enabled. Only one thread may count at a time.
+    class ScopedAllocationCounter {
+      public:
+        ScopedAllocationCounter();
+        ~ScopedAllocationCounter();
+
+        uint64_t count() const;
+
+      private:
+        uint64_t m_start{0};
+    };
+
     // A generic timer.
     struct ITimer {
         virtual ~ITimer() = default;
@@ -282,6 +300,669 @@ namespace pimax_openxr::utils {
         mutable clock::duration m_duration{0};
     };
 
+    // A vector with fixed-capacity inline storage, which never allocates.
+    template <typename T, size_t Capacity>
+    class FixedVector {
+      public:
+        T& emplace_back() {
+            CHECK_MSG(m_size < Capacity, "FixedVector capacity exceeded");
+            m_data[m_size] = {};
+            return m_data[m_size++];
+        }
+
+        void push_back(const T& value) {
+            emplace_back() = value;
+        }
+
+        bool contains(const T& value) const {
+            return std::find(begin(), end(), value) != end();
+        }
+
+        void clear() {
+            m_size = 0;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        bool full() const {
+            return m_size == Capacity;
+        }
+
+        T& back() {
+            return m_data[m_size - 1];
+        }
+
+        T& operator[](size_t index) {
+            return m_data[index];
+        }
+
+        const T& operator[](size_t index) const {
+            return m_data[index];
+        }
+
+        T* begin() {
+            return m_data.data();
+        }
+
+        T* end() {
+            return m_data.data() + m_size;
+        }
+
+        const T* begin() const {
+            return m_data.data();
+        }
+
+        const T* end() const {
+            return m_data.data() + m_size;
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+      private:
+        std::array<T, Capacity> m_data{};
+        size_t m_size{0};
+    };
+
+    // A fixed-capacity FIFO, which never allocates. Pushing into a full buffer drops the oldest value.
+    template <typename T, size_t Capacity>
+    class RingBuffer {
+      public:
+        void push_back(const T& value) {
+            if (m_size == Capacity) {
+                pop_front();
+            }
+            m_data[(m_start + m_size) % Capacity] = value;
+            m_size++;
+        }
+
+        void pop_front() {
+            m_start = (m_start + 1) % Capacity;
+            m_size--;
+        }
+
+        const T& front() const {
+            return m_data[m_start];
+        }
+
+        const T& back() const {
+            return m_data[(m_start + m_size - 1) % Capacity];
+        }
+
+        // Index 0 is the oldest value.
+        const T& operator[](size_t index) const {
+            return m_data[(m_start + index) % Capacity];
+        }
+
+        void clear() {
+            m_start = m_size = 0;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+      private:
+        std::array<T, Capacity> m_data{};
+        size_t m_start{0};
+        size_t m_size{0};
+    };
+
+    // A bounded single-producer/single-consumer ring. Each index is only written by its owning thread, therefore
+    // pushing and popping never require a lock. The slots are storage that is reused in-place without allocations.
+    template <typename T, size_t Capacity>
+    class SpscRing {
+      public:
+        // Producer: get the slot to fill, or nullptr if the ring is full.
+        T* beginPush() {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) >= Capacity) {
+                return nullptr;
+            }
+            return &m_slots[head % Capacity];
+        }
+
+        // Producer: make the slot returned by beginPush() visible to the consumer.
+        void endPush() {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer: get the oldest slot, or nullptr if the ring is empty.
+        T* peek() {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (m_head.load(std::memory_order_acquire) == tail) {
+                return nullptr;
+            }
+            return &m_slots[tail % Capacity];
+        }
+
+        // Consumer: release the slot returned by peek() back to the producer.
+        void pop() {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        size_t size() const {
+            return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+      private:
+        std::array<T, Capacity> m_slots{};
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+    };
+
+    // A wake-up signal for state shared without locks, built on WaitOnAddress(). The threads changing the state call
+    // notify() afterwards, and the waiters re-evaluate their condition each time, so no wake-up can be lost.
+    class EpochSignal {
+      public:
+        void notify() {
+            m_epoch.fetch_add(1);
+            WakeByAddressAll(&m_epoch);
+        }
+
+        template <typename Condition>
+        void wait(Condition condition) {
+            while (true) {
+                uint32_t epoch = m_epoch.load();
+                if (condition()) {
+                    return;
+                }
+                WaitOnAddress(&m_epoch, &epoch, sizeof(epoch), INFINITE);
+            }
+        }
+
+        // Returns false if the deadline passed before the condition became true.
+        template <typename Condition>
+        bool waitUntil(Condition condition, std::chrono::high_resolution_clock::time_point deadline) {
+            while (true) {
+                uint32_t epoch = m_epoch.load();
+                if (condition()) {
+                    return true;
+                }
+                const auto now = std::chrono::high_resolution_clock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+                const auto timeoutMs = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+                WaitOnAddress(&m_epoch, &epoch, sizeof(epoch), static_cast<DWORD>(timeoutMs));
+            }
+        }
+
+      private:
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+        std::atomic<uint32_t> m_epoch{0};
+    };
+
+    // A bounded multiple-producer/single-consumer ring. Producers claim a slot with a compare-and-swap and publish it
+    // through the per-slot sequence counter, therefore pushing never waits on the other producers or on the consumer.
+    template <typename T, size_t Capacity>
+    class MpscRing {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+      public:
+        MpscRing() {
+            for (size_t i = 0; i < Capacity; i++) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Producer: fill a slot in-place with the callback. Returns false without invoking it if the ring is full.
+        template <typename Fill>
+        bool push(Fill fill) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_slots[head % Capacity];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence == head) {
+                    if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                        fill(slot.value);
+                        slot.sequence.store(head + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (sequence < head) {
+                    // The slot was not released by the consumer yet.
+                    return false;
+                } else {
+                    head = m_head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Consumer: get the oldest slot, or nullptr if the ring is empty or the oldest slot is still being filled.
+        T* peek() {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[tail % Capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                return nullptr;
+            }
+            return &slot.value;
+        }
+
+        // Consumer: release the slot returned by peek() back to the producers.
+        void pop() {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            m_slots[tail % Capacity].sequence.store(tail + Capacity, std::memory_order_release);
+            m_tail.store(tail + 1, std::memory_order_relaxed);
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+      private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::array<Slot, Capacity> m_slots;
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+    };
+
+    // A bounded ring of the most recent values, written by one thread at a time and read concurrently by any number of
+    // threads without locking. Each slot is protected by a sequence counter: readers retry if the slot was rewritten
+    // while they were copying it. The writer never waits on the readers, and the oldest values are overwritten.
+    template <typename T, size_t Capacity>
+    class SeqlockRing {
+        static_assert(std::is_trivially_copyable_v<T>, "Values are copied while they may be concurrently written");
+
+      public:
+        // Writer: append a value, overwriting the oldest one if the ring is full.
+        void push(const T& value) {
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[head % Capacity];
+
+            const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.value = value;
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        // Reader: copy the values, from the newest to the oldest, until the callback returns false. Returns the number
+        // of values that were visited. Once the ring is full, the oldest slot is the next one to be overwritten, and it
+        // is never visited.
+        template <typename Callback>
+        size_t forEachNewest(Callback callback) const {
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            const uint64_t count = std::min<uint64_t>(head, Capacity - 1);
+
+            size_t visited = 0;
+            for (uint64_t age = 0; age < count; age++) {
+                T value;
+                if (!read(head - 1 - age, value)) {
+                    // The writer has lapped us.
+                    break;
+                }
+                visited++;
+                if (!callback(value)) {
+                    break;
+                }
+            }
+            return visited;
+        }
+
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) == 0;
+        }
+
+        void clear() {
+            m_head.store(0, std::memory_order_release);
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+      private:
+        struct Slot {
+            std::atomic<uint32_t> sequence{0};
+            T value{};
+        };
+
+        bool read(uint64_t index, T& value) const {
+            const Slot& slot = m_slots[index % Capacity];
+            while (true) {
+                const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    _mm_pause();
+                    continue;
+                }
+                value = slot.value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != before) {
+                    continue;
+                }
+
+                // Only now that we hold a consistent copy, make sure it is not a newer value written to the same slot.
+                // The writer reuses the slot once the head reaches index + Capacity, and only advances the head after
+                // writing, so a copy of the newer value is always followed by a head at least that far.
+                return m_head.load(std::memory_order_acquire) - index < Capacity;
+            }
+        }
+
+        std::array<Slot, Capacity> m_slots{};
+        alignas(64) std::atomic<uint64_t> m_head{0};
+    };
+
+    // A small pool of persistent threads to run the iterations of a loop in parallel. The calling thread takes part in
+    // the work, and run() returns once all the iterations have completed. Only one thread may call run() at a time.
+    class WorkerPool {
+      public:
+        ~WorkerPool() {
+            stop();
+        }
+
+        void start(size_t workerCount) {
+            stop();
+            m_terminate = false;
+            for (size_t i = 0; i < workerCount; i++) {
+                m_workers.emplace_back([this]() { workerThread(); });
+            }
+        }
+
+        void stop() {
+            {
+                std::unique_lock lock(m_mutex);
+                m_terminate = true;
+            }
+            m_wakeUp.notify_all();
+            for (std::thread& worker : m_workers) {
+                worker.join();
+            }
+            m_workers.clear();
+        }
+
+        size_t workerCount() const {
+            return m_workers.size();
+        }
+
+        // Invoke function(i) for each i in [0, count). The first exception thrown by the function is rethrown once all
+        // the iterations have completed.
+        void run(size_t count, const std::function<void(size_t)>& function) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_function = &function;
+                m_count = count;
+                m_next = 0;
+                m_pending = count;
+                m_exception = nullptr;
+                m_generation++;
+            }
+            m_wakeUp.notify_all();
+
+            work();
+
+            std::unique_lock lock(m_mutex);
+            m_done.wait(lock, [&] { return m_pending == 0; });
+            m_function = nullptr;
+            if (m_exception) {
+                std::rethrow_exception(m_exception);
+            }
+        }
+
+      private:
+        void workerThread() {
+            uint64_t generation = 0;
+            while (true) {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_wakeUp.wait(lock, [&] { return m_terminate || m_generation != generation; });
+                    if (m_terminate) {
+                        break;
+                    }
+                    generation = m_generation;
+                }
+                work();
+            }
+        }
+
+        // Claim and run iterations until there are none left. A worker that wakes up late finds nothing to claim.
+        void work() {
+            while (true) {
+                size_t index;
+                const std::function<void(size_t)>* function;
+                {
+                    std::unique_lock lock(m_mutex);
+                    if (m_next >= m_count) {
+                        break;
+                    }
+                    index = m_next++;
+                    function = m_function;
+                }
+
+                std::exception_ptr exception;
+                try {
+                    (*function)(index);
+                } catch (...) {
+                    exception = std::current_exception();
+                }
+
+                std::unique_lock lock(m_mutex);
+                if (exception && !m_exception) {
+                    m_exception = exception;
+                }
+                if (--m_pending == 0) {
+                    m_done.notify_all();
+                }
+            }
+        }
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::condition_variable m_done;
+        bool m_terminate{false};
+        uint64_t m_generation{0};
+        const std::function<void(size_t)>* m_function{nullptr};
+        size_t m_count{0};
+        size_t m_next{0};
+        size_t m_pending{0};
+        std::exception_ptr m_exception;
+    };
+
+    // An append-only table interning strings into dense identifiers starting at 1. Entries are never moved or modified
+    // once published, therefore looking up a string from its identifier never requires a lock.
+    class StringInternTable {
+      public:
+        StringInternTable() = default;
+        StringInternTable(const StringInternTable&) = delete;
+        StringInternTable& operator=(const StringInternTable&) = delete;
+
+        // Returns nullptr for an unknown identifier.
+        const std::string* getString(uint64_t id) const {
+            if (id == 0 || id > m_count.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            const uint64_t index = id - 1;
+            return &m_chunks[index / k_chunkSize][index % k_chunkSize];
+        }
+
+        // Returns 0 for a string that was never interned.
+        uint64_t getId(const std::string& str) const {
+            std::unique_lock lock(m_mutex);
+
+            const auto it = m_ids.find(str);
+            return it != m_ids.cend() ? it->second : 0;
+        }
+
+        uint64_t intern(const std::string& str) {
+            std::unique_lock lock(m_mutex);
+
+            const auto it = m_ids.find(str);
+            if (it != m_ids.cend()) {
+                return it->second;
+            }
+
+            const uint64_t index = m_count.load(std::memory_order_relaxed);
+            CHECK_MSG(index < k_chunkSize * k_maxChunks, "StringInternTable capacity exceeded");
+
+            auto& chunk = m_chunks[index / k_chunkSize];
+            if (!chunk) {
+                chunk = std::make_unique<std::string[]>(k_chunkSize);
+            }
+            chunk[index % k_chunkSize] = str;
+            m_ids.emplace(str, index + 1);
+
+            // Publish the entry to the readers.
+            m_count.store(index + 1, std::memory_order_release);
+
+            return index + 1;
+        }
+
+        size_t size() const {
+            return m_count.load(std::memory_order_acquire);
+        }
+
+      private:
+        static constexpr size_t k_chunkSize = 256;
+        static constexpr size_t k_maxChunks = 1024;
+
+        std::array<std::unique_ptr<std::string[]>, k_maxChunks> m_chunks;
+        std::atomic<uint64_t> m_count{0};
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, uint64_t> m_ids;
+    };
+
+    // A table of objects referenced through opaque handles. A handle encodes the index of its slot in the low 32 bits
+    // and the generation of the slot in the high 32 bits: validating a handle is a constant-time lookup, and a handle
+    // that outlived its object is rejected. Objects are allocated individually so that references to them remain valid
+    // while the table grows.
+    template <typename Handle, typename T>
+    class HandleTable {
+      public:
+        Handle insert(std::unique_ptr<T> object) {
+            uint32_t index;
+            if (!m_freeSlots.empty()) {
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            } else {
+                index = (uint32_t)m_slots.size();
+                m_slots.emplace_back();
+            }
+
+            Slot& slot = m_slots[index];
+            slot.object = std::move(object);
+            m_size++;
+
+            return (Handle)(((uint64_t)slot.generation << 32) | index);
+        }
+
+        // Returns nullptr for an invalid or destroyed handle.
+        T* get(Handle handle) const {
+            const uint64_t value = (uint64_t)handle;
+            const uint32_t index = (uint32_t)value;
+            if (index >= m_slots.size() || m_slots[index].generation != (uint32_t)(value >> 32)) {
+                return nullptr;
+            }
+            return m_slots[index].object.get();
+        }
+
+        bool contains(Handle handle) const {
+            return get(handle) != nullptr;
+        }
+
+        void erase(Handle handle) {
+            if (!contains(handle)) {
+                return;
+            }
+            release((uint32_t)(uint64_t)handle);
+        }
+
+        // Invalidates the handle like erase(), but hands the object over to the caller instead of destroying it.
+        std::unique_ptr<T> extract(Handle handle) {
+            if (!contains(handle)) {
+                return {};
+            }
+            const uint32_t index = (uint32_t)(uint64_t)handle;
+            std::unique_ptr<T> object = std::move(m_slots[index].object);
+            release(index);
+            return object;
+        }
+
+        void clear() {
+            for (uint32_t i = 0; i < m_slots.size(); i++) {
+                if (m_slots[i].object) {
+                    release(i);
+                }
+            }
+        }
+
+        template <typename Function>
+        void forEach(Function function) const {
+            for (const auto& slot : m_slots) {
+                if (slot.object) {
+                    function(*slot.object);
+                }
+            }
+        }
+
+        std::vector<Handle> handles() const {
+            std::vector<Handle> handles;
+            for (uint32_t i = 0; i < m_slots.size(); i++) {
+                if (m_slots[i].object) {
+                    handles.push_back((Handle)(((uint64_t)m_slots[i].generation << 32) | i));
+                }
+            }
+            return handles;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+      private:
+        struct Slot {
+            std::unique_ptr<T> object;
+
+            // Never 0, so that no handle is ever XR_NULL_HANDLE.
+            uint32_t generation{1};
+        };
+
+        void release(uint32_t index) {
+            Slot& slot = m_slots[index];
+            slot.object.reset();
+            slot.generation = slot.generation == UINT32_MAX ? 1 : slot.generation + 1;
+            m_freeSlots.push_back(index);
+            m_size--;
+        }
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_freeSlots;
+        size_t m_size{0};
+    };
+
     // API dispatch table for Vulkan.
     struct VulkanDispatch {
         PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr{nullptr};
@@ -310,10 +991,6 @@ namespace pimax_openxr::utils {
         PFN_vkCreateSemaphore vkCreateSemaphore{nullptr};
         PFN_vkDestroySemaphore vkDestroySemaphore{nullptr};
         PFN_vkImportSemaphoreWin32HandleKHR vkImportSemaphoreWin32HandleKHR{nullptr};
-        PFN_vkCreateFence vkCreateFence{nullptr};
-        PFN_vkDestroyFence vkDestroyFence{nullptr};
-        PFN_vkResetFences vkResetFences{nullptr};
-        PFN_vkWaitForFences vkWaitForFences{nullptr};
         PFN_vkDeviceWaitIdle vkDeviceWaitIdle{nullptr};
         PFN_vkCreateQueryPool vkCreateQueryPool{nullptr};
         PFN_vkDestroyQueryPool vkDestroyQueryPool{nullptr};
@@ -520,6 +1197,12 @@ namespace pimax_openxr::utils {
         return false;
     }
 
+    // Whether alpha correction and SRGB encoding may be done in a single compute pass, writing to the swapchain image
+    // through a R32_UINT view of its typeless format.
+    static bool isSRGBFormatWithPackedUAV(DXGI_FORMAT format) {
+        return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    }
+
     static pvrTextureFormat dxgiToPvrTextureFormat(DXGI_FORMAT format) {
         switch (format) {
         case DXGI_FORMAT_R8G8B8A8_UNORM:
@@ -716,3 +1399,7 @@ namespace pimax_openxr::utils {
 } // namespace pimax_openxr::utils
 
 #include "gpu_timers.h"
+#include "frame_timing.h"
+#include "settings.h"
+#include "telemetry.h"
+#include "timeline.h"
@@ -62,57 +62,191 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewIndex >= xr::StereoView::Count) {
+        if (viewIndex >= getViewCount(viewConfigurationType)) {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
-        // We only support the hidden area mesh and we don't return a mask with parallel projection.
-        if (visibilityMaskType != XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR || m_useParallelProjection) {
+        // We don't return a mask with parallel projection. The focus views of quad views are always fully visible.
+        if ((visibilityMaskType != XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR &&
+             visibilityMaskType != XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR) ||
+            m_useParallelProjection || viewIndex >= xr::StereoView::Count) {
             visibilityMask->vertexCountOutput = 0;
             visibilityMask->indexCountOutput = 0;
             return XR_SUCCESS;
         }
 
+        std::unique_lock lock(m_visibilityMaskMutex);
+
+        const CachedVisibilityMask& mask = getVisibilityMask(viewIndex);
+        const auto& vertices =
+            visibilityMaskType == XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR ? mask.lineLoopVertices : mask.hiddenVertices;
+        const auto& indices =
+            visibilityMaskType == XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR ? mask.lineLoopIndices : mask.hiddenIndices;
+
+        if (visibilityMask->vertexCapacityInput == 0) {
+            visibilityMask->vertexCountOutput = (uint32_t)vertices.size();
+            visibilityMask->indexCountOutput = (uint32_t)indices.size();
+        } else if (visibilityMask->vertices && visibilityMask->indices) {
+            if (visibilityMask->vertexCapacityInput < vertices.size() ||
+                visibilityMask->indexCapacityInput < indices.size()) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            std::copy(vertices.cbegin(), vertices.cend(), visibilityMask->vertices);
+            std::copy(indices.cbegin(), indices.cend(), visibilityMask->indices);
+            visibilityMask->vertexCountOutput = (uint32_t)vertices.size();
+            visibilityMask->indexCountOutput = (uint32_t)indices.size();
+        }
+
+        return XR_SUCCESS;
+    }
+
+    // Retrieve the masks for a view, only reading them from PVR and converting them when the FOV configuration has
+    // changed. Must be invoked with the visibility mask mutex held.
+    const OpenXrRuntime::CachedVisibilityMask& OpenXrRuntime::getVisibilityMask(uint32_t viewIndex) {
+        CachedVisibilityMask& mask = m_cachedVisibilityMask[viewIndex];
+        const pvrFovPort& fov = m_cachedEyeInfo[viewIndex].Fov;
+        if (mask.isValid && mask.fovLevel == m_fovLevel && mask.fov.UpTan == fov.UpTan &&
+            mask.fov.DownTan == fov.DownTan && mask.fov.LeftTan == fov.LeftTan && mask.fov.RightTan == fov.RightTan) {
+            return mask;
+        }
+
+        mask = {};
+        mask.isValid = true;
+        mask.fovLevel = m_fovLevel;
+        mask.fov = fov;
+
         const auto verticesCount =
             pvr_getEyeHiddenAreaMesh(m_pvrSession, !viewIndex ? pvrEye_Left : pvrEye_Right, nullptr, 0);
         TraceLoggingWrite(g_traceProvider, "PVR_EyeHiddenAreaMesh", TLArg(verticesCount, "VerticesCount"));
 
         // The hidden area mesh is disabled by the platform.
-        if (!verticesCount) {
-            visibilityMask->vertexCountOutput = 0;
-            visibilityMask->indexCountOutput = 0;
-            return XR_SUCCESS;
+        if (verticesCount <= 0) {
+            return mask;
         }
 
-        if (visibilityMask->vertexCapacityInput == 0) {
-            visibilityMask->vertexCountOutput = verticesCount;
-            visibilityMask->indexCountOutput = verticesCount;
-        } else if (visibilityMask->vertices && visibilityMask->indices) {
-            if (visibilityMask->vertexCapacityInput < verticesCount ||
-                visibilityMask->indexCapacityInput < verticesCount) {
-                return XR_ERROR_SIZE_INSUFFICIENT;
+        static_assert(sizeof(XrVector2f) == sizeof(pvrVector2f));
+        std::vector<XrVector2f> triangles(verticesCount);
+        pvr_getEyeHiddenAreaMesh(m_pvrSession,
+                                 !viewIndex ? pvrEye_Left : pvrEye_Right,
+                                 reinterpret_cast<pvrVector2f*>(triangles.data()),
+                                 verticesCount);
+
+        // PVR gives us a list of triangles with many shared vertices, deduplicate them into an indexed mesh.
+        {
+            std::unordered_map<uint64_t, uint32_t> uniqueVertices;
+            mask.hiddenIndices.reserve(triangles.size());
+            for (const auto& vertex : triangles) {
+                uint64_t key;
+                static_assert(sizeof(key) == sizeof(vertex));
+                memcpy(&key, &vertex, sizeof(key));
+
+                const auto it = uniqueVertices.insert({key, (uint32_t)mask.hiddenVertices.size()});
+                if (it.second) {
+                    mask.hiddenVertices.push_back(vertex);
+                }
+                mask.hiddenIndices.push_back(it.first->second);
             }
+        }
 
-            static_assert(sizeof(XrVector2f) == sizeof(pvrVector2f));
-            pvr_getEyeHiddenAreaMesh(m_pvrSession,
-                                     !viewIndex ? pvrEye_Left : pvrEye_Right,
-                                     (pvrVector2f*)visibilityMask->vertices,
-                                     verticesCount);
+        // Must be done before the conversion, while the edges of the viewport are still at 0 and 1.
+        const auto loop = getHiddenMeshInnerLoop(mask.hiddenVertices, mask.hiddenIndices);
+        for (const auto index : loop) {
+            mask.lineLoopIndices.push_back((uint32_t)mask.lineLoopVertices.size());
+            mask.lineLoopVertices.push_back(mask.hiddenVertices[index]);
+        }
+
+        convertSteamVRToOpenXRHiddenMesh(fov, mask.hiddenVertices.data(), (uint32_t)mask.hiddenVertices.size());
+        convertSteamVRToOpenXRHiddenMesh(fov, mask.lineLoopVertices.data(), (uint32_t)mask.lineLoopVertices.size());
+
+        TraceLoggingWrite(g_traceProvider,
+                          "VisibilityMask",
+                          TLArg(viewIndex, "ViewIndex"),
+                          TLArg(mask.hiddenVertices.size(), "HiddenVerticesCount"),
+                          TLArg(mask.hiddenIndices.size(), "HiddenIndicesCount"),
+                          TLArg(mask.lineLoopVertices.size(), "LineLoopVerticesCount"));
+
+        return mask;
+    }
 
-            convertSteamVRToOpenXRHiddenMesh(
-                m_cachedEyeInfo[viewIndex].Fov, visibilityMask->vertices, visibilityMask->indices, verticesCount);
+    // Find the outline of the visible area: the edges of the hidden area mesh that belong to a single triangle, minus
+    // those running along the edge of the viewport. We keep the longest closed loop formed by these edges.
+    std::vector<uint32_t> OpenXrRuntime::getHiddenMeshInnerLoop(const std::vector<XrVector2f>& vertices,
+                                                                const std::vector<uint32_t>& indices) {
+        std::map<std::pair<uint32_t, uint32_t>, int> edgesUse;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            for (uint32_t j = 0; j < 3; j++) {
+                const uint32_t a = indices[i + j];
+                const uint32_t b = indices[i + (j + 1) % 3];
+                edgesUse[{std::min(a, b), std::max(a, b)}]++;
+            }
         }
 
-        return XR_SUCCESS;
+        const auto isOnViewportEdge = [&](uint32_t a, uint32_t b) {
+            const auto isAt = [](float value, float edge) { return std::abs(value - edge) < 1e-4f; };
+            return (isAt(vertices[a].x, 0.f) && isAt(vertices[b].x, 0.f)) ||
+                   (isAt(vertices[a].x, 1.f) && isAt(vertices[b].x, 1.f)) ||
+                   (isAt(vertices[a].y, 0.f) && isAt(vertices[b].y, 0.f)) ||
+                   (isAt(vertices[a].y, 1.f) && isAt(vertices[b].y, 1.f));
+        };
+
+        std::multimap<uint32_t, uint32_t> adjacency;
+        for (const auto& [edge, use] : edgesUse) {
+            if (use == 1 && !isOnViewportEdge(edge.first, edge.second)) {
+                adjacency.insert({edge.first, edge.second});
+                adjacency.insert({edge.second, edge.first});
+            }
+        }
+
+        std::vector<uint32_t> longestLoop;
+        std::set<uint32_t> visited;
+        for (const auto& [start, unused] : adjacency) {
+            if (visited.count(start)) {
+                continue;
+            }
+
+            std::vector<uint32_t> loop;
+            uint32_t previous = start;
+            uint32_t current = start;
+            bool isClosed = false;
+            while (!visited.count(current)) {
+                visited.insert(current);
+                loop.push_back(current);
+
+                // Walk to the neighbor we did not come from.
+                std::optional<uint32_t> next;
+                const auto neighbors = adjacency.equal_range(current);
+                for (auto it = neighbors.first; it != neighbors.second; it++) {
+                    if (it->second != previous || loop.size() == 1) {
+                        next = it->second;
+                        break;
+                    }
+                }
+                if (!next) {
+                    break;
+                }
+                if (*next == start && loop.size() > 2) {
+                    isClosed = true;
+                    break;
+                }
+                previous = current;
+                current = *next;
+            }
+
+            if (isClosed && loop.size() > longestLoop.size()) {
+                longestLoop = std::move(loop);
+            }
+        }
+
+        return longestLoop;
     }
 
     void OpenXrRuntime::convertSteamVRToOpenXRHiddenMesh(const pvrFovPort& fov,
                                                          XrVector2f* vertices,
-                                                         uint32_t* indices,
                                                          uint32_t count) const {
         const float b = -fov.DownTan;
         const float t = fov.UpTan;
@@ -136,18 +270,20 @@ namespace pimax_openxr {
         const float hConstTerm = rplOverHSpan * halfHSpan;
         const float vConstTerm = tpbOverVSpan * halfVSpan;
 
-        for (uint32_t i = 0; i < count; i++) {
-            // Screen to NDC.
-            XrVector2f ndc{(vertices[i].x - 0.5f) * 2.f, (vertices[i].y - 0.5f) * 2.f};
+        // Screen to NDC then project: pv = ((ps - 0.5) * 2) * halfSpan + constTerm = ps * 2halfSpan + (constTerm -
+        // halfSpan). We process 2 vertices at a time.
+        const XMVECTOR scale = XMVectorSet(2.f * halfHSpan, 2.f * halfVSpan, 2.f * halfHSpan, 2.f * halfVSpan);
+        const XMVECTOR offset = XMVectorSet(
+            hConstTerm - halfHSpan, vConstTerm - halfVSpan, hConstTerm - halfHSpan, vConstTerm - halfVSpan);
 
-            // Project the vertex.
-            XMStoreFloat2(reinterpret_cast<XMFLOAT2*>(&vertices[i]),
-                          XMVectorMultiplyAdd(XMVECTORF32{{{ndc.x, ndc.y, 0.f, 0.f}}},
-                                              XMVECTORF32{{{halfHSpan, halfVSpan, 0.f, 0.f}}},
-                                              XMVECTORF32{{{hConstTerm, vConstTerm, 0.f, 0.f}}}));
-
-            // Record the indices.
-            indices[i] = i;
+        uint32_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            XMFLOAT4* const pair = reinterpret_cast<XMFLOAT4*>(&vertices[i]);
+            XMStoreFloat4(pair, XMVectorMultiplyAdd(XMLoadFloat4(pair), scale, offset));
+        }
+        if (i < count) {
+            XMFLOAT2* const last = reinterpret_cast<XMFLOAT2*>(&vertices[i]);
+            XMStoreFloat2(last, XMVectorMultiplyAdd(XMLoadFloat2(last), scale, offset));
         }
     }
 
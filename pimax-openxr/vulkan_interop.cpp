@@ -151,6 +151,11 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
+        // The adapter LUID is not stable across reboots, so it cannot come from the cached system.
+        if (!ensureLiveSystem()) {
+            return XR_ERROR_SYSTEM_INVALID;
+        }
+
         uint32_t deviceCount = 0;
         CHECK_VKCMD(vkEnumeratePhysicalDevices(vkInstance, &deviceCount, nullptr));
         std::vector<VkPhysicalDevice> devices(deviceCount);
@@ -495,13 +500,6 @@ namespace pimax_openxr {
         importInfo.handle = fenceHandle.get();
         CHECK_VKCMD(m_vkDispatch.vkImportSemaphoreWin32HandleKHR(m_vkDevice, &importInfo));
 
-        // Create an additional semaphore for host-side wait.
-        {
-            VkFenceCreateInfo createInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-            CHECK_VKCMD(m_vkDispatch.vkCreateFence(
-                m_vkDevice, &createInfo, m_vkAllocator ? &m_vkAllocator.value() : nullptr, &m_vkFenceForFlush));
-        }
-
         // We will need command buffers to perform layout transitions.
         VkCommandPoolCreateInfo poolCreateInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
         poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
@@ -516,14 +514,15 @@ namespace pimax_openxr {
 
         // Frame timers.
         if (queueSupportsTimers) {
-            for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-                m_gpuTimerApp[i] = std::make_unique<VulkanGpuTimer>(m_vkDispatch,
-                                                                    m_vkPhysicalDevice,
-                                                                    m_vkDevice,
-                                                                    m_vkQueue,
-                                                                    vkBindings.queueFamilyIndex,
-                                                                    m_vkAllocator);
-            }
+            m_gpuTimestampsApp = std::make_unique<VulkanTimestampPool>(m_vkDispatch,
+                                                                       m_vkPhysicalDevice,
+                                                                       m_vkDevice,
+                                                                       m_vkQueue,
+                                                                       vkBindings.queueFamilyIndex,
+                                                                       m_vkAllocator,
+                                                                       k_maxGpuTimersPerPool,
+                                                                       k_gpuTimersLatency);
+            m_gpuTimerApp = std::make_unique<GpuTimer>(*m_gpuTimestampsApp);
         } else {
             Log("Queue does not support timestamps. Smart Smoothing will not work properly.\n");
         }
@@ -562,10 +561,6 @@ namespace pimax_openxr {
         VK_GET_PTR(vkCreateSemaphore);
         VK_GET_PTR(vkDestroySemaphore);
         VK_GET_PTR(vkImportSemaphoreWin32HandleKHR);
-        VK_GET_PTR(vkCreateFence);
-        VK_GET_PTR(vkDestroyFence);
-        VK_GET_PTR(vkResetFences);
-        VK_GET_PTR(vkWaitForFences);
         VK_GET_PTR(vkDeviceWaitIdle);
         VK_GET_PTR(vkCreateQueryPool);
         VK_GET_PTR(vkDestroyQueryPool);
@@ -579,16 +574,12 @@ namespace pimax_openxr {
             m_vkDispatch.vkDeviceWaitIdle(m_vkDevice);
         }
 
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i].reset();
-        }
+        m_gpuTimerApp.reset();
+        m_gpuTimestampsApp.reset();
         if (m_vkDispatch.vkDestroySemaphore) {
             m_vkDispatch.vkDestroySemaphore(
                 m_vkDevice, m_vkTimelineSemaphore, m_vkAllocator ? &m_vkAllocator.value() : nullptr);
             m_vkTimelineSemaphore = VK_NULL_HANDLE;
-            m_vkDispatch.vkDestroyFence(
-                m_vkDevice, m_vkFenceForFlush, m_vkAllocator ? &m_vkAllocator.value() : nullptr);
-            m_vkFenceForFlush = VK_NULL_HANDLE;
         }
         if (m_vkDispatch.vkResetCommandBuffer) {
             m_vkDispatch.vkResetCommandBuffer(m_vkCmdBuffer, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
@@ -597,6 +588,7 @@ namespace pimax_openxr {
             m_vkDispatch.vkFreeCommandBuffers(m_vkDevice, m_vkCmdPool, 1, &m_vkCmdBuffer);
             m_vkCmdBuffer = VK_NULL_HANDLE;
         }
+        m_vkCmdBufferFenceValue = 0;
         if (m_vkDispatch.vkDestroyCommandPool) {
             m_vkDispatch.vkDestroyCommandPool(
                 m_vkDevice, m_vkCmdPool, m_vkAllocator ? &m_vkAllocator.value() : nullptr);
@@ -635,8 +627,9 @@ namespace pimax_openxr {
 
             if (needTransition) {
                 // We keep our code simple by only using a single command buffer, which means we must wait before
-                // reusing it.
-                flushVulkanCommandQueue();
+                // reusing it. This is rarely an actual wait, since the previous use is long completed. We wait through
+                // the D3D11 side of the fence, since the imported semaphore may not be waited on by Vulkan.
+                waitForSubmissionFenceValue(m_vkCmdBufferFenceValue);
 
                 // Prepare to execute layout transitions.
                 VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
@@ -792,10 +785,7 @@ namespace pimax_openxr {
         if (!initialized && needTransition) {
             // Transition all images to the desired state.
             CHECK_VKCMD(m_vkDispatch.vkEndCommandBuffer(m_vkCmdBuffer));
-            VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &m_vkCmdBuffer;
-            CHECK_VKCMD(m_vkDispatch.vkQueueSubmit(m_vkQueue, 1, &submitInfo, VK_NULL_HANDLE));
+            m_vkCmdBufferFenceValue = submitVulkanAndSignal(m_vkCmdBuffer);
         }
 
         return XR_SUCCESS;
@@ -804,26 +794,46 @@ namespace pimax_openxr {
     // Wait for all pending commands to finish.
     void OpenXrRuntime::flushVulkanCommandQueue() {
         if (m_vkDispatch.vkQueueSubmit) {
-            TraceLoggingWrite(g_traceProvider, "FlushContext_Wait", TLArg("Vulkan", "Api"));
-            CHECK_VKCMD(m_vkDispatch.vkResetFences(m_vkDevice, 1, &m_vkFenceForFlush));
-            VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-            CHECK_VKCMD(m_vkDispatch.vkQueueSubmit(m_vkQueue, 1, &submitInfo, m_vkFenceForFlush));
-            CHECK_VKCMD(m_vkDispatch.vkWaitForFences(m_vkDevice, 1, &m_vkFenceForFlush, true, 1'000'000'000));
+            const UINT64 fenceValue = submitVulkanAndSignal(VK_NULL_HANDLE);
+            TraceLoggingWrite(
+                g_traceProvider, "FlushContext_Wait", TLArg("Vulkan", "Api"), TLArg(fenceValue, "FenceValue"));
+            waitForSubmissionFenceValue(fenceValue);
         }
     }
 
-    // Serialize commands from the Vulkan queue to the D3D11 context used by PVR.
-    void OpenXrRuntime::serializeVulkanFrame() {
-        m_fenceValue++;
-        TraceLoggingWrite(
-            g_traceProvider, "xrEndFrame_Sync", TLArg("Vulkan", "Api"), TLArg(m_fenceValue, "FenceValue"));
+    // Submit a batch (possibly without commands) signaling the next value of the shared fence. Returns that value.
+    UINT64 OpenXrRuntime::submitVulkanAndSignal(VkCommandBuffer cmdBuffer) {
+        std::unique_lock lock(m_fenceMutex);
+
+        const UINT64 fenceValue = ++m_fenceValue;
         VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
         timelineInfo.signalSemaphoreValueCount = 1;
-        timelineInfo.pSignalSemaphoreValues = &m_fenceValue;
+        timelineInfo.pSignalSemaphoreValues = &fenceValue;
         VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO, &timelineInfo};
+        if (cmdBuffer != VK_NULL_HANDLE) {
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &cmdBuffer;
+        }
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = &m_vkTimelineSemaphore;
         CHECK_VKCMD(m_vkDispatch.vkQueueSubmit(m_vkQueue, 1, &submitInfo, VK_NULL_HANDLE));
+        return fenceValue;
+    }
+
+    // Serialize commands from the Vulkan queue to the D3D11 context used by PVR.
+    void OpenXrRuntime::serializeVulkanFrame() {
+        if (m_gpuTimestampsApp) {
+            // Submit the end timestamp of the app GPU timer and the signal in the same batch.
+            std::unique_lock lock(m_fenceMutex);
+
+            m_frameFenceValue = ++m_fenceValue;
+            static_cast<VulkanTimestampPool*>(m_gpuTimestampsApp.get())
+                ->flushAndSignal(m_vkTimelineSemaphore, m_frameFenceValue);
+        } else {
+            m_frameFenceValue = submitVulkanAndSignal(VK_NULL_HANDLE);
+        }
+        TraceLoggingWrite(
+            g_traceProvider, "xrEndFrame_Sync", TLArg("Vulkan", "Api"), TLArg(m_frameFenceValue, "FenceValue"));
 
         waitOnSubmissionDevice();
     }
@@ -0,0 +1,1192 @@
+// MIT License
+//
+// Copyright(c) 2022-2023 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A headless benchmark driving the runtime through sessions with each graphics API, under various layer
+// configurations, and reporting the runtime overhead. The runtime DLL is loaded directly (bypassing the OpenXR loader)
+// so that the build under test is always the one being measured. With -math, it instead measures the pose math used by
+// the locate paths, without loading the runtime. The frame statistics are read from the telemetry of the runtime, which
+// must be enabled with its "telemetry" setting.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <unknwn.h>
+#include <wrl.h>
+
+using Microsoft::WRL::ComPtr;
+
+#include <d3d11.h>
+#include <d3d12.h>
+#include <dxgi1_2.h>
+#define VK_USE_PLATFORM_WIN32_KHR
+#include <vulkan/vulkan.h>
+#include <GL/GL.h>
+#include <GL/glext.h>
+
+#define XR_NO_PROTOTYPES
+#define XR_USE_PLATFORM_WIN32
+#define XR_USE_GRAPHICS_API_D3D11
+#define XR_USE_GRAPHICS_API_D3D12
+#define XR_USE_GRAPHICS_API_VULKAN
+#define XR_USE_GRAPHICS_API_OPENGL
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <loader_interfaces.h>
+
+#include <XrMath.h>
+
+#include "../pimax-openxr/pose_math.h"
+#include "../pimax-openxr/telemetry.h"
+
+namespace {
+
+    namespace telemetry = pimax_openxr::utils::telemetry;
+
+    void checkResult(bool success, const char* expression, const std::string& result) {
+        if (!success) {
+            throw std::runtime_error(std::string(expression) + " failed with " + result);
+        }
+    }
+
+#define CHECK_XR(cmd)                                                                                                  \
+    {                                                                                                                  \
+        const XrResult _result = (cmd);                                                                                \
+        checkResult(XR_SUCCEEDED(_result), #cmd, std::to_string(_result));                                             \
+    }
+#define CHECK_HR(cmd)                                                                                                  \
+    {                                                                                                                  \
+        const HRESULT _result = (cmd);                                                                                 \
+        checkResult(SUCCEEDED(_result), #cmd, std::to_string(_result));                                                \
+    }
+#define CHECK_VK(cmd)                                                                                                  \
+    {                                                                                                                  \
+        const VkResult _result = (cmd);                                                                                \
+        checkResult(_result == VK_SUCCESS, #cmd, std::to_string(_result));                                             \
+    }
+
+    template <typename F>
+    struct ScopeExit {
+        ~ScopeExit() {
+            callback();
+        }
+        F callback;
+    };
+
+    template <typename F>
+    ScopeExit<F> MakeScopeExit(F callback) {
+        return ScopeExit<F>{std::move(callback)};
+    }
+
+#define FOR_EACH_GLOBAL_XR_FUNCTION(_) _(xrCreateInstance)
+
+#define FOR_EACH_XR_FUNCTION(_)                                                                                        \
+    _(xrDestroyInstance)                                                                                               \
+    _(xrGetSystem)                                                                                                     \
+    _(xrCreateSession)                                                                                                 \
+    _(xrDestroySession)                                                                                                \
+    _(xrBeginSession)                                                                                                  \
+    _(xrEndSession)                                                                                                    \
+    _(xrRequestExitSession)                                                                                            \
+    _(xrPollEvent)                                                                                                     \
+    _(xrCreateReferenceSpace)                                                                                          \
+    _(xrDestroySpace)                                                                                                  \
+    _(xrEnumerateViewConfigurationViews)                                                                               \
+    _(xrCreateSwapchain)                                                                                               \
+    _(xrDestroySwapchain)                                                                                              \
+    _(xrAcquireSwapchainImage)                                                                                         \
+    _(xrWaitSwapchainImage)                                                                                            \
+    _(xrReleaseSwapchainImage)                                                                                         \
+    _(xrWaitFrame)                                                                                                     \
+    _(xrBeginFrame)                                                                                                    \
+    _(xrEndFrame)                                                                                                      \
+    _(xrLocateViews)
+
+#define DECLARE_XR_FUNCTION(name) PFN_##name name{nullptr};
+
+    struct XrDispatchTable {
+        PFN_xrGetInstanceProcAddr xrGetInstanceProcAddr{nullptr};
+        FOR_EACH_GLOBAL_XR_FUNCTION(DECLARE_XR_FUNCTION)
+        FOR_EACH_XR_FUNCTION(DECLARE_XR_FUNCTION)
+    } xr;
+
+    template <typename T>
+    T getXrFunction(XrInstance instance, const char* name) {
+        PFN_xrVoidFunction function = nullptr;
+        CHECK_XR(xr.xrGetInstanceProcAddr(instance, name, &function));
+        return reinterpret_cast<T>(function);
+    }
+
+#define LOAD_XR_FUNCTION(name) xr.name = getXrFunction<PFN_##name>(instance, #name);
+
+    void loadRuntime(const std::filesystem::path& path) {
+        const HMODULE module = LoadLibraryW(path.c_str());
+        if (!module) {
+            throw std::runtime_error("Failed to load " + path.string());
+        }
+        const auto xrNegotiateLoaderRuntimeInterface = reinterpret_cast<PFN_xrNegotiateLoaderRuntimeInterface>(
+            GetProcAddress(module, "xrNegotiateLoaderRuntimeInterface"));
+        if (!xrNegotiateLoaderRuntimeInterface) {
+            throw std::runtime_error(path.string() + " is not an OpenXR runtime");
+        }
+
+        XrNegotiateLoaderInfo loaderInfo{};
+        loaderInfo.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+        loaderInfo.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+        loaderInfo.structSize = sizeof(loaderInfo);
+        loaderInfo.minInterfaceVersion = loaderInfo.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+        loaderInfo.minApiVersion = loaderInfo.maxApiVersion = XR_CURRENT_API_VERSION;
+        XrNegotiateRuntimeRequest runtimeRequest{};
+        runtimeRequest.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
+        runtimeRequest.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
+        runtimeRequest.structSize = sizeof(runtimeRequest);
+        CHECK_XR(xrNegotiateLoaderRuntimeInterface(&loaderInfo, &runtimeRequest));
+
+        xr.xrGetInstanceProcAddr = runtimeRequest.getInstanceProcAddr;
+        const XrInstance instance = XR_NULL_HANDLE;
+        FOR_EACH_GLOBAL_XR_FUNCTION(LOAD_XR_FUNCTION)
+    }
+
+    // The graphics device of the application, created on the adapter required by the runtime.
+    class GraphicsBackend {
+      public:
+        virtual ~GraphicsBackend() = default;
+
+        virtual const char* name() const = 0;
+        virtual const char* extensionName() const = 0;
+
+        // Returns the graphics binding to chain to XrSessionCreateInfo.
+        virtual const void* initialize(XrInstance instance, XrSystemId systemId) = 0;
+
+        virtual int64_t colorFormat(bool srgb) const = 0;
+        virtual int64_t depthFormat() const = 0;
+    };
+
+    ComPtr<IDXGIAdapter1> findAdapter(const LUID& luid) {
+        ComPtr<IDXGIFactory1> factory;
+        CHECK_HR(CreateDXGIFactory1(IID_PPV_ARGS(factory.ReleaseAndGetAddressOf())));
+        for (UINT i = 0;; i++) {
+            ComPtr<IDXGIAdapter1> adapter;
+            if (factory->EnumAdapters1(i, adapter.ReleaseAndGetAddressOf()) == DXGI_ERROR_NOT_FOUND) {
+                break;
+            }
+            DXGI_ADAPTER_DESC1 desc{};
+            CHECK_HR(adapter->GetDesc1(&desc));
+            if (!memcmp(&desc.AdapterLuid, &luid, sizeof(LUID))) {
+                return adapter;
+            }
+        }
+        throw std::runtime_error("Could not find the adapter required by the runtime");
+    }
+
+    class D3D11Backend : public GraphicsBackend {
+      public:
+        const char* name() const override {
+            return "d3d11";
+        }
+
+        const char* extensionName() const override {
+            return XR_KHR_D3D11_ENABLE_EXTENSION_NAME;
+        }
+
+        const void* initialize(XrInstance instance, XrSystemId systemId) override {
+            const auto xrGetD3D11GraphicsRequirementsKHR =
+                getXrFunction<PFN_xrGetD3D11GraphicsRequirementsKHR>(instance, "xrGetD3D11GraphicsRequirementsKHR");
+            XrGraphicsRequirementsD3D11KHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR};
+            CHECK_XR(xrGetD3D11GraphicsRequirementsKHR(instance, systemId, &requirements));
+
+            const auto adapter = findAdapter(requirements.adapterLuid);
+            CHECK_HR(D3D11CreateDevice(adapter.Get(),
+                                       D3D_DRIVER_TYPE_UNKNOWN,
+                                       nullptr,
+                                       0,
+                                       &requirements.minFeatureLevel,
+                                       1,
+                                       D3D11_SDK_VERSION,
+                                       m_device.ReleaseAndGetAddressOf(),
+                                       nullptr,
+                                       nullptr));
+
+            m_binding.device = m_device.Get();
+            return &m_binding;
+        }
+
+        int64_t colorFormat(bool srgb) const override {
+            return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        int64_t depthFormat() const override {
+            return DXGI_FORMAT_D32_FLOAT;
+        }
+
+      private:
+        ComPtr<ID3D11Device> m_device;
+        XrGraphicsBindingD3D11KHR m_binding{XR_TYPE_GRAPHICS_BINDING_D3D11_KHR};
+    };
+
+    class D3D12Backend : public GraphicsBackend {
+      public:
+        const char* name() const override {
+            return "d3d12";
+        }
+
+        const char* extensionName() const override {
+            return XR_KHR_D3D12_ENABLE_EXTENSION_NAME;
+        }
+
+        const void* initialize(XrInstance instance, XrSystemId systemId) override {
+            const auto xrGetD3D12GraphicsRequirementsKHR =
+                getXrFunction<PFN_xrGetD3D12GraphicsRequirementsKHR>(instance, "xrGetD3D12GraphicsRequirementsKHR");
+            XrGraphicsRequirementsD3D12KHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_D3D12_KHR};
+            CHECK_XR(xrGetD3D12GraphicsRequirementsKHR(instance, systemId, &requirements));
+
+            const auto adapter = findAdapter(requirements.adapterLuid);
+            CHECK_HR(D3D12CreateDevice(
+                adapter.Get(), requirements.minFeatureLevel, IID_PPV_ARGS(m_device.ReleaseAndGetAddressOf())));
+
+            D3D12_COMMAND_QUEUE_DESC queueDesc{};
+            queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+            CHECK_HR(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(m_queue.ReleaseAndGetAddressOf())));
+
+            m_binding.device = m_device.Get();
+            m_binding.queue = m_queue.Get();
+            return &m_binding;
+        }
+
+        int64_t colorFormat(bool srgb) const override {
+            return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        int64_t depthFormat() const override {
+            return DXGI_FORMAT_D32_FLOAT;
+        }
+
+      private:
+        ComPtr<ID3D12Device> m_device;
+        ComPtr<ID3D12CommandQueue> m_queue;
+        XrGraphicsBindingD3D12KHR m_binding{XR_TYPE_GRAPHICS_BINDING_D3D12_KHR};
+    };
+
+    class VulkanBackend : public GraphicsBackend {
+      public:
+        ~VulkanBackend() override {
+            if (m_device != VK_NULL_HANDLE) {
+                vkDestroyDevice(m_device, nullptr);
+            }
+            if (m_instance != VK_NULL_HANDLE) {
+                vkDestroyInstance(m_instance, nullptr);
+            }
+        }
+
+        const char* name() const override {
+            return "vulkan";
+        }
+
+        const char* extensionName() const override {
+            return XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME;
+        }
+
+        const void* initialize(XrInstance instance, XrSystemId systemId) override {
+            const auto xrGetVulkanGraphicsRequirements2KHR = getXrFunction<PFN_xrGetVulkanGraphicsRequirements2KHR>(
+                instance, "xrGetVulkanGraphicsRequirements2KHR");
+            const auto xrCreateVulkanInstanceKHR =
+                getXrFunction<PFN_xrCreateVulkanInstanceKHR>(instance, "xrCreateVulkanInstanceKHR");
+            const auto xrGetVulkanGraphicsDevice2KHR =
+                getXrFunction<PFN_xrGetVulkanGraphicsDevice2KHR>(instance, "xrGetVulkanGraphicsDevice2KHR");
+            const auto xrCreateVulkanDeviceKHR =
+                getXrFunction<PFN_xrCreateVulkanDeviceKHR>(instance, "xrCreateVulkanDeviceKHR");
+
+            XrGraphicsRequirementsVulkan2KHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN2_KHR};
+            CHECK_XR(xrGetVulkanGraphicsRequirements2KHR(instance, systemId, &requirements));
+
+            VkApplicationInfo applicationInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+            applicationInfo.pApplicationName = "pimax_bench";
+            applicationInfo.apiVersion = VK_API_VERSION_1_2;
+            VkInstanceCreateInfo instanceInfo{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+            instanceInfo.pApplicationInfo = &applicationInfo;
+            XrVulkanInstanceCreateInfoKHR xrInstanceInfo{XR_TYPE_VULKAN_INSTANCE_CREATE_INFO_KHR};
+            xrInstanceInfo.systemId = systemId;
+            xrInstanceInfo.pfnGetInstanceProcAddr = vkGetInstanceProcAddr;
+            xrInstanceInfo.vulkanCreateInfo = &instanceInfo;
+            VkResult vkResult = VK_SUCCESS;
+            CHECK_XR(xrCreateVulkanInstanceKHR(instance, &xrInstanceInfo, &m_instance, &vkResult));
+            CHECK_VK(vkResult);
+
+            XrVulkanGraphicsDeviceGetInfoKHR deviceGetInfo{XR_TYPE_VULKAN_GRAPHICS_DEVICE_GET_INFO_KHR};
+            deviceGetInfo.systemId = systemId;
+            deviceGetInfo.vulkanInstance = m_instance;
+            CHECK_XR(xrGetVulkanGraphicsDevice2KHR(instance, &deviceGetInfo, &m_physicalDevice));
+
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+            const auto graphicsFamily =
+                std::find_if(queueFamilies.cbegin(), queueFamilies.cend(), [](const VkQueueFamilyProperties& family) {
+                    return family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+                });
+            if (graphicsFamily == queueFamilies.cend()) {
+                throw std::runtime_error("No graphics queue on the Vulkan device");
+            }
+
+            const float queuePriority = 1.f;
+            VkDeviceQueueCreateInfo queueInfo{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+            queueInfo.queueFamilyIndex = (uint32_t)std::distance(queueFamilies.cbegin(), graphicsFamily);
+            queueInfo.queueCount = 1;
+            queueInfo.pQueuePriorities = &queuePriority;
+            VkDeviceCreateInfo deviceInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+            deviceInfo.queueCreateInfoCount = 1;
+            deviceInfo.pQueueCreateInfos = &queueInfo;
+            XrVulkanDeviceCreateInfoKHR xrDeviceInfo{XR_TYPE_VULKAN_DEVICE_CREATE_INFO_KHR};
+            xrDeviceInfo.systemId = systemId;
+            xrDeviceInfo.pfnGetInstanceProcAddr = vkGetInstanceProcAddr;
+            xrDeviceInfo.vulkanPhysicalDevice = m_physicalDevice;
+            xrDeviceInfo.vulkanCreateInfo = &deviceInfo;
+            CHECK_XR(xrCreateVulkanDeviceKHR(instance, &xrDeviceInfo, &m_device, &vkResult));
+            CHECK_VK(vkResult);
+
+            m_binding.instance = m_instance;
+            m_binding.physicalDevice = m_physicalDevice;
+            m_binding.device = m_device;
+            m_binding.queueFamilyIndex = queueInfo.queueFamilyIndex;
+            m_binding.queueIndex = 0;
+            return &m_binding;
+        }
+
+        int64_t colorFormat(bool srgb) const override {
+            return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        int64_t depthFormat() const override {
+            return VK_FORMAT_D32_SFLOAT;
+        }
+
+      private:
+        VkInstance m_instance{VK_NULL_HANDLE};
+        VkPhysicalDevice m_physicalDevice{VK_NULL_HANDLE};
+        VkDevice m_device{VK_NULL_HANDLE};
+        XrGraphicsBindingVulkanKHR m_binding{XR_TYPE_GRAPHICS_BINDING_VULKAN_KHR};
+    };
+
+    class OpenGLBackend : public GraphicsBackend {
+      public:
+        ~OpenGLBackend() override {
+            if (m_glrc) {
+                wglMakeCurrent(nullptr, nullptr);
+                wglDeleteContext(m_glrc);
+            }
+            if (m_dc) {
+                ReleaseDC(m_window, m_dc);
+            }
+            if (m_window) {
+                DestroyWindow(m_window);
+            }
+        }
+
+        const char* name() const override {
+            return "opengl";
+        }
+
+        const char* extensionName() const override {
+            return XR_KHR_OPENGL_ENABLE_EXTENSION_NAME;
+        }
+
+        const void* initialize(XrInstance instance, XrSystemId systemId) override {
+            const auto xrGetOpenGLGraphicsRequirementsKHR =
+                getXrFunction<PFN_xrGetOpenGLGraphicsRequirementsKHR>(instance, "xrGetOpenGLGraphicsRequirementsKHR");
+            XrGraphicsRequirementsOpenGLKHR requirements{XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_KHR};
+            CHECK_XR(xrGetOpenGLGraphicsRequirementsKHR(instance, systemId, &requirements));
+
+            // The context is never presented, but WGL requires a window to create it.
+            WNDCLASSW windowClass{};
+            windowClass.lpfnWndProc = DefWindowProcW;
+            windowClass.hInstance = GetModuleHandle(nullptr);
+            windowClass.lpszClassName = L"pimax_bench";
+            RegisterClassW(&windowClass);
+            m_window = CreateWindowW(
+                L"pimax_bench", L"pimax_bench", WS_OVERLAPPEDWINDOW, 0, 0, 1, 1, nullptr, nullptr, nullptr, nullptr);
+            if (!m_window) {
+                throw std::runtime_error("Failed to create the OpenGL window");
+            }
+            m_dc = GetDC(m_window);
+
+            PIXELFORMATDESCRIPTOR pixelFormat{};
+            pixelFormat.nSize = sizeof(pixelFormat);
+            pixelFormat.nVersion = 1;
+            pixelFormat.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+            pixelFormat.iPixelType = PFD_TYPE_RGBA;
+            pixelFormat.cColorBits = 32;
+            if (!SetPixelFormat(m_dc, ChoosePixelFormat(m_dc, &pixelFormat), &pixelFormat)) {
+                throw std::runtime_error("Failed to set the OpenGL pixel format");
+            }
+            m_glrc = wglCreateContext(m_dc);
+            if (!m_glrc || !wglMakeCurrent(m_dc, m_glrc)) {
+                throw std::runtime_error("Failed to create the OpenGL context");
+            }
+
+            m_binding.hDC = m_dc;
+            m_binding.hGLRC = m_glrc;
+            return &m_binding;
+        }
+
+        int64_t colorFormat(bool srgb) const override {
+            return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        }
+
+        int64_t depthFormat() const override {
+            return GL_DEPTH_COMPONENT32F;
+        }
+
+      private:
+        HWND m_window{nullptr};
+        HDC m_dc{nullptr};
+        HGLRC m_glrc{nullptr};
+        XrGraphicsBindingOpenGLWin32KHR m_binding{XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR};
+    };
+
+    std::unique_ptr<GraphicsBackend> createBackend(const std::string& api) {
+        if (api == "d3d11") {
+            return std::make_unique<D3D11Backend>();
+        } else if (api == "d3d12") {
+            return std::make_unique<D3D12Backend>();
+        } else if (api == "vulkan") {
+            return std::make_unique<VulkanBackend>();
+        } else if (api == "opengl") {
+            return std::make_unique<OpenGLBackend>();
+        }
+        throw std::runtime_error("Unknown graphics API: " + api);
+    }
+
+    // Reads the frame records published by the runtime in shared memory.
+    class TelemetryReader {
+      public:
+        ~TelemetryReader() {
+            if (m_view) {
+                UnmapViewOfFile(m_view);
+            }
+            if (m_mapping) {
+                CloseHandle(m_mapping);
+            }
+        }
+
+        bool open() {
+            m_mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, telemetry::k_sharedMemoryName);
+            if (!m_mapping) {
+                return false;
+            }
+            m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!m_view) {
+                return false;
+            }
+            m_header = reinterpret_cast<const telemetry::Header*>(m_view);
+            if (m_header->magic != telemetry::k_magic || m_header->version != telemetry::k_version) {
+                m_header = nullptr;
+                return false;
+            }
+            m_nextIndex = m_header->writeIndex.load(std::memory_order_acquire);
+            return true;
+        }
+
+        // Invoke the callback for each record published since the last call.
+        void readNew(const std::function<void(const telemetry::FrameRecord&)>& callback) {
+            if (!m_header) {
+                return;
+            }
+
+            const uint64_t writeIndex = m_header->writeIndex.load(std::memory_order_acquire);
+            if (writeIndex < m_nextIndex) {
+                // The ring was claimed again by a new session.
+                m_nextIndex = 0;
+            }
+            if (writeIndex - m_nextIndex > m_header->recordsCount) {
+                m_nextIndex = writeIndex - m_header->recordsCount;
+            }
+            for (; m_nextIndex < writeIndex; m_nextIndex++) {
+                const auto slot = reinterpret_cast<const telemetry::FrameSlot*>(
+                    reinterpret_cast<const uint8_t*>(m_view) + m_header->headerSize +
+                    (m_nextIndex % m_header->recordsCount) * m_header->slotSize);
+                const uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+                if (sequence & 1) {
+                    continue;
+                }
+                const telemetry::FrameRecord record = slot->record;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+                    continue;
+                }
+                callback(record);
+            }
+        }
+
+        bool isOpen() const {
+            return m_header;
+        }
+
+        // The runtime only publishes the frame records when its "telemetry" setting is enabled.
+        bool hasFrameRecords() const {
+            return m_header && m_header->frameRecordsEnabled;
+        }
+
+      private:
+        HANDLE m_mapping{nullptr};
+        void* m_view{nullptr};
+        const telemetry::Header* m_header{nullptr};
+        uint64_t m_nextIndex{0};
+    };
+
+    class Distribution {
+      public:
+        void add(double value) {
+            m_samples.push_back(value);
+            m_isSorted = false;
+        }
+
+        double percentile(double p) const {
+            if (m_samples.empty()) {
+                return NAN;
+            }
+            if (!m_isSorted) {
+                std::sort(m_samples.begin(), m_samples.end());
+                m_isSorted = true;
+            }
+            const size_t index = std::min(m_samples.size() - 1, (size_t)(m_samples.size() * p / 100.0));
+            return m_samples[index];
+        }
+
+        double mean() const {
+            if (m_samples.empty()) {
+                return NAN;
+            }
+            double sum = 0;
+            for (const double value : m_samples) {
+                sum += value;
+            }
+            return sum / m_samples.size();
+        }
+
+      private:
+        mutable std::vector<double> m_samples;
+        mutable bool m_isSorted{true};
+    };
+
+    struct Scenario {
+        const char* name;
+        uint32_t quadLayers;
+        bool alphaBlendedQuads;
+        bool textureArray;
+        bool srgb;
+        bool depth;
+    };
+
+    const Scenario k_scenarios[] = {
+        {"baseline", 0, false, false, true, false},
+        {"linear", 0, false, false, false, false},
+        {"texture-array", 0, false, true, true, false},
+        {"depth", 0, false, false, true, true},
+        {"texture-array-depth", 0, false, true, true, true},
+        {"quads-4", 4, false, false, true, false},
+        {"quads-4-alpha", 4, true, false, true, false},
+        {"quads-15-alpha", 15, true, false, true, false},
+    };
+
+    // All durations are in microseconds.
+    struct Results {
+        Distribution waitFrame;
+        Distribution beginFrame;
+        Distribution swapchains;
+        Distribution endFrame;
+        Distribution pvrWait;
+        Distribution pvrEndFrame;
+        Distribution precompositionGpu;
+        Distribution endFrameAllocations;
+        uint32_t frames{0};
+    };
+
+    Results runScenario(GraphicsBackend& backend, const Scenario& scenario, uint32_t frames, uint32_t warmupFrames) {
+        using clock = std::chrono::high_resolution_clock;
+        const auto elapsedUs = [](clock::time_point start, clock::time_point end) {
+            return std::chrono::duration<double, std::micro>(end - start).count();
+        };
+
+        std::vector<const char*> extensions{backend.extensionName()};
+        if (scenario.depth) {
+            extensions.push_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+        }
+        XrInstanceCreateInfo instanceCreateInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+        strcpy_s(instanceCreateInfo.applicationInfo.applicationName, "pimax_bench");
+        strcpy_s(instanceCreateInfo.applicationInfo.engineName, "pimax_bench");
+        instanceCreateInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+        instanceCreateInfo.enabledExtensionCount = (uint32_t)extensions.size();
+        instanceCreateInfo.enabledExtensionNames = extensions.data();
+        XrInstance instance = XR_NULL_HANDLE;
+        CHECK_XR(xr.xrCreateInstance(&instanceCreateInfo, &instance));
+        FOR_EACH_XR_FUNCTION(LOAD_XR_FUNCTION)
+        auto destroyInstance = MakeScopeExit([&] { xr.xrDestroyInstance(instance); });
+
+        XrSystemGetInfo systemInfo{XR_TYPE_SYSTEM_GET_INFO};
+        systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+        XrSystemId systemId = XR_NULL_SYSTEM_ID;
+        CHECK_XR(xr.xrGetSystem(instance, &systemInfo, &systemId));
+
+        XrSessionCreateInfo sessionCreateInfo{XR_TYPE_SESSION_CREATE_INFO};
+        sessionCreateInfo.next = backend.initialize(instance, systemId);
+        sessionCreateInfo.systemId = systemId;
+        XrSession session = XR_NULL_HANDLE;
+        CHECK_XR(xr.xrCreateSession(instance, &sessionCreateInfo, &session));
+        auto destroySession = MakeScopeExit([&] { xr.xrDestroySession(session); });
+
+        XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        spaceCreateInfo.poseInReferenceSpace.orientation.w = 1.f;
+        XrSpace space = XR_NULL_HANDLE;
+        CHECK_XR(xr.xrCreateReferenceSpace(session, &spaceCreateInfo, &space));
+
+        XrViewConfigurationView views[2]{{XR_TYPE_VIEW_CONFIGURATION_VIEW}, {XR_TYPE_VIEW_CONFIGURATION_VIEW}};
+        uint32_t viewCount = 0;
+        CHECK_XR(xr.xrEnumerateViewConfigurationViews(
+            instance, systemId, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, 2, &viewCount, views));
+
+        std::vector<XrSwapchain> swapchains;
+        auto destroySwapchains = MakeScopeExit([&] {
+            for (const XrSwapchain swapchain : swapchains) {
+                xr.xrDestroySwapchain(swapchain);
+            }
+        });
+        const auto createSwapchain = [&](int64_t format, XrSwapchainUsageFlags usage, uint32_t width, uint32_t height,
+                                         uint32_t arraySize) {
+            XrSwapchainCreateInfo createInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+            createInfo.usageFlags = usage;
+            createInfo.format = format;
+            createInfo.sampleCount = 1;
+            createInfo.width = width;
+            createInfo.height = height;
+            createInfo.faceCount = 1;
+            createInfo.arraySize = arraySize;
+            createInfo.mipCount = 1;
+            XrSwapchain swapchain = XR_NULL_HANDLE;
+            CHECK_XR(xr.xrCreateSwapchain(session, &createInfo, &swapchain));
+            swapchains.push_back(swapchain);
+            return swapchain;
+        };
+
+        const uint32_t width = views[0].recommendedImageRectWidth;
+        const uint32_t height = views[0].recommendedImageRectHeight;
+        const XrSwapchainUsageFlags colorUsage =
+            XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+        const XrSwapchainUsageFlags depthUsage = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        XrSwapchain colorSwapchains[2]{};
+        XrSwapchain depthSwapchains[2]{};
+        for (uint32_t eye = 0; eye < 2; eye++) {
+            if (scenario.textureArray && eye > 0) {
+                colorSwapchains[eye] = colorSwapchains[0];
+                depthSwapchains[eye] = depthSwapchains[0];
+                continue;
+            }
+            const uint32_t arraySize = scenario.textureArray ? 2 : 1;
+            colorSwapchains[eye] =
+                createSwapchain(backend.colorFormat(scenario.srgb), colorUsage, width, height, arraySize);
+            if (scenario.depth) {
+                depthSwapchains[eye] = createSwapchain(backend.depthFormat(), depthUsage, width, height, arraySize);
+            }
+        }
+        std::vector<XrSwapchain> quadSwapchains;
+        for (uint32_t i = 0; i < scenario.quadLayers; i++) {
+            quadSwapchains.push_back(createSwapchain(backend.colorFormat(scenario.srgb), colorUsage, 512, 512, 1));
+        }
+
+        XrSessionState sessionState = XR_SESSION_STATE_UNKNOWN;
+        const auto pollEvents = [&] {
+            XrEventDataBuffer event{XR_TYPE_EVENT_DATA_BUFFER};
+            while (xr.xrPollEvent(instance, &event) == XR_SUCCESS) {
+                if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+                    sessionState = reinterpret_cast<const XrEventDataSessionStateChanged*>(&event)->state;
+                }
+                event = {XR_TYPE_EVENT_DATA_BUFFER};
+            }
+        };
+        const auto startTime = clock::now();
+        while (sessionState != XR_SESSION_STATE_READY) {
+            pollEvents();
+            if (clock::now() - startTime > std::chrono::seconds(10)) {
+                throw std::runtime_error("The session did not become ready (is the headset on?)");
+            }
+            Sleep(10);
+        }
+
+        XrSessionBeginInfo sessionBeginInfo{XR_TYPE_SESSION_BEGIN_INFO};
+        sessionBeginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        CHECK_XR(xr.xrBeginSession(session, &sessionBeginInfo));
+
+        TelemetryReader telemetry;
+        if (!telemetry.open()) {
+            throw std::runtime_error("Telemetry is unavailable (in use by another application?)");
+        }
+        if (!telemetry.hasFrameRecords()) {
+            throw std::runtime_error("The frame telemetry is disabled, set the \"telemetry\" setting to 1");
+        }
+
+        Results results;
+        std::vector<XrCompositionLayerQuad> quads(scenario.quadLayers);
+        std::vector<const XrCompositionLayerBaseHeader*> layers;
+        bool exitRequested = false;
+        for (uint32_t frame = 0; sessionState != XR_SESSION_STATE_STOPPING; frame++) {
+            const bool isMeasured = frame >= warmupFrames && !exitRequested;
+
+            const auto waitFrameStart = clock::now();
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            CHECK_XR(xr.xrWaitFrame(session, nullptr, &frameState));
+            const auto beginFrameStart = clock::now();
+            CHECK_XR(xr.xrBeginFrame(session, nullptr));
+            const auto beginFrameEnd = clock::now();
+
+            XrViewLocateInfo locateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+            locateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            locateInfo.displayTime = frameState.predictedDisplayTime;
+            locateInfo.space = space;
+            XrViewState viewState{XR_TYPE_VIEW_STATE};
+            XrView eyeViews[2]{{XR_TYPE_VIEW}, {XR_TYPE_VIEW}};
+            CHECK_XR(xr.xrLocateViews(session, &locateInfo, &viewState, 2, &viewCount, eyeViews));
+
+            // We do not render anything: only the cost of the runtime is of interest.
+            const auto swapchainsStart = clock::now();
+            for (const XrSwapchain swapchain : swapchains) {
+                uint32_t index;
+                CHECK_XR(xr.xrAcquireSwapchainImage(swapchain, nullptr, &index));
+                XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+                waitInfo.timeout = XR_INFINITE_DURATION;
+                CHECK_XR(xr.xrWaitSwapchainImage(swapchain, &waitInfo));
+                CHECK_XR(xr.xrReleaseSwapchainImage(swapchain, nullptr));
+            }
+            const auto swapchainsEnd = clock::now();
+
+            XrCompositionLayerProjectionView projectionViews[2]{};
+            XrCompositionLayerDepthInfoKHR depthInfo[2]{};
+            for (uint32_t eye = 0; eye < 2; eye++) {
+                projectionViews[eye] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+                projectionViews[eye].pose = eyeViews[eye].pose;
+                projectionViews[eye].fov = eyeViews[eye].fov;
+                projectionViews[eye].subImage.swapchain = colorSwapchains[eye];
+                projectionViews[eye].subImage.imageRect = {{0, 0}, {(int32_t)width, (int32_t)height}};
+                projectionViews[eye].subImage.imageArrayIndex = scenario.textureArray ? eye : 0;
+                if (scenario.depth) {
+                    depthInfo[eye] = {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR};
+                    depthInfo[eye].subImage = projectionViews[eye].subImage;
+                    depthInfo[eye].subImage.swapchain = depthSwapchains[eye];
+                    depthInfo[eye].minDepth = 0.f;
+                    depthInfo[eye].maxDepth = 1.f;
+                    depthInfo[eye].nearZ = 0.1f;
+                    depthInfo[eye].farZ = 100.f;
+                    projectionViews[eye].next = &depthInfo[eye];
+                }
+            }
+            XrCompositionLayerProjection projection{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
+            projection.space = space;
+            projection.viewCount = 2;
+            projection.views = projectionViews;
+
+            layers.clear();
+            layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&projection));
+            for (uint32_t i = 0; i < scenario.quadLayers; i++) {
+                XrCompositionLayerQuad& quad = quads[i];
+                quad = {XR_TYPE_COMPOSITION_LAYER_QUAD};
+                quad.layerFlags = scenario.alphaBlendedQuads ? XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT : 0;
+                quad.space = space;
+                quad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                quad.subImage.swapchain = quadSwapchains[i];
+                quad.subImage.imageRect = {{0, 0}, {512, 512}};
+                quad.pose.orientation.w = 1.f;
+                quad.pose.position = {-0.45f + 0.3f * (i % 4), -0.3f + 0.3f * (i / 4), -1.5f};
+                quad.size = {0.25f, 0.25f};
+                layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&quad));
+            }
+
+            XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
+            frameEndInfo.displayTime = frameState.predictedDisplayTime;
+            frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+            frameEndInfo.layerCount = frameState.shouldRender ? (uint32_t)layers.size() : 0;
+            frameEndInfo.layers = layers.data();
+            const auto endFrameStart = clock::now();
+            CHECK_XR(xr.xrEndFrame(session, &frameEndInfo));
+            const auto endFrameEnd = clock::now();
+
+            if (isMeasured) {
+                results.waitFrame.add(elapsedUs(waitFrameStart, beginFrameStart));
+                results.beginFrame.add(elapsedUs(beginFrameStart, beginFrameEnd));
+                results.swapchains.add(elapsedUs(swapchainsStart, swapchainsEnd));
+                results.endFrame.add(elapsedUs(endFrameStart, endFrameEnd));
+                results.frames++;
+            }
+            telemetry.readNew([&](const telemetry::FrameRecord& record) {
+                if (isMeasured) {
+                    results.pvrWait.add(record.waitDurationUs);
+                    results.pvrEndFrame.add(record.endFrameDurationUs);
+                    results.precompositionGpu.add(record.precompositionGpuTimeUs);
+                    results.endFrameAllocations.add(record.endFrameAllocations);
+                }
+            });
+
+            pollEvents();
+            if (sessionState == XR_SESSION_STATE_LOSS_PENDING) {
+                throw std::runtime_error("The session was lost");
+            }
+            if (!exitRequested && frame + 1 >= warmupFrames + frames) {
+                CHECK_XR(xr.xrRequestExitSession(session));
+                exitRequested = true;
+            }
+        }
+        CHECK_XR(xr.xrEndSession(session));
+        xr.xrDestroySpace(space);
+
+        return results;
+    }
+
+    // Measure the cost per call of the pose math in batches, and check that it matches xr::math::Pose, which it
+    // replaces in the locate paths. The relative velocity is checked against the derivative of the relative pose.
+    int runPoseMathBenchmark(uint32_t batches) {
+        constexpr size_t k_batchSize = 1024;
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+        const auto randomPose = [&]() {
+            XrQuaternionf q{uniform(rng), uniform(rng), uniform(rng), uniform(rng)};
+            const float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+            q = {q.x / length, q.y / length, q.z / length, q.w / length};
+            return XrPosef{q, {uniform(rng), uniform(rng), uniform(rng)}};
+        };
+        const auto randomVector = [&]() { return XrVector3f{uniform(rng), uniform(rng), uniform(rng)}; };
+        std::vector<XrPosef> poses(k_batchSize);
+        std::vector<XrVector3f> vectors(k_batchSize);
+        for (size_t i = 0; i < k_batchSize; i++) {
+            poses[i] = randomPose();
+            vectors[i] = randomVector();
+        }
+        const XrPosef base = randomPose();
+        std::vector<XrPosef> results(k_batchSize);
+        std::vector<XrVector3f> velocities(k_batchSize);
+
+        using clock = std::chrono::high_resolution_clock;
+        const auto measure = [&](const char* name, const std::function<void()>& batch) {
+            Distribution distribution;
+            for (uint32_t i = 0; i < batches; i++) {
+                const auto start = clock::now();
+                batch();
+                const auto end = clock::now();
+                distribution.add(std::chrono::duration<double, std::nano>(end - start).count() / k_batchSize);
+            }
+            printf("%-32s %8.2f %8.2f\n", name, distribution.percentile(50), distribution.percentile(99));
+        };
+
+        float maxError = 0.f;
+        const auto checkPose = [&](const XrPosef& a, const XrPosef& b) {
+            const float values[] = {a.orientation.x - b.orientation.x,
+                                    a.orientation.y - b.orientation.y,
+                                    a.orientation.z - b.orientation.z,
+                                    a.orientation.w - b.orientation.w,
+                                    a.position.x - b.position.x,
+                                    a.position.y - b.position.y,
+                                    a.position.z - b.position.z};
+            for (const float value : values) {
+                maxError = std::max(maxError, std::abs(value));
+            }
+        };
+
+        printf("%-32s %8s %8s\n", "operation", "p50 ns", "p99 ns");
+
+        using namespace pimax_openxr::utils;
+        measure("Multiply (xr::math)", [&]() {
+            for (size_t i = 0; i < k_batchSize; i++) {
+                results[i] = xr::math::Pose::Multiply(poses[i], base);
+            }
+        });
+        const std::vector<XrPosef> expected = results;
+        measure("Multiply (SIMD)", [&]() {
+            for (size_t i = 0; i < k_batchSize; i++) {
+                results[i] = simd::Multiply(poses[i], base);
+            }
+        });
+        for (size_t i = 0; i < k_batchSize; i++) {
+            checkPose(results[i], expected[i]);
+        }
+
+        measure("Multiply batch (SIMD)", [&]() {
+            const simd::Pose baseVector = simd::LoadPose(base);
+            for (size_t i = 0; i < k_batchSize; i++) {
+                results[i] = simd::StorePose(simd::Multiply(simd::LoadPose(poses[i]), baseVector));
+            }
+        });
+        for (size_t i = 0; i < k_batchSize; i++) {
+            checkPose(results[i], expected[i]);
+        }
+
+        measure("Invert (xr::math)", [&]() {
+            for (size_t i = 0; i < k_batchSize; i++) {
+                results[i] = xr::math::Pose::Invert(poses[i]);
+            }
+        });
+        const std::vector<XrPosef> expectedInverse = results;
+        measure("Invert (SIMD)", [&]() {
+            for (size_t i = 0; i < k_batchSize; i++) {
+                results[i] = simd::Invert(poses[i]);
+            }
+        });
+        for (size_t i = 0; i < k_batchSize; i++) {
+            checkPose(results[i], expectedInverse[i]);
+        }
+
+        // The poses are those of the spaces relative to a common space, in which the base space moves with the given
+        // velocities.
+        const XrVector3f baseLinear = randomVector();
+        const XrVector3f baseAngular = randomVector();
+        const XrPosef virtualToBase = xr::math::Pose::Invert(base);
+        std::vector<XrPosef> spacesInBase(k_batchSize);
+        for (size_t i = 0; i < k_batchSize; i++) {
+            spacesInBase[i] = xr::math::Pose::Multiply(poses[i], virtualToBase);
+        }
+        measure("RelativeVelocity (SIMD)", [&]() {
+            const simd::Pose virtualToBaseVector = simd::LoadPose(virtualToBase);
+            const simd::Velocity baseVelocity{simd::LoadVector(baseAngular), simd::LoadVector(baseLinear)};
+            for (size_t i = 0; i < k_batchSize; i++) {
+                const simd::Velocity spaceVelocity{DirectX::XMVectorZero(), simd::LoadVector(vectors[i])};
+                simd::StoreVector(velocities[i],
+                                  simd::RelativeVelocity(
+                                      virtualToBaseVector, simd::LoadPose(spacesInBase[i]), spaceVelocity, baseVelocity)
+                                      .linear);
+            }
+        });
+
+        // Move both spaces along their velocities for a short time, and differentiate the position of the space
+        // relative to the base space.
+        constexpr float k_dt = 1e-3f;
+        const auto spaceInBaseAt = [&](size_t i, float t) {
+            using namespace DirectX;
+            const float angle = XMVectorGetX(XMVector3Length(simd::LoadVector(baseAngular))) * t;
+            XrPosef baseRotation{{0, 0, 0, 1}, {0, 0, 0}};
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&baseRotation.orientation),
+                          XMQuaternionRotationNormal(XMVector3Normalize(simd::LoadVector(baseAngular)), angle));
+            XrPosef baseAt = xr::math::Pose::Multiply(base, baseRotation);
+            baseAt.position = {base.position.x + baseLinear.x * t,
+                               base.position.y + baseLinear.y * t,
+                               base.position.z + baseLinear.z * t};
+            XrPosef spaceAt = poses[i];
+            spaceAt.position = {poses[i].position.x + vectors[i].x * t,
+                                poses[i].position.y + vectors[i].y * t,
+                                poses[i].position.z + vectors[i].z * t};
+            return xr::math::Pose::Multiply(spaceAt, xr::math::Pose::Invert(baseAt)).position;
+        };
+        float maxVelocityError = 0.f;
+        for (size_t i = 0; i < k_batchSize; i++) {
+            const XrVector3f after = spaceInBaseAt(i, k_dt);
+            const XrVector3f before = spaceInBaseAt(i, -k_dt);
+            maxVelocityError = std::max({maxVelocityError,
+                                         std::abs(velocities[i].x - (after.x - before.x) / (2 * k_dt)),
+                                         std::abs(velocities[i].y - (after.y - before.y) / (2 * k_dt)),
+                                         std::abs(velocities[i].z - (after.z - before.z) / (2 * k_dt))});
+        }
+
+        printf("max error: %g\n", maxError);
+        printf("max velocity error: %g\n", maxVelocityError);
+        if (maxError > 1e-4f) {
+            std::cerr << "The SIMD pose math does not match xr::math::Pose\n";
+            return 1;
+        }
+        // The finite differences are only accurate to the square of the time step, and to the float precision of the
+        // positions divided by the time step.
+        if (maxVelocityError > 1e-3f) {
+            std::cerr << "The SIMD relative velocity does not match the motion of the spaces\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    void printUsage(const char* program) {
+        std::cerr << "usage: " << program
+                  << " [-api <d3d11|d3d12|vulkan|opengl|all>] [-scenario <name|all>] [-frames <count>]"
+                     " [-warmup <count>] [-runtime <path>] [-pvr <path>] [-csv <path>]\n";
+        std::cerr << "       " << program << " -math <batches>\n";
+        std::cerr << "scenarios:";
+        for (const auto& scenario : k_scenarios) {
+            std::cerr << " " << scenario.name;
+        }
+        std::cerr << "\n";
+    }
+
+    std::string formatDistribution(const Distribution& distribution) {
+        char buf[64];
+        sprintf_s(buf, "%8.1f %8.1f", distribution.percentile(50), distribution.percentile(99));
+        return buf;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string api = "all";
+    std::string scenarioName = "all";
+    uint32_t frames = 1000;
+    uint32_t warmupFrames = 200;
+    std::filesystem::path runtimePath;
+    std::filesystem::path csvPath;
+    uint32_t mathBatches = 0;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const std::string value(argv[++i]);
+        if (arg == "-api") {
+            api = value;
+        } else if (arg == "-scenario") {
+            scenarioName = value;
+        } else if (arg == "-frames") {
+            frames = std::stoul(value);
+        } else if (arg == "-warmup") {
+            warmupFrames = std::stoul(value);
+        } else if (arg == "-runtime") {
+            runtimePath = value;
+        } else if (arg == "-pvr") {
+            // Substitute the PVR client, typically with the mock from pvr-mock, to run without a headset.
+            SetEnvironmentVariableA("PIMAX_OPENXR_PVR_CLIENT", value.c_str());
+        } else if (arg == "-csv") {
+            csvPath = value;
+        } else if (arg == "-math") {
+            mathBatches = std::stoul(value);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mathBatches) {
+        return runPoseMathBenchmark(mathBatches);
+    }
+
+    // By default, use the runtime built alongside the benchmark.
+    if (runtimePath.empty()) {
+        wchar_t path[MAX_PATH];
+        GetModuleFileNameW(nullptr, path, MAX_PATH);
+        runtimePath = std::filesystem::path(path).parent_path() / L"pimax-openxr.dll";
+    }
+
+    std::vector<std::string> apis;
+    if (api == "all") {
+        apis = {"d3d11", "d3d12", "vulkan", "opengl"};
+    } else {
+        apis = {api};
+    }
+    std::vector<const Scenario*> scenarios;
+    for (const auto& scenario : k_scenarios) {
+        if (scenarioName == "all" || scenarioName == scenario.name) {
+            scenarios.push_back(&scenario);
+        }
+    }
+    if (scenarios.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty()) {
+        csv.open(csvPath, std::ios_base::trunc);
+        csv << "api,scenario,frames,wait_frame_p50_us,wait_frame_p99_us,pvr_wait_p50_us,begin_frame_p50_us,"
+               "swapchains_p50_us,end_frame_p50_us,end_frame_p99_us,pvr_end_frame_p50_us,precomposition_gpu_p50_us,"
+               "precomposition_gpu_p99_us,end_frame_allocations_mean\n";
+    }
+
+    int retval = 0;
+    try {
+        loadRuntime(runtimePath);
+
+        printf("%-8s %-20s %17s %17s %17s %17s %17s %17s %17s %8s\n",
+               "",
+               "",
+               "xrWaitFrame",
+               "(PVR wait)",
+               "xrBeginFrame",
+               "swapchains",
+               "xrEndFrame",
+               "(pvr_endFrame)",
+               "precomp. GPU",
+               "allocs");
+        printf("%-8s %-20s", "api", "scenario");
+        for (int i = 0; i < 7; i++) {
+            printf(" %8s %8s", "p50 us", "p99 us");
+        }
+        printf(" %8s\n", "mean");
+
+        for (const auto& apiName : apis) {
+            for (const Scenario* scenario : scenarios) {
+                try {
+                    // The graphics device must outlive the session.
+                    const auto backend = createBackend(apiName);
+                    const Results results = runScenario(*backend, *scenario, frames, warmupFrames);
+
+                    printf("%-8s %-20s %s %s %s %s %s %s %s %8.1f\n",
+                           apiName.c_str(),
+                           scenario->name,
+                           formatDistribution(results.waitFrame).c_str(),
+                           formatDistribution(results.pvrWait).c_str(),
+                           formatDistribution(results.beginFrame).c_str(),
+                           formatDistribution(results.swapchains).c_str(),
+                           formatDistribution(results.endFrame).c_str(),
+                           formatDistribution(results.pvrEndFrame).c_str(),
+                           formatDistribution(results.precompositionGpu).c_str(),
+                           results.endFrameAllocations.mean());
+
+                    if (csv.is_open()) {
+                        csv << apiName << "," << scenario->name << "," << results.frames << ","
+                            << results.waitFrame.percentile(50) << "," << results.waitFrame.percentile(99) << ","
+                            << results.pvrWait.percentile(50) << "," << results.beginFrame.percentile(50) << ","
+                            << results.swapchains.percentile(50) << "," << results.endFrame.percentile(50) << ","
+                            << results.endFrame.percentile(99) << "," << results.pvrEndFrame.percentile(50) << ","
+                            << results.precompositionGpu.percentile(50) << ","
+                            << results.precompositionGpu.percentile(99) << "," << results.endFrameAllocations.mean()
+                            << "\n";
+                    }
+                } catch (std::exception& exc) {
+                    std::cerr << apiName << " " << scenario->name << ": " << exc.what() << "\n";
+                    retval = 1;
+                }
+            }
+        }
+    } catch (std::exception& exc) {
+        std::cerr << exc.what() << "\n";
+        retval = 1;
+    }
+
+    return retval;
+}
@@ -177,6 +177,253 @@ namespace util {
     }
 } // namespace util
 
+// A low-overhead alternative to tracing every call, enabled by setting the PVR_LOGGER_PROFILE environment variable to
+// the reporting period in seconds. Each call only records its function and its start and end times into a ring owned
+// by the calling thread. A background thread drains the rings and periodically reports latency percentiles for each
+// function, as PVR_Profile events.
+namespace profiler {
+
+#define PROFILED_FUNCTIONS(_)                                                                                          \
+    _(initialise)                                                                                                      \
+    _(shutdown)                                                                                                        \
+    _(getVersionString)                                                                                                \
+    _(getTimeSeconds)                                                                                                  \
+    _(getTrackingState)                                                                                                \
+    _(getTrackedDevicePoseState)                                                                                       \
+    _(createTextureSwapChainDX)                                                                                        \
+    _(destroyTextureSwapChain)                                                                                         \
+    _(getTextureSwapChainCurrentIndex)                                                                                 \
+    _(commitTextureSwapChain)                                                                                          \
+    _(getPredictedDisplayTime)                                                                                         \
+    _(beginFrame)                                                                                                      \
+    _(endFrame)                                                                                                        \
+    _(waitToBeginFrame)                                                                                                \
+    _(submitFrame)                                                                                                     \
+    _(getFloatConfig)                                                                                                  \
+    _(setFloatConfig)                                                                                                  \
+    _(getIntConfig)                                                                                                    \
+    _(setIntConfig)                                                                                                    \
+    _(getStringConfig)                                                                                                 \
+    _(setStringConfig)                                                                                                 \
+    _(getVector3fConfig)                                                                                               \
+    _(setVector3fConfig)                                                                                               \
+    _(getQuatfConfig)                                                                                                  \
+    _(setQuatfConfig)                                                                                                  \
+    _(getInt64Config)                                                                                                  \
+    _(setInt64Config)                                                                                                  \
+    _(getTrackedDeviceFloatProperty)                                                                                   \
+    _(getTrackedDeviceIntProperty)                                                                                     \
+    _(getTrackedDeviceStringProperty)                                                                                  \
+    _(getTrackedDeviceVector3fProperty)                                                                                \
+    _(getTrackedDeviceQuatfProperty)                                                                                   \
+    _(getTrackedDeviceInt64Property)                                                                                   \
+    _(logMessage)                                                                                                      \
+    _(getInputState)                                                                                                   \
+    _(triggerHapticPulse)                                                                                              \
+    _(getEyeTrackingInfo)
+
+    enum class ProfiledFunction : uint32_t {
+#define _ENTRY(name) name,
+        PROFILED_FUNCTIONS(_ENTRY)
+#undef _ENTRY
+        Count
+    };
+
+    constexpr const char* k_functionNames[] = {
+#define _ENTRY(name) "PVR_" #name,
+        PROFILED_FUNCTIONS(_ENTRY)
+#undef _ENTRY
+    };
+
+    struct Record {
+        ProfiledFunction function;
+        int64_t start;
+        int64_t end;
+    };
+
+    // The records of one thread. The owning thread is the only producer, and the profiler thread the only consumer.
+    struct ThreadRing {
+        static constexpr size_t k_capacity = 8192;
+
+        DWORD threadId{GetCurrentThreadId()};
+        std::atomic<bool> hasExited{false};
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        // Only accessed by the profiler thread.
+        uint64_t droppedDrained{0};
+        Record records[k_capacity];
+    };
+
+    std::atomic<bool> g_isProfiling{false};
+    std::chrono::milliseconds g_reportPeriod{5000};
+    std::mutex g_ringsLock;
+    std::vector<std::shared_ptr<ThreadRing>> g_rings;
+
+    // Flags the ring of the thread when it exits, so that the profiler thread releases it once drained.
+    struct ThreadRingOwner {
+        ThreadRingOwner() : ring(std::make_shared<ThreadRing>()) {
+            std::unique_lock lock(g_ringsLock);
+            g_rings.push_back(ring);
+        }
+
+        ~ThreadRingOwner() {
+            ring->hasExited = true;
+        }
+
+        std::shared_ptr<ThreadRing> ring;
+    };
+
+    inline ThreadRing& getThreadRing() {
+        thread_local ThreadRingOwner owner;
+        return *owner.ring;
+    }
+
+    inline int64_t now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    class ProfileScope {
+      public:
+        explicit ProfileScope(ProfiledFunction function) : m_function(function), m_start(now()) {
+        }
+
+        ~ProfileScope() {
+            const int64_t end = now();
+
+            ThreadRing& ring = getThreadRing();
+            const uint64_t head = ring.head.load(std::memory_order_relaxed);
+            if (head - ring.tail.load(std::memory_order_acquire) >= ThreadRing::k_capacity) {
+                ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+            ring.records[head % ThreadRing::k_capacity] = {m_function, m_start, end};
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+
+      private:
+        const ProfiledFunction m_function;
+        const int64_t m_start;
+    };
+
+    // Drain the rings frequently enough for them not to overflow, and report at the end of each period.
+    void profilerThread() {
+        constexpr auto k_drainPeriod = std::chrono::milliseconds(50);
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const double ticksToUs = 1e6 / frequency.QuadPart;
+
+        std::vector<uint32_t> durationsUs[(size_t)ProfiledFunction::Count];
+        std::set<DWORD> threadIds[(size_t)ProfiledFunction::Count];
+        uint64_t dropped = 0;
+        auto reportTime = std::chrono::steady_clock::now() + g_reportPeriod;
+        while (true) {
+            std::this_thread::sleep_for(k_drainPeriod);
+
+            {
+                std::unique_lock lock(g_ringsLock);
+
+                for (auto it = g_rings.begin(); it != g_rings.end();) {
+                    ThreadRing& ring = **it;
+                    const bool hasExited = ring.hasExited.load();
+                    const uint64_t head = ring.head.load(std::memory_order_acquire);
+                    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+                    for (; tail < head; tail++) {
+                        const Record& record = ring.records[tail % ThreadRing::k_capacity];
+                        durationsUs[(size_t)record.function].push_back(
+                            (uint32_t)((record.end - record.start) * ticksToUs));
+                        threadIds[(size_t)record.function].insert(ring.threadId);
+                    }
+                    ring.tail.store(tail, std::memory_order_release);
+                    // Count the drops of each ring as it is drained, since the ring may go away right after.
+                    const uint64_t ringDropped = ring.dropped.load(std::memory_order_relaxed);
+                    dropped += ringDropped - ring.droppedDrained;
+                    ring.droppedDrained = ringDropped;
+
+                    if (hasExited) {
+                        it = g_rings.erase(it);
+                    } else {
+                        it++;
+                    }
+                }
+            }
+
+            const auto currentTime = std::chrono::steady_clock::now();
+            if (currentTime < reportTime) {
+                continue;
+            }
+            const double periodUs =
+                std::chrono::duration<double, std::micro>(currentTime - (reportTime - g_reportPeriod)).count();
+            reportTime = currentTime + g_reportPeriod;
+
+            for (size_t i = 0; i < (size_t)ProfiledFunction::Count; i++) {
+                auto& durations = durationsUs[i];
+                if (durations.empty()) {
+                    continue;
+                }
+
+                std::sort(durations.begin(), durations.end());
+                const auto percentile = [&](double p) {
+                    return durations[std::min((size_t)(p * durations.size()), durations.size() - 1)];
+                };
+                uint64_t totalUs = 0;
+                for (const auto duration : durations) {
+                    totalUs += duration;
+                }
+
+                TraceLoggingWrite(g_traceProvider,
+                                  "PVR_Profile",
+                                  TLArg(k_functionNames[i], "Function"),
+                                  TLArg(durations.size(), "Calls"),
+                                  TLArg(threadIds[i].size(), "Threads"),
+                                  TLArg(percentile(0.5), "P50Us"),
+                                  TLArg(percentile(0.9), "P90Us"),
+                                  TLArg(percentile(0.99), "P99Us"),
+                                  TLArg(durations.back(), "MaxUs"),
+                                  TLArg(totalUs, "TotalUs"),
+                                  TLArg(100.0 * totalUs / periodUs, "PercentOfPeriod"));
+                durations.clear();
+                threadIds[i].clear();
+            }
+
+            if (dropped) {
+                TraceLoggingWrite(g_traceProvider, "PVR_Profile_Dropped", TLArg(dropped, "Records"));
+            }
+            dropped = 0;
+        }
+    }
+
+    // Start profiling if requested, instead of tracing the calls.
+    void startProfiler() {
+        char value[32]{};
+        if (!GetEnvironmentVariableA("PVR_LOGGER_PROFILE", value, sizeof(value))) {
+            return;
+        }
+        const int periodSeconds = atoi(value);
+        if (periodSeconds <= 0) {
+            return;
+        }
+
+        g_reportPeriod = std::chrono::seconds(periodSeconds);
+        g_isProfiling = true;
+        TraceLoggingWrite(g_traceProvider, "PVR_Profile_Start", TLArg(periodSeconds, "PeriodSeconds"));
+
+        // This thread lives for as long as the process.
+        std::thread(profilerThread).detach();
+    }
+
+} // namespace profiler
+
+// Only record the call when profiling, skipping all the tracing.
+#define PROFILED_CALL(function, call)                                                                                  \
+    if (profiler::g_isProfiling.load(std::memory_order_relaxed)) {                                                     \
+        const profiler::ProfileScope profile(profiler::ProfiledFunction::function);                                    \
+        return call;                                                                                                   \
+    }
+
 namespace {
     using namespace util;
 
@@ -189,6 +436,8 @@ namespace {
     bool g_realPvrInterfaceD3DValid = false;
 
     pvrResult wrapper_initialise() {
+        PROFILED_CALL(initialise, g_realPvrInterface.initialise());
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_initialize");
@@ -199,6 +448,8 @@ namespace {
     }
 
     void wrapper_shutdown() {
+        PROFILED_CALL(shutdown, g_realPvrInterface.shutdown());
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_shutdown");
@@ -207,6 +458,8 @@ namespace {
     }
 
     const char* wrapper_getVersionString() {
+        PROFILED_CALL(getVersionString, g_realPvrInterface.getVersionString());
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getVersionString");
@@ -217,6 +470,8 @@ namespace {
     }
 
     double wrapper_getTimeSeconds() {
+        PROFILED_CALL(getTimeSeconds, g_realPvrInterface.getTimeSeconds());
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getTimeSeconds");
@@ -227,6 +482,8 @@ namespace {
     }
 
     pvrResult wrapper_getTrackingState(pvrHmdHandle hmdh, double absTime, pvrTrackingState* state) {
+        PROFILED_CALL(getTrackingState, g_realPvrInterface.getTrackingState(hmdh, absTime, state));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getTrackingState", TLArg(absTime));
@@ -245,6 +502,9 @@ namespace {
                                                 pvrTrackedDeviceType device,
                                                 double absTime,
                                                 pvrPoseStatef* state) {
+        PROFILED_CALL(getTrackedDevicePoseState,
+                      g_realPvrInterface.getTrackedDevicePoseState(hmdh, device, absTime, state));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(
@@ -264,6 +524,9 @@ namespace {
                                                IUnknown* d3dPtr,
                                                const pvrTextureSwapChainDesc* desc,
                                                pvrTextureSwapChain* out_TextureSwapChain) {
+        PROFILED_CALL(createTextureSwapChainDX,
+                      g_realPvrInterfaceD3D.createTextureSwapChainDX(hmdh, d3dPtr, desc, out_TextureSwapChain));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -289,6 +552,8 @@ namespace {
     }
 
     void wrapper_destroyTextureSwapChain(pvrHmdHandle hmdh, pvrTextureSwapChain chain) {
+        PROFILED_CALL(destroyTextureSwapChain, g_realPvrInterface.destroyTextureSwapChain(hmdh, chain));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_destroyTextureSwapChain", TLPArg(chain));
@@ -297,6 +562,9 @@ namespace {
     }
 
     pvrResult wrapper_getTextureSwapChainCurrentIndex(pvrHmdHandle hmdh, pvrTextureSwapChain chain, int* out_Index) {
+        PROFILED_CALL(getTextureSwapChainCurrentIndex,
+                      g_realPvrInterface.getTextureSwapChainCurrentIndex(hmdh, chain, out_Index));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getTextureSwapChainCurrentIndex", TLPArg(chain));
@@ -310,6 +578,8 @@ namespace {
     }
 
     pvrResult wrapper_commitTextureSwapChain(pvrHmdHandle hmdh, pvrTextureSwapChain chain) {
+        PROFILED_CALL(commitTextureSwapChain, g_realPvrInterface.commitTextureSwapChain(hmdh, chain));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_commitTextureSwapChain", TLPArg(chain));
@@ -320,6 +590,8 @@ namespace {
     }
 
     double wrapper_getPredictedDisplayTime(pvrHmdHandle hmdh, long long frameIndex) {
+        PROFILED_CALL(getPredictedDisplayTime, g_realPvrInterface.getPredictedDisplayTime(hmdh, frameIndex));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getPredictedDisplayTime", TLArg(frameIndex));
@@ -330,6 +602,8 @@ namespace {
     }
 
     pvrResult wrapper_beginFrame(pvrHmdHandle hmdh, long long frameIndex) {
+        PROFILED_CALL(beginFrame, g_realPvrInterface.beginFrame(hmdh, frameIndex));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_beginFrame", TLArg(frameIndex));
@@ -351,6 +625,8 @@ namespace {
                                long long frameIndex,
                                pvrLayerHeader const* const* layerPtrList,
                                unsigned int layerCount) {
+        PROFILED_CALL(endFrame, g_realPvrInterface.endFrame(hmdh, frameIndex, layerPtrList, layerCount));
+
         TraceLocalActivity(local);
 
         // Frame rate counter for convenience.
@@ -427,6 +703,8 @@ namespace {
     }
 
     pvrResult wrapper_waitToBeginFrame(pvrHmdHandle hmdh, long long frameIndex) {
+        PROFILED_CALL(waitToBeginFrame, g_realPvrInterface.waitToBeginFrame(hmdh, frameIndex));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_waitToBeginFrame", TLArg(frameIndex));
@@ -440,6 +718,8 @@ namespace {
                                   long long frameIndex,
                                   pvrLayerHeader const* const* layerPtrList,
                                   unsigned int layerCount) {
+        PROFILED_CALL(submitFrame, g_realPvrInterface.submitFrame(hmdh, frameIndex, layerPtrList, layerCount));
+
         TraceLocalActivity(local);
 
         // Frame rate counter for convenience.
@@ -516,6 +796,8 @@ namespace {
     }
 
     float wrapper_getFloatConfig(pvrHmdHandle hmdh, const char* key, float def_val) {
+        PROFILED_CALL(getFloatConfig, g_realPvrInterface.getFloatConfig(hmdh, key, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getFloatConfig", TLArg(key), TLArg(def_val));
@@ -526,6 +808,8 @@ namespace {
     }
 
     pvrResult wrapper_setFloatConfig(pvrHmdHandle hmdh, const char* key, float val) {
+        PROFILED_CALL(setFloatConfig, g_realPvrInterface.setFloatConfig(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setFloatConfig", TLArg(key), TLArg(val));
@@ -536,6 +820,8 @@ namespace {
     }
 
     int wrapper_getIntConfig(pvrHmdHandle hmdh, const char* key, int def_val) {
+        PROFILED_CALL(getIntConfig, g_realPvrInterface.getIntConfig(hmdh, key, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getIntConfig", TLArg(key), TLArg(def_val));
@@ -546,6 +832,8 @@ namespace {
     }
 
     pvrResult wrapper_setIntConfig(pvrHmdHandle hmdh, const char* key, int val) {
+        PROFILED_CALL(setIntConfig, g_realPvrInterface.setIntConfig(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setIntConfig", TLArg(key), TLArg(val));
@@ -556,6 +844,8 @@ namespace {
     }
 
     int wrapper_getStringConfig(pvrHmdHandle hmdh, const char* key, char* val, int size) {
+        PROFILED_CALL(getStringConfig, g_realPvrInterface.getStringConfig(hmdh, key, val, size));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getStringConfig", TLArg(key));
@@ -566,6 +856,8 @@ namespace {
     }
 
     pvrResult wrapper_setStringConfig(pvrHmdHandle hmdh, const char* key, const char* val) {
+        PROFILED_CALL(setStringConfig, g_realPvrInterface.setStringConfig(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setStringConfig", TLArg(key), TLArg(val));
@@ -576,6 +868,8 @@ namespace {
     }
 
     pvrVector3f wrapper_getVector3fConfig(pvrHmdHandle hmdh, const char* key, pvrVector3f def_val) {
+        PROFILED_CALL(getVector3fConfig, g_realPvrInterface.getVector3fConfig(hmdh, key, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getVector3fConfig", TLArg(key), TLArg(ToString(def_val).c_str()));
@@ -586,6 +880,8 @@ namespace {
     }
 
     pvrResult wrapper_setVector3fConfig(pvrHmdHandle hmdh, const char* key, pvrVector3f val) {
+        PROFILED_CALL(setVector3fConfig, g_realPvrInterface.setVector3fConfig(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setVector3fConfig", TLArg(key), TLArg(ToString(val).c_str(), "val"));
@@ -596,6 +892,8 @@ namespace {
     }
 
     pvrQuatf wrapper_getQuatfConfig(pvrHmdHandle hmdh, const char* key, pvrQuatf def_val) {
+        PROFILED_CALL(getQuatfConfig, g_realPvrInterface.getQuatfConfig(hmdh, key, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getQuatfConfig", TLArg(key), TLArg(ToString(def_val).c_str()));
@@ -606,6 +904,8 @@ namespace {
     }
 
     pvrResult wrapper_setQuatfConfig(pvrHmdHandle hmdh, const char* key, pvrQuatf val) {
+        PROFILED_CALL(setQuatfConfig, g_realPvrInterface.setQuatfConfig(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setQuatfConfig", TLArg(key), TLArg(ToString(val).c_str(), "val"));
@@ -616,6 +916,8 @@ namespace {
     }
 
     int64_t wrapper_getInt64Config(pvrHmdHandle hmdh, const char* key, int64_t def_val) {
+        PROFILED_CALL(getInt64Config, g_realPvrInterface.getInt64Config(hmdh, key, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_getInt64Config", TLArg(key), TLArg(def_val));
@@ -626,6 +928,8 @@ namespace {
     }
 
     pvrResult wrapper_setInt64Config(pvrHmdHandle hmdh, const char* key, int64_t val) {
+        PROFILED_CALL(setInt64Config, g_realPvrInterface.setInt64Config(hmdh, key, val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_setInt64Config", TLArg(key), TLArg(val));
@@ -639,6 +943,9 @@ namespace {
                                                 pvrTrackedDeviceType device,
                                                 pvrTrackedDeviceProp prop,
                                                 float def_val) {
+        PROFILED_CALL(getTrackedDeviceFloatProperty,
+                      g_realPvrInterface.getTrackedDeviceFloatProperty(hmdh, device, prop, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -656,6 +963,9 @@ namespace {
                                             pvrTrackedDeviceType device,
                                             pvrTrackedDeviceProp prop,
                                             int def_val) {
+        PROFILED_CALL(getTrackedDeviceIntProperty,
+                      g_realPvrInterface.getTrackedDeviceIntProperty(hmdh, device, prop, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -671,6 +981,9 @@ namespace {
 
     int wrapper_getTrackedDeviceStringProperty(
         pvrHmdHandle hmdh, pvrTrackedDeviceType device, pvrTrackedDeviceProp prop, char* val, int size) {
+        PROFILED_CALL(getTrackedDeviceStringProperty,
+                      g_realPvrInterface.getTrackedDeviceStringProperty(hmdh, device, prop, val, size));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -687,6 +1000,9 @@ namespace {
                                                          pvrTrackedDeviceType device,
                                                          pvrTrackedDeviceProp prop,
                                                          pvrVector3f def_val) {
+        PROFILED_CALL(getTrackedDeviceVector3fProperty,
+                      g_realPvrInterface.getTrackedDeviceVector3fProperty(hmdh, device, prop, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -704,6 +1020,9 @@ namespace {
                                                    pvrTrackedDeviceType device,
                                                    pvrTrackedDeviceProp prop,
                                                    pvrQuatf def_val) {
+        PROFILED_CALL(getTrackedDeviceQuatfProperty,
+                      g_realPvrInterface.getTrackedDeviceQuatfProperty(hmdh, device, prop, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -721,6 +1040,9 @@ namespace {
                                                   pvrTrackedDeviceType device,
                                                   pvrTrackedDeviceProp prop,
                                                   int64_t def_val) {
+        PROFILED_CALL(getTrackedDeviceInt64Property,
+                      g_realPvrInterface.getTrackedDeviceInt64Property(hmdh, device, prop, def_val));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local,
@@ -735,6 +1057,8 @@ namespace {
     }
 
     void wrapper_logMessage(pvrLogLevel level, const char* message) {
+        PROFILED_CALL(logMessage, g_realPvrInterface.logMessage(level, message));
+
         TraceLocalActivity(local);
 
         TraceLoggingWriteStart(local, "PVR_logMessage", TLArg((int)level), TLArg(message));
@@ -742,6 +1066,22 @@ namespace {
         TraceLoggingWriteStop(local, "PVR_logMessage");
     }
 
+    // Functions that are only hooked for profiling, since tracing them would be too verbose.
+    pvrResult wrapper_getInputState(pvrHmdHandle hmdh, pvrInputState* inputState) {
+        const profiler::ProfileScope profile(profiler::ProfiledFunction::getInputState);
+        return g_realPvrInterface.getInputState(hmdh, inputState);
+    }
+
+    pvrResult wrapper_triggerHapticPulse(pvrHmdHandle hmdh, pvrTrackedDeviceType device, float intensity) {
+        const profiler::ProfileScope profile(profiler::ProfiledFunction::triggerHapticPulse);
+        return g_realPvrInterface.triggerHapticPulse(hmdh, device, intensity);
+    }
+
+    pvrResult wrapper_getEyeTrackingInfo(pvrHmdHandle hmdh, double absTime, pvrEyeTrackingInfo* outInfo) {
+        const profiler::ProfileScope profile(profiler::ProfiledFunction::getEyeTrackingInfo);
+        return g_realPvrInterface.getEyeTrackingInfo(hmdh, absTime, outInfo);
+    }
+
     // Entry point for patching the dispatch table for graphics calls.
     void* wrapper_getDxGlInterface(const char* api) {
         TraceLocalActivity(local);
@@ -783,6 +1123,7 @@ namespace {
         TraceLoggingWriteStart(local, "PVR_getInterface", TLArg(modulePath), TLArg(major_ver), TLArg(minor_ver));
         if (!g_realPvrLibrary) {
             *g_realPvrLibrary.put() = LoadLibraryA("real" PVRCLIENT_DLL_NAME);
+            profiler::startProfiler();
         }
         if (g_realPvrLibrary) {
             const auto realGetPvrInterface =
@@ -831,6 +1172,11 @@ namespace {
                     result->getTrackedDeviceQuatfProperty = wrapper_getTrackedDeviceQuatfProperty;
                     result->getTrackedDeviceInt64Property = wrapper_getTrackedDeviceInt64Property;
                     result->logMessage = wrapper_logMessage;
+                    if (profiler::g_isProfiling) {
+                        result->getInputState = wrapper_getInputState;
+                        result->triggerHapticPulse = wrapper_triggerHapticPulse;
+                        result->getEyeTrackingInfo = wrapper_getEyeTrackingInfo;
+                    }
 
                     // result->getDxGlInterface = wrapper_getDxGlInterface;
                 }
@@ -878,9 +1224,6 @@ namespace {
     pvrResult wrapper_getTrackedDeviceCaps(pvrHmdHandle hmdh, pvrTrackedDeviceType device, uint32_t* pcap) {
     }
 
-    pvrResult wrapper_getInputState(pvrHmdHandle hmdh, pvrInputState* inputState) {
-    }
-
     pvrResult wrapper_getFovTextureSize(
         pvrHmdHandle hmdh, pvrEyeType eye, pvrFovPort fov, float pixelsPerDisplayPixel, pvrSizei* size) {
     }
@@ -934,9 +1277,6 @@ namespace {
     pvrResult wrapper_getTrackerPose(pvrHmdHandle hmdh, unsigned int idx, pvrTrackerPose* pose) {
     }
 
-    pvrResult wrapper_triggerHapticPulse(pvrHmdHandle hmdh, pvrTrackedDeviceType device, float intensity) {
-    }
-
     pvrResult wrapper_getConnectedDevices(pvrHmdHandle hmdh, uint32_t* pDevices) {
     }
 
@@ -955,9 +1295,6 @@ namespace {
     pvrResult wrapper_getGripLimitSkeletalData(pvrHmdHandle hmdh, pvrTrackedDeviceType device, pvrSkeletalData* data) {
     }
 
-    pvrResult wrapper_getEyeTrackingInfo(pvrHmdHandle hmdh, double absTime, pvrEyeTrackingInfo* outInfo) {
-    }
-
     pvrResult wrapper_getTextureSwapChainBufferDX(
         pvrHmdHandle hmdh, pvrTextureSwapChain chain, int index, IID iid, void** out_Buffer) {
     }
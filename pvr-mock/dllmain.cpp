@@ -0,0 +1,1009 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+// A mock of the PVR client library, standing in for libPVRClient64.dll and pi_server, so that the runtime can be
+// exercised without a headset. The mock simulates the compositor frame pacing, serves synthetic or recorded pose and
+// input streams, and records what is submitted with pvr_endFrame().
+//
+// The mock is configured with environment variables:
+//   PVR_MOCK_REFRESH_RATE     Display refresh rate in Hz (default 90).
+//   PVR_MOCK_RESOLUTION       Per-eye panel resolution, as <width>x<height> (default 2448x2448).
+//   PVR_MOCK_FOV              Horizontal and vertical field of view of each eye, in degrees (default 100).
+//   PVR_MOCK_LATENCY_MS       Time from the start of a frame to its display (default 2 frame periods).
+//   PVR_MOCK_END_FRAME_US     Time spent in pvr_endFrame(), to simulate the compositor submission cost (default 0).
+//   PVR_MOCK_CONTROLLER       Type of the controllers, or "none" (default pimax_crystal).
+//   PVR_MOCK_POSE_STREAM      CSV file of poses, with rows: <time>,<hmd|left|right>,<px>,<py>,<pz>,<qx>,<qy>,<qz>,<qw>.
+//   PVR_MOCK_INPUT_STREAM     CSV file of inputs, with rows: <time>,<left|right>,<buttons>,<touches>,<trigger>,<grip>,
+//                             <joystick x>,<joystick y>.
+//   PVR_MOCK_RECORD           CSV file to record each submitted frame to.
+//
+// Streams are played back in a loop, with times in seconds relative to pvr_initialise(). Without a pose stream, the
+// headset slowly looks left and right and the controllers follow it.
+//
+// To use the mock, point the runtime to it with the PIMAX_OPENXR_PVR_CLIENT environment variable.
+
+namespace {
+
+    using Microsoft::WRL::ComPtr;
+
+    constexpr int k_swapchainLength = 3;
+    constexpr int k_framesInFlight = 16;
+
+    struct Config {
+        float refreshRate{90.f};
+        int width{2448};
+        int height{2448};
+        float fov{100.f};
+        double latency{0};
+        double endFrameCost{0};
+        std::string controllerType{"pimax_crystal"};
+        std::string poseStreamPath;
+        std::string inputStreamPath;
+        std::string recordPath;
+    };
+
+    struct PoseSample {
+        double time;
+        pvrPosef pose;
+    };
+
+    struct InputSample {
+        double time;
+        uint32_t buttons;
+        uint32_t touches;
+        float trigger;
+        float grip;
+        pvrVector2f joystick;
+    };
+
+    struct Swapchain {
+        pvrTextureSwapChainDesc desc;
+        std::vector<ComPtr<ID3D11Texture2D>> images;
+        int currentIndex{0};
+    };
+
+    struct MirrorTexture {
+        ComPtr<ID3D11Texture2D> texture;
+    };
+
+    std::mutex g_globalLock;
+    Config g_config;
+    pvrInterface g_interface{};
+    pvrD3DInterface g_interfaceD3D{};
+    int g_hmd;
+
+    LARGE_INTEGER g_qpcFrequency;
+    double g_epoch;
+    double g_framePeriod;
+
+    // Frame pacing: a frame may begin on the first vsync after the previous frame was submitted.
+    double g_nextFrameVsync;
+    long long g_frameVsyncIndex[k_framesInFlight];
+    double g_frameVsync[k_framesInFlight];
+    uint64_t g_framesSubmitted;
+    double g_lastSubmitTime;
+    float g_fps;
+
+    // Streams, indexed by pvrTrackedDeviceType for poses and by side for inputs.
+    std::vector<PoseSample> g_poseStreams[3];
+    double g_poseStreamDuration;
+    std::vector<InputSample> g_inputStreams[2];
+    double g_inputStreamDuration;
+
+    std::unordered_map<std::string, int> g_intConfigs;
+    std::unordered_map<std::string, float> g_floatConfigs;
+    std::unordered_map<std::string, std::string> g_stringConfigs;
+
+    std::ofstream g_record;
+
+    std::optional<std::string> getEnvironment(const char* name) {
+        char value[MAX_PATH];
+        const DWORD length = GetEnvironmentVariableA(name, value, sizeof(value));
+        if (!length || length >= sizeof(value)) {
+            return {};
+        }
+        return std::string(value, length);
+    }
+
+    void loadConfig() {
+        g_config = {};
+        if (const auto value = getEnvironment("PVR_MOCK_REFRESH_RATE")) {
+            g_config.refreshRate = std::stof(value.value());
+        }
+        if (const auto value = getEnvironment("PVR_MOCK_RESOLUTION")) {
+            sscanf_s(value.value().c_str(), "%dx%d", &g_config.width, &g_config.height);
+        }
+        if (const auto value = getEnvironment("PVR_MOCK_FOV")) {
+            g_config.fov = std::stof(value.value());
+        }
+        g_config.latency = 2.0 / g_config.refreshRate;
+        if (const auto value = getEnvironment("PVR_MOCK_LATENCY_MS")) {
+            g_config.latency = std::stod(value.value()) / 1000;
+        }
+        if (const auto value = getEnvironment("PVR_MOCK_END_FRAME_US")) {
+            g_config.endFrameCost = std::stod(value.value()) / 1000000;
+        }
+        if (const auto value = getEnvironment("PVR_MOCK_CONTROLLER")) {
+            g_config.controllerType = value.value() != "none" ? value.value() : "";
+        }
+        g_config.poseStreamPath = getEnvironment("PVR_MOCK_POSE_STREAM").value_or("");
+        g_config.inputStreamPath = getEnvironment("PVR_MOCK_INPUT_STREAM").value_or("");
+        g_config.recordPath = getEnvironment("PVR_MOCK_RECORD").value_or("");
+    }
+
+    int deviceIndex(const std::string& name) {
+        if (name == "hmd") {
+            return 0;
+        } else if (name == "left") {
+            return 1;
+        } else if (name == "right") {
+            return 2;
+        }
+        return -1;
+    }
+
+    void loadStreams() {
+        for (auto& stream : g_poseStreams) {
+            stream.clear();
+        }
+        g_poseStreamDuration = 0;
+        if (!g_config.poseStreamPath.empty()) {
+            std::ifstream file(g_config.poseStreamPath);
+            std::string line;
+            while (std::getline(file, line)) {
+                char device[16]{};
+                PoseSample sample{};
+                pvrPosef& pose = sample.pose;
+                if (sscanf_s(line.c_str(),
+                             "%lf,%15[^,],%f,%f,%f,%f,%f,%f,%f",
+                             &sample.time,
+                             device,
+                             (unsigned)sizeof(device),
+                             &pose.Position.x,
+                             &pose.Position.y,
+                             &pose.Position.z,
+                             &pose.Orientation.x,
+                             &pose.Orientation.y,
+                             &pose.Orientation.z,
+                             &pose.Orientation.w) != 9) {
+                    continue;
+                }
+                const int index = deviceIndex(device);
+                if (index >= 0) {
+                    g_poseStreams[index].push_back(sample);
+                    g_poseStreamDuration = std::max(g_poseStreamDuration, sample.time);
+                }
+            }
+        }
+
+        for (auto& stream : g_inputStreams) {
+            stream.clear();
+        }
+        g_inputStreamDuration = 0;
+        if (!g_config.inputStreamPath.empty()) {
+            std::ifstream file(g_config.inputStreamPath);
+            std::string line;
+            while (std::getline(file, line)) {
+                char side[16]{};
+                InputSample sample{};
+                if (sscanf_s(line.c_str(),
+                             "%lf,%15[^,],%u,%u,%f,%f,%f,%f",
+                             &sample.time,
+                             side,
+                             (unsigned)sizeof(side),
+                             &sample.buttons,
+                             &sample.touches,
+                             &sample.trigger,
+                             &sample.grip,
+                             &sample.joystick.x,
+                             &sample.joystick.y) != 8) {
+                    continue;
+                }
+                const int index = deviceIndex(side) - 1;
+                if (index >= 0) {
+                    g_inputStreams[index].push_back(sample);
+                    g_inputStreamDuration = std::max(g_inputStreamDuration, sample.time);
+                }
+            }
+        }
+
+        // Streams must be sorted for lookups.
+        const auto byTime = [](const auto& a, const auto& b) { return a.time < b.time; };
+        for (auto& stream : g_poseStreams) {
+            std::stable_sort(stream.begin(), stream.end(), byTime);
+        }
+        for (auto& stream : g_inputStreams) {
+            std::stable_sort(stream.begin(), stream.end(), byTime);
+        }
+    }
+
+    double now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return (double)counter.QuadPart / g_qpcFrequency.QuadPart;
+    }
+
+    double nextVsyncAfter(double time) {
+        return g_epoch + std::ceil((time - g_epoch) / g_framePeriod) * g_framePeriod;
+    }
+
+    // Sleep until the given time, with sub-millisecond precision.
+    void waitUntil(double time) {
+        static thread_local wil::unique_handle timer(
+            CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
+
+        const double sleepUntil = time - 0.0005;
+        double current = now();
+        if (timer && sleepUntil > current) {
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -(LONGLONG)((sleepUntil - current) * 10000000);
+            if (SetWaitableTimer(timer.get(), &dueTime, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer.get(), INFINITE);
+            }
+        }
+        while (now() < time) {
+            YieldProcessor();
+        }
+    }
+
+    pvrQuatf makeQuat(float x, float y, float z, float w) {
+        pvrQuatf result;
+        result.x = x;
+        result.y = y;
+        result.z = z;
+        result.w = w;
+        return result;
+    }
+
+    pvrQuatf multiply(const pvrQuatf& a, const pvrQuatf& b) {
+        pvrQuatf result;
+        result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+        result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+        result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+        result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+        return result;
+    }
+
+    pvrVector3f rotate(const pvrQuatf& q, const pvrVector3f& v) {
+        const pvrQuatf result = multiply(multiply(q, makeQuat(v.x, v.y, v.z, 0)), makeQuat(-q.x, -q.y, -q.z, q.w));
+        return {result.x, result.y, result.z};
+    }
+
+    pvrPosef compose(const pvrPosef& a, const pvrPosef& b) {
+        pvrPosef result;
+        const pvrVector3f offset = rotate(a.Orientation, b.Position);
+        result.Position = {a.Position.x + offset.x, a.Position.y + offset.y, a.Position.z + offset.z};
+        result.Orientation = multiply(a.Orientation, b.Orientation);
+        return result;
+    }
+
+    pvrPosef interpolate(const pvrPosef& a, const pvrPosef& b, float t) {
+        pvrPosef result;
+        result.Position.x = a.Position.x + (b.Position.x - a.Position.x) * t;
+        result.Position.y = a.Position.y + (b.Position.y - a.Position.y) * t;
+        result.Position.z = a.Position.z + (b.Position.z - a.Position.z) * t;
+
+        // Normalized linear interpolation along the shortest path is plenty for densely sampled streams.
+        const float dot = a.Orientation.x * b.Orientation.x + a.Orientation.y * b.Orientation.y +
+                          a.Orientation.z * b.Orientation.z + a.Orientation.w * b.Orientation.w;
+        const float sign = dot < 0 ? -1.f : 1.f;
+        pvrQuatf& q = result.Orientation;
+        q.x = a.Orientation.x + (sign * b.Orientation.x - a.Orientation.x) * t;
+        q.y = a.Orientation.y + (sign * b.Orientation.y - a.Orientation.y) * t;
+        q.z = a.Orientation.z + (sign * b.Orientation.z - a.Orientation.z) * t;
+        q.w = a.Orientation.w + (sign * b.Orientation.w - a.Orientation.w) * t;
+        const float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        q.x /= length;
+        q.y /= length;
+        q.z /= length;
+        q.w /= length;
+        return result;
+    }
+
+    // Returns false if the device is not tracked at this time.
+    bool samplePose(
+        int device, double absTime, pvrPosef& pose, pvrVector3f& linearVelocity, pvrVector3f& angularVelocity) {
+        linearVelocity = {};
+        angularVelocity = {};
+
+        if (!g_config.poseStreamPath.empty()) {
+            const auto& stream = g_poseStreams[device];
+            if (stream.empty()) {
+                return false;
+            }
+            double time = absTime - g_epoch;
+            if (g_poseStreamDuration > 0) {
+                time = std::fmod(std::max(time, 0.0), g_poseStreamDuration);
+            }
+            auto next = std::upper_bound(
+                stream.begin(), stream.end(), time, [](double t, const PoseSample& sample) { return t < sample.time; });
+            if (next == stream.begin()) {
+                pose = next->pose;
+            } else if (next == stream.end()) {
+                pose = stream.back().pose;
+            } else {
+                const auto& previous = *(next - 1);
+                const double span = next->time - previous.time;
+                const float t = span > 0 ? (float)((time - previous.time) / span) : 0.f;
+                pose = interpolate(previous.pose, next->pose, t);
+                linearVelocity.x = (float)((next->pose.Position.x - previous.pose.Position.x) / span);
+                linearVelocity.y = (float)((next->pose.Position.y - previous.pose.Position.y) / span);
+                linearVelocity.z = (float)((next->pose.Position.z - previous.pose.Position.z) / span);
+            }
+            return true;
+        }
+
+        if (device != 0 && g_config.controllerType.empty()) {
+            return false;
+        }
+
+        // The headset looks left and right by 15 degrees every 5 seconds.
+        constexpr double amplitude = 15 * 3.14159265358979 / 180;
+        constexpr double frequency = 0.2;
+        const double phase = 2 * 3.14159265358979 * frequency * (absTime - g_epoch);
+        const float yaw = (float)(amplitude * std::sin(phase));
+        pvrPosef headPose{};
+        headPose.Orientation = makeQuat(0, std::sin(yaw / 2), 0, std::cos(yaw / 2));
+        if (device == 0) {
+            pose = headPose;
+            angularVelocity.y = (float)(amplitude * 2 * 3.14159265358979 * frequency * std::cos(phase));
+            return true;
+        }
+
+        // The controllers are held in front of the headset.
+        pvrPosef controllerPose{};
+        controllerPose.Position = {device == 1 ? -0.2f : 0.2f, -0.3f, -0.4f};
+        controllerPose.Orientation = makeQuat(0, 0, 0, 1);
+        pose = compose(headPose, controllerPose);
+        return true;
+    }
+
+    const InputSample* sampleInput(int side, double absTime) {
+        const auto& stream = g_inputStreams[side];
+        if (stream.empty()) {
+            return nullptr;
+        }
+        double time = absTime - g_epoch;
+        if (g_inputStreamDuration > 0) {
+            time = std::fmod(std::max(time, 0.0), g_inputStreamDuration);
+        }
+        auto next = std::upper_bound(
+            stream.begin(), stream.end(), time, [](double t, const InputSample& sample) { return t < sample.time; });
+        return next == stream.begin() ? nullptr : &*(next - 1);
+    }
+
+    DXGI_FORMAT getDxgiFormat(pvrTextureFormat format, bool typeless) {
+        switch (format) {
+        case PVR_FORMAT_R8G8B8A8_UNORM:
+            return typeless ? DXGI_FORMAT_R8G8B8A8_TYPELESS : DXGI_FORMAT_R8G8B8A8_UNORM;
+        case PVR_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return typeless ? DXGI_FORMAT_R8G8B8A8_TYPELESS : DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case PVR_FORMAT_B8G8R8A8_UNORM:
+            return typeless ? DXGI_FORMAT_B8G8R8A8_TYPELESS : DXGI_FORMAT_B8G8R8A8_UNORM;
+        case PVR_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return typeless ? DXGI_FORMAT_B8G8R8A8_TYPELESS : DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        case PVR_FORMAT_B8G8R8X8_UNORM:
+            return typeless ? DXGI_FORMAT_B8G8R8X8_TYPELESS : DXGI_FORMAT_B8G8R8X8_UNORM;
+        case PVR_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return typeless ? DXGI_FORMAT_B8G8R8X8_TYPELESS : DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+        case PVR_FORMAT_R16G16B16A16_FLOAT:
+            return typeless ? DXGI_FORMAT_R16G16B16A16_TYPELESS : DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case PVR_FORMAT_D16_UNORM:
+            return typeless ? DXGI_FORMAT_R16_TYPELESS : DXGI_FORMAT_D16_UNORM;
+        case PVR_FORMAT_D24_UNORM_S8_UINT:
+            return typeless ? DXGI_FORMAT_R24G8_TYPELESS : DXGI_FORMAT_D24_UNORM_S8_UINT;
+        case PVR_FORMAT_D32_FLOAT:
+            return typeless ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_D32_FLOAT;
+        case PVR_FORMAT_D32_FLOAT_S8X24_UINT:
+            return typeless ? DXGI_FORMAT_R32G8X24_TYPELESS : DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    const char* getLayerTypeName(pvrLayerType type) {
+        switch (type) {
+        case pvrLayerType_EyeFov:
+            return "EyeFov";
+        case pvrLayerType_EyeFovDepth:
+            return "EyeFovDepth";
+        case pvrLayerType_Quad:
+            return "Quad";
+        default:
+            return "Unknown";
+        }
+    }
+
+    pvrResult mock_initialise() {
+        std::unique_lock lock(g_globalLock);
+
+        loadConfig();
+        loadStreams();
+
+        QueryPerformanceFrequency(&g_qpcFrequency);
+        g_epoch = now();
+        g_framePeriod = 1.0 / g_config.refreshRate;
+        g_nextFrameVsync = 0;
+        for (auto& index : g_frameVsyncIndex) {
+            index = -1;
+        }
+        g_framesSubmitted = 0;
+        g_lastSubmitTime = 0;
+        g_fps = 0;
+
+        g_intConfigs.clear();
+        g_floatConfigs.clear();
+        g_stringConfigs.clear();
+
+        if (!g_config.recordPath.empty()) {
+            g_record.open(g_config.recordPath, std::ios_base::trunc);
+            g_record << "frame_index,submit_time,wait_time_ms,layer_count,layers\n";
+        }
+
+        return pvr_success;
+    }
+
+    void mock_shutdown() {
+        std::unique_lock lock(g_globalLock);
+
+        if (g_record.is_open()) {
+            g_record.close();
+        }
+    }
+
+    const char* mock_getVersionString() {
+        return "PVR mock";
+    }
+
+    double mock_getTimeSeconds() {
+        return now();
+    }
+
+    pvrResult mock_createHmd(pvrHmdHandle* phmdh) {
+        *phmdh = reinterpret_cast<pvrHmdHandle>(&g_hmd);
+        return pvr_success;
+    }
+
+    void mock_destroyHmd(pvrHmdHandle hmdh) {
+    }
+
+    pvrResult mock_getHmdInfo(pvrHmdHandle hmdh, pvrHmdInfo* outInfo) {
+        *outInfo = {};
+        outInfo->VendorId = 0x34A4;
+        outInfo->ProductId = 0xFFFF;
+        sprintf_s(outInfo->Manufacturer, sizeof(outInfo->Manufacturer), "Pimax");
+        sprintf_s(outInfo->ProductName, sizeof(outInfo->ProductName), "PVR mock");
+        sprintf_s(outInfo->SerialNumber, sizeof(outInfo->SerialNumber), "MOCK-0000");
+        outInfo->Resolution.w = g_config.width * 2;
+        outInfo->Resolution.h = g_config.height;
+        return pvr_success;
+    }
+
+    pvrResult mock_getEyeDisplayInfo(pvrHmdHandle hmdh, pvrEyeType eye, pvrDisplayInfo* outInfo) {
+        *outInfo = {};
+
+        // The runtime creates its devices on the adapter of the headset, so report the primary adapter.
+        ComPtr<IDXGIFactory1> factory;
+        ComPtr<IDXGIAdapter1> adapter;
+        DXGI_ADAPTER_DESC1 desc;
+        if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(factory.ReleaseAndGetAddressOf()))) &&
+            SUCCEEDED(factory->EnumAdapters1(0, adapter.ReleaseAndGetAddressOf())) &&
+            SUCCEEDED(adapter->GetDesc1(&desc))) {
+            static_assert(sizeof(outInfo->luid) == sizeof(LUID));
+            memcpy(&outInfo->luid, &desc.AdapterLuid, sizeof(LUID));
+        }
+        outInfo->width = g_config.width;
+        outInfo->height = g_config.height;
+        outInfo->refresh_rate = g_config.refreshRate;
+        return pvr_success;
+    }
+
+    pvrResult mock_getEyeRenderInfo(pvrHmdHandle hmdh, pvrEyeType eye, pvrEyeRenderInfo* outInfo) {
+        *outInfo = {};
+        const float tangent = std::tan(g_config.fov / 2 * 3.14159265f / 180);
+        outInfo->Fov.UpTan = outInfo->Fov.DownTan = outInfo->Fov.LeftTan = outInfo->Fov.RightTan = tangent;
+        outInfo->DistortedViewport.Pos.x = eye == pvrEye_Left ? 0 : g_config.width;
+        outInfo->DistortedViewport.Pos.y = 0;
+        outInfo->DistortedViewport.Size.w = g_config.width;
+        outInfo->DistortedViewport.Size.h = g_config.height;
+        outInfo->HmdToEyePose.Orientation = makeQuat(0, 0, 0, 1);
+        outInfo->HmdToEyePose.Position = {eye == pvrEye_Left ? -0.0315f : 0.0315f, 0, 0};
+        return pvr_success;
+    }
+
+    pvrResult mock_getHmdStatus(pvrHmdHandle hmdh, pvrHmdStatus* outStatus) {
+        *outStatus = {};
+        outStatus->ServiceReady = true;
+        outStatus->HmdPresent = true;
+        outStatus->HmdMounted = true;
+        outStatus->IsVisible = true;
+        return pvr_success;
+    }
+
+    pvrResult mock_setTrackingOriginType(pvrHmdHandle hmdh, pvrTrackingOrigin origin) {
+        return pvr_success;
+    }
+
+    pvrResult mock_getTrackingOriginType(pvrHmdHandle hmdh, pvrTrackingOrigin* origin) {
+        *origin = pvrTrackingOrigin_EyeLevel;
+        return pvr_success;
+    }
+
+    pvrResult mock_recenterTrackingOrigin(pvrHmdHandle hmdh) {
+        return pvr_success;
+    }
+
+    pvrResult mock_getTrackedDevicePoseState(pvrHmdHandle hmdh,
+                                             pvrTrackedDeviceType device,
+                                             double absTime,
+                                             pvrPoseStatef* state) {
+        *state = {};
+        int index;
+        switch (device) {
+        case pvrTrackedDevice_HMD:
+            index = 0;
+            break;
+        case pvrTrackedDevice_LeftController:
+            index = 1;
+            break;
+        case pvrTrackedDevice_RightController:
+            index = 2;
+            break;
+        default:
+            return pvr_invalid_param;
+        }
+        if (samplePose(index, absTime, state->ThePose, state->LinearVelocity, state->AngularVelocity)) {
+            state->StatusFlags = pvrStatus_OrientationTracked | pvrStatus_PositionTracked;
+        }
+        state->TimeInSeconds = absTime;
+        return pvr_success;
+    }
+
+    pvrResult mock_getTrackingState(pvrHmdHandle hmdh, double absTime, pvrTrackingState* state) {
+        *state = {};
+        return mock_getTrackedDevicePoseState(hmdh, pvrTrackedDevice_HMD, absTime, &state->HeadPose);
+    }
+
+    pvrResult mock_getInputState(pvrHmdHandle hmdh, pvrInputState* inputState) {
+        *inputState = {};
+        inputState->TimeInSeconds = now();
+        for (int side = 0; side < 2; side++) {
+            const InputSample* sample = sampleInput(side, inputState->TimeInSeconds);
+            if (!sample) {
+                continue;
+            }
+            inputState->HandButtons[side] = sample->buttons;
+            inputState->HandTouches[side] = sample->touches;
+            inputState->Trigger[side] = sample->trigger;
+            inputState->Grip[side] = sample->grip;
+            inputState->JoyStick[side] = sample->joystick;
+        }
+        return pvr_success;
+    }
+
+    pvrResult mock_triggerHapticPulse(pvrHmdHandle hmdh, pvrTrackedDeviceType device, float intensity) {
+        return pvr_success;
+    }
+
+    pvrResult mock_getSkeletalData(pvrHmdHandle hmdh,
+                                   pvrTrackedDeviceType device,
+                                   pvrSkeletalMotionRange range,
+                                   pvrSkeletalData* data) {
+        *data = {};
+        return pvr_not_support;
+    }
+
+    pvrResult mock_getEyeTrackingInfo(pvrHmdHandle hmdh, double absTime, pvrEyeTrackingInfo* outInfo) {
+        // A time of 0 signals that there is no valid gaze.
+        *outInfo = {};
+        return pvr_success;
+    }
+
+    unsigned int mock_getEyeHiddenAreaMesh(pvrHmdHandle hmdh,
+                                           pvrEyeType eye,
+                                           pvrVector2f* outVertexBuffer,
+                                           unsigned int bufferCount) {
+        return 0;
+    }
+
+    pvrResult mock_getFovTextureSize(
+        pvrHmdHandle hmdh, pvrEyeType eye, pvrFovPort fov, float pixelsPerDisplayPixel, pvrSizei* size) {
+        const float tangent = std::tan(g_config.fov / 2 * 3.14159265f / 180);
+        size->w = (int)std::ceil(g_config.width * (fov.LeftTan + fov.RightTan) / (2 * tangent) * pixelsPerDisplayPixel);
+        size->h = (int)std::ceil(g_config.height * (fov.UpTan + fov.DownTan) / (2 * tangent) * pixelsPerDisplayPixel);
+        return pvr_success;
+    }
+
+    void mock_calcEyePoses(pvrPosef headPose, const pvrPosef hmdToEyePose[2], pvrPosef outEyePoses[2]) {
+        for (int eye = 0; eye < 2; eye++) {
+            outEyePoses[eye] = compose(headPose, hmdToEyePose[eye]);
+        }
+    }
+
+    pvrResult mock_createTextureSwapChainDX(pvrHmdHandle hmdh,
+                                            IUnknown* d3dPtr,
+                                            const pvrTextureSwapChainDesc* desc,
+                                            pvrTextureSwapChain* out_TextureSwapChain) {
+        ComPtr<ID3D11Device> device;
+        if (FAILED(d3dPtr->QueryInterface(IID_PPV_ARGS(device.ReleaseAndGetAddressOf())))) {
+            return pvr_not_support;
+        }
+
+        const bool typeless = desc->MiscFlags & pvrTextureMisc_DX_Typeless;
+        D3D11_TEXTURE2D_DESC textureDesc{};
+        textureDesc.Format = getDxgiFormat(desc->Format, typeless);
+        if (textureDesc.Format == DXGI_FORMAT_UNKNOWN) {
+            return pvr_invalid_param;
+        }
+        textureDesc.Width = desc->Width;
+        textureDesc.Height = desc->Height;
+        textureDesc.ArraySize = desc->ArraySize;
+        textureDesc.MipLevels = desc->MipLevels;
+        textureDesc.SampleDesc.Count = desc->SampleCount;
+        textureDesc.Usage = D3D11_USAGE_DEFAULT;
+        const bool isDepth = desc->BindFlags & pvrTextureBind_DX_DepthStencil;
+        if (!isDepth || typeless) {
+            textureDesc.BindFlags |= D3D11_BIND_SHADER_RESOURCE;
+        }
+        if (desc->BindFlags & pvrTextureBind_DX_RenderTarget) {
+            textureDesc.BindFlags |= D3D11_BIND_RENDER_TARGET;
+        }
+        if (isDepth) {
+            textureDesc.BindFlags |= D3D11_BIND_DEPTH_STENCIL;
+        }
+        if (desc->BindFlags & pvrTextureBind_DX_UnorderedAccess) {
+            textureDesc.BindFlags |= D3D11_BIND_UNORDERED_ACCESS;
+        }
+        if (desc->MiscFlags & pvrTextureMisc_AllowGenerateMips) {
+            textureDesc.MiscFlags |= D3D11_RESOURCE_MISC_GENERATE_MIPS;
+        }
+        // Like the real compositor, the textures are shareable.
+        if (desc->SampleCount <= 1) {
+            textureDesc.MiscFlags |= D3D11_RESOURCE_MISC_SHARED;
+        }
+
+        auto swapchain = std::make_unique<Swapchain>();
+        swapchain->desc = *desc;
+        const int length = desc->StaticImage ? 1 : k_swapchainLength;
+        for (int i = 0; i < length; i++) {
+            ComPtr<ID3D11Texture2D> texture;
+            if (FAILED(device->CreateTexture2D(&textureDesc, nullptr, texture.ReleaseAndGetAddressOf()))) {
+                return pvr_failed;
+            }
+            swapchain->images.push_back(texture);
+        }
+
+        *out_TextureSwapChain = reinterpret_cast<pvrTextureSwapChain>(swapchain.release());
+        return pvr_success;
+    }
+
+    void mock_destroyTextureSwapChain(pvrHmdHandle hmdh, pvrTextureSwapChain chain) {
+        delete reinterpret_cast<Swapchain*>(chain);
+    }
+
+    pvrResult mock_getTextureSwapChainLength(pvrHmdHandle hmdh, pvrTextureSwapChain chain, int* out_Length) {
+        *out_Length = (int)reinterpret_cast<Swapchain*>(chain)->images.size();
+        return pvr_success;
+    }
+
+    pvrResult mock_getTextureSwapChainDesc(pvrHmdHandle hmdh,
+                                           pvrTextureSwapChain chain,
+                                           pvrTextureSwapChainDesc* out_Desc) {
+        *out_Desc = reinterpret_cast<Swapchain*>(chain)->desc;
+        return pvr_success;
+    }
+
+    pvrResult mock_getTextureSwapChainCurrentIndex(pvrHmdHandle hmdh, pvrTextureSwapChain chain, int* out_Index) {
+        *out_Index = reinterpret_cast<Swapchain*>(chain)->currentIndex;
+        return pvr_success;
+    }
+
+    pvrResult mock_commitTextureSwapChain(pvrHmdHandle hmdh, pvrTextureSwapChain chain) {
+        Swapchain* swapchain = reinterpret_cast<Swapchain*>(chain);
+        swapchain->currentIndex = (swapchain->currentIndex + 1) % swapchain->images.size();
+        return pvr_success;
+    }
+
+    pvrResult mock_getTextureSwapChainBufferDX(
+        pvrHmdHandle hmdh, pvrTextureSwapChain chain, int index, IID iid, void** out_Buffer) {
+        Swapchain* swapchain = reinterpret_cast<Swapchain*>(chain);
+        if (index < 0 || index >= (int)swapchain->images.size()) {
+            return pvr_invalid_param;
+        }
+        return SUCCEEDED(swapchain->images[index]->QueryInterface(iid, out_Buffer)) ? pvr_success : pvr_failed;
+    }
+
+    pvrResult mock_createMirrorTextureDX(pvrHmdHandle hmdh,
+                                         IUnknown* d3dPtr,
+                                         const pvrMirrorTextureDesc* desc,
+                                         pvrMirrorTexture* out_MirrorTexture) {
+        ComPtr<ID3D11Device> device;
+        if (FAILED(d3dPtr->QueryInterface(IID_PPV_ARGS(device.ReleaseAndGetAddressOf())))) {
+            return pvr_not_support;
+        }
+
+        D3D11_TEXTURE2D_DESC textureDesc{};
+        textureDesc.Format = getDxgiFormat(desc->Format, false);
+        if (textureDesc.Format == DXGI_FORMAT_UNKNOWN) {
+            return pvr_invalid_param;
+        }
+        textureDesc.Width = desc->Width;
+        textureDesc.Height = desc->Height;
+        textureDesc.ArraySize = 1;
+        textureDesc.MipLevels = 1;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Usage = D3D11_USAGE_DEFAULT;
+        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+
+        auto mirrorTexture = std::make_unique<MirrorTexture>();
+        if (FAILED(device->CreateTexture2D(&textureDesc, nullptr, mirrorTexture->texture.ReleaseAndGetAddressOf()))) {
+            return pvr_failed;
+        }
+
+        *out_MirrorTexture = reinterpret_cast<pvrMirrorTexture>(mirrorTexture.release());
+        return pvr_success;
+    }
+
+    pvrResult
+    mock_getMirrorTextureBufferDX(pvrHmdHandle hmdh, pvrMirrorTexture mirrorTexture, IID iid, void** out_Buffer) {
+        return SUCCEEDED(reinterpret_cast<MirrorTexture*>(mirrorTexture)->texture->QueryInterface(iid, out_Buffer))
+                   ? pvr_success
+                   : pvr_failed;
+    }
+
+    void mock_destroyMirrorTexture(pvrHmdHandle hmdh, pvrMirrorTexture mirrorTexture) {
+        delete reinterpret_cast<MirrorTexture*>(mirrorTexture);
+    }
+
+    pvrResult mock_waitToBeginFrame(pvrHmdHandle hmdh, long long frameIndex) {
+        double vsync;
+        {
+            std::unique_lock lock(g_globalLock);
+            vsync = g_nextFrameVsync;
+        }
+
+        // When the application is late, the frame begins on the vsync that was just missed.
+        const double current = now();
+        if (vsync > current) {
+            waitUntil(vsync);
+        } else {
+            vsync = nextVsyncAfter(current) - g_framePeriod;
+        }
+
+        std::unique_lock lock(g_globalLock);
+        g_frameVsyncIndex[frameIndex % k_framesInFlight] = frameIndex;
+        g_frameVsync[frameIndex % k_framesInFlight] = vsync;
+        return pvr_success;
+    }
+
+    pvrResult mock_beginFrame(pvrHmdHandle hmdh, long long frameIndex) {
+        return pvr_success;
+    }
+
+    double mock_getPredictedDisplayTime(pvrHmdHandle hmdh, long long frameIndex) {
+        std::unique_lock lock(g_globalLock);
+        const int slot = frameIndex % k_framesInFlight;
+        const double vsync =
+            g_frameVsyncIndex[slot] == frameIndex ? g_frameVsync[slot] : nextVsyncAfter(now()) - g_framePeriod;
+        return vsync + g_config.latency;
+    }
+
+    pvrResult mock_endFrame(pvrHmdHandle hmdh,
+                            long long frameIndex,
+                            pvrLayerHeader const* const* layerPtrList,
+                            unsigned int layerCount) {
+        const double start = now();
+        if (g_config.endFrameCost > 0) {
+            waitUntil(start + g_config.endFrameCost);
+        }
+        const double end = now();
+
+        std::unique_lock lock(g_globalLock);
+
+        g_nextFrameVsync = nextVsyncAfter(end);
+        if (g_lastSubmitTime > 0) {
+            // Exponential moving average over about one second.
+            const float instantFps = (float)(1 / (end - g_lastSubmitTime));
+            const float weight = std::min(1.f, 1.f / g_config.refreshRate);
+            g_fps = g_fps ? g_fps + (instantFps - g_fps) * weight : instantFps;
+        }
+        g_lastSubmitTime = end;
+        g_framesSubmitted++;
+
+        if (g_record.is_open()) {
+            const int slot = frameIndex % k_framesInFlight;
+            const double waitTime =
+                g_frameVsyncIndex[slot] == frameIndex ? (start - g_frameVsync[slot]) * 1000 : 0.0;
+            g_record << frameIndex << ',' << start << ',' << waitTime << ',' << layerCount << ',';
+            for (unsigned int i = 0; i < layerCount; i++) {
+                const pvrLayerHeader* const layer = layerPtrList[i];
+                if (i) {
+                    g_record << ';';
+                }
+                g_record << getLayerTypeName(layer->Type);
+                if (layer->Type == pvrLayerType_EyeFov) {
+                    const auto* const eyeFov = reinterpret_cast<const pvrLayerEyeFov*>(layer);
+                    g_record << ':' << eyeFov->Viewport[0].Size.w << 'x' << eyeFov->Viewport[0].Size.h;
+                } else if (layer->Type == pvrLayerType_EyeFovDepth) {
+                    const auto* const eyeFovDepth = reinterpret_cast<const pvrLayerEyeFovDepth*>(layer);
+                    g_record << ':' << eyeFovDepth->Viewport[0].Size.w << 'x' << eyeFovDepth->Viewport[0].Size.h;
+                } else if (layer->Type == pvrLayerType_Quad) {
+                    const auto* const quad = reinterpret_cast<const pvrLayerQuad*>(layer);
+                    g_record << ':' << quad->Viewport.Size.w << 'x' << quad->Viewport.Size.h;
+                }
+            }
+            g_record << '\n';
+        }
+
+        return pvr_success;
+    }
+
+    pvrResult mock_submitFrame(pvrHmdHandle hmdh,
+                               long long frameIndex,
+                               pvrLayerHeader const* const* layerPtrList,
+                               unsigned int layerCount) {
+        return mock_endFrame(hmdh, frameIndex, layerPtrList, layerCount);
+    }
+
+    float mock_getFloatConfig(pvrHmdHandle hmdh, const char* key, float def_val) {
+        std::unique_lock lock(g_globalLock);
+        if (std::string_view(key) == "client_fps") {
+            return g_fps;
+        }
+        const auto it = g_floatConfigs.find(key);
+        return it != g_floatConfigs.cend() ? it->second : def_val;
+    }
+
+    pvrResult mock_setFloatConfig(pvrHmdHandle hmdh, const char* key, float val) {
+        std::unique_lock lock(g_globalLock);
+        g_floatConfigs[key] = val;
+        return pvr_success;
+    }
+
+    int mock_getIntConfig(pvrHmdHandle hmdh, const char* key, int def_val) {
+        std::unique_lock lock(g_globalLock);
+        const auto it = g_intConfigs.find(key);
+        return it != g_intConfigs.cend() ? it->second : def_val;
+    }
+
+    pvrResult mock_setIntConfig(pvrHmdHandle hmdh, const char* key, int val) {
+        std::unique_lock lock(g_globalLock);
+        g_intConfigs[key] = val;
+        return pvr_success;
+    }
+
+    int mock_getStringConfig(pvrHmdHandle hmdh, const char* key, char* val, int size) {
+        std::unique_lock lock(g_globalLock);
+        const auto it = g_stringConfigs.find(key);
+        if (it == g_stringConfigs.cend()) {
+            return 0;
+        }
+        if (val && size > 0) {
+            strncpy_s(val, size, it->second.c_str(), _TRUNCATE);
+        }
+        return (int)it->second.size() + 1;
+    }
+
+    pvrResult mock_setStringConfig(pvrHmdHandle hmdh, const char* key, const char* val) {
+        std::unique_lock lock(g_globalLock);
+        g_stringConfigs[key] = val;
+        return pvr_success;
+    }
+
+    int mock_getTrackedDeviceIntProperty(pvrHmdHandle hmdh,
+                                         pvrTrackedDeviceType device,
+                                         pvrTrackedDeviceProp prop,
+                                         int def_val) {
+        if (device != pvrTrackedDevice_HMD && !g_config.controllerType.empty() &&
+            prop == pvrTrackedDeviceProp_BatteryPercent_int) {
+            return 100;
+        }
+        return def_val;
+    }
+
+    int mock_getTrackedDeviceStringProperty(
+        pvrHmdHandle hmdh, pvrTrackedDeviceType device, pvrTrackedDeviceProp prop, char* val, int size) {
+        if (device == pvrTrackedDevice_HMD || g_config.controllerType.empty() ||
+            prop != pvrTrackedDeviceProp_ControllerType_String) {
+            return 0;
+        }
+        if (val && size > 0) {
+            strncpy_s(val, size, g_config.controllerType.c_str(), _TRUNCATE);
+        }
+        return (int)g_config.controllerType.size() + 1;
+    }
+
+    void mock_logMessage(pvrLogLevel level, const char* message) {
+        OutputDebugStringA(message);
+    }
+
+    void* mock_getDxGlInterface(const char* api) {
+        return std::string_view(api) == "dx" ? &g_interfaceD3D : nullptr;
+    }
+
+} // namespace
+
+extern "C" __declspec(dllexport) pvrInterface* getPvrInterface(uint32_t major_ver, uint32_t minor_ver) {
+    std::unique_lock lock(g_globalLock);
+
+    // Only populate the entry points that the runtime uses. The others are left null on purpose, in order to catch
+    // any new dependency on PVR immediately.
+    g_interface = {};
+    g_interface.initialise = mock_initialise;
+    g_interface.shutdown = mock_shutdown;
+    g_interface.getVersionString = mock_getVersionString;
+    g_interface.getTimeSeconds = mock_getTimeSeconds;
+    g_interface.createHmd = mock_createHmd;
+    g_interface.destroyHmd = mock_destroyHmd;
+    g_interface.getHmdInfo = mock_getHmdInfo;
+    g_interface.getEyeDisplayInfo = mock_getEyeDisplayInfo;
+    g_interface.getEyeRenderInfo = mock_getEyeRenderInfo;
+    g_interface.getHmdStatus = mock_getHmdStatus;
+    g_interface.setTrackingOriginType = mock_setTrackingOriginType;
+    g_interface.getTrackingOriginType = mock_getTrackingOriginType;
+    g_interface.recenterTrackingOrigin = mock_recenterTrackingOrigin;
+    g_interface.getTrackingState = mock_getTrackingState;
+    g_interface.getTrackedDevicePoseState = mock_getTrackedDevicePoseState;
+    g_interface.getInputState = mock_getInputState;
+    g_interface.triggerHapticPulse = mock_triggerHapticPulse;
+    g_interface.getSkeletalData = mock_getSkeletalData;
+    g_interface.getEyeTrackingInfo = mock_getEyeTrackingInfo;
+    g_interface.getEyeHiddenAreaMesh = mock_getEyeHiddenAreaMesh;
+    g_interface.getFovTextureSize = mock_getFovTextureSize;
+    g_interface.calcEyePoses = mock_calcEyePoses;
+    g_interface.destroyTextureSwapChain = mock_destroyTextureSwapChain;
+    g_interface.getTextureSwapChainLength = mock_getTextureSwapChainLength;
+    g_interface.getTextureSwapChainDesc = mock_getTextureSwapChainDesc;
+    g_interface.getTextureSwapChainCurrentIndex = mock_getTextureSwapChainCurrentIndex;
+    g_interface.commitTextureSwapChain = mock_commitTextureSwapChain;
+    g_interface.destroyMirrorTexture = mock_destroyMirrorTexture;
+    g_interface.waitToBeginFrame = mock_waitToBeginFrame;
+    g_interface.beginFrame = mock_beginFrame;
+    g_interface.getPredictedDisplayTime = mock_getPredictedDisplayTime;
+    g_interface.endFrame = mock_endFrame;
+    g_interface.submitFrame = mock_submitFrame;
+    g_interface.getFloatConfig = mock_getFloatConfig;
+    g_interface.setFloatConfig = mock_setFloatConfig;
+    g_interface.getIntConfig = mock_getIntConfig;
+    g_interface.setIntConfig = mock_setIntConfig;
+    g_interface.getStringConfig = mock_getStringConfig;
+    g_interface.setStringConfig = mock_setStringConfig;
+    g_interface.getTrackedDeviceIntProperty = mock_getTrackedDeviceIntProperty;
+    g_interface.getTrackedDeviceStringProperty = mock_getTrackedDeviceStringProperty;
+    g_interface.logMessage = mock_logMessage;
+    g_interface.getDxGlInterface = mock_getDxGlInterface;
+
+    g_interfaceD3D = {};
+    g_interfaceD3D.createTextureSwapChainDX = mock_createTextureSwapChainDX;
+    g_interfaceD3D.getTextureSwapChainBufferDX = mock_getTextureSwapChainBufferDX;
+    g_interfaceD3D.createMirrorTextureDX = mock_createMirrorTextureDX;
+    g_interfaceD3D.getMirrorTextureBufferDX = mock_getMirrorTextureBufferDX;
+
+    return &g_interface;
+}
+
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
+    return TRUE;
+}
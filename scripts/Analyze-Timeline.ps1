@@ -0,0 +1,131 @@
+param (
+    [Parameter(Mandatory=$true)]
+    [string]$TimelineFile,
+    [double]$BucketMs = 1.0,
+    [int]$SkipFrames = 90
+)
+
+# Must match pimax-openxr/timeline.h.
+$Magic = 0x4C545850
+$Version = 1
+
+$ErrorActionPreference = "Stop"
+
+function Write-Distribution {
+    param (
+        [string]$Title,
+        [double[]]$ValuesMs
+    )
+
+    Write-Host "${Title} ($($ValuesMs.Count) samples)"
+    if ($ValuesMs.Count -eq 0) {
+        return
+    }
+
+    $sorted = $ValuesMs | Sort-Object
+    $percentiles = @(50, 90, 99, 99.9)
+    $line = ""
+    foreach ($p in $percentiles) {
+        $index = [Math]::Min($sorted.Count - 1, [Math]::Floor($sorted.Count * $p / 100))
+        $line += "  p${p}: $($sorted[$index].ToString('0.00')) ms"
+    }
+    $line += "  max: $($sorted[-1].ToString('0.00')) ms"
+    Write-Host $line
+
+    $buckets = @{}
+    foreach ($value in $sorted) {
+        $bucket = [Math]::Floor($value / $BucketMs)
+        $buckets[$bucket] = $buckets[$bucket] + 1
+    }
+    $maxCount = ($buckets.Values | Measure-Object -Maximum).Maximum
+    foreach ($bucket in ($buckets.Keys | Sort-Object)) {
+        $count = $buckets[$bucket]
+        $bar = "#" * [Math]::Max(1, [Math]::Round(50 * $count / $maxCount))
+        $label = "{0,7:0.0}-{1,-7:0.0}" -f ($bucket * $BucketMs), (($bucket + 1) * $BucketMs)
+        Write-Host ("  {0} ms {1,8} {2}" -f $label, $count, $bar)
+    }
+    Write-Host ""
+}
+
+$reader = New-Object System.IO.BinaryReader([System.IO.File]::OpenRead((Resolve-Path $TimelineFile)))
+try {
+    if ($reader.ReadUInt32() -ne $Magic) {
+        throw "Not a frame timeline file"
+    }
+    $fileVersion = $reader.ReadUInt32()
+    if ($fileVersion -ne $Version) {
+        throw "Unsupported frame timeline version: ${fileVersion}"
+    }
+    $recordSize = $reader.ReadUInt32()
+    [void]$reader.ReadUInt32()
+    $refreshRate = $reader.ReadDouble()
+    $applicationName = [System.Text.Encoding]::UTF8.GetString($reader.ReadBytes(128)).TrimEnd([char]0)
+
+    Write-Host "Application: ${applicationName}"
+    Write-Host "Refresh rate: $($refreshRate.ToString('0.##')) Hz"
+
+    $frameIntervals = New-Object System.Collections.Generic.List[double]
+    $motionToPhoton = New-Object System.Collections.Generic.List[double]
+    $appFrame = New-Object System.Collections.Generic.List[double]
+    $submission = New-Object System.Collections.Generic.List[double]
+    $frames = 0
+    $discarded = 0
+    $smartSmoothing = 0
+    $lastEndFrame = 0.0
+
+    while ($reader.BaseStream.Position + $recordSize -le $reader.BaseStream.Length) {
+        $start = $reader.BaseStream.Position
+        $frameId = $reader.ReadUInt64()
+        $waitFrameStart = $reader.ReadDouble()
+        $waitFrameEnd = $reader.ReadDouble()
+        $predictedDisplayTime = $reader.ReadDouble()
+        $beginFrame = $reader.ReadDouble()
+        $endFrameStart = $reader.ReadDouble()
+        $displayTime = $reader.ReadDouble()
+        $precompositionEnd = $reader.ReadDouble()
+        $pvrEndFrameStart = $reader.ReadDouble()
+        $pvrEndFrameEnd = $reader.ReadDouble()
+        $layerCount = $reader.ReadUInt32()
+        $flags = $reader.ReadUInt32()
+        $reader.BaseStream.Position = $start + $recordSize
+
+        $frames++
+        if ($frames -le $SkipFrames) {
+            $lastEndFrame = $pvrEndFrameEnd
+            continue
+        }
+        if ($flags -band 1) {
+            $discarded++
+        }
+        if ($flags -band 4) {
+            $smartSmoothing++
+        }
+
+        if ($lastEndFrame -gt 0 -and $pvrEndFrameEnd -gt 0) {
+            $frameIntervals.Add(($pvrEndFrameEnd - $lastEndFrame) * 1000)
+        }
+        $lastEndFrame = $pvrEndFrameEnd
+
+        # The application samples its poses for the predicted display time upon returning from xrWaitFrame(), so the
+        # motion-to-photon latency is estimated as the time from then until the frame is displayed.
+        if ($waitFrameEnd -gt 0 -and $predictedDisplayTime -gt 0) {
+            $motionToPhoton.Add(($predictedDisplayTime - $waitFrameEnd) * 1000)
+        }
+        if ($beginFrame -gt 0 -and $endFrameStart -gt 0) {
+            $appFrame.Add(($endFrameStart - $beginFrame) * 1000)
+        }
+        if ($endFrameStart -gt 0 -and $pvrEndFrameEnd -gt 0) {
+            $submission.Add(($pvrEndFrameEnd - $endFrameStart) * 1000)
+        }
+    }
+} finally {
+    $reader.Close()
+}
+
+Write-Host "Frames: ${frames} (skipped ${SkipFrames}, ${discarded} discarded, ${smartSmoothing} with Smart Smoothing)"
+Write-Host ""
+
+Write-Distribution "Frame interval" $frameIntervals.ToArray()
+Write-Distribution "Motion-to-photon (estimated)" $motionToPhoton.ToArray()
+Write-Distribution "xrBeginFrame to xrEndFrame" $appFrame.ToArray()
+Write-Distribution "xrEndFrame to pvr_endFrame completion" $submission.ToArray()
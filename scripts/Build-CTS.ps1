@@ -36,3 +36,4 @@ Copy-Item $PSScriptRoot\..\bin\x64\CTS\src\conformance\conformance_layer\$BuildT
 Copy-Item $PSScriptRoot\..\bin\x64\CTS\src\conformance\conformance_layer\XrApiLayer_runtime_conformance.json $PSScriptRoot\..\bin\x64\CTS\output -Force
 
 Write-Host "All output in: $PSScriptRoot\..\bin\x64\CTS\output"
+Write-Host "To run without a headset, set PIMAX_OPENXR_PVR_CLIENT to the path of the libPVRClient64.dll built by pvr-mock"